@@ -10,6 +10,22 @@
 
 #include <boost/detail/endian.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <cstddef>
+#include <cstring>
+
+//  The bulk conversions use SSSE3/AVX2 byte shuffles when the compiler targets them.
+//  Define BOOST_ENDIAN_NO_INTRINSICS to force the portable scalar loop.
+#if !defined(BOOST_ENDIAN_NO_INTRINSICS)
+# if defined(__AVX2__)
+#   define BOOST_ENDIAN_AVX2
+#   define BOOST_ENDIAN_SSSE3
+#   include <immintrin.h>
+# elif defined(__SSSE3__)
+#   define BOOST_ENDIAN_SSSE3
+#   include <tmmintrin.h>
+# endif
+#endif
 
 //------------------------------------- synopsis ---------------------------------------//
 
@@ -52,6 +68,24 @@ namespace endian
   template <class T> inline void big_to_native(T source, T& target);
   template <class T> inline void little_to_native(T source, T& target);
 
+  // bulk unconditional modifying (i.e. in-place) reverse byte order of [first, last);
+  //   T may be any 2, 4 or 8 byte type, including float and double
+
+  template <class T> inline void reorder(T* first, T* last);
+
+  // bulk unconditional non-modifying reverse byte order copy of n elements;
+  //   source and target may be identical, but must not otherwise overlap
+
+  template <class T> inline void reorder(const T* source, T* target, std::size_t n);
+
+  // bulk non-modifying conditional reverse byte order copy of n elements;
+  //   source and target may be identical, but must not otherwise overlap
+
+  template <class T> inline void native_to_big(const T* source, T* target, std::size_t n);
+  template <class T> inline void native_to_little(const T* source, T* target, std::size_t n);
+  template <class T> inline void big_to_native(const T* source, T* target, std::size_t n);
+  template <class T> inline void little_to_native(const T* source, T* target, std::size_t n);
+
 //----------------------------------- implementation -----------------------------------//
                                                 
   inline void reorder(int16_t& x)
@@ -216,6 +250,104 @@ namespace endian
   template <class T> inline void little_to_native(T little, T& native) { reorder(source, target); }
 #endif
 
+//----------------------------------- bulk implementation ------------------------------//
+
+  //  not named detail: that would hide boost::detail from the endian classes in integers.hpp
+  namespace conversion_detail
+  {
+    template <std::size_t N> struct bulk_word;
+    template <> struct bulk_word<2> { typedef uint16_t type; };
+    template <> struct bulk_word<4> { typedef uint32_t type; };
+    template <> struct bulk_word<8> { typedef uint64_t type; };
+
+    //  byte reversal of a single N byte element; memcpy keeps this free of aliasing
+    //  problems for float and double, and compiles to a load, bswap and store
+    template <std::size_t N>
+    inline void reorder_element(const char* source, char* target)
+    {
+      typename bulk_word<N>::type x;
+      std::memcpy(&x, source, N);
+      reorder(x);
+      std::memcpy(target, &x, N);
+    }
+
+#ifdef BOOST_ENDIAN_SSSE3
+    //  pshufb control reversing each N byte element of a 16 byte lane
+    template <std::size_t N>
+    inline __m128i reorder_mask()
+    {
+      return N == 2 ? _mm_set_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1)
+           : N == 4 ? _mm_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3)
+           :          _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+    }
+#endif
+
+    //  reverses the bytes of each of the n N-byte elements at source, storing at target
+    template <std::size_t N>
+    inline void reorder_n(const char* source, char* target, std::size_t n)
+    {
+      BOOST_STATIC_ASSERT(N == 2 || N == 4 || N == 8);
+
+      std::size_t bytes = n * N;
+      std::size_t k = 0;
+
+#ifdef BOOST_ENDIAN_SSSE3
+      const __m128i mask = reorder_mask<N>();
+# ifdef BOOST_ENDIAN_AVX2
+      //  vpshufb shuffles within each 128 bit lane, so the same control serves both lanes
+      const __m256i mask2 = _mm256_broadcastsi128_si256(mask);
+      for (; k + 64 <= bytes; k += 64)
+      {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + k));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + k + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + k), _mm256_shuffle_epi8(a, mask2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + k + 32), _mm256_shuffle_epi8(b, mask2));
+      }
+# endif
+      for (; k + 16 <= bytes; k += 16)
+      {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + k));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + k), _mm_shuffle_epi8(a, mask));
+      }
+#endif
+
+      //  scalar tail (or the whole range without SSSE3)
+      for (; k < bytes; k += N)
+        reorder_element<N>(source + k, target + k);
+    }
+
+    template <class T>
+    inline void copy_n(const T* source, T* target, std::size_t n)
+    {
+      if (source != target)
+        std::memcpy(target, source, n * sizeof(T));
+    }
+  } // namespace conversion_detail
+
+  template <class T> inline void reorder(T* first, T* last)
+  {
+    conversion_detail::reorder_n<sizeof(T)>(reinterpret_cast<const char*>(first),
+      reinterpret_cast<char*>(first), last - first);
+  }
+
+  template <class T> inline void reorder(const T* source, T* target, std::size_t n)
+  {
+    conversion_detail::reorder_n<sizeof(T)>(reinterpret_cast<const char*>(source),
+      reinterpret_cast<char*>(target), n);
+  }
+
+#ifdef BOOST_LITTLE_ENDIAN
+  template <class T> inline void native_to_big(const T* source, T* target, std::size_t n)    { reorder(source, target, n); }
+  template <class T> inline void native_to_little(const T* source, T* target, std::size_t n) { conversion_detail::copy_n(source, target, n); }
+  template <class T> inline void big_to_native(const T* source, T* target, std::size_t n)    { reorder(source, target, n); }
+  template <class T> inline void little_to_native(const T* source, T* target, std::size_t n) { conversion_detail::copy_n(source, target, n); }
+#else
+  template <class T> inline void native_to_big(const T* source, T* target, std::size_t n)    { conversion_detail::copy_n(source, target, n); }
+  template <class T> inline void native_to_little(const T* source, T* target, std::size_t n) { reorder(source, target, n); }
+  template <class T> inline void big_to_native(const T* source, T* target, std::size_t n)    { conversion_detail::copy_n(source, target, n); }
+  template <class T> inline void little_to_native(const T* source, T* target, std::size_t n) { reorder(source, target, n); }
+#endif
+
 }  // namespace endian
 }  // namespace boost
 
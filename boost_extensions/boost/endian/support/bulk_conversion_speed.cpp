@@ -0,0 +1,119 @@
+//  bulk_conversion_speed.cpp  ---------------------------------------------------------//
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//
+//  Compares the bulk reorder and native_to_big overloads of boost/endian/conversion.hpp
+//  with a loop over the scalar reorder, for 2, 4 and 8 byte elements and for double.
+//
+//  usage: bulk_conversion_speed [elements [repetitions]]
+//
+//  Build once with -mavx2 (or -mssse3) and once with -DBOOST_ENDIAN_NO_INTRINSICS to
+//  compare the shuffle kernels with the portable loop.
+//
+//--------------------------------------------------------------------------------------//
+
+#include <boost/endian/conversion.hpp>
+#include <boost/timer/timer.hpp>
+#include <boost/cstdint.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace boost::endian;
+
+namespace
+{
+  std::size_t n = 1 << 24;
+  int reps = 10;
+
+  template <class T>
+  void fill(std::vector<T>& v)
+  {
+    for (std::size_t i = 0; i < v.size(); ++i)
+      v[i] = static_cast<T>(i * 2654435761u);
+  }
+
+  //  reference: the scalar in-place reorder applied element by element
+  template <class U, class T>
+  void scalar_reorder(T* first, T* last)
+  {
+    for (; first != last; ++first)
+    {
+      U x;
+      std::memcpy(&x, first, sizeof(U));
+      reorder(x);
+      std::memcpy(first, &x, sizeof(U));
+    }
+  }
+
+  double gb_per_s(const boost::timer::cpu_timer& t, std::size_t bytes)
+  {
+    double seconds = t.elapsed().wall * 1e-9;
+    return seconds > 0 ? bytes * double(reps) / seconds / 1e9 : 0;
+  }
+
+  template <class T, class U>
+  void run(const char* name)
+  {
+    std::vector<T> v(n), w(n);
+    fill(v);
+    const std::size_t bytes = n * sizeof(T);
+
+    boost::timer::cpu_timer t;
+    for (int r = 0; r < reps; ++r)
+      scalar_reorder<U>(&v[0], &v[0] + n);
+    t.stop();
+    double scalar = gb_per_s(t, bytes);
+
+    t.start();
+    for (int r = 0; r < reps; ++r)
+      reorder(&v[0], &v[0] + n);
+    t.stop();
+    double in_place = gb_per_s(t, bytes);
+
+    t.start();
+    for (int r = 0; r < reps; ++r)
+      native_to_big(&v[0], &w[0], n);
+    t.stop();
+    double copy = gb_per_s(t, bytes);
+
+    std::cout << std::setw(10) << name
+              << std::setw(14) << scalar
+              << std::setw(14) << in_place
+              << std::setw(14) << copy << " GB/s\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc > 1)
+    n = std::strtoul(argv[1], 0, 10);
+  if (argc > 2)
+    reps = std::atoi(argv[2]);
+
+  std::cout << n << " elements, " << reps << " repetitions, kernel: "
+#if defined(BOOST_ENDIAN_AVX2)
+            << "AVX2"
+#elif defined(BOOST_ENDIAN_SSSE3)
+            << "SSSE3"
+#else
+            << "scalar"
+#endif
+            << "\n\n" << std::setw(10) << "type"
+            << std::setw(14) << "scalar loop"
+            << std::setw(14) << "reorder"
+            << std::setw(14) << "native_to_big" << '\n';
+
+  run<boost::uint16_t, boost::uint16_t>("uint16_t");
+  run<boost::uint32_t, boost::uint32_t>("uint32_t");
+  run<boost::uint64_t, boost::uint64_t>("uint64_t");
+  run<double, boost::uint64_t>("double");
+
+  return 0;
+}
@@ -275,7 +275,7 @@ public:
     // the counter sequence.
     typedef std::pair<domain_type, size_t> pos_type;
     pos_type tell() const{ 
-        return make_pair(c, nth());
+        return std::make_pair(c, nth());
     }
     void seek(pos_type pos){ 
         c = pos.first; setnext(pos.second);
@@ -32,7 +32,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef BOOST_RANDOM_COUNTER_BASED_URNG_HPP
 #define BOOST_RANDOM_COUNTER_BASED_URNG_HPP
 
+#include <istream>
 #include <stdexcept>
+#include <utility>
 #include <boost/cstdint.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits/make_unsigned.hpp>
@@ -129,6 +131,22 @@ public:
         setnext(newnth);
     }
 
+    // As in counter_based_engine: a pos_type with tell() and
+    // seek(pos_type) give the caller visibility into and control
+    // over where we are in the counter sequence.  Together with
+    // getprf() they are enough to save and restore the complete
+    // state without going through the stream operators.
+    typedef std::pair<domain_type, size_t> pos_type;
+    pos_type tell() const{
+        return std::make_pair(c, nth());
+    }
+    void seek(pos_type pos){
+        c = pos.first; setnext(pos.second);
+    }
+    const prf_type& getprf() const{
+        return b;
+    }
+
 protected:
     typedef typename domain_type::value_type dvalue_type;
     prf_type b;
@@ -63,8 +63,8 @@ struct aes_common : public prf_common<128/std::numeric_limits<Uint>::digits, 128
         : common_type(first, last), useAESNI(hasAESNI())
     { }
 
-    aes_common(aes_common& v) : common_type(static_cast<common_type &>(v)){}
-    aes_common(const aes_common& v) : common_type(static_cast<const common_type &>(v)), useAESNI(hasAESNI())
+    aes_common(aes_common& v) : common_type(static_cast<common_type &>(v)), useAESNI(v.useAESNI){}
+    aes_common(const aes_common& v) : common_type(static_cast<const common_type &>(v)), useAESNI(v.useAESNI)
     {}
 
     BOOST_RANDOM_DETAIL_SEED_SEQ_CONSTRUCTOR(aes_common, SeedSeq, seq)
@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef BOOST_RANDOM_DETAIL_AES_IMPL_HPP
 #define BOOST_RANDOM_DETAIL_AES_IMPL_HPP
 
+#include <ostream>
 #include <boost/endian/conversion.hpp>
 #include <boost/cstdint.hpp>
 #include "aes_config.hpp"
@@ -96,17 +96,14 @@ mulhilo_hw(Uint a, Uint b, Uint& hip){
 // Hopefully, the patch will be accepted before 1.49.  For now, the
 // ::exact typedefs follows a completely different code path and
 // tickle SFINAE as documented (and as we require).
+//
+// Newer versions of boost reject uint_t<128> with a static assertion
+// rather than a substitution failure, so instead of probing for the
+// typedef we compare against the widest integer boost knows about.
 template <typename Uint>
 class has_double_width{
-    typedef char yes[1];
-    typedef char no[2];
-
-    template <typename T>
-    static yes& test(typename uint_t<2*std::numeric_limits<T>::digits>::exact*);
-    template <typename>
-    static no& test(...);
 public:
-    static const bool value = sizeof(test<Uint>(0)) == sizeof(yes);
+    static const bool value = 2*std::numeric_limits<Uint>::digits <= std::numeric_limits<uintmax_t>::digits;
 };
 
 // mulhilo using double-width DblUint
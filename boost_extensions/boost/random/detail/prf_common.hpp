@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef BOOST_RANDOM_PRF_COMMON_HPP
 #define BOOST_RANDOM_PRF_COMMON_HPP
 
+#include <istream>
 #include <boost/random/detail/operators.hpp>
 #include <boost/random/detail/seed.hpp>
 #include <boost/random/seed_seq.hpp>
@@ -0,0 +1,138 @@
+//  bulk_conversion_test.cpp  ----------------------------------------------------------//
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//
+//  Checks the bulk reorder and native_to_big/native_to_little overloads of
+//  boost/endian/conversion.hpp against the scalar reorder applied element by element,
+//  for every start offset within a vector and every length up to a few vectors, so that
+//  unaligned heads and the scalar tails are all covered.
+//
+//  Build once with -mavx2, once with -mssse3 and once with -DBOOST_ENDIAN_NO_INTRINSICS
+//  to cover each kernel.
+//
+//--------------------------------------------------------------------------------------//
+
+#include <boost/endian/conversion.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/cstdint.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace boost::endian;
+
+namespace
+{
+  const std::size_t max_offset = 64;   // bytes: every misalignment of an AVX2 pair of loads
+  const std::size_t max_length = 150;  // elements: several vectors, and every tail
+  const unsigned char guard = 0xA5;
+
+  //  distinct, non-palindromic bytes
+  void fill(std::vector<unsigned char>& v)
+  {
+    for (std::size_t i = 0; i < v.size(); ++i)
+      v[i] = static_cast<unsigned char>(i * 131 + 7);
+  }
+
+  //  reference: the scalar reorder of each element, with U the integer of the size of T
+  template <class U>
+  void scalar_reorder(const unsigned char* source, unsigned char* target, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      U x;
+      std::memcpy(&x, source + i * sizeof(U), sizeof(U));
+      reorder(x);
+      std::memcpy(target + i * sizeof(U), &x, sizeof(U));
+    }
+  }
+
+  //  the bytes before and after the n elements at offset are untouched
+  bool guarded(const std::vector<unsigned char>& v, std::size_t offset, std::size_t bytes)
+  {
+    for (std::size_t i = 0; i < v.size(); ++i)
+      if ((i < offset || i >= offset + bytes) && v[i] != guard)
+        return false;
+    return true;
+  }
+
+  template <class T, class U>
+  void check()
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) == sizeof(U));
+    const std::size_t size = max_offset + (max_length + 1) * sizeof(T);
+
+    std::vector<unsigned char> source(size), expected(size), target(size), in_place(size);
+    fill(source);
+
+    int failures = 0;
+    for (std::size_t offset = 0; offset < max_offset; ++offset)
+    {
+      for (std::size_t n = 0; n <= max_length; ++n)
+      {
+        const std::size_t bytes = n * sizeof(T);
+        std::fill(expected.begin(), expected.end(), guard);
+        scalar_reorder<U>(&source[offset], &expected[offset], n);
+
+        //  copying, from and to the same misalignment
+        std::fill(target.begin(), target.end(), guard);
+        reorder(reinterpret_cast<const T*>(&source[offset]), reinterpret_cast<T*>(&target[offset]), n);
+        bool ok = std::equal(expected.begin(), expected.end(), target.begin());
+
+        //  in place
+        std::fill(in_place.begin(), in_place.end(), guard);
+        std::memcpy(&in_place[offset], &source[offset], bytes);
+        T* first = reinterpret_cast<T*>(&in_place[offset]);
+        reorder(first, first + n);
+        ok = ok && std::equal(expected.begin(), expected.end(), in_place.begin());
+
+        //  and from an aligned source to a misaligned target
+        std::fill(target.begin(), target.end(), guard);
+        reorder(reinterpret_cast<const T*>(&source[0]), reinterpret_cast<T*>(&target[offset]), n);
+        scalar_reorder<U>(&source[0], &in_place[0], n);
+        ok = ok && std::equal(in_place.begin(), in_place.begin() + bytes, target.begin() + offset)
+                && guarded(target, offset, bytes);
+
+        if (!ok)
+          ++failures;
+      }
+    }
+    BOOST_TEST_EQ(failures, 0);
+
+    //  native_to_big and native_to_little reorder on one side and copy on the other
+    const std::size_t n = 37;
+    std::fill(expected.begin(), expected.end(), guard);
+    scalar_reorder<U>(&source[1], &expected[1], n);
+    std::vector<unsigned char> big(size, guard), little(size, guard), back(size, guard);
+    native_to_big(reinterpret_cast<const T*>(&source[1]), reinterpret_cast<T*>(&big[1]), n);
+    native_to_little(reinterpret_cast<const T*>(&source[1]), reinterpret_cast<T*>(&little[1]), n);
+# ifdef BOOST_BIG_ENDIAN
+    BOOST_TEST(std::equal(source.begin() + 1, source.begin() + 1 + n * sizeof(T), big.begin() + 1));
+    BOOST_TEST(std::equal(expected.begin(), expected.end(), little.begin()));
+    little_to_native(reinterpret_cast<const T*>(&little[1]), reinterpret_cast<T*>(&back[1]), n);
+# else
+    BOOST_TEST(std::equal(expected.begin(), expected.end(), big.begin()));
+    BOOST_TEST(std::equal(source.begin() + 1, source.begin() + 1 + n * sizeof(T), little.begin() + 1));
+    big_to_native(reinterpret_cast<const T*>(&big[1]), reinterpret_cast<T*>(&back[1]), n);
+# endif
+    BOOST_TEST(std::equal(source.begin() + 1, source.begin() + 1 + n * sizeof(T), back.begin() + 1));
+  }
+}
+
+int main()
+{
+  check<boost::uint16_t, boost::uint16_t>();
+  check<boost::int16_t, boost::uint16_t>();
+  check<boost::uint32_t, boost::uint32_t>();
+  check<boost::int32_t, boost::uint32_t>();
+  check<float, boost::uint32_t>();
+  check<boost::uint64_t, boost::uint64_t>();
+  check<boost::int64_t, boost::uint64_t>();
+  check<double, boost::uint64_t>();
+
+  return boost::report_errors();
+}
@@ -17,7 +17,7 @@ set( Boost_NO_SYSTEM_PATHS ON CACHE BOOL "Turn OFF if your boost library is in t
 #message( STATUS ${MSVC90} )
 #message( STATUS ${MSVC10} )
 #message( STATUS ${MSVC11} )
-find_package( Boost 1.47.0 REQUIRED chrono program_options signals system timer unit_test_framework )
+find_package( Boost 1.47.0 REQUIRED chrono program_options signals system thread timer unit_test_framework )
 #message( ${Boost_LIB_PREFIX}boost_${COMPONENT}${_boost_COMPILER}${_boost_MULTITHREADED}${_boost_RELEASE_ABI_TAG}-${Boost_LIB_VERSION} )
 if( Boost_FOUND )				
 #    message( "Boost_LIBRARY_NAMES:" ${Boost_LIBRARY_NAMES} )
@@ -12,6 +12,7 @@
 
 #include <qfcl/random/variate_generator.hpp>
 #include <qfcl/random/distribution/gbm_npv_vanilla_call.hpp>
+#include <qfcl/utility/numa.hpp>
 
 #include <vector>
 #include <iostream>
@@ -42,6 +43,10 @@ public:
     // Main loop
     void operator()()
     {
+        // Pin this job to a CPU, spreading the jobs over the NUMA nodes, before the engine is allocated,
+        // so that the engine and sampler are placed on the node of the job (first touch).
+        qfcl::numa::pin_worker(m_sequence_number);
+
         // Initialize parallel random number generator and distribution sampler.
         Prf::domain_type c = {{}};
         Prf::key_type    k = {{m_sequence_number,0}};
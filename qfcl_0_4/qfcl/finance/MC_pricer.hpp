@@ -4,45 +4,219 @@
 /*! \file qfcl/finance/MC_pricer.hpp
 	\brief Monte Carlo pricer
 
+	Scenarios are simulated in batches of paths held in structure-of-arrays form (one array of spots,
+	one of barrier states, ...), so the market and the instrument each process a whole batch per
+	monitoring date. Batches are handed out to worker threads from a shared counter. Each worker
+	accumulates into its own copy of the statistics, and the copies are merged at the end.
+
+	Batch \c b is simulated with an engine seeded by <tt>seed + b</tt>, where \c b counts the batches
+	of all calls to \c simulate. The scenarios therefore do not depend on the number of threads;
+	only the order of merging the statistics does (up to rounding).
+
+	Everything a worker writes or reads repeatedly (the engines, the path and normal buffers, the
+	accumulator, and copies of the market and the instrument) is allocated by the worker itself, so on
+	a NUMA machine it is placed on the worker's node by first touch. With \c pin_threads the workers are
+	pinned and spread evenly over the nodes (see qfcl/utility/numa.hpp), so that they stay there.
+
+	Two of the variance reductions of the mc1 schemes (see qfcl/mc1/VarianceReduction.hpp) work on
+	the normals of a batch, date by date, before the market applies them:
+	- antithetic variates: the second half of each batch is driven by the negated normals of the
+	  first half, and the statistics are fed the average payoff of each pair (a lone path of an odd
+	  batch on its own), so they count samples, not scenarios;
+	- moment matching: the independent normals of a batch are shifted and scaled to sample mean 0
+	  and sample variance 1. The samples of a batch are then slightly dependent, which the standard
+	  error of the statistics ignores.
+
 	\author James Hirschorn
 	\date Created January 15, 2013
 */
 
-#include <boost/parameter.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <qfcl/utility/numa.hpp>
 
 #include "instruments/instrument_base.hpp"
 
 namespace qfcl {
 namespace finance {
 
-// AccMarket and AccStatistics must satisfy the Accumulator concept (see boost::accumulators).
-// Instr must satisfy out Instrument concept.
-template<typename AccMarket, typename AccStatistics, typename Instr>
+/*! \brief Monte Carlo pricer.
+
+	\tparam Market satisfies our Market concept (see \c gbm_market):
+		<tt>value_type</tt>, <tt>reset(S, M)</tt>, <tt>advance(S, M, dt, eng, work)</tt>, <tt>discount(t)</tt>
+		and <tt>volatility()</tt>; with variance reduction also <tt>normals(z, M, eng)</tt> and
+		<tt>advance(S, M, dt, z)</tt>.
+	\tparam AccStatistics satisfies the Accumulator concept (see boost::accumulators), i.e. it is fed the
+		discounted payoffs by <tt>operator()</tt>, and in addition has <tt>merge(const AccStatistics &)</tt>
+		(see \c qfcl::statistics::running_moments). A default constructed one must be empty: the workers
+		start from one, and their results are merged into the statistics passed to the constructor,
+		which may already hold samples.
+	\tparam Instr satisfies our Instrument concept (see \c barrier_option):
+		<tt>state_type</tt>, <tt>num_dates()</tt>, <tt>time_step(i)</tt>, <tt>maturity()</tt>,
+		<tt>start(S, state, M)</tt>, <tt>monitor(S, state, M, dt, market)</tt> and <tt>payoff(S, state, value, M)</tt>.
+	\tparam Engine a uniform random number generator constructible from a seed.
+*/
+template<typename Market, typename AccStatistics, typename Instr, typename Engine = boost::random::mt19937>
 class MC_pricer
 {
-	MC_pricer(AccMarket market, AccStatistics stats, Instr instrument)
-		: market_(market), stats_(stats), instrument_(instrument)
-	{}
+public:
+	typedef typename Market::value_type value_type;
+
+	/*! \param batch_size number of paths simulated together
+		\param threads number of worker threads; 0 for one per hardware thread
+	*/
+	MC_pricer(Market market, AccStatistics stats, Instr instrument, std::size_t batch_size = 1024, unsigned int threads = 0)
+		: market_(market), stats_(stats), instrument_(instrument),
+		  batch_size_(std::max<std::size_t>(batch_size, 1)), threads_(threads), pinned_(false),
+		  antithetic_(false), moment_matching_(false), seed_(5489u), batches_(0)
+	{
+		if (threads_ == 0)
+			threads_ = std::max(boost::thread::hardware_concurrency(), 1u);
+	}
+
+	//! seeds the batches simulated from now on
+	void seed(unsigned long s) {seed_ = s; batches_ = 0;}
+
+	//! whether worker \c w is pinned to the CPU <tt>numa::topology::system().worker_cpu(w)</tt>
+	/*! Only worker threads are pinned; a simulation with one worker runs in the calling thread, unpinned.
+	*/
+	void pin_threads(bool pinned) {pinned_ = pinned;}
+
+	//! whether the second half of each batch uses the negated normals of the first half
+	void antithetic(bool on) {antithetic_ = on;}
 
-	// simulate N scenarios
+	//! whether the normals of each batch are matched to sample mean 0 and variance 1 at each date
+	void moment_matching(bool on) {moment_matching_ = on;}
+
+	//! simulate \p N more scenarios
 	template<typename CounterType>
 	void simulate(CounterType N)
 	{
-		for (i = 0; i < N; ++i)
+		const std::size_t n = static_cast<std::size_t>(N);
+		const std::size_t num_batches = (n + batch_size_ - 1) / batch_size_;
+		const unsigned int workers = static_cast<unsigned int>( std::min<std::size_t>(threads_, num_batches) );
+		if (workers == 0)
+			return;
+
+		std::atomic<std::size_t> next(0);
+		std::vector<AccStatistics> local(workers);
+
+		if (workers == 1)
+			work(local[0], next, num_batches, n, -1);
+		else
 		{
-			instrument_.reset();
-			market_(dt = instrument_.next());
-			stats_(AccMarket::value(market_));
+			boost::thread_group group;
+			for (unsigned int w = 0; w < workers; ++w)
+				group.create_thread( boost::bind(&MC_pricer::work, this, boost::ref(local[w]), boost::ref(next), num_batches, n,
+												 pinned_ ? static_cast<int>(w) : -1) );
+			group.join_all();
 		}
+
+		for (unsigned int w = 0; w < workers; ++w)
+			stats_.merge(local[w]);
+		batches_ += num_batches;
 	}
+
 	AccStatistics get_statistics() const {return stats_;}
+	const Market & market() const {return market_;}
+	const Instr & instrument() const {return instrument_;}
+
 private:
-	AccMarket market_;
+	//! simulates batches until there are none left, into \p result; pinned as worker \p pin unless it is negative
+	void work(AccStatistics & result, std::atomic<std::size_t> & next, std::size_t num_batches, std::size_t N, int pin) const
+	{
+		if (pin >= 0)
+			numa::pin_worker(pin);
+
+		// first touched here, after pinning
+		const Market market(market_);
+		const Instr instrument(instrument_);
+		AccStatistics acc;
+		std::vector<value_type> S(batch_size_), normals(batch_size_), value(batch_size_);
+		std::vector<typename Instr::state_type> state(batch_size_);
+		const value_type df = market.discount( instrument.maturity() );
+
+		for (std::size_t b = next++; b < num_batches; b = next++)
+		{
+			const std::size_t M = std::min(batch_size_, N - b * batch_size_);
+			Engine eng( static_cast<typename Engine::result_type>(seed_ + batches_ + b) );
+			const std::size_t H = antithetic_ ? (M + 1) / 2 : M;	// independent normals per date
+
+			market.reset(&S[0], M);
+			instrument.start(&S[0], &state[0], M);
+			for (std::size_t i = 0; i < instrument.num_dates(); ++i)
+			{
+				const value_type dt = instrument.time_step(i);
+				if (antithetic_ || moment_matching_)
+				{
+					market.normals(&normals[0], H, eng);
+					if (moment_matching_)
+						match_moments(&normals[0], H);
+					for (std::size_t m = H; m < M; ++m)
+						normals[m] = -normals[m - H];
+					market.advance(&S[0], M, dt, &normals[0]);
+				}
+				else
+					market.advance(&S[0], M, dt, eng, &normals[0]);
+				instrument.monitor(&S[0], &state[0], M, dt, market);
+			}
+
+			instrument.payoff(&S[0], &state[0], &value[0], M);
+			if (antithetic_)
+			{
+				for (std::size_t m = 0; m < M - H; ++m)
+					acc( df * value_type(0.5) * (value[m] + value[H + m]) );
+				if (2 * H > M)
+					acc(df * value[H - 1]);
+			}
+			else
+				for (std::size_t m = 0; m < M; ++m)
+					acc(df * value[m]);
+		}
+
+		result = acc;
+	}
+
+	//! shifts and scales the \p M normals \p z to sample mean 0 and sample variance 1
+	static void match_moments(value_type * z, std::size_t M)
+	{
+		if (M < 2)
+			return;
+
+		value_type sum = 0, sum_squares = 0;
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			sum += z[m];
+			sum_squares += z[m] * z[m];
+		}
+		const value_type mean = sum / M, variance = (sum_squares - sum * mean) / (M - 1);
+		const value_type scale = variance > 0 ? 1 / std::sqrt(variance) : value_type(1);
+		for (std::size_t m = 0; m < M; ++m)
+			z[m] = (z[m] - mean) * scale;
+	}
+
+	Market market_;
 	AccStatistics stats_;
 	Instr instrument_;
+	std::size_t batch_size_;
+	unsigned int threads_;
+	bool pinned_;
+	bool antithetic_;
+	bool moment_matching_;
+	unsigned long seed_;
+	std::size_t batches_;		// batches simulated since seeding
 };
 
 }	// namespace finance
 }	// namespace qfcl
 
-#endif	// QFCL_MC_PRICER_HPP
\ No newline at end of file
+#endif	// QFCL_MC_PRICER_HPP
@@ -0,0 +1,108 @@
+#ifndef QFCL_BLACK_SCHOLES_HPP
+#define QFCL_BLACK_SCHOLES_HPP
+
+/*! \file qfcl/finance/analytics/black_scholes.hpp
+	\brief Black-Scholes prices and greeks of European options
+
+	Closed forms for the options simulated by the GBM distributions (\c gbm_vanilla_call_distribution and
+	\c gbm_vanilla_put_distribution), for pricing vanilla legs analytically inside a Monte Carlo run and as
+	control variate anchors.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+
+namespace qfcl {
+namespace finance {
+
+enum call_put {CALL, PUT};
+
+//! price and sensitivities; theta is per year of calendar time
+template<typename T>
+struct black_scholes_greeks
+{
+	T price;
+	T delta;	//!< dV/dS
+	T gamma;	//!< d^2V/dS^2
+	T vega;		//!< dV/dsigma
+	T theta;	//!< -dV/dt, t the time to expiry
+	T rho;		//!< dV/dr
+};
+
+namespace detail {
+
+template<typename T>
+inline T normal_cdf(T x)
+{
+	return T(0.5) * std::erfc( -x / std::sqrt(T(2)) );
+}
+
+template<typename T>
+inline T normal_pdf(T x)
+{
+	return std::exp(-T(0.5) * x * x) / std::sqrt( T(2) * T(3.14159265358979323846) );
+}
+
+}	// namespace detail
+
+/*! \brief Black-Scholes price and greeks.
+
+	\param S spot
+	\param K strike
+	\param r continuously compounded interest rate
+	\param q continuous dividend yield
+	\param sigma volatility
+	\param t time to expiry in years
+
+	If \f$\sigma \sqrt{t} = 0\f$ the option is priced on the deterministic forward, with zero gamma and vega.
+*/
+template<typename T>
+black_scholes_greeks<T> black_scholes(call_put type, T S, T K, T r, T q, T sigma, T t)
+{
+	using detail::normal_cdf;
+
+	black_scholes_greeks<T> g;
+	const T Dq = std::exp(-q * t), Dr = std::exp(-r * t);
+	const T w = type == CALL ? T(1) : T(-1);
+	const T sd = sigma * std::sqrt(t);
+
+	if (!(sd > 0))
+	{
+		const bool itm = w * (S * Dq - K * Dr) > 0;
+		g.price = std::max( w * (S * Dq - K * Dr), T(0) );
+		g.delta = itm ? w * Dq : T(0);
+		g.gamma = g.vega = T(0);
+		g.theta = itm ? w * (q * S * Dq - r * K * Dr) : T(0);
+		g.rho = itm ? w * K * t * Dr : T(0);
+		return g;
+	}
+
+	const T d1 = ( std::log(S / K) + (r - q) * t ) / sd + T(0.5) * sd;
+	const T d2 = d1 - sd;
+	const T Nd1 = normal_cdf(w * d1), Nd2 = normal_cdf(w * d2);
+	const T nd1 = detail::normal_pdf(d1);
+
+	g.price = w * (S * Dq * Nd1 - K * Dr * Nd2);
+	g.delta = w * Dq * Nd1;
+	g.gamma = Dq * nd1 / (S * sd);
+	g.vega = S * Dq * nd1 * std::sqrt(t);
+	g.theta = -S * Dq * nd1 * sigma / (2 * std::sqrt(t)) + w * (q * S * Dq * Nd1 - r * K * Dr * Nd2);
+	g.rho = w * K * t * Dr * Nd2;
+
+	return g;
+}
+
+//! Black-Scholes price, see \c black_scholes
+template<typename T>
+inline T black_scholes_price(call_put type, T S, T K, T r, T q, T sigma, T t)
+{
+	return black_scholes(type, S, K, r, q, sigma, t).price;
+}
+
+}	// namespace finance
+}	// namespace qfcl
+
+#endif	// QFCL_BLACK_SCHOLES_HPP
@@ -8,6 +8,12 @@
 	\date Created January 15, 2013
 */
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
 #include <boost/parameter.hpp>
 
 #include "instrument_base.hpp"
@@ -22,45 +28,195 @@ BOOST_PARAMETER_NAME(down)
 BOOST_PARAMETER_NAME(payoff)
 BOOST_PARAMETER_NAME(t0)
 BOOST_PARAMETER_NAME(dates)
+BOOST_PARAMETER_NAME(monitoring)
+
+//! what a barrier does when it is hit
+enum hit_behaviour {IN, OUT, NOTHING};
+
+//! how the barriers are monitored
+enum monitoring_type
+{
+	DISCRETE,		//!< only at the monitoring dates
+	CONTINUOUS		//!< at all times, using the Brownian bridge crossing probability between dates
+};
 
 namespace detail {
 
+/*! \brief What is known about the barrier hits of one path so far.
+
+	\c no_up, \c no_down and \c none are the probabilities, given the simulated spots, that the path did not hit the upper
+	barrier, the lower barrier and either barrier. With discrete monitoring they are 0 or 1. \c log_up and \c log_down
+	are \f$\log(H / S)\f$ and \f$\log(S / L)\f$ at the last monitoring date.
+*/
+template<typename T>
+struct barrier_state
+{
+	T none, no_up, no_down;
+	T log_up, log_down;
+};
+
+/*! \brief Barrier option on one asset.
+
+	Satisfies our Instrument concept. The barriers are monitored for a whole batch of paths at a time:
+	\c start and \c monitor update a \c barrier_state per path, and \c payoff turns the terminal spots and these
+	states into the payoffs.
+
+	A path is knocked out if it hit an \c OUT barrier. If there is an \c IN barrier, a path that was not knocked
+	out pays only if it hit an \c IN barrier. The payoff is the payoff function weighted by the probability of this
+	event, which is a linear combination of \c none, \c no_up and \c no_down.
+
+	With \c CONTINUOUS monitoring, the probability that \f$\log S\f$, a Brownian motion with volatility \f$\sigma\f$
+	(<tt>market.volatility()</tt>), crosses the upper barrier between two dates \f$\Delta t\f$ apart is
+	\f[ p = \exp\left(-2\,\frac{\log(H / S_{i-1}) \log(H / S_i)}{\sigma^2 \Delta t}\right), \f]
+	and similarly for the lower barrier. Using these conditional probabilities instead of checking the simulated
+	spots only, the price of a single barrier option on geometric Brownian motion is unbiased for any set of
+	dates, so a few dates (the payoff dates) suffice. For double barriers \f$1 - p_{up} - p_{down}\f$ is used for
+	not hitting either barrier within a step, which neglects crossing both barriers in one step.
+
+	Time is measured in years (Act/365).
+*/
 template<typename T, typename F>
 class barrier_option_imp : public instrument_base
 {
 public:
-	enum hit_behaviour {IN, OUT, NOTHING};
+	typedef T value_type;
+	typedef barrier_state<T> state_type;
+
+	//! number of monitoring dates, the last one being the expiry
+	std::size_t num_dates() const {return dt_.size();}
+	//! year fraction from the previous monitoring date (or \c t0) to monitoring date \p i
+	T time_step(std::size_t i) const {return dt_[i];}
+	//! year fraction from \c t0 to expiry
+	T maturity() const {return maturity_;}
+
+	//! initializes the \p state of \p M paths starting at the spots \p S
+	void start(const T * S, state_type * state, std::size_t M) const
+	{
+		const bool upper = up != NOTHING, lower = down != NOTHING;
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			state_type & s = state[m];
+			s.none = s.no_up = s.no_down = T(1);
+			s.log_up = upper ? std::log(H / S[m]) : T(1);
+			s.log_down = lower ? std::log(S[m] / L) : T(1);
+		}
+		monitor_discrete(S, state, M);
+	}
 
-	// temporary solution
-	void reset() {date = 0;}
-	//date_type first_date() const {return dates_[0];}
-	bool is_mature() const {return date >= num_dates;}
-	T next() 
+	//! updates the \p state of \p M paths, which moved to the spots \p S in the time \p dt
+	template<typename Market>
+	void monitor(const T * S, state_type * state, std::size_t M, T dt, const Market & market) const
 	{
-		T result = date == 0 ? dates[0] - t0 : dates[date] - dates[date - 1];
-		++date;
-		return result;
+		if (monitoring == DISCRETE)
+		{
+			monitor_discrete(S, state, M);
+			return;
+		}
+
+		const bool upper = up != NOTHING, lower = down != NOTHING;
+		const T sigma = market.volatility();
+		const T c = T(-2) / (sigma * sigma * dt);
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			state_type & s = state[m];
+			const T lu = upper ? std::log(H / S[m]) : T(1);
+			const T ld = lower ? std::log(S[m] / L) : T(1);
+			const T pu = !upper ? T(0) : (lu <= 0 || s.log_up <= 0) ? T(1) : std::exp(c * s.log_up * lu);
+			const T pd = !lower ? T(0) : (ld <= 0 || s.log_down <= 0) ? T(1) : std::exp(c * s.log_down * ld);
+			update(s, pu, pd);
+			s.log_up = lu;
+			s.log_down = ld;
+		}
 	}
+
+	//! undiscounted payoffs \p value of \p M paths with terminal spots \p S and barrier states \p state
+	void payoff(const T * S, const state_type * state, T * value, std::size_t M) const
+	{
+		// probability of paying = a + b none + c no_up + d no_down
+		const bool out_up = up == OUT, out_down = down == OUT, in_up = up == IN, in_down = down == IN;
+		T a = 0, b = 0, c = 0, d = 0;
+		if (out_up && out_down)
+			b = 1;
+		else if (out_up)
+			{c = 1; b = in_down ? T(-1) : T(0);}
+		else if (out_down)
+			{d = 1; b = in_up ? T(-1) : T(0);}
+		else
+		{
+			a = 1;
+			if (in_up && in_down)
+				b = -1;
+			else if (in_up)
+				c = -1;
+			else if (in_down)
+				d = -1;
+		}
+
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			const state_type & s = state[m];
+			value[m] = (a + b * s.none + c * s.no_up + d * s.no_down) * payoff_(S[m]);
+		}
+	}
+
+	T upper_barrier() const {return H;}
+	T lower_barrier() const {return L;}
+	hit_behaviour upper_behaviour() const {return up;}
+	hit_behaviour lower_behaviour() const {return down;}
+	const F & payoff_function() const {return payoff_;}
+	monitoring_type monitoring_method() const {return monitoring;}
+
 protected:
 	template<typename Arg>
 	barrier_option_imp(const Arg & args) :
-		H(args[_upper_barrier] | T()),
-		L(args[_lower_barrier] | T()),
-		up(args[_up] | NOTHING),
-		down(args[_down] | NOTHING),
-		payoff(args[_payoff]),
+		H(args[_upper_barrier | T()]),
+		L(args[_lower_barrier | T()]),
+		up(args[_up | NOTHING]),
+		down(args[_down | NOTHING]),
+		monitoring(args[_monitoring | DISCRETE]),
+		payoff_(args[_payoff]),
 		t0(args[_t0]),
-		dates(args[_dates])
+		dates(args[_dates]),
+		maturity_(0)
 	{
+		if (dates.empty())
+			throw std::invalid_argument("barrier_option: no monitoring dates");
+
+		dt_.resize(dates.size());
+		for (std::size_t i = 0; i < dates.size(); ++i)
+		{
+			const date_type & previous = i == 0 ? t0 : dates[i - 1];
+			if (dates[i] <= previous)
+				throw std::invalid_argument("barrier_option: monitoring dates must be increasing and after t0");
+			dt_[i] = T((dates[i] - previous).days()) / 365;
+			maturity_ += dt_[i];
+		}
 	}
 
 	T H, L;
 	hit_behaviour up, down;
-	F payoff;
-	date_type dates[];
+	monitoring_type monitoring;
+	F payoff_;
 	date_type t0;
-	size_t num_dates;
-	size_t date;
+	std::vector<date_type> dates;
+
+private:
+	static void update(state_type & s, T pu, T pd)
+	{
+		s.none *= std::max(T(1) - pu - pd, T(0));
+		s.no_up *= T(1) - pu;
+		s.no_down *= T(1) - pd;
+	}
+
+	void monitor_discrete(const T * S, state_type * state, std::size_t M) const
+	{
+		const bool upper = up != NOTHING, lower = down != NOTHING;
+		for (std::size_t m = 0; m < M; ++m)
+			update(state[m], T(upper && S[m] >= H), T(lower && S[m] <= L));
+	}
+
+	std::vector<T> dt_;
+	T maturity_;
 };
 
 }	// namespace detail
@@ -70,19 +226,20 @@ class barrier_option : public detail::barrier_option_imp<T, F>
 {
 public:
 	BOOST_PARAMETER_CONSTRUCTOR(
-		barrier_option, 
-		(detail::barrier_option_imp<T, F>), 
-		tag, 
-		( required 
+		barrier_option,
+		(detail::barrier_option_imp<T, F>),
+		tag,
+		( required
 			( payoff, (F) )
 			( t0, (date_type) )
-			( dates, (date_type[]) )
+			( dates, (std::vector<date_type>) )
 		)
-		( optional 
-			( upper_barrier, (T) ) 
+		( optional
+			( upper_barrier, (T) )
 			( lower_barrier, (T) )
 			( up, (hit_behaviour) )
 			( down, (hit_behaviour) )
+			( monitoring, (monitoring_type) )
 		)
 	)
 };
@@ -90,4 +247,4 @@ public:
 }	// namespace finance
 }	// namespace qfcl
 
-#endif	// QFCL_BARRIER_OPTION_HPP
\ No newline at end of file
+#endif	// QFCL_BARRIER_OPTION_HPP
@@ -0,0 +1,86 @@
+#ifndef QFCL_GBM_MARKET_HPP
+#define QFCL_GBM_MARKET_HPP
+
+/*! \file qfcl/finance/markets/gbm_market.hpp
+	\brief single asset following geometric Brownian motion
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include <boost/random/normal_distribution.hpp>
+
+namespace qfcl {
+namespace finance {
+
+/*! \brief Black-Scholes market: \f$dS = (r - q) S\,dt + \sigma S\,dW\f$, deterministic rate \f$r\f$.
+
+	Satisfies our Market concept: a batch of \c M paths is held in a plain array of spot values,
+	which \c reset initializes and \c advance moves forward by \c dt using the exact log-normal step.
+	The normals are drawn first into \c work and then applied in a separate loop, which the
+	compiler can vectorize. The two halves are also available separately (\c normals and
+	\c advance with given normals), so that a pricer can transform the normals in between,
+	e.g. for antithetic variates.
+*/
+template<typename T = double, typename NormalDistribution = boost::random::normal_distribution<T> >
+class gbm_market
+{
+public:
+	typedef T value_type;
+
+	gbm_market(T S0, T r, T q, T sigma)
+		: S0_(S0), r_(r), q_(q), sigma_(sigma)
+	{}
+
+	//! sets the \p M spot values \p S to the initial spot
+	void reset(T * S, std::size_t M) const
+	{
+		std::fill(S, S + M, S0_);
+	}
+
+	//! advances the \p M paths \p S by the time \p dt, using \p work (of size \p M) for the normals
+	template<typename Engine>
+	void advance(T * S, std::size_t M, T dt, Engine & eng, T * work) const
+	{
+		normals(work, M, eng);
+		advance(S, M, dt, work);
+	}
+
+	//! \p M standard normals, as drawn by \c advance
+	template<typename Engine>
+	void normals(T * z, std::size_t M, Engine & eng) const
+	{
+		NormalDistribution normal;
+		for (std::size_t m = 0; m < M; ++m)
+			z[m] = normal(eng);
+	}
+
+	//! advances the \p M paths \p S by the time \p dt, driven by the given standard normals \p z
+	void advance(T * S, std::size_t M, T dt, const T * z) const
+	{
+		const T drift = (r_ - q_ - T(0.5) * sigma_ * sigma_) * dt;
+		const T diffusion = sigma_ * std::sqrt(dt);
+		for (std::size_t m = 0; m < M; ++m)
+			S[m] *= std::exp(drift + diffusion * z[m]);
+	}
+
+	//! discount factor to time \p t
+	T discount(T t) const {return std::exp(-r_ * t);}
+
+	T spot() const {return S0_;}
+	T rate() const {return r_;}
+	T dividend_yield() const {return q_;}
+	T volatility() const {return sigma_;}
+
+private:
+	T S0_, r_, q_, sigma_;
+};
+
+}	// namespace finance
+}	// namespace qfcl
+
+#endif	// QFCL_GBM_MARKET_HPP
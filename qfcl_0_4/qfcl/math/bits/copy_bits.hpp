@@ -153,6 +153,13 @@ struct bit_pseudoiterator_helper
 
 		return *this;
 	}
+	//! <tt>*dest = *src</tt> for equal word sizes, e.g. 64 bit words and 64 bit NTL words
+	/*! Otherwise the implicit copy assignment makes this ambiguous.
+	*/
+	bit_pseudoiterator_helper & operator=(const bit_pseudoiterator_helper & in)
+	{
+		return this -> template operator=<intSize, Iter>(in);
+	}
 	/*! <tt>operator=(IntType)</tt>
 	*/
 	template<typename InIntType>
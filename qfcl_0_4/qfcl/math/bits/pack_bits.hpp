@@ -0,0 +1,206 @@
+/* qfcl/math/bits/pack_bits.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef	QFCL_MATH_BITS_PACK_BITS_HPP
+#define	QFCL_MATH_BITS_PACK_BITS_HPP
+
+/*! \file qfcl/math/bits/pack_bits.hpp
+	\brief word level packing of bit streams
+
+	A bit stream is an array of words of which only the low \c inSize (or \c outSize) bits are used,
+	with bit \f$j\f$ of the stream in bit \f$j \bmod inSize\f$ of word \f$\lfloor j / inSize \rfloor\f$.
+	This is the layout of both the state of a \c linear_generator (with \c inSize the word size \c w) and
+	of an \c NTL::vec_GF2 (with \c NTL_BITS_PER_LONG bits per word).
+
+	\c pack_bits and \c unpack_bits convert between two such streams one output word at a time, unlike
+	\c copy_bits which moves the bits through \c bit_pseudoiterator helpers. When the word sizes agree
+	every output word is a funnel shift of two input words; with AVX2 and 64 bit words, 4 are done per
+	step (unless \c QFCL_MATH_NO_INTRINSICS is defined).
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cstddef>
+
+#include <boost/cstdint.hpp>
+
+#if !defined(QFCL_MATH_NO_INTRINSICS) && defined(__AVX2__)
+#define QFCL_MATH_AVX2_BITS
+#include <immintrin.h>
+#endif
+
+namespace qfcl {
+
+namespace math {
+
+namespace detail {
+
+//! mask of the low \p nbits bits, for <tt>nbits <= 64</tt>
+inline boost::uint64_t low_bits(std::size_t nbits)
+{
+	return nbits >= 64 ? ~boost::uint64_t(0) : (boost::uint64_t(1) << nbits) - 1;
+}
+
+//! the <tt>nbits <= 64</tt> bits of the stream \p in starting at bit \p pos
+template<std::size_t inSize, typename InWord>
+inline boost::uint64_t get_bits(const InWord * in, std::size_t pos, std::size_t nbits)
+{
+	boost::uint64_t result = 0;
+
+	for (std::size_t got = 0; got < nbits; )
+	{
+		const std::size_t shift = pos % inSize;
+		const std::size_t take = std::min(inSize - shift, nbits - got);
+		result |= ( ( static_cast<boost::uint64_t>(in[pos / inSize]) >> shift ) & low_bits(take) ) << got;
+		got += take;
+		pos += take;
+	}
+
+	return result;
+}
+
+//! word \p q of the stream that has the \p nbits bits of \p in starting at bit \p shift, and zeros elsewhere
+template<std::size_t inSize, std::size_t outSize, typename InWord>
+inline boost::uint64_t shifted_word(const InWord * in, std::size_t nbits, std::size_t shift, std::size_t q)
+{
+	// the word covers the bits [start, start + outSize) of in, which can start before bit 0
+	const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(q * outSize) - static_cast<std::ptrdiff_t>(shift);
+	const std::ptrdiff_t lo = std::max<std::ptrdiff_t>(start, 0);
+	const std::ptrdiff_t hi = std::min<std::ptrdiff_t>(start + outSize, nbits);
+	if (hi <= lo)
+		return 0;
+
+	return get_bits<inSize>(in, lo, hi - lo) << (lo - start);
+}
+
+#ifdef QFCL_MATH_AVX2_BITS
+//! <tt>out[q] = (in[q] >> s) | (in[q + 1] << (64 - s))</tt> for \p m words, with <tt>0 < s < 64</tt>
+inline std::size_t funnel_shift_avx2(const boost::uint64_t * in, std::size_t s, std::size_t m, boost::uint64_t * out)
+{
+	const __m128i right = _mm_cvtsi32_si128(static_cast<int>(s)), left = _mm_cvtsi32_si128(static_cast<int>(64 - s));
+
+	std::size_t q = 0;
+	for (; q + 4 <= m; q += 4)
+	{
+		const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(in + q) );
+		const __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(in + q + 1) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>(out + q),
+			_mm256_or_si256(_mm256_srl_epi64(a, right), _mm256_sll_epi64(b, left)) );
+	}
+
+	return q;
+}
+#endif
+
+}	// namespace detail
+
+//! copy the bits <tt>[shift, shift + nbits)</tt> of the stream \p in to the start of the stream \p out
+/*! Writes <tt>ceil(nbits / outSize)</tt> words; the bits past \p nbits in the last one are cleared.
+*/
+template<std::size_t inSize, std::size_t outSize, typename InWord, typename OutWord>
+inline void pack_bits(const InWord * in, std::size_t shift, std::size_t nbits, OutWord * out)
+{
+	const std::size_t words = (nbits + outSize - 1) / outSize;
+	std::size_t q = 0;
+
+	if (inSize == outSize)
+	{
+		// whole output words
+		const std::size_t full = nbits / outSize;
+		const std::size_t s = shift % inSize;
+		const boost::uint64_t mask = detail::low_bits(inSize);
+		in += shift / inSize;
+
+		if (s == 0)
+			for (; q < full; ++q)
+				out[q] = static_cast<OutWord>(in[q] & mask);
+		else
+		{
+#ifdef QFCL_MATH_AVX2_BITS
+			if (inSize == 64 && sizeof(InWord) == 8 && sizeof(OutWord) == 8)
+				q = detail::funnel_shift_avx2( reinterpret_cast<const boost::uint64_t *>(in), s, full,
+											   reinterpret_cast<boost::uint64_t *>(out) );
+#endif
+			for (; q < full; ++q)
+				out[q] = static_cast<OutWord>( ( ( (static_cast<boost::uint64_t>(in[q]) & mask) >> s )
+					| ( static_cast<boost::uint64_t>(in[q + 1]) << (inSize - s) ) ) & mask );
+		}
+
+		in -= shift / inSize;
+	}
+
+	// the last partial word, or all of them if the word sizes differ
+	for (; q < words; ++q)
+		out[q] = static_cast<OutWord>( detail::get_bits<inSize>( in, shift + q * outSize, std::min(outSize, nbits - q * outSize) ) );
+}
+
+//! copy the first \p nbits bits of the stream \p in to the bits <tt>[shift, shift + nbits)</tt> of the stream \p out
+/*! Writes <tt>ceil((shift + nbits) / outSize)</tt> words; the first \p shift bits and the bits past
+	<tt>shift + nbits</tt> in the last word are cleared.
+*/
+template<std::size_t inSize, std::size_t outSize, typename InWord, typename OutWord>
+inline void unpack_bits(const InWord * in, std::size_t nbits, OutWord * out, std::size_t shift)
+{
+	const std::size_t words = (shift + nbits + outSize - 1) / outSize;
+	std::size_t q = 0;
+
+	// words entirely before the copied bits
+	for (; q < shift / outSize; ++q)
+		out[q] = 0;
+
+	if (inSize == outSize)
+	{
+		const std::size_t s = shift % outSize;
+		const boost::uint64_t mask = detail::low_bits(outSize);
+		const std::size_t base = shift / outSize;
+
+		if (s == 0)
+			for (; q < base + nbits / outSize; ++q)
+				out[q] = static_cast<OutWord>(in[q - base] & mask);
+		else
+		{
+			// word base holds the low bits of in[0]; word base + j > base is a funnel shift of in[j - 1], in[j]
+			if (q < words)
+			{
+				out[q] = static_cast<OutWord>( detail::shifted_word<inSize, outSize>(in, nbits, shift, q) );
+				++q;
+			}
+			for (; (q - base + 1) * outSize <= nbits + s; ++q)
+				out[q] = static_cast<OutWord>( ( ( static_cast<boost::uint64_t>(in[q - base]) << s )
+					| ( (static_cast<boost::uint64_t>(in[q - base - 1]) & mask) >> (outSize - s) ) ) & mask );
+		}
+	}
+
+	for (; q < words; ++q)
+		out[q] = static_cast<OutWord>( detail::shifted_word<inSize, outSize>(in, nbits, shift, q) );
+}
+
+//! parity of the number of bits set in \p x
+template<typename UIntType>
+inline bool parity(UIntType x)
+{
+#if defined(__GNUC__)
+	return __builtin_parityll(x) != 0;
+#else
+	boost::uint64_t y = x;
+	y ^= y >> 32;
+	y ^= y >> 16;
+	y ^= y >> 8;
+	y ^= y >> 4;
+	return ( (0x6996 >> (y & 0xF)) & 1 ) != 0;
+#endif
+}
+
+}	// namespace math
+
+}	// namespace qfcl
+
+#endif	// QFCL_MATH_BITS_PACK_BITS_HPP
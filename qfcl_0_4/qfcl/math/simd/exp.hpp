@@ -0,0 +1,121 @@
+/* qfcl/math/simd/exp.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef	QFCL_MATH_SIMD_EXP_HPP
+#define	QFCL_MATH_SIMD_EXP_HPP
+
+/*! \file qfcl/math/simd/exp.hpp
+	\brief exponential of arrays
+
+	\c exp_affine computes \f$c \exp(a + b x_i)\f$ over an array, which is the terminal value transform of
+	geometric Brownian motion applied to an array of normals.
+
+	When the compiler targets AVX2 and FMA, 4 doubles are done per step: \f$x = k \log 2 + r\f$ with
+	\f$|r| \le \log(2) / 2\f$ (Cody and Waite), a degree 12 Taylor polynomial in \f$r\f$ evaluated by FMA, and
+	\f$2^k\f$ built directly in the exponent bits. The relative error is below 2 ulp. Lanes outside
+	\f$[-708, 709]\f$ and NaNs fall back to \c std::exp, so overflow, underflow and denormals are exact.
+	Otherwise, or if \c QFCL_MATH_NO_INTRINSICS is defined, the loop calls \c std::exp.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cmath>
+#include <cstddef>
+
+#if !defined(QFCL_MATH_NO_INTRINSICS) && defined(__AVX2__) && defined(__FMA__)
+#define QFCL_MATH_AVX2_EXP
+#include <immintrin.h>
+#endif
+
+namespace qfcl {
+namespace math {
+
+namespace detail {
+
+#ifdef QFCL_MATH_AVX2_EXP
+//! exp of 4 doubles in [-708, 709]
+inline __m256d exp_avx2(__m256d x)
+{
+	const __m256d log2e = _mm256_set1_pd(1.4426950408889634);
+	const __m256d ln2_hi = _mm256_set1_pd(6.93145751953125e-1);
+	const __m256d ln2_lo = _mm256_set1_pd(1.42860682030941723212e-6);
+	const __m256d magic = _mm256_set1_pd(6755399441055744.0);		// 2^52 + 2^51
+
+	// x = k log 2 + r
+	__m256d k = _mm256_round_pd(_mm256_mul_pd(x, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256d r = _mm256_fnmadd_pd(k, ln2_hi, x);
+	r = _mm256_fnmadd_pd(k, ln2_lo, r);
+
+	// exp(r) = sum_{j <= 12} r^j / j!
+	__m256d p = _mm256_set1_pd(1.0 / 479001600.0);
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 39916800.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+	p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+
+	// 2^k from the exponent bits; k is in [-1022, 1023]
+	__m256i ki = _mm256_sub_epi64( _mm256_castpd_si256(_mm256_add_pd(k, magic)), _mm256_castpd_si256(magic) );
+	__m256d two_k = _mm256_castsi256_pd( _mm256_slli_epi64(_mm256_add_epi64(ki, _mm256_set1_epi64x(1023)), 52) );
+
+	return _mm256_mul_pd(p, two_k);
+}
+#endif
+
+}	// namespace detail
+
+//! <tt>out[i] = c * exp(a + b * x[i])</tt> for \p n elements; \p out may be \p x
+inline void exp_affine(const double * x, double * out, std::size_t n, double a, double b, double c = 1.0)
+{
+	std::size_t i = 0;
+
+#ifdef QFCL_MATH_AVX2_EXP
+	const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b), vc = _mm256_set1_pd(c);
+	const __m256d lo = _mm256_set1_pd(-708.0), hi = _mm256_set1_pd(709.0);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d y = _mm256_fmadd_pd(vb, _mm256_loadu_pd(x + i), va);
+		// false for NaN
+		__m256d in_range = _mm256_and_pd(_mm256_cmp_pd(y, lo, _CMP_GE_OQ), _mm256_cmp_pd(y, hi, _CMP_LE_OQ));
+		if (_mm256_movemask_pd(in_range) == 0xF)
+			_mm256_storeu_pd(out + i, _mm256_mul_pd(vc, detail::exp_avx2(y)));
+		else
+		{
+			double tmp[4];
+			_mm256_storeu_pd(tmp, y);
+			for (int j = 0; j < 4; ++j)
+				out[i + j] = c * std::exp(tmp[j]);
+		}
+	}
+#endif
+
+	for (; i < n; ++i)
+		out[i] = c * std::exp(a + b * x[i]);
+}
+
+//! generic version of the above, a plain loop
+template<typename T>
+inline void exp_affine(const T * x, T * out, std::size_t n, T a, T b, T c = T(1))
+{
+	for (std::size_t i = 0; i < n; ++i)
+		out[i] = c * std::exp(a + b * x[i]);
+}
+
+}	// namespace math
+}	// namespace qfcl
+
+#endif	// QFCL_MATH_SIMD_EXP_HPP
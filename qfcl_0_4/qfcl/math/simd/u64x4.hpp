@@ -0,0 +1,103 @@
+/* qfcl/math/simd/u64x4.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef	QFCL_MATH_SIMD_U64X4_HPP
+#define	QFCL_MATH_SIMD_U64X4_HPP
+
+/*! \file qfcl/math/simd/u64x4.hpp
+	\brief 4 lanes of 64 bit unsigned integers
+
+	\c u64x4 has the integer operators used by xorshift type generators (xor, or, and, addition, shifts,
+	rotations and multiplication modulo \f$2^{64}\f$), so that code templated on the word type runs on
+	4 independent lanes at once. With AVX2 a \c u64x4 is one \c __m256i; otherwise, or if
+	\c QFCL_MATH_NO_INTRINSICS is defined, it is an array that the compiler may vectorize.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <boost/cstdint.hpp>
+
+#if !defined(QFCL_MATH_NO_INTRINSICS) && defined(__AVX2__)
+#define QFCL_MATH_AVX2_U64X4
+#include <immintrin.h>
+#endif
+
+namespace qfcl {
+namespace math {
+
+//! rotate \p x left by <tt>0 < k < 64</tt> bits
+inline boost::uint64_t rotl(boost::uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+//! 4 lanes of \c boost::uint64_t
+struct u64x4
+{
+#ifdef QFCL_MATH_AVX2_U64X4
+	__m256i v;
+
+	static u64x4 make(__m256i a) {u64x4 x; x.v = a; return x;}
+
+	//! all lanes equal to \p a
+	static u64x4 broadcast(boost::uint64_t a) {return make( _mm256_set1_epi64x(static_cast<long long>(a)) );}
+	//! from 4 words, which need not be aligned
+	static u64x4 load(const boost::uint64_t * p) {return make( _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)) );}
+	//! to 4 words, which need not be aligned
+	void store(boost::uint64_t * p) const {_mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);}
+
+	friend u64x4 operator^(u64x4 a, u64x4 b) {return make( _mm256_xor_si256(a.v, b.v) );}
+	friend u64x4 operator|(u64x4 a, u64x4 b) {return make( _mm256_or_si256(a.v, b.v) );}
+	friend u64x4 operator&(u64x4 a, u64x4 b) {return make( _mm256_and_si256(a.v, b.v) );}
+	friend u64x4 operator+(u64x4 a, u64x4 b) {return make( _mm256_add_epi64(a.v, b.v) );}
+	friend u64x4 operator<<(u64x4 a, int k) {return make( _mm256_slli_epi64(a.v, k) );}
+	friend u64x4 operator>>(u64x4 a, int k) {return make( _mm256_srli_epi64(a.v, k) );}
+	//! the low 64 bits of the products; AVX2 only multiplies 32 bit halves
+	friend u64x4 operator*(u64x4 a, boost::uint64_t c)
+	{
+		const __m256i c_lo = _mm256_set1_epi64x( static_cast<long long>(c & 0xFFFFFFFF) );
+		const __m256i c_hi = _mm256_set1_epi64x( static_cast<long long>(c >> 32) );
+
+		const __m256i lo = _mm256_mul_epu32(a.v, c_lo);
+		const __m256i cross = _mm256_add_epi64( _mm256_mul_epu32(_mm256_srli_epi64(a.v, 32), c_lo),
+												_mm256_mul_epu32(a.v, c_hi) );
+		return make( _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32)) );
+	}
+#else
+	boost::uint64_t v[4];
+
+	static u64x4 broadcast(boost::uint64_t a) {u64x4 x; for (int j = 0; j < 4; ++j) x.v[j] = a; return x;}
+	static u64x4 load(const boost::uint64_t * p) {u64x4 x; for (int j = 0; j < 4; ++j) x.v[j] = p[j]; return x;}
+	void store(boost::uint64_t * p) const {for (int j = 0; j < 4; ++j) p[j] = v[j];}
+
+	friend u64x4 operator^(u64x4 a, u64x4 b) {for (int j = 0; j < 4; ++j) a.v[j] ^= b.v[j]; return a;}
+	friend u64x4 operator|(u64x4 a, u64x4 b) {for (int j = 0; j < 4; ++j) a.v[j] |= b.v[j]; return a;}
+	friend u64x4 operator&(u64x4 a, u64x4 b) {for (int j = 0; j < 4; ++j) a.v[j] &= b.v[j]; return a;}
+	friend u64x4 operator+(u64x4 a, u64x4 b) {for (int j = 0; j < 4; ++j) a.v[j] += b.v[j]; return a;}
+	friend u64x4 operator<<(u64x4 a, int k) {for (int j = 0; j < 4; ++j) a.v[j] <<= k; return a;}
+	friend u64x4 operator>>(u64x4 a, int k) {for (int j = 0; j < 4; ++j) a.v[j] >>= k; return a;}
+	friend u64x4 operator*(u64x4 a, boost::uint64_t c) {for (int j = 0; j < 4; ++j) a.v[j] *= c; return a;}
+#endif
+
+	u64x4 & operator^=(u64x4 b) {return *this = *this ^ b;}
+	u64x4 & operator|=(u64x4 b) {return *this = *this | b;}
+	u64x4 & operator+=(u64x4 b) {return *this = *this + b;}
+};
+
+//! rotate each lane of \p x left by <tt>0 < k < 64</tt> bits
+inline u64x4 rotl(u64x4 x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+}	// namespace math
+}	// namespace qfcl
+
+#endif	// QFCL_MATH_SIMD_U64X4_HPP
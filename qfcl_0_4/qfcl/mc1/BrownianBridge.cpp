@@ -0,0 +1,171 @@
+// BrownianBridge.cpp
+//
+// Brownian bridge path construction.
+//
+// 2012-10-19 DD kick off: precomputed weights, level-by-level batch construction
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef BrownianBridge_CPP
+#define BrownianBridge_CPP
+
+#include "BrownianBridge.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <qfcl/random/distribution/normal_inversion.hpp>
+
+template <typename Time>
+BrownianBridge<Time>::BrownianBridge(const ublas::vector<Time>& mesh) : t(mesh.begin(), mesh.end())
+{ // Precompute the construction order and the weights
+
+	if (t.size() < 2)
+		throw std::invalid_argument("BrownianBridge: the mesh needs at least two points");
+	for (std::size_t i = 1; i < t.size(); ++i)
+	{
+		if (!(t[i-1] < t[i]))
+			throw std::invalid_argument("BrownianBridge: the mesh must be strictly increasing");
+	}
+
+	const std::size_t N = t.size() - 1;
+	steps.reserve(N);
+
+	// Level 0: the terminal point, from W(t[0]) = 0
+	Step terminal = { N, 0, 0, Time(0), Time(0), std::sqrt(t[N] - t[0]) };
+	steps.push_back(terminal);
+	levelEnd.push_back(steps.size());
+
+	// Then bisect the subintervals (left, right), one level at a time
+	std::vector<std::pair<std::size_t, std::size_t> > intervals(1, std::make_pair(std::size_t(0), N)), next;
+	while (!intervals.empty())
+	{
+		next.clear();
+		for (std::size_t j = 0; j < intervals.size(); ++j)
+		{
+			std::size_t l = intervals[j].first, r = intervals[j].second;
+			if (r - l < 2)
+				continue;
+
+			std::size_t i = l + (r - l) / 2;
+			Time span = t[r] - t[l];
+			Step s = { i, l, r, (t[r] - t[i]) / span, (t[i] - t[l]) / span,
+					   std::sqrt((t[i] - t[l]) * (t[r] - t[i]) / span) };
+			steps.push_back(s);
+
+			next.push_back(std::make_pair(l, i));
+			next.push_back(std::make_pair(i, r));
+		}
+
+		if (steps.size() > levelEnd.back())
+			levelEnd.push_back(steps.size());
+		intervals.swap(next);
+	}
+}
+
+template <typename Time>
+void BrownianBridge<Time>::buildPath(const Time* z, Time* w) const
+{
+	buildPaths(z, w, 1);
+}
+
+template <typename Time>
+void BrownianBridge<Time>::buildPaths(const Time* z, Time* w, std::size_t M) const
+{ // Each step is a dense pass over the batch
+
+	for (std::size_t m = 0; m < M; ++m)
+	{
+		w[m] = Time(0);
+	}
+
+	// Terminal point
+	{
+		const Step& s = steps[0];
+		Time* wi = w + s.index * M;
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			wi[m] = s.sigma * z[m];
+		}
+	}
+
+	for (std::size_t d = 1; d < steps.size(); ++d)
+	{
+		const Step& s = steps[d];
+		const Time* wl = w + s.left * M;
+		const Time* wr = w + s.right * M;
+		const Time* zd = z + d * M;
+		Time* wi = w + s.index * M;
+
+		const Time a = s.leftWeight, b = s.rightWeight, c = s.sigma;
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			wi[m] = a * wl[m] + b * wr[m] + c * zd[m];
+		}
+	}
+}
+
+template <typename Generator, typename Time>
+void PseudoRandomNormals<Generator, Time>::operator () (Time* z, std::size_t dim, std::size_t M)
+{
+	boost::variate_generator<Generator&, boost::normal_distribution<Time> > nor(rng, boost::normal_distribution<Time>(0.0, 1.0));
+
+	for (std::size_t j = 0; j < dim * M; ++j)
+	{
+		z[j] = nor();
+	}
+}
+
+template <typename PointGenerator, typename Time>
+void InverseCDFNormals<PointGenerator, Time>::operator () (Time* z, std::size_t dim, std::size_t M)
+{
+	u.resize(dim);
+
+	for (std::size_t m = 0; m < M; ++m)
+	{
+		points(&u[0], dim);
+		for (std::size_t d = 0; d < dim; ++d)
+		{
+			z[d * M + m] = qfcl::random::detail::normal_inv(u[d]);
+		}
+	}
+}
+
+template <typename Engine, typename Time>
+void UniformPoints<Engine, Time>::operator () (Time* u, std::size_t dim)
+{ // Midpoints of the engine's output cells, so never 0 or 1
+
+	const Time scale = Time(1) / (Time((eng.max)() - (eng.min)()) + Time(1));
+	for (std::size_t d = 0; d < dim; ++d)
+	{
+		u[d] = (Time(eng() - (eng.min)()) + Time(0.5)) * scale;
+	}
+}
+
+template <typename NormalSource, typename Time>
+BrownianBridgeBatch<NormalSource, Time>::BrownianBridgeBatch(const ublas::vector<Time>& mesh, const NormalSource& normalSource)
+	: bridge(mesh), source(normalSource), M(0)
+{
+}
+
+template <typename NormalSource, typename Time>
+const Time* BrownianBridgeBatch<NormalSource, Time>::next(std::size_t nPaths)
+{
+	if (nPaths == 0)
+		throw std::invalid_argument("BrownianBridgeBatch: empty batch");
+
+	M = nPaths;
+	z.resize(bridge.dimension() * M);
+	w.resize(bridge.points() * M);
+
+	source(&z[0], bridge.dimension(), M);
+	bridge.buildPaths(&z[0], &w[0], M);
+
+	return &w[0];
+}
+
+#endif	// BrownianBridge_CPP
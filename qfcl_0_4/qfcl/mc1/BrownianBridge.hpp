@@ -0,0 +1,136 @@
+// BrownianBridge.hpp
+//
+// Brownian bridge construction of Brownian paths on a (possibly non-uniform)
+// mesh, e.g. the one created by Range::mesh().
+//
+// The bridge weights are computed once per mesh. The construction is done
+// level by level: the terminal value first, then the midpoints of ever finer
+// subintervals. All points in one level depend only on points of earlier
+// levels, so a batch of paths is built by a sequence of dense axpy passes
+// over the batch rather than a dependent scalar chain per path.
+//
+// The first normals drive the coarsest features of the path, which reduces
+// the effective dimension when the normals come from a low-discrepancy sequence.
+//
+// Layout of the batch buffers (M paths, structure of arrays):
+//	normals:	z[d * M + m], d = 0, ..., N - 1		(d = order of importance)
+//	paths:		w[i * M + m], i = 0, ..., N			(i = index of the mesh point)
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef BrownianBridge_HPP
+#define BrownianBridge_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+
+namespace ublas=boost::numeric::ublas;
+
+template <typename Time = double>
+			class BrownianBridge
+{
+private:
+
+	// One construction step: w[index] = leftWeight * w[left] + rightWeight * w[right] + sigma * z
+	struct Step
+	{
+		std::size_t index, left, right;
+		Time leftWeight, rightWeight, sigma;
+	};
+
+	std::vector<Time> t;				// The mesh
+	std::vector<Step> steps;			// Construction steps, step d consumes normal d
+	std::vector<std::size_t> levelEnd;	// Steps [levelEnd[l-1], levelEnd[l]) make up level l
+
+public:
+	BrownianBridge() {}
+	BrownianBridge(const ublas::vector<Time>& mesh);	// mesh[0] < ... < mesh[N], W(mesh[0]) = 0
+
+	std::size_t dimension() const { return steps.size(); }	// Number of normals per path, N
+	std::size_t points() const { return t.size(); }			// Number of points per path, N + 1
+	std::size_t levels() const { return levelEnd.size(); }
+
+	// Build a single path w[0..N] from the normals z[0..N-1]
+	void buildPath(const Time* z, Time* w) const;
+
+	// Build M paths at once, see the layout above
+	void buildPaths(const Time* z, Time* w, std::size_t M) const;
+};
+
+// Normal sources for BrownianBridgeBatch. A normal source fills a block of
+// normals for M paths of dimension dim in the layout z[d * M + m].
+
+// Pseudo-random normals from a uniform random number generator
+template <typename Generator, typename Time = double>
+			class PseudoRandomNormals
+{
+private:
+	Generator rng;
+
+public:
+	PseudoRandomNormals() {}
+	PseudoRandomNormals(const Generator& generator) : rng(generator) {}
+
+	void operator () (Time* z, std::size_t dim, std::size_t M);
+};
+
+// Normals by inverse-CDF from points in (0,1)^dim. PointGenerator is called as
+// points(u, dim) and must fill u[0..dim-1] with the next point, e.g. of a
+// low-discrepancy sequence. Each path gets one point, coordinate d going to normal d.
+template <typename PointGenerator, typename Time = double>
+			class InverseCDFNormals
+{
+private:
+	PointGenerator points;
+	std::vector<Time> u;
+
+public:
+	InverseCDFNormals() {}
+	InverseCDFNormals(const PointGenerator& pointGenerator) : points(pointGenerator) {}
+
+	void operator () (Time* z, std::size_t dim, std::size_t M);
+};
+
+// Points in (0,1)^dim from a uniform random number generator, for use with InverseCDFNormals
+template <typename Engine, typename Time = double>
+			class UniformPoints
+{
+private:
+	Engine eng;
+
+public:
+	UniformPoints() {}
+	UniformPoints(const Engine& engine) : eng(engine) {}
+
+	void operator () (Time* u, std::size_t dim);
+};
+
+// Batches of Brownian paths from a bridge and a normal source
+template <typename NormalSource, typename Time = double>
+			class BrownianBridgeBatch
+{
+private:
+	BrownianBridge<Time> bridge;
+	NormalSource source;
+
+	std::vector<Time> z;	// Normals of the current batch
+	std::vector<Time> w;	// Paths of the current batch
+	std::size_t M;			// Number of paths in the current batch
+
+public:
+	BrownianBridgeBatch(const ublas::vector<Time>& mesh, const NormalSource& normalSource);
+
+	// Generate the next M paths and return them in the layout w[i * M + m]
+	const Time* next(std::size_t nPaths);
+
+	// Point i of path m of the current batch
+	Time operator () (std::size_t m, std::size_t i) const { return w[i * M + m]; }
+
+	std::size_t size() const { return M; }
+	const BrownianBridge<Time>& getBridge() const { return bridge; }
+};
+
+#endif
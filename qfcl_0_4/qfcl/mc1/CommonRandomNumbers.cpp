@@ -0,0 +1,167 @@
+// CommonRandomNumbers.cpp
+//
+// Normal block cache and common random number scenario pricing.
+//
+// 2012-10-19 DD kick off: seeded batches replayed across scenarios
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef CommonRandomNumbers_CPP
+#define CommonRandomNumbers_CPP
+
+#include "CommonRandomNumbers.hpp"
+#include "FDMVisitor.cpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/cstdint.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+// NormalBlockCache
+
+template <typename Generator>
+NormalBlockCache<Generator>::NormalBlockCache(long pathsPerBatch, long normalsPerPath, unsigned long seed)
+	: M(pathsPerBatch), n(normalsPerPath), s(seed), current(-1), z(pathsPerBatch * normalsPerPath)
+{
+	if (M < 1 || n < 1)
+		throw std::invalid_argument("NormalBlockCache: need at least one path and one normal per path");
+}
+
+template <typename Generator>
+void NormalBlockCache<Generator>::seed(unsigned long seed)
+{
+	s = seed;
+	current = -1;
+}
+
+template <typename Generator>
+void NormalBlockCache<Generator>::fill(long batch)
+{
+	if (batch == current)
+	{
+		return;
+	}
+
+	rng.seed(static_cast<boost::uint32_t>(s + batch));
+	boost::variate_generator<Generator&, boost::normal_distribution<> > nor(rng, boost::normal_distribution<>(0.0, 1.0));
+	for (std::size_t j = 0; j < z.size(); ++j)
+	{
+		z[j] = nor();
+	}
+
+	current = batch;
+}
+
+// MCScenarios
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+MCScenarios<Real, Counter, Generator, Payoff>::MCScenarios(long pathsPerBatch, long NSteps, unsigned long seed)
+	: cache(pathsPerBatch, NSteps, seed), base(pathsPerBatch)
+{
+	reset();
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+std::size_t MCScenarios<Real, Counter, Generator, Payoff>::addScenario(FdmVisitor<Real, Real, Real, Generator>& fdm,
+																		const Payoff& payoff)
+{
+	if (fdm.N != cache.normals())
+		throw std::invalid_argument("MCScenarios: all scenarios need the same number of steps");
+
+	Scenario sc = { &fdm, payoff, 0.0, 0.0, 0.0, 0.0 };
+	scenarios.push_back(sc);
+
+	return scenarios.size() - 1;
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+void MCScenarios<Real, Counter, Generator, Payoff>::simulate(Counter NSimulations)
+{
+	const long M = cache.paths(), n = cache.normals();
+
+	for (Counter done = 0; done < NSimulations; done += M)
+	{
+		cache.fill(batches);
+
+		for (std::size_t k = 0; k < scenarios.size(); ++k)
+		{ // Bump loop inside the batch: the normals are still in cache
+			Scenario& sc = scenarios[k];
+
+			for (long i = 0; i < M; ++i)
+			{
+				sc.fdm -> generator.replay(cache.path(i), n);
+				Real P = sc.payoff(sc.fdm -> path());
+
+				sc.sum += P;
+				sc.sumSquares += P * P;
+				if (k == 0)
+				{
+					base[i] = P;
+				}
+				else
+				{
+					sc.diffSum += P - base[i];
+					sc.diffSumSquares += (P - base[i]) * (P - base[i]);
+				}
+			}
+		}
+
+		++batches;
+		NSim += M;
+	}
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+void MCScenarios<Real, Counter, Generator, Payoff>::reset()
+{
+	NSim = 0;
+	batches = 0;
+	for (std::size_t k = 0; k < scenarios.size(); ++k)
+	{
+		scenarios[k].sum = scenarios[k].sumSquares = 0.0;
+		scenarios[k].diffSum = scenarios[k].diffSumSquares = 0.0;
+	}
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+void MCScenarios<Real, Counter, Generator, Payoff>::seed(unsigned long seed)
+{
+	cache.seed(seed);
+	reset();
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCScenarios<Real, Counter, Generator, Payoff>::price(std::size_t k) const
+{
+	return scenarios[k].sum / NSim;
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCScenarios<Real, Counter, Generator, Payoff>::standardError(std::size_t k) const
+{
+	const Scenario& sc = scenarios[k];
+	double var = (sc.sumSquares - sc.sum * sc.sum / NSim) / (NSim - 1);
+
+	return std::sqrt(std::max(var, 0.0) / NSim);
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCScenarios<Real, Counter, Generator, Payoff>::difference(std::size_t k) const
+{
+	return scenarios[k].diffSum / NSim;
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCScenarios<Real, Counter, Generator, Payoff>::differenceError(std::size_t k) const
+{
+	const Scenario& sc = scenarios[k];
+	double var = (sc.diffSumSquares - sc.diffSum * sc.diffSum / NSim) / (NSim - 1);
+
+	return std::sqrt(std::max(var, 0.0) / NSim);
+}
+
+#endif	// CommonRandomNumbers_CPP
@@ -0,0 +1,96 @@
+// CommonRandomNumbers.hpp
+//
+// Common random numbers for scenario grids and finite difference greeks.
+//
+// NormalBlockCache holds the normals of a batch of paths. Batch b is drawn
+// from a generator seeded with seed + b, so a run is reproducible and a batch
+// does not depend on the batches before it.
+//
+// MCScenarios prices K scenarios, e.g. the base case and bumped copies of an
+// SDE, with the same normals. For each batch the normals are drawn once and
+// replayed (BoostNormal::replay) through the scheme of every scenario, so the
+// bump loop is inside the batch: one generator pass instead of K, and the
+// differences P_k - P_0 only carry the noise of the bump itself.
+//
+// As in MCVarianceReduction, the schemes must draw one normal per time step,
+// in order (ExplicitEuler, ExplicitEulerTypeII, Milstein, PredictorCorrector,
+// PredictorCorrectorClassico). Payoff must be a functor with signature
+// Real (const pathType<Real>&).
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef CommonRandomNumbers_HPP
+#define CommonRandomNumbers_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "FDMVisitor.hpp"
+
+template <typename Generator>
+			class NormalBlockCache
+{
+private:
+	long M;					// Paths per batch
+	long n;					// Normals per path
+	unsigned long s;		// Seed of batch 0
+	long current;			// Batch in the cache, -1 if none
+	Generator rng;
+	std::vector<double> z;	// M x n, row major
+
+public:
+	NormalBlockCache(long pathsPerBatch, long normalsPerPath, unsigned long seed = 5489);
+
+	void seed(unsigned long seed);		// Empties the cache
+	void fill(long batch);				// Draw the normals of a batch (no-op if cached)
+
+	long paths() const { return M; }
+	long normals() const { return n; }
+	long batch() const { return current; }
+
+	const double* path(long i) const { return &z[i * n]; }
+};
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+			class MCScenarios
+{
+private:
+	struct Scenario
+	{
+		FdmVisitor<Real, Real, Real, Generator>* fdm;
+		Payoff payoff;
+		double sum, sumSquares;					// P_k
+		double diffSum, diffSumSquares;			// P_k - P_0
+	};
+
+	NormalBlockCache<Generator> cache;
+	std::vector<Scenario> scenarios;
+	std::vector<Real> base;		// P_0 of the paths of the current batch
+	Counter NSim;
+	long batches;				// Batches simulated so far
+
+public:
+	MCScenarios(long pathsPerBatch, long NSteps, unsigned long seed = 5489);
+
+	// Scenario 0 is the base case; fdm must have NSteps steps and outlive this object
+	std::size_t addScenario(FdmVisitor<Real, Real, Real, Generator>& fdm, const Payoff& payoff);
+
+	// At least NSimulations more paths, rounded up to whole batches
+	void simulate(Counter NSimulations);
+
+	void reset();				// Restart from batch 0: the same paths again
+	void seed(unsigned long seed);
+
+	Counter pathCount() const { return NSim; }
+	std::size_t size() const { return scenarios.size(); }
+
+	Real price(std::size_t k) const;
+	Real standardError(std::size_t k) const;
+
+	// Mean of P_k - P_0 over the common paths, and its standard error
+	Real difference(std::size_t k) const;
+	Real differenceError(std::size_t k) const;
+};
+
+#endif
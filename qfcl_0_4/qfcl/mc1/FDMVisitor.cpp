@@ -16,6 +16,13 @@
 // 2012-1-7 DD moment matching + type II Euler
 // 2012-1-9 DD MC102 frozen.
 // 2012-3-18 DD index TYPE for loops is now std::size_t; this removes warnings during compilation.
+// 2012-10-19 DD Euler, PC, KL and Milstein schemes step from the previous value rather than the initial condition
+// 2012-10-19 DD Euler with Brownian bridge increments
+// 2012-10-19 DD KL schemes use a precomputed basis and batched increments
+// 2012-10-19 DD moment matching across a batch of paths
+// 2012-10-19 DD precomputed CEV coefficients, exact log stepping of GBM
+// 2012-10-19 DD CEV coefficients from the visited SDE
+// 2012-10-19 DD KL schemes use the full discrete expansion, so that they converge to the Ito solution
 //
 // (C) Datasim Education BV 2007-2011
 //
@@ -31,7 +38,10 @@ using namespace std;
 
 #include <omp.h>
 
+#include <stdexcept>
+
 #include <qfcl/math/simple/functions.hpp>
+#include <qfcl/math/simd/exp.hpp>
 
 template <typename X, typename Time, typename RT,typename Generator>
 FdmVisitor<X,Time,RT,Generator>::FdmVisitor(long NSteps, const Sde<X,Time,RT>& mySde, const Generator& myGenerator) : 
@@ -47,7 +57,20 @@ FdmVisitor<X,Time,RT,Generator>::FdmVisitor(long NSteps, const Sde<X,Time,RT>& m
 	
 		N = NSteps;
 
+		analyse(mySde);
+		z.resize(NSteps);
+}
 
+template <typename X, typename Time, typename RT,typename Generator>
+void FdmVisitor<X,Time,RT,Generator>::analyse(const Sde<X,Time,RT>& sde)
+{ // Constant per-step factors when the SDE declares the structure
+
+		const SdeStructure<RT>& st = sde.structure;
+		cev = st.isCev();
+		beta = st.beta;
+		stepDrift = 1.0 + st.mu * k;
+		stepDiffusion = st.sigma * sqrk;
+		stepMilstein = 0.5 * st.sigma * st.sigma * st.beta * k;
 }
 
 template <typename X, typename Time, typename RT,typename Generator >
@@ -76,11 +99,27 @@ void ExplicitEuler<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
         auto VOld = sde.ic;
 	
         res[0] = VOld;
+
+		this -> analyse(sde);
+		if (cev)
+		{ // Precomputed factors over the normals of the path
+			generator.fill(&z[0], z.size());
+			for (std::size_t index = 1; index < x.size(); ++index)
+			{
+				RT diffusion = (beta == 1.0) ? VOld : std::pow(VOld, beta);
+				VOld = VOld * stepDrift + stepDiffusion * diffusion * z[index-1];
+				res[index] = VOld;
+			}
+
+			return;
+		}
+
         for (std::size_t index = 1; index < x.size(); ++index)
 		{
 			time = x[index-1];
             res[index] = VOld  + k * sde.drift(VOld, time)
 							+ sqrk * sde.diffusion(VOld, time) *  generator.RN();
+			VOld = res[index];
 		}
 }
 
@@ -110,35 +149,36 @@ void ExplicitEulerTypeII<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
             res[index] = VOld  + k * sde.drift(VOld, time)
 							//+ sqrk * sde.diffusion(VOld, time) *  generator.RN();
 							+ sqrk * sde.diffusion(VOld, time) *  dW2[index];
+			VOld = res[index];
 		}
 }
 
 // Euler, Moment matching
 template <typename X, typename Time, typename RT,typename Generator>
-ExplicitEulerMM<X,Time,RT,Generator>::ExplicitEulerMM(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator)
-			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator)
+ExplicitEulerMM<X,Time,RT,Generator>::ExplicitEulerMM(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator,
+													   std::size_t batchSize)
+			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), batch(batchSize), current(batchSize)
 {
-		dW2 = boost::numeric::ublas::vector<Time> (N + 1);	
+		dW2.resize(batch * N);
 }
 
 template <typename X, typename Time, typename RT,typename Generator >
 void ExplicitEulerMM<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 {
-	// For some reason does not give good results...............
-		// Optimise later
-		X avg = 0.0;
-		for (std::size_t j = 0; j < dW2.size(); ++j)
-		{
-			dW2[j] = generator.RN();
-			avg += dW2[j];
-		}
-		avg /= X(dW2.size());
-		
-		for (std::size_t j = 0; j < dW2.size(); ++j)
+		// Matching the moments of one path (across its time steps) biases the path
+		// distribution; match each time step across the batch of paths instead.
+		if (current == batch)
 		{
-			dW2[j] -= avg;
+			for (std::size_t j = 0; j < dW2.size(); ++j)
+			{
+				dW2[j] = generator.RN();
+			}
+			matchMoments(&dW2[0], batch, N);
+			current = 0;
 		}
 
+		const Time* dW = &dW2[N * current++];
+
         auto VOld = sde.ic;
 	
 		res[0] = VOld;
@@ -146,12 +186,50 @@ void ExplicitEulerMM<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 		{
 			time = x[index-1];
             res[index] = VOld  + k * sde.drift(VOld, time)
-							+ sqrk * sde.diffusion(VOld, time) *  dW2[index];
+							+ sqrk * sde.diffusion(VOld, time) *  dW[index-1];
+			VOld = res[index];
 		}
-		
 }
 
 
+// Euler, Brownian bridge
+template <typename X, typename Time, typename RT,typename Generator>
+ExplicitEulerBridge<X,Time,RT,Generator>::ExplicitEulerBridge(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator,
+															   std::size_t batchSize)
+			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), bridge(x), batch(batchSize), current(batchSize)
+{
+		z.resize(bridge.dimension() * batch);
+		w.resize(bridge.points() * batch);
+}
+
+template <typename X, typename Time, typename RT,typename Generator >
+void ExplicitEulerBridge<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
+{
+		if (current == batch)
+		{ // Build the next batch of paths
+			for (std::size_t j = 0; j < z.size(); ++j)
+			{
+				z[j] = generator.RN();
+			}
+			bridge.buildPaths(&z[0], &w[0], batch);
+			current = 0;
+		}
+
+		const Time* W = &w[current++];
+
+        auto VOld = sde.ic;
+
+		res[0] = VOld;
+		for (std::size_t index = 1; index < x.size(); ++index)
+		{
+			time = x[index-1];
+			Time dW = W[index * batch] - W[(index - 1) * batch];
+            res[index] = VOld  + k * sde.drift(VOld, time)
+							+ sde.diffusion(VOld, time) *  dW;
+			VOld = res[index];
+		}
+}
+
 // Adapted Predictor-Corrector
 template <typename X, typename Time, typename RT,typename Generator>
 PredictorCorrector<X,Time,RT,Generator>::PredictorCorrector(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator,X alpha, X beta)
@@ -189,6 +267,7 @@ void PredictorCorrector<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 			diffusionTerm = sde.diffusion(B*VMid + (1.0 - B)*VOld , 0.5*(x[index] + x[index-1]))* Wincr;
 
             res[index] = VOld + adjDriftTerm + diffusionTerm;
+			VOld = res[index];
 		}
 
 }
@@ -230,7 +309,7 @@ void PredictorCorrectorClassico<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 			diffusionTerm = sde.diffusion(B*VMid + (1.0 - B)*VOld , 0.5*(x[index] + x[index-1]))* Wincr;
 
             res[index] = VOld + driftTerm + diffusionTerm;
-
+			VOld = res[index];
 		}
 	
 }
@@ -310,6 +389,28 @@ void Milstein<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 
         auto VOld = sde.ic;
 		res[0] = VOld;
+
+		this -> analyse(sde);
+		if (cev)
+		{ // Precomputed factors over the normals of the path
+			generator.fill(&z[0], z.size());
+			for (std::size_t index = 1; index < x.size(); ++index)
+			{
+				RT Z = z[index-1];
+				if (beta == 1.0)
+				{
+					VOld = VOld * (stepDrift + stepDiffusion * Z + stepMilstein * (Z * Z - 1.0));
+				}
+				else
+				{
+					VOld = VOld * stepDrift + stepDiffusion * std::pow(VOld, beta) * Z
+							+ stepMilstein * std::pow(VOld, 2.0 * beta - 1.0) * (Z * Z - 1.0);
+				}
+				res[index] = VOld;
+			}
+
+			return;
+		}
 	
 		double Wincr, diffTerm;
 
@@ -323,85 +424,117 @@ void Milstein<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
             res[index] = VOld  + k * sde.drift(VOld, x[index-1])
 							+ sqrk * sde.diffusion(VOld, x[index-1]) *  Wincr
 						+ 0.5 * diffTerm* sde.diffusionDerivative(VOld, x[index-1])*k*(Wincr*Wincr - 1.0); // 'Correction' part
+			VOld = res[index];
 		}	
 }
 
-// KarhunenLoeve 
-
+// Exact GBM in log space
 template <typename X, typename Time, typename RT,typename Generator>
-KarhunenLoeve<X,Time,RT,Generator>::KarhunenLoeve(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator, double tolerance)
-			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), tol(tolerance)
+ExactLog<X,Time,RT,Generator>::ExactLog(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator)
+			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), s(NSteps + 1)
 {
-	Ntrunc = static_cast<long>(sqrt(2.0*sde.ran.high())/(tol*3.1415) - 0.5);
-	sqrT = 2.0*sqrt(2.0*T);
-	cout << "Truncation Value: " << Ntrunc;
-	dW2 = boost::numeric::ublas::vector<Time> (Ntrunc+1); 		
+	if (!sde.structure.isGbm())
+		throw std::invalid_argument("ExactLog: the SDE must declare the structure of geometric Brownian motion");
 }
 
+template <typename X, typename Time, typename RT,typename Generator >
+void ExactLog<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
+{
+		if (!sde.structure.isGbm())
+			throw std::invalid_argument("ExactLog: the SDE must declare the structure of geometric Brownian motion");
+
+		this -> analyse(sde);
+		const RT m = (sde.structure.mu - 0.5 * sde.structure.sigma * sde.structure.sigma) * k;
+
+		generator.fill(&z[0], z.size());
 
+		s[0] = 0.0;
+		for (std::size_t index = 1; index < s.size(); ++index)
+		{
+			s[index] = s[index-1] + m + stepDiffusion * z[index-1];
+		}
 
+		// X_n = X_0 exp(s_n), vectorised
+		qfcl::math::exp_affine(&s[0], &res[0], s.size(), 0.0, 1.0, sde.ic);
+}
+
+// KarhunenLoeve 
 
 template <typename X, typename Time, typename RT,typename Generator>
-X KarhunenLoeve<X,Time,RT,Generator>::orthogonalFunction(Time t, long n)
+KarhunenLoeve<X,Time,RT,Generator>::KarhunenLoeve(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator,
+												   std::size_t batchSize)
+			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), kl(x), batch(batchSize), current(batchSize)
 {
-	
-    X f = (2.0*n + 1.0) * qfcl::math::pi<X>();
-	
-    return (sqrT/f)*sin(qfcl::math::half<T>()*f*t/T);
-	//return (sqrT/f)*mySin<X>(0.5*f*t/T);
+	dW2.resize(kl.terms() * batch);
+	dW.resize(kl.steps() * batch);
 }
 
 template <typename X, typename Time, typename RT,typename Generator>
-X KarhunenLoeve<X,Time,RT,Generator>::KLExpansion(Time s, Time t) // s > t
-{
-	
-		X value = 0.0;
-#pragma omp parallel for reduction (+:value)
-		for (std::size_t n = 0; n < dW2.size(); ++n)
+const Time* KarhunenLoeve<X,Time,RT,Generator>::nextIncrements()
+{ // Increments of the next path, generated a batch at a time
+
+		if (current == batch)
 		{
-			value += dW2[n]*(orthogonalFunction(s, n) - orthogonalFunction(t, n) );
+			for (std::size_t j = 0; j < dW2.size(); ++j)
+			{
+				dW2[j] = generator.RN();
+			}
+			kl.buildIncrements(&dW2[0], &dW[0], batch);
+			current = 0;
 		}
 
-		return value;
+		return &dW[kl.steps() * current++];
 }
 
-
 template <typename X, typename Time, typename RT,typename Generator >
 void KarhunenLoeve<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 {
 
 		// Generate once for each draw/simulation
-		for (std::size_t j = 0; j < dW2.size(); ++j)
-		{
-			dW2[j] = generator.RN();
-		}
+		const Time* Wincr = nextIncrements();
 
         auto VOld = sde.ic;
 	
 		res[0] = VOld;
 		for (std::size_t index = 1; index < x.size(); ++index)
 		{
-            res[index] = VOld  + k * sde.drift(VOld, x[index-1])
-								+ sqrk * sde.diffusion(VOld, time) *  generator.RN(); // Classic Euler
-							//	+ sde.diffusion(VOld, time) *  KLExpansion(x[index], x[index-1]);
+			time = x[index-1];
+            res[index] = VOld  + k * sde.drift(VOld, time)
+								+ sde.diffusion(VOld, time) *  Wincr[index-1];
+			VOld = res[index];
 		}
 }
 
 
 // Predictor-Corrector with Karhune-Loeve
 template <typename X, typename Time, typename RT,typename Generator>
-PredictorCorrectorKL<X,Time,RT,Generator>::PredictorCorrectorKL(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator,X alpha, X beta, double tolerance)
-			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), tol(tolerance)
+PredictorCorrectorKL<X,Time,RT,Generator>::PredictorCorrectorKL(long NSteps, Sde<X,Time,RT>& sde,const Generator& generator,X alpha, X beta,
+																 std::size_t batchSize)
+			: FdmVisitor<X,Time,RT,Generator>(NSteps, sde, generator), kl(x), batch(batchSize), current(batchSize)
 {
 	
 	A = alpha;
 	B = beta;
 
-	Ntrunc = static_cast<long>(sqrt(2.0*sde.ran.high())/(tol*3.1415) - 0.5);
-	sqrT = 2.0*sqrt(2.0*T);
-	cout << "trunc " << Ntrunc;
-	dW2 = boost::numeric::ublas::vector<Time> (Ntrunc+1); 		
+	dW2.resize(kl.terms() * batch);
+	dW.resize(kl.steps() * batch);
+}
 
+template <typename X, typename Time, typename RT,typename Generator>
+const Time* PredictorCorrectorKL<X,Time,RT,Generator>::nextIncrements()
+{ // Increments of the next path, generated a batch at a time
+
+		if (current == batch)
+		{
+			for (std::size_t j = 0; j < dW2.size(); ++j)
+			{
+				dW2[j] = generator.RN();
+			}
+			kl.buildIncrements(&dW2[0], &dW[0], batch);
+			current = 0;
+		}
+
+		return &dW[kl.steps() * current++];
 }
 
 template <typename X, typename Time, typename RT,typename Generator >
@@ -409,10 +542,7 @@ void PredictorCorrectorKL<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 {
 	
 		// Generate once for each draw/simulation
-		for (std::size_t j = 0; j < dW2.size(); ++j)
-		{
-			dW2[j] = generator.RN();
-		}
+		const Time* Wincr = nextIncrements();
 
         auto VOld = sde.ic;
 		res[0] = VOld;
@@ -422,7 +552,7 @@ void PredictorCorrectorKL<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 		{
 		
 			// Predictor part; we use Euler with 'normal' drift function
-			VMid = VOld  + k * sde.drift(VOld, x[index-1]) + sde.diffusion(VOld, x[index-1]) *  KLExpansion(x[index], x[index-1]);
+			VMid = VOld  + k * sde.drift(VOld, x[index-1]) + sde.diffusion(VOld, x[index-1]) *  Wincr[index-1];
 
 			// Corrector part
 			// Trapezoid average
@@ -432,36 +562,14 @@ void PredictorCorrectorKL<X,Time,RT,Generator>::Visit(Sde<X,Time,RT>& sde)
 			adjDriftTerm = k*sde.driftCorrected(A*VMid + (1.0 - A)*VOld , 0.5*(x[index] + x[index-1]), B);
 			
 			//diffusionTerm = (B * sde.diffusion(VMid, x[index]) 
-				//				+ (1.0 - B) * sde.diffusion(VOld, x[index-1]) ) * KLExpansion(x[index], x[index-1]);
+				//				+ (1.0 - B) * sde.diffusion(VOld, x[index-1]) ) * Wincr[index-1];
 
 			// Midpoint average
-			diffusionTerm = sde.diffusion(B*VMid + (1.0 - B)*VOld , 0.5*(x[index] + x[index-1]))* KLExpansion(x[index], x[index-1]);
+			diffusionTerm = sde.diffusion(B*VMid + (1.0 - B)*VOld , 0.5*(x[index] + x[index-1]))* Wincr[index-1];
 
             res[index] = VOld + adjDriftTerm + diffusionTerm;
+			VOld = res[index];
 		}	
 	
 }
-template <typename X, typename Time, typename RT,typename Generator>
-X PredictorCorrectorKL<X,Time,RT,Generator>::orthogonalFunction(Time t, long n)
-{
-	const double PI = 3.1415;
-
-	X f = (2.0*n + 1.0)*PI;
-	
-	return (sqrT/f)*sin(0.5*f*t/T);
-}
-
-template <typename X, typename Time, typename RT,typename Generator>
-X PredictorCorrectorKL<X,Time,RT,Generator>::KLExpansion(Time s, Time t) // s > t
-{
-	
-		X value = 0.0;
-#pragma omp parallel for reduction (+:value)
-		for (std::size_t n = 0; n < dW2.size(); ++n)
-		{
-			value += dW2[n]*(orthogonalFunction(s, n) - orthogonalFunction(t, n) );
-		}
-
-		return value;
-}
 #endif
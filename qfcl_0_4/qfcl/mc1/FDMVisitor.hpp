@@ -13,6 +13,10 @@
 #include "Sde.hpp"
 #include "SdeVisitor.hpp"
 #include "Range.cpp"
+#include "BrownianBridge.cpp"
+#include "KLPathGenerator.cpp"
+
+#include <vector>
 
 #include <boost/mpl/string.hpp>
 #include <boost/numeric/ublas/matrix.hpp>		// The matrix class.
@@ -62,13 +66,27 @@ public: // For convenience
 
 	Sde<X,Time,RT> sde;
 
+	// Per-step coefficients of a time-homogeneous CEV SDE (SdeStructure), taken
+	// from the SDE being visited: X_{n+1} = X_n stepDrift
+	// + stepDiffusion X_n^beta Z (+ stepMilstein X_n^(2 beta - 1) (Z^2 - 1))
+	bool cev;
+	RT beta;
+	RT stepDrift;		// 1 + mu k
+	RT stepDiffusion;	// sigma sqrt(k)
+	RT stepMilstein;	// sigma^2 beta k / 2
+	std::vector<double> z;	// Normals of one path
+
 public:
-	FdmVisitor() {}
+	FdmVisitor() : cev(false) {}
 
 	FdmVisitor(long NSteps, const Sde<X,Time,RT>& mySde, const Generator& generator);
 
 	virtual pathType<X> & path();
 
+	// Model analysis: the coefficients above for sde, which may be another SDE
+	// than the one given to the constructor (on the same range)
+	void analyse(const Sde<X,Time,RT>& sde);
+
 };
 
 namespace detail {
@@ -99,6 +117,13 @@ public:
     using base_type::generator;
     using base_type::N;
 
+    using base_type::cev;
+    using base_type::beta;
+    using base_type::stepDrift;
+    using base_type::stepDiffusion;
+    using base_type::stepMilstein;
+    using base_type::z;
+
 	ExplicitEuler() {}
 	ExplicitEuler(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator);
 
@@ -132,12 +157,14 @@ public:
 
 template <typename X, typename Time, typename RT,  typename Generator>
 	class ExplicitEulerMM : public FdmVisitor<X,Time,RT, Generator>
-{ // Explicit Euler by Momen matching (quadratic resampling
+{ // Explicit Euler by Momen matching (quadratic resampling) over a batch of paths
 
 private:
     typedef FdmVisitor<X, Time, RT, Generator> base_type;
 
-	boost::numeric::ublas::vector<Time> dW2; 
+	std::size_t batch;		// Number of paths per batch
+	std::size_t current;	// Next unused path of the batch
+	std::vector<Time> dW2;	// Matched normals of the batch, one row per path
 
 public:
     /* inherit from base clase */
@@ -149,8 +176,36 @@ public:
     using base_type::generator;
     using base_type::N;
 
-    ExplicitEulerMM() {}
-	ExplicitEulerMM(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator);
+    ExplicitEulerMM() : batch(0), current(0) {}
+	ExplicitEulerMM(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator, std::size_t batchSize = 256);
+
+	void Visit(Sde<X,Time,RT>& sde);
+};
+
+template <typename X, typename Time, typename RT,  typename Generator>
+	class ExplicitEulerBridge : public FdmVisitor<X,Time,RT, Generator>
+{ // Explicit Euler with increments from Brownian bridge paths, built a batch at a time
+
+private:
+    typedef FdmVisitor<X, Time, RT, Generator> base_type;
+
+	BrownianBridge<Time> bridge;
+	std::size_t batch;		// Number of paths per batch
+	std::size_t current;	// Next unused path of the batch
+	std::vector<Time> z;	// Normals of the batch
+	std::vector<Time> w;	// Brownian paths of the batch
+
+public:
+    /* inherit from base clase */
+    using base_type::res;
+    using base_type::x;
+    using base_type::time;
+    using base_type::k;
+    using base_type::generator;
+    using base_type::N;
+
+    ExplicitEulerBridge() : batch(0), current(0) {}
+	ExplicitEulerBridge(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator, std::size_t batchSize = 1024);
 
 	void Visit(Sde<X,Time,RT>& sde);
 };
@@ -258,6 +313,13 @@ public:
     using base_type::generator;
     using base_type::N;
 
+    using base_type::cev;
+    using base_type::beta;
+    using base_type::stepDrift;
+    using base_type::stepDiffusion;
+    using base_type::stepMilstein;
+    using base_type::z;
+
     Milstein() {}
 	Milstein(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator);
 
@@ -271,12 +333,13 @@ template <typename X, typename Time, typename RT,  typename Generator>
 private:
     typedef FdmVisitor<X, Time, RT, Generator> base_type;
 
-	double tol, sqrT;
-	long Ntrunc; // Computed number of needed terms
-	boost::numeric::ublas::vector<Time> dW2; 
+	KLPathGenerator<Time> kl;	// Discrete basis tabulated on the mesh, all N terms
+	std::size_t batch;			// Number of paths per batch
+	std::size_t current;		// Next unused path of the batch
+	std::vector<Time> dW2;		// Normals of the batch
+	std::vector<Time> dW;		// Brownian increments of the batch
 
-	X orthogonalFunction(Time t, long n);
-	X KLExpansion(Time s, Time t);
+	const Time* nextIncrements();
 
 public:
     /* inherit from base clase */
@@ -289,8 +352,37 @@ public:
     using base_type::N;
     using base_type::T;
 
-    KarhunenLoeve() {}
-    KarhunenLoeve(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator, double tolerance);
+    KarhunenLoeve() : batch(0), current(0) {}
+    KarhunenLoeve(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator, std::size_t batchSize = 256);
+
+	void Visit(Sde<X,Time,RT>& sde);
+};
+
+// Geometric Brownian motion stepped exactly in log space,
+// X_{n+1} = X_n exp((mu - sigma^2 / 2) k + sigma sqrt(k) Z); needs an SDE
+// declaring SdeStructure::cev(mu, sigma, 1)
+template <typename X, typename Time, typename RT,  typename Generator>
+	class ExactLog : public FdmVisitor<X,Time,RT, Generator>
+{
+
+private:
+    typedef FdmVisitor<X, Time, RT, Generator> base_type;
+
+	std::vector<double> s;	// log(X_n / X_0)
+
+public:
+    /* inherit from base clase */
+    using base_type::res;
+    using base_type::x;
+    using base_type::k;
+    using base_type::sqrk;
+    using base_type::generator;
+    using base_type::N;
+    using base_type::stepDiffusion;
+    using base_type::z;
+
+    ExactLog() {}
+	ExactLog(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator);
 
 	void Visit(Sde<X,Time,RT>& sde);
 };
@@ -306,12 +398,13 @@ private:
 	X A, B;
 	X VMid;	// Predictor value
 
-	double tol, sqrT;
-	long Ntrunc; // Computed number of needed terms
-	boost::numeric::ublas::vector<Time> dW2; 
+	KLPathGenerator<Time> kl;	// Discrete basis tabulated on the mesh, all N terms
+	std::size_t batch;			// Number of paths per batch
+	std::size_t current;		// Next unused path of the batch
+	std::vector<Time> dW2;		// Normals of the batch
+	std::vector<Time> dW;		// Brownian increments of the batch
 
-	X orthogonalFunction(Time t, long n);
-	X KLExpansion(Time s, Time t);
+	const Time* nextIncrements();
 
 public:
     /* inherit from base clase */
@@ -324,9 +417,9 @@ public:
     using base_type::N;
     using base_type::T;
 
-    PredictorCorrectorKL() {}
+    PredictorCorrectorKL() : batch(0), current(0) {}
 	PredictorCorrectorKL(long NSteps, Sde<X,Time,RT>& sde, const Generator& generator,
-						X alpha, X beta, double tolerance);
+						X alpha, X beta, std::size_t batchSize = 256);
 
 	void Visit(Sde<X,Time,RT>& sde);
 };
@@ -41,16 +41,20 @@ typedef qfcl::tmp::concatenate< mpl::string<'R', 'i', 'c', 'h', 'a', 'r', 'd'>::
 typedef mpl::string<'M', 'i', 'l', 's', 't', 'e', 'i', 'n'>::type Milstein_string;
 typedef mpl::string<'K', 'a', 'r', 'h', 'u', 'n', 'e', 'n'>::type Karhunen_string;
 typedef mpl::string<'L', 'o', 'e', 'v', 'e'>::type Loeve_string;
+typedef mpl::string<'E', 'x', 'a', 'c', 't'>::type Exact_string;
+typedef mpl::string<'L', 'o', 'g'>::type Log_string;
 
 typedef qfcl::tmp::concatenate<Explicit_string, Euler_string>::type ExplicitEuler_name;
 typedef qfcl::tmp::concatenate<ExplicitEuler_name, Type_string, Roman_II_string>::type ExplicitEulerTypeII_name;
 typedef qfcl::tmp::concatenate<ExplicitEuler_name, mpl::string<'M', 'M'>::type>::type ExplicitEulerMM_name;
+typedef qfcl::tmp::concatenate<ExplicitEuler_name, mpl::string<'B', 'r', 'i', 'd', 'g', 'e'>::type>::type ExplicitEulerBridge_name;
 typedef qfcl::tmp::concatenate<Predictor_string, Corrector_string>::type PredictorCorrector_name;
 typedef qfcl::tmp::concatenate<PredictorCorrector_name, Classico_string>::type PredictorCorrectorClassico_name;
 typedef qfcl::tmp::concatenate<Richardson_string, Euler_string>::type RichardsonEuler_name;
 typedef Milstein_string Milstein_name;
 typedef qfcl::tmp::concatenate<Karhunen_string, Loeve_string>::type KarhunenLoeve_name;
 typedef qfcl::tmp::concatenate<PredictorCorrector_name, mpl::string<'K', 'L'>::type>::type PredictorCorrectorKL_name;
+typedef qfcl::tmp::concatenate<Exact_string, Log_string>::type ExactLog_name;
 
 }	// namespace detail
 
@@ -87,6 +91,18 @@ public:
 							   detail::ExplicitEulerMM_name >(NSteps, sde, generator) {}
 };
 
+template<typename X, typename Time, typename RT, typename Generator>
+class ExplicitEulerBridge_named
+	: public qfcl::named_adapter< ExplicitEulerBridge<X, Time, RT, Generator>, detail::ExplicitEulerBridge_name >
+{
+public:
+	ExplicitEulerBridge_named() {}
+	//! \p batchSize paths are built at a time
+	ExplicitEulerBridge_named(long NSteps, Sde<X, Time, RT> & sde, const Generator & generator, std::size_t batchSize = 1024)
+		: qfcl::named_adapter< ExplicitEulerBridge<X, Time, RT, Generator>, 
+							   detail::ExplicitEulerBridge_name >(NSteps, sde, generator, batchSize) {}
+};
+
 template<typename X, typename Time, typename RT, typename Generator>
 class RichardsonEuler_named
 	: public qfcl::named_adapter< RichardsonEuler<X, Time, RT, Generator>, detail::RichardsonEuler_name >
@@ -134,7 +150,6 @@ public:
 							   detail::Milstein_name >(NSteps, sde, generator) {}
 };
 
-//! kludge: hard-coded tol = 0.01
 template<typename X, typename Time, typename RT, typename Generator>
 class KarhunenLoeve_named
 	: public qfcl::named_adapter< KarhunenLoeve<X, Time, RT, Generator>, detail::KarhunenLoeve_name >
@@ -143,10 +158,10 @@ public:
 	KarhunenLoeve_named() {}
 	KarhunenLoeve_named(long NSteps, Sde<X, Time, RT> & sde, const Generator & generator)
 		: qfcl::named_adapter< KarhunenLoeve<X, Time, RT, Generator>, 
-							   detail::KarhunenLoeve_name >(NSteps, sde, generator, 0.01) {}
+							   detail::KarhunenLoeve_name >(NSteps, sde, generator) {}
 };
 
-//! For now alpha = beta = 0.5 and tol are hard-coded. This is a kludge.
+//! For now alpha = beta = 0.5 are hard-coded. This is a kludge.
 template<typename X, typename Time, typename RT, typename Generator>
 class PredictorCorrectorKL_named
 	: public qfcl::named_adapter< PredictorCorrectorKL<X, Time, RT, Generator>, detail::PredictorCorrectorKL_name >
@@ -155,7 +170,19 @@ public:
 	PredictorCorrectorKL_named() {}
 	PredictorCorrectorKL_named(long NSteps, Sde<X, Time, RT> & sde, const Generator & generator)
 		: qfcl::named_adapter< PredictorCorrectorKL<X, Time, RT, Generator>, 
-							   detail::PredictorCorrectorKL_name >(NSteps, sde, generator, 0.5, 0.5, 0.01) {}
+							   detail::PredictorCorrectorKL_name >(NSteps, sde, generator, 0.5, 0.5) {}
+};
+
+//! needs an SDE declaring the GBM structure
+template<typename X, typename Time, typename RT, typename Generator>
+class ExactLog_named
+	: public qfcl::named_adapter< ExactLog<X, Time, RT, Generator>, detail::ExactLog_name >
+{
+public:
+	ExactLog_named() {}
+	ExactLog_named(long NSteps, Sde<X, Time, RT> & sde, const Generator & generator)
+		: qfcl::named_adapter< ExactLog<X, Time, RT, Generator>, 
+							   detail::ExactLog_name >(NSteps, sde, generator) {}
 };
 
 }	// namespace mc1
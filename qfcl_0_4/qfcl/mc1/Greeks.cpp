@@ -0,0 +1,235 @@
+// Greeks.cpp
+//
+// Pathwise (adjoint) and likelihood ratio sensitivities for the Euler and
+// Milstein schemes.
+//
+// 2012-10-19 DD kick off: adjoint sweep, Euler likelihood ratio
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef Greeks_CPP
+#define Greeks_CPP
+
+#include "Greeks.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+// TerminalPayoff
+
+inline double TerminalPayoff::operator () (const pathType<double>& path, double* dPath, double* dTheta) const
+{
+	const std::size_t N = path.size() - 1;
+	const double df = std::exp(-r * T);
+	const double value = f(path[N]);
+
+	dPath[N] += df * fDerivative(path[N]);
+	if (rIndex >= 0)
+	{
+		dTheta[rIndex] += -T * df * value;
+	}
+
+	return df * value;
+}
+
+namespace GreeksDetail
+{
+	inline double call(double K, double S) { return std::max(S - K, 0.0); }
+	inline double callDerivative(double K, double S) { return S > K ? 1.0 : 0.0; }
+}
+
+inline TerminalPayoff callPayoff(double K, double r, double T, int rIndex)
+{
+	return TerminalPayoff(boost::bind(&GreeksDetail::call, K, _1), boost::bind(&GreeksDetail::callDerivative, K, _1),
+						  r, T, rIndex);
+}
+
+// MCGreeks
+
+template <typename Generator>
+MCGreeks<Generator>::MCGreeks(const SdeGradient<double, double>& mySde, long NSteps, GreeksScheme myScheme,
+							  const Generator& generator)
+	: sde(mySde), scheme(myScheme), N(NSteps), P(mySde.parameters()), rng(generator)
+{
+	if (N < 1)
+		throw std::invalid_argument("MCGreeks: need at least one step");
+
+	k = sde.ran.spread() / double(N);
+	sqrk = std::sqrt(k);
+	for (long n = 0; n <= N; ++n)
+	{
+		t.push_back(sde.ran.low() + n * k);
+	}
+
+	X = pathType<double>(N + 1, 0.0);
+	Z.resize(N);
+	dPath.resize(N + 1);
+	dTheta.resize(P);
+	thetaBar.resize(P);
+	a_theta.resize(P);
+	b_theta.resize(P);
+	bx_theta.resize(P);
+	g.resize(P + 1);
+
+	reset();
+}
+
+template <typename Generator>
+void MCGreeks<Generator>::reset()
+{
+	NSim = 0;
+	sum = sumSquares = 0.0;
+	gsum.assign(P + 1, 0.0);
+	gsumSquares.assign(P + 1, 0.0);
+}
+
+template <typename Generator>
+void MCGreeks<Generator>::forward()
+{
+	boost::variate_generator<Generator&, boost::normal_distribution<> > nor(rng, boost::normal_distribution<>(0.0, 1.0));
+
+	X[0] = sde.ic;
+	for (long n = 0; n < N; ++n)
+	{
+		const double x = X[n], z = nor();
+		const double b = sde.diffusion(x, t[n]);
+
+		Z[n] = z;
+		X[n+1] = x + k * sde.drift(x, t[n]) + sqrk * b * z;
+		if (scheme == MilsteinGreeks)
+		{
+			X[n+1] += 0.5 * b * sde.diffusionX(x, t[n]) * k * (z * z - 1.0);
+		}
+	}
+}
+
+template <typename Generator>
+void MCGreeks<Generator>::accumulate(double value, const std::vector<double>& grad)
+{
+	++NSim;
+	sum += value;
+	sumSquares += value * value;
+	for (std::size_t i = 0; i <= P; ++i)
+	{
+		gsum[i] += grad[i];
+		gsumSquares[i] += grad[i] * grad[i];
+	}
+}
+
+template <typename Generator>
+void MCGreeks<Generator>::adjoint(const Payoff& payoff, long NSimulations)
+{
+	for (long i = 0; i < NSimulations; ++i)
+	{
+		// A. Forward: states and normals
+		forward();
+
+		std::fill(dPath.begin(), dPath.end(), 0.0);
+		std::fill(dTheta.begin(), dTheta.end(), 0.0);
+		const double value = payoff(X, &dPath[0], P > 0 ? &dTheta[0] : 0);
+
+		// B. Backward: lambda = dP/dX_n, thetaBar = dP/dtheta through X_{n+1}, ..., X_N
+		double lambda = dPath[N];
+		std::copy(dTheta.begin(), dTheta.end(), thetaBar.begin());
+
+		for (long n = N - 1; n >= 0; --n)
+		{
+			const double x = X[n], z = Z[n];
+			const double bx = sde.diffusionX(x, t[n]);
+			sde.driftTheta(x, t[n], &a_theta[0]);
+			sde.diffusionTheta(x, t[n], &b_theta[0]);
+
+			double dX = 1.0 + k * sde.driftX(x, t[n]) + sqrk * bx * z;
+			double c = 0.0, b = 0.0;
+			if (scheme == MilsteinGreeks)
+			{
+				b = sde.diffusion(x, t[n]);
+				c = 0.5 * k * (z * z - 1.0);
+				dX += c * (bx * bx + b * sde.diffusionXX(x, t[n]));
+				sde.diffusionXTheta(x, t[n], &bx_theta[0]);
+			}
+
+			for (std::size_t p = 0; p < P; ++p)
+			{
+				double dXdtheta = k * a_theta[p] + sqrk * b_theta[p] * z;
+				if (scheme == MilsteinGreeks)
+				{
+					dXdtheta += c * (b_theta[p] * bx + b * bx_theta[p]);
+				}
+				thetaBar[p] += lambda * dXdtheta;
+			}
+
+			lambda = dPath[n] + lambda * dX;
+		}
+
+		g[0] = lambda;
+		std::copy(thetaBar.begin(), thetaBar.end(), g.begin() + 1);
+		accumulate(value, g);
+	}
+}
+
+template <typename Generator>
+void MCGreeks<Generator>::likelihoodRatio(const Payoff& payoff, long NSimulations)
+{
+	if (scheme != EulerGreeks)
+		throw std::logic_error("MCGreeks: likelihood ratio needs the Gaussian transitions of the Euler scheme");
+
+	for (long i = 0; i < NSimulations; ++i)
+	{
+		forward();
+
+		std::fill(dPath.begin(), dPath.end(), 0.0);
+		std::fill(dTheta.begin(), dTheta.end(), 0.0);
+		const double value = payoff(X, &dPath[0], P > 0 ? &dTheta[0] : 0);
+
+		// Score of the transition density N(X_n + a k, b^2 k) of each step, with the path fixed
+		std::fill(thetaBar.begin(), thetaBar.end(), 0.0);
+		for (long n = 0; n < N; ++n)
+		{
+			const double x = X[n], z = Z[n];
+			const double b = sde.diffusion(x, t[n]);
+			sde.driftTheta(x, t[n], &a_theta[0]);
+			sde.diffusionTheta(x, t[n], &b_theta[0]);
+
+			for (std::size_t p = 0; p < P; ++p)
+			{
+				thetaBar[p] += ((z * z - 1.0) * b_theta[p] + z * sqrk * a_theta[p]) / b;
+			}
+
+			if (n == 0)
+			{ // Only the first transition depends on X0
+				const double bx = sde.diffusionX(x, t[0]);
+				g[0] = value * ((z * z - 1.0) * bx + z * (1.0 + k * sde.driftX(x, t[0])) / sqrk) / b;
+			}
+		}
+
+		for (std::size_t p = 0; p < P; ++p)
+		{
+			g[p + 1] = dTheta[p] + value * thetaBar[p];
+		}
+		accumulate(value, g);
+	}
+}
+
+template <typename Generator>
+double MCGreeks<Generator>::priceError() const
+{
+	double var = (sumSquares - sum * sum / NSim) / (NSim - 1);
+
+	return std::sqrt(std::max(var, 0.0) / NSim);
+}
+
+template <typename Generator>
+double MCGreeks<Generator>::sensitivityError(std::size_t i) const
+{
+	double var = (gsumSquares[i] - gsum[i] * gsum[i] / NSim) / (NSim - 1);
+
+	return std::sqrt(std::max(var, 0.0) / NSim);
+}
+
+#endif	// Greeks_CPP
@@ -0,0 +1,113 @@
+// Greeks.hpp
+//
+// Monte Carlo sensitivities of E[P] to the initial value X0 and to the
+// parameters theta of an SdeGradient, from one simulation:
+//
+//	adjoint:		pathwise derivatives. Each path is simulated by the Euler or
+//					Milstein recurrence, storing the states and the normals; a
+//					backward sweep
+//
+//						lambda_N = dP/dX_N,
+//						lambda_n = dP/dX_n + lambda_{n+1} dX_{n+1}/dX_n,
+//						thetaBar += lambda_{n+1} dX_{n+1}/dtheta,
+//
+//					then gives dP/dX0 = lambda_0 and dP/dtheta for all parameters
+//					at once, at a cost of a few forward passes. Needs a payoff
+//					that is (almost everywhere) differentiable in the path.
+//	likelihoodRatio: E[P score], with the score of the Euler transition
+//					densities. Only needs the payoff value, so it also works for
+//					digitals and barriers, with a larger variance. Euler only.
+//
+// Payoff is a functor with signature
+//
+//	double (const pathType<double>& path, double* dPath, double* dTheta)
+//
+// returning the (discounted) payoff and adding dP/dX_n to dPath[n] (N + 1
+// values) and any direct parameter dependence, e.g. of the discount factor,
+// to dTheta[p] (P values). Both arrays are zero on entry.
+//
+// Sensitivities are indexed 0 for X0 and 1 + p for parameter p.
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef Greeks_HPP
+#define Greeks_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "FDMVisitor.hpp"	// pathType
+#include "SdeGradient.hpp"
+
+enum GreeksScheme { EulerGreeks, MilsteinGreeks };
+
+// Discounted payoff f(X_N) exp(-r T) of the terminal value; rIndex is the
+// position of r among the parameters (or -1 if the discount rate is fixed)
+struct TerminalPayoff
+{
+	boost::function<double (double)> f;
+	boost::function<double (double)> fDerivative;
+	double r, T;
+	int rIndex;
+
+	TerminalPayoff(const boost::function<double (double)>& payoff, const boost::function<double (double)>& derivative,
+				   double rate, double maturity, int rateIndex = 0)
+		: f(payoff), fDerivative(derivative), r(rate), T(maturity), rIndex(rateIndex) {}
+
+	double operator () (const pathType<double>& path, double* dPath, double* dTheta) const;
+};
+
+// European call max(X_T - K, 0), discounted
+TerminalPayoff callPayoff(double K, double r, double T, int rIndex = 0);
+
+template <typename Generator>
+			class MCGreeks
+{
+public:
+	typedef boost::function<double (const pathType<double>&, double*, double*)> Payoff;
+
+private:
+	SdeGradient<double, double> sde;
+	GreeksScheme scheme;
+	long N;					// Number of steps
+	double k, sqrk;			// Time step and its square root
+	std::vector<double> t;	// Mesh
+	std::size_t P;			// Number of parameters
+
+	Generator rng;
+
+	// Per path work space
+	pathType<double> X;
+	std::vector<double> Z, dPath, dTheta, thetaBar, a_theta, b_theta, bx_theta, g;
+
+	// Sums over the paths of the payoff and of the sensitivity estimates
+	long NSim;
+	double sum, sumSquares;
+	std::vector<double> gsum, gsumSquares;
+
+	void forward();						// Simulate X from fresh normals Z
+	void accumulate(double value, const std::vector<double>& grad);
+
+public:
+	MCGreeks(const SdeGradient<double, double>& mySde, long NSteps, GreeksScheme myScheme, const Generator& generator);
+
+	// Pathwise sensitivities by the adjoint sweep
+	void adjoint(const Payoff& payoff, long NSimulations);
+
+	// Likelihood ratio sensitivities (Euler scheme)
+	void likelihoodRatio(const Payoff& payoff, long NSimulations);
+
+	void reset();
+
+	double price() const { return sum / NSim; }
+	double priceError() const;
+
+	std::size_t size() const { return P + 1; }			// Number of sensitivities
+	double sensitivity(std::size_t i) const { return gsum[i] / NSim; }
+	double sensitivityError(std::size_t i) const;		// Standard error
+};
+
+#endif
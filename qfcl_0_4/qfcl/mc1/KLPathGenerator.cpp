@@ -0,0 +1,137 @@
+// KLPathGenerator.cpp
+//
+// Karhunen-Loeve path synthesis with a precomputed basis.
+//
+// 2012-10-19 DD kick off: basis tables, blocked matrix product
+// 2012-10-19 DD discrete expansion with exact increments
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef KLPathGenerator_CPP
+#define KLPathGenerator_CPP
+
+#include "KLPathGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <qfcl/math/simple/functions.hpp>
+
+template <typename Time>
+KLPathGenerator<Time>::KLPathGenerator(const ublas::vector<Time>& mesh, std::size_t terms)
+		: K(terms), N(mesh.size() - 1)
+{ // Tabulate the basis and its increments
+
+	if (mesh.size() < 2 || terms == 0)
+		throw std::invalid_argument("KLPathGenerator: need at least one step and one term");
+
+	const Time t0 = mesh[0];
+	const Time T = mesh[N] - t0;
+	const Time sqrT = 2.0 * std::sqrt(2.0 * T);
+
+	phiT.resize(K * (N + 1));
+	dPhiT.resize(K * N);
+	for (std::size_t n = 0; n < K; ++n)
+	{
+		Time f = (2.0 * n + 1.0) * qfcl::math::pi<Time>();
+		for (std::size_t i = 0; i <= N; ++i)
+		{
+			phiT[n * (N + 1) + i] = (sqrT / f) * std::sin(0.5 * f * (mesh[i] - t0) / T);
+		}
+		for (std::size_t i = 0; i < N; ++i)
+		{
+			dPhiT[n * N + i] = phiT[n * (N + 1) + i + 1] - phiT[n * (N + 1) + i];
+		}
+	}
+}
+
+template <typename Time>
+KLPathGenerator<Time>::KLPathGenerator(const ublas::vector<Time>& mesh)
+		: K(mesh.size() - 1), N(mesh.size() - 1)
+{ // Tabulate the discrete basis, scaling the unit steps to the mesh
+
+	if (mesh.size() < 2)
+		throw std::invalid_argument("KLPathGenerator: need at least one step");
+
+	const Time norm = std::sqrt(2.0 * N + 1.0);
+
+	phiT.resize(K * (N + 1));
+	dPhiT.resize(K * N);
+	for (std::size_t n = 0; n < K; ++n)
+	{
+		Time theta = (2.0 * n + 1.0) * qfcl::math::pi<Time>() / (2.0 * (2.0 * N + 1.0));
+		Time scale = 1.0 / (norm * std::sin(theta));
+		Time psiOld = 0.0;
+
+		phiT[n * (N + 1)] = 0.0;
+		for (std::size_t i = 0; i < N; ++i)
+		{
+			Time psi = scale * std::sin(2.0 * theta * (i + 1.0));
+			dPhiT[n * N + i] = std::sqrt(mesh[i + 1] - mesh[i]) * (psi - psiOld);
+			phiT[n * (N + 1) + i + 1] = phiT[n * (N + 1) + i] + dPhiT[n * N + i];
+			psiOld = psi;
+		}
+	}
+}
+
+template <typename Time>
+std::size_t KLPathGenerator<Time>::truncation(Time T, double tol)
+{
+	long Ntrunc = static_cast<long>(std::sqrt(2.0 * T) / (tol * qfcl::math::pi<double>()) - 0.5);
+
+	return static_cast<std::size_t>(std::max(Ntrunc, 0L)) + 1;
+}
+
+template <typename Time>
+void KLPathGenerator<Time>::multiply(const Time* a, const Time* bT, Time* c, std::size_t M, std::size_t K, std::size_t cols)
+{ // Blocks of rows x columns of c stay in cache while the terms are accumulated into them
+
+	const std::size_t rowBlock = 32, colBlock = 256, termBlock = 64;
+
+	for (std::size_t ib = 0; ib < M; ib += rowBlock)
+	{
+		const std::size_t ie = std::min(ib + rowBlock, M);
+		for (std::size_t jb = 0; jb < cols; jb += colBlock)
+		{
+			const std::size_t je = std::min(jb + colBlock, cols);
+			for (std::size_t i = ib; i < ie; ++i)
+			{
+				std::fill(c + i * cols + jb, c + i * cols + je, Time(0));
+			}
+
+			for (std::size_t nb = 0; nb < K; nb += termBlock)
+			{
+				const std::size_t ne = std::min(nb + termBlock, K);
+				for (std::size_t i = ib; i < ie; ++i)
+				{
+					Time* ci = c + i * cols;
+					for (std::size_t n = nb; n < ne; ++n)
+					{
+						const Time ain = a[i * K + n];
+						const Time* bn = bT + n * cols;
+						for (std::size_t j = jb; j < je; ++j)
+						{
+							ci[j] += ain * bn[j];
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+template <typename Time>
+void KLPathGenerator<Time>::buildPaths(const Time* z, Time* w, std::size_t M) const
+{
+	multiply(z, &phiT[0], w, M, K, N + 1);
+}
+
+template <typename Time>
+void KLPathGenerator<Time>::buildIncrements(const Time* z, Time* dw, std::size_t M) const
+{
+	multiply(z, &dPhiT[0], dw, M, K, N);
+}
+
+#endif	// KLPathGenerator_CPP
@@ -0,0 +1,77 @@
+// KLPathGenerator.hpp
+//
+// Brownian paths on a mesh from a truncated Karhunen-Loeve expansion
+//
+//	W(t) = sum_n Z_n phi_n(t),	phi_n(t) = 2 sqrt(2T) / ((2n + 1) pi) sin((2n + 1) pi t / (2T)),
+//
+// with the basis phi_n evaluated once per mesh (e.g. Range::mesh) and the
+// truncation chosen once. A batch of paths is then a single matrix product
+//
+//	W (paths x points) = Z (paths x terms) * Phi^T (terms x points),
+//
+// done in cache-sized blocks, instead of a sum of sines per step per path.
+//
+// A truncated expansion is smooth, so a scheme driven by its increments
+// converges to the Stratonovich rather than the Ito solution. The schemes
+// use the discrete expansion instead: N terms, the eigenvectors of the
+// covariance min(i, j) of a random walk of N unit steps,
+//
+//	psi_n(i) = sin(2 theta_n i) / (sqrt(2N + 1) sin theta_n),	theta_n = (2n + 1) pi / (2(2N + 1)),
+//
+// with step i scaled by sqrt(t_{i+1} - t_i). Its increments are exactly
+// independent N(0, t_{i+1} - t_i) on any mesh, and on a uniform mesh it is
+// the principal component decomposition of the Brownian path.
+//
+// Layout (row major, one row per path):
+//	normals:	z[m * terms() + n]
+//	paths:		w[m * points() + i]
+//	increments:	dw[m * steps() + i],	dw = w[i+1] - w[i]
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef KLPathGenerator_HPP
+#define KLPathGenerator_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+
+namespace ublas=boost::numeric::ublas;
+
+template <typename Time = double>
+			class KLPathGenerator
+{
+private:
+	std::size_t K;				// Number of terms
+	std::size_t N;				// Number of steps
+	std::vector<Time> phiT;		// phiT[n * (N + 1) + i] = phi_n(t_i)
+	std::vector<Time> dPhiT;	// dPhiT[n * N + i] = phi_n(t_{i+1}) - phi_n(t_i)
+
+	// c (M x cols) = a (M x K) * bT (K x cols), blocked
+	static void multiply(const Time* a, const Time* bT, Time* c, std::size_t M, std::size_t K, std::size_t cols);
+
+public:
+	KLPathGenerator() : K(0), N(0) {}
+	KLPathGenerator(const ublas::vector<Time>& mesh, std::size_t terms);	// Truncated expansion
+	explicit KLPathGenerator(const ublas::vector<Time>& mesh);				// Discrete expansion
+
+	// The number of terms needed for tolerance tol on [0, T], as used by the KL schemes
+	static std::size_t truncation(Time T, double tol);
+
+	std::size_t terms() const { return K; }
+	std::size_t steps() const { return N; }
+	std::size_t points() const { return N + 1; }
+
+	// phi_n(t_i)
+	Time basis(std::size_t i, std::size_t n) const { return phiT[n * (N + 1) + i]; }
+
+	// M paths w from the normals z, see the layout above
+	void buildPaths(const Time* z, Time* w, std::size_t M) const;
+
+	// The increments of M paths from the normals z, see the layout above
+	void buildIncrements(const Time* z, Time* dw, std::size_t M) const;
+};
+
+#endif
@@ -13,6 +13,7 @@
 // 2011-12-5 DD payoff --> signals
 // 2011-12-9 DD use uBLAS vector
 // 2011-12-11 DD generic RMG class from Boost
+// 2012-10-19 DD optional variance reduction (MCVarianceReduction)
 //
 // This class plays the role of the Director in the Builder
 // pattern (if we decide to use it).
@@ -33,6 +34,7 @@
 #include "MCPostProcess.hpp"
 #include "Sde.hpp"
 #include "FDMVisitor.hpp"
+#include "VarianceReduction.hpp"
 
 #include <boost/function.hpp>
 #include <boost/signals.hpp>
@@ -73,6 +75,15 @@ class MCTypeDMediator
 			}
 			
 			fdm = &myFdm;			
+			vr = 0;
+		}
+
+		// Price through reduction from now on: it simulates NSim paths (its schemes must be
+		// the same as the mediator's) and its samples are sent to the reporter
+		void varianceReduction(MCVarianceReduction<Real, Counter, Generator, Payoff> & reduction)
+		{
+			vr = &reduction;
+			vr -> record(true);
 		}
 
 		void price()
@@ -89,17 +100,26 @@ class MCTypeDMediator
 		
 			ublas::vector<Real> TerminalValue(NSim, 0.0); // Array of values at t = T
 	
-			// A.
-			for (Counter i = 0; i < NSim; ++i)
-			{ // Calculate a path at each iteration
+			if (vr != 0)
+			{ // A. and B. by the variance reduction, one value per sample
+				vr -> reset();
+				vr -> simulate(NSim);
+				vr -> adjustedSamples(TerminalValue);
+			}
+			else
+			{
+				// A.
+				for (Counter i = 0; i < NSim; ++i)
+				{ // Calculate a path at each iteration
 		
-				prog(i);
+					prog(i);
 			
-				// Compute the current path and get value at t = T
-				// For more complicated payoffs we have to send the complete path.
+					// Compute the current path and get value at t = T
+					// For more complicated payoffs we have to send the complete path.
 				
-				//TerminalValue[i] = payoff(fdm->path()[fdm->path().size()-1]);
-				TerminalValue[i] = payoff(fdm -> path());
+					//TerminalValue[i] = payoff(fdm->path()[fdm->path().size()-1]);
+					TerminalValue[i] = payoff(fdm -> path());
+				}
 			}
 	
 			// Send statistics Display information
@@ -126,6 +146,7 @@ class MCTypeDMediator
 
 		typename Progress<Counter>::signal prog;
 		FdmVisitor<Real,Real,Real,Generator> * fdm;
+		MCVarianceReduction<Real, Counter, Generator, Payoff> * vr;	// 0 for plain Monte Carlo
 		MCReporter & mcr;
 };
 
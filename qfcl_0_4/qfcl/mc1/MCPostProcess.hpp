@@ -25,6 +25,7 @@ namespace mpl = boost::mpl;
 #include <boost/tuple/tuple_io.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <qfcl/statistics/column_store.hpp>
 #include <qfcl/statistics/descriptive.hpp>
 
 #include <qfcl/utility/tmp.hpp>
@@ -215,5 +216,50 @@ struct MCReporter
 	}
 };
 
+// Slot that appends the simulated values to a memory mapped column store instead of keeping
+// them in memory. The file can be reloaded without parsing by qfcl::statistics::column_store_reader,
+// and its columns given directly to DescriptiveStatistics.
+struct MCColumnOutput
+{
+	qfcl::statistics::column_store_writer store;
+
+	static std::vector<qfcl::statistics::column_spec> column_specs()
+	{
+		std::vector<qfcl::statistics::column_spec> specs;
+		specs.push_back( qfcl::statistics::column_spec("terminal_value") );
+		specs.push_back( qfcl::statistics::column_spec("discounted_value") );
+		return specs;
+	}
+
+	// capacity is the total number of simulations to be stored
+	MCColumnOutput(const std::string & filename, size_t capacity)
+		: store( filename, column_specs(), capacity )
+	{
+	}
+
+	void operator () (Status s)
+	{
+		if (s == STOP)
+			store.flush();
+	}
+
+	void operator () (const boost::numeric::ublas::vector<double>& packetArr)
+	{
+		using namespace OneFactorSDE;
+
+		if ( packetArr.empty() )
+			return;
+
+		std::vector<double> discounted( packetArr.begin(), packetArr.end() );
+		auto discount_factor = exp(-r * T);
+		for_each(discounted.begin(), discounted.end(), [=] (double & d) {d *= discount_factor;});
+
+		auto chunk = store.append( packetArr.size() );
+		chunk.write( 0, &packetArr[0] );
+		chunk.write( 1, &discounted[0] );
+		chunk.commit();
+	}
+};
+
 
 #endif
@@ -0,0 +1,211 @@
+// MLMC.cpp
+//
+// Multilevel Monte Carlo driver.
+//
+// 2012-10-19 DD kick off: coupled levels, online variance/cost, optimal allocation
+// 2012-10-19 DD cost as time steps per sample rather than wall clock time of the parallel levels
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef MLMC_CPP
+#define MLMC_CPP
+
+#include "MLMC.hpp"
+#include "FDMVisitor.cpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+MLMC<Scheme, Generator, Payoff>::MLMC(const Sde<double, double, double>& mySde, const Payoff& myPayoff, long NSteps0,
+									  std::size_t maxLevels, double weakOrder, double varianceRate)
+	: sde(mySde), payoff(myPayoff), N0(NSteps0), Lmax(maxLevels), alpha(weakOrder), beta(varianceRate)
+{
+	if (N0 < 1 || Lmax < 3)
+		throw std::invalid_argument("MLMC: need at least one step on level 0 and at least 3 levels");
+}
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+void MLMC<Scheme, Generator, Payoff>::addLevel(unsigned long seed)
+{
+	const std::size_t l = levels.size();
+
+	Simulator s;
+	s.fine.reset(new scheme_type(N0 << l, sde, Generator()));
+	s.z.resize(N0 << l);
+	if (l > 0)
+	{
+		s.coarse.reset(new scheme_type(N0 << (l - 1), sde, Generator()));
+		s.zc.resize(N0 << (l - 1));
+	}
+	s.rng.seed(static_cast<boost::uint32_t>(seed + l));
+
+	simulators.push_back(s);
+	levels.push_back(Level());
+}
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+void MLMC<Scheme, Generator, Payoff>::sample(std::size_t l, long n)
+{
+	Simulator& s = simulators[l];
+	Level& level = levels[l];
+
+	boost::variate_generator<Generator&, boost::normal_distribution<> > nor(s.rng, boost::normal_distribution<>(0.0, 1.0));
+	const double invSqrt2 = 1.0 / std::sqrt(2.0);
+
+	for (long i = 0; i < n; ++i)
+	{
+		for (std::size_t j = 0; j < s.z.size(); ++j)
+		{
+			s.z[j] = nor();
+		}
+
+		s.fine -> generator.replay(&s.z[0], static_cast<long>(s.z.size()));
+		double P = payoff(s.fine -> path());
+
+		if (l > 0)
+		{ // Same Brownian increments on the coarse grid
+			for (std::size_t j = 0; j < s.zc.size(); ++j)
+			{
+				s.zc[j] = (s.z[2*j] + s.z[2*j + 1]) * invSqrt2;
+			}
+
+			s.coarse -> generator.replay(&s.zc[0], static_cast<long>(s.zc.size()));
+			P -= payoff(s.coarse -> path());
+		}
+
+		level.sum += P;
+		level.sumSquares += P * P;
+	}
+
+	level.N += n;
+	level.work += static_cast<double>(n) * (s.z.size() + s.zc.size());
+}
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+double MLMC<Scheme, Generator, Payoff>::rate(double (*f)(const Level&), std::size_t from) const
+{ // Least squares slope of -log2 f(level l) against l, l >= from
+
+	double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+	for (std::size_t l = from; l < levels.size(); ++l)
+	{
+		double y = std::log(std::max(f(levels[l]), 1e-300)) / std::log(2.0);
+		n += 1.0; sx += l; sy += y; sxx += double(l) * l; sxy += l * y;
+	}
+
+	return -(n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+namespace MLMCDetail
+{
+	template <typename Level>
+	double absMean(const Level& level) { return std::abs(level.mean()); }
+
+	template <typename Level>
+	double variance(const Level& level) { return level.variance(); }
+}
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+double MLMC<Scheme, Generator, Payoff>::estimate(double eps, long Ninit, unsigned long seed)
+{
+	simulators.clear();
+	levels.clear();
+	for (std::size_t l = 0; l < 3; ++l)
+	{
+		addLevel(seed);
+	}
+
+	std::vector<long> dN(levels.size(), Ninit);
+
+	while (true)
+	{
+		// A. Simulate the extra samples, one level per thread when built with OpenMP
+		#pragma omp parallel for schedule(dynamic)
+		for (long l = 0; l < static_cast<long>(levels.size()); ++l)
+		{
+			if (dN[l] > 0)
+			{
+				sample(l, dN[l]);
+			}
+		}
+
+		// B. Variances and costs; deep levels with few samples borrow from the decay rate
+		const std::size_t L = levels.size() - 1;
+		double b = beta > 0.0 ? beta : std::max(0.5, rate(&MLMCDetail::variance<Level>, 1));
+		std::vector<double> V(L + 1), C(L + 1);
+		for (std::size_t l = 0; l <= L; ++l)
+		{
+			V[l] = levels[l].variance();
+			if (l >= 2)
+			{
+				V[l] = std::max(V[l], 0.5 * V[l-1] / std::pow(2.0, b));
+			}
+			V[l] = std::max(V[l], 1e-300);
+			C[l] = levels[l].cost();
+		}
+
+		// C. Optimal number of samples per level for sampling error eps / sqrt(2)
+		double sum = 0.0;
+		for (std::size_t l = 0; l <= L; ++l)
+		{
+			sum += std::sqrt(V[l] * C[l]);
+		}
+
+		bool done = true;
+		dN.assign(L + 1, 0);
+		for (std::size_t l = 0; l <= L; ++l)
+		{
+			long N = static_cast<long>(std::ceil(2.0 / (eps * eps) * std::sqrt(V[l] / C[l]) * sum));
+			dN[l] = std::max(0L, N - levels[l].N);
+			if (dN[l] > 0.01 * levels[l].N)
+			{
+				done = false;
+			}
+		}
+
+		if (!done)
+		{
+			continue;
+		}
+
+		// D. Bias estimate from the last two levels; add a level if too large
+		double a = alpha > 0.0 ? alpha : std::max(0.5, rate(&MLMCDetail::absMean<Level>, 1));
+		double remainder = std::max(std::abs(levels[L].mean()), std::abs(levels[L-1].mean()) / std::pow(2.0, a))
+							/ (std::pow(2.0, a) - 1.0);
+
+		if (remainder <= eps / std::sqrt(2.0) || levels.size() >= Lmax)
+		{
+			break;
+		}
+
+		addLevel(seed);
+		dN.push_back(Ninit);
+	}
+
+	double P = 0.0;
+	for (std::size_t l = 0; l < levels.size(); ++l)
+	{
+		P += levels[l].mean();
+	}
+
+	return P;
+}
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+double MLMC<Scheme, Generator, Payoff>::totalCost() const
+{
+	double cost = 0.0;
+	for (std::size_t l = 0; l < levels.size(); ++l)
+	{
+		cost += levels[l].work;
+	}
+
+	return cost;
+}
+
+#endif	// MLMC_CPP
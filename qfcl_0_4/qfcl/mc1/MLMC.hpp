@@ -0,0 +1,110 @@
+// MLMC.hpp
+//
+// Multilevel Monte Carlo (Giles) driver for the FdmVisitor schemes.
+//
+// Level l uses N0 * 2^l time steps. Its estimator is the mean of
+// P_l - P_{l-1}, where the fine and the coarse path of each sample are driven
+// by the same Brownian increments: the coarse scheme gets the fine normals
+// pairwise aggregated, (z_{2j} + z_{2j+1}) / sqrt(2). Level 0 is a plain
+// simulation with N0 steps.
+//
+// The per-level variance V_l is estimated online and the cost C_l is the number
+// of time steps simulated per sample, N0 2^l + N0 2^(l-1) (N0 on level 0), so
+// that it does not depend on the other levels simulated at the same time. The
+// number of samples per level is set to
+//
+//	N_l = 2 / eps^2 * sqrt(V_l / C_l) * sum_k sqrt(V_k C_k),
+//
+// which makes the sampling error eps / sqrt(2), and levels are added until the
+// estimated bias is below eps / sqrt(2). The levels are simulated in parallel.
+//
+// The coupling is only exact for schemes that draw one normal per time step,
+// in order (ExplicitEuler, Milstein, PredictorCorrector,
+// PredictorCorrectorClassico, ExactLog); other schemes are rejected at compile
+// time through OneNormalPerStep.
+//
+// Payoff must be a functor with signature Real (const pathType<Real>&), as for
+// MCTypeDMediator.
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef MLMC_HPP
+#define MLMC_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+
+#include "FDMVisitor.hpp"
+
+// Does the scheme draw exactly one normal per time step, in order?
+template <template <typename, typename, typename, typename> class Scheme>
+			struct OneNormalPerStep { static const bool value = false; };
+
+template <> struct OneNormalPerStep<ExplicitEuler> { static const bool value = true; };
+template <> struct OneNormalPerStep<Milstein> { static const bool value = true; };
+template <> struct OneNormalPerStep<PredictorCorrector> { static const bool value = true; };
+template <> struct OneNormalPerStep<PredictorCorrectorClassico> { static const bool value = true; };
+template <> struct OneNormalPerStep<ExactLog> { static const bool value = true; };
+
+template <template <typename, typename, typename, typename> class Scheme, typename Generator, typename Payoff>
+			class MLMC
+{
+	BOOST_STATIC_ASSERT_MSG(OneNormalPerStep<Scheme>::value, "MLMC: the scheme must draw one normal per time step, in order");
+
+public:
+	typedef Scheme<double, double, double, Generator> scheme_type;
+
+	// Statistics of one level
+	struct Level
+	{
+		long N;				// Number of samples so far
+		double sum;			// Sum of P_l - P_{l-1}
+		double sumSquares;	// Sum of (P_l - P_{l-1})^2
+		double work;		// Total number of time steps simulated
+
+		Level() : N(0), sum(0.0), sumSquares(0.0), work(0.0) {}
+
+		double mean() const { return sum / N; }
+		double variance() const { return N > 1 ? (sumSquares - sum * sum / N) / (N - 1) : 0.0; }
+		double cost() const { return work / N; }
+	};
+
+private:
+	Sde<double, double, double> sde;
+	Payoff payoff;
+	long N0;			// Number of steps on level 0
+	std::size_t Lmax;	// Maximum number of levels
+	double alpha;		// Weak order, estimated when 0
+	double beta;		// Variance decay rate, estimated when 0
+
+	// The schemes and normals of a level; coarse is empty on level 0
+	struct Simulator
+	{
+		boost::shared_ptr<scheme_type> fine, coarse;
+		Generator rng;
+		std::vector<double> z, zc;
+	};
+
+	std::vector<Simulator> simulators;
+	std::vector<Level> levels;
+
+	void addLevel(unsigned long seed);
+	void sample(std::size_t l, long n);		// n more samples on level l
+	double rate(double (*f)(const Level&), std::size_t from) const;	// Regression of log2 f(level l) on l
+
+public:
+	MLMC(const Sde<double, double, double>& mySde, const Payoff& myPayoff, long NSteps0, std::size_t maxLevels,
+		 double weakOrder = 0.0, double varianceRate = 0.0);
+
+	// Estimate E[P] to root mean square error eps, starting each new level with Ninit samples
+	double estimate(double eps, long Ninit = 1000, unsigned long seed = 5489);
+
+	const std::vector<Level>& statistics() const { return levels; }
+	double totalCost() const;	// Number of time steps simulated over all levels
+};
+
+#endif
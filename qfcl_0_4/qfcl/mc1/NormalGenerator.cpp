@@ -16,6 +16,12 @@
 //	2009-6-29 DD Boost Normal generator
 //	2011-12-9 DD strippded to Boost
 //  2011-12-11 DD template version
+//  2012-10-19 DD replay of supplied numbers
+//  2012-10-19 DD moment matching over a batch of paths
+//  2012-10-19 DD explicit seeding
+//  2012-10-19 DD engine by value, block buffer, bulk fill
+//  2012-10-19 DD one variate generator per object
+//  2012-10-19 DD variate generator held by value
 //
 // (C) Datasim Education BV 2008-2011
 //
@@ -23,38 +29,145 @@
 #include "NormalGenerator.hpp"
 #include <boost/random.hpp>
 #include <cmath>
+#include <ctime>
+#include <new>
+#include <vector>
 
 
-template <typename Generator>
-BoostNormal<Generator>::BoostNormal(const Generator& generator, long N) : 
-					rng(Generator()), vec(ublas::vector<double>(N, 0.0))
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+BoostNormal<Generator, Distribution, Variate>::BoostNormal() : normal(rng, dist), next(0), end(0)
 {
+	allocate();
+}
 
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+BoostNormal<Generator, Distribution, Variate>::BoostNormal(const Generator& generator, long N) : 
+					rng(generator), dist(Distribution()), normal(rng, dist), next(0), end(0), vec(ublas::vector<double>(N, 0.0))
+{
 	rng.seed(static_cast<boost::uint32_t> (std::time(0)));
-	nor = boost::normal_distribution<>(0.0,1.0);
+	allocate();
+}
 
-	myRandom = new boost::variate_generator<Generator&, boost::normal_distribution<> > (rng, nor);
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+BoostNormal<Generator, Distribution, Variate>::BoostNormal(const BoostNormal& other) :
+					rng(other.rng), dist(other.dist), normal(rng, dist), next(0), end(0), vec(other.vec)
+{ // The buffered numbers are not copied: the copy continues from the engine state
+
+	allocate();
 }
-template <typename Generator>
-void BoostNormal<Generator>::getNormalVector()
-{ 
 
-	for(long i=0; i < vec.size();  ++i)
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+BoostNormal<Generator, Distribution, Variate>& BoostNormal<Generator, Distribution, Variate>::operator = (const BoostNormal& other)
+{
+	if (this != &other)
 	{
-		vec[i] = (*myRandom)();
+		rng = other.rng;
+		dist = other.dist;
+		vec = other.vec;
+		next = end = 0;
+		restart();
 	}
-	
+
+	return *this;
+}
+
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+void BoostNormal<Generator, Distribution, Variate>::allocate()
+{ // Room for blockSize doubles from a 64 byte boundary
+
+	storage.resize(blockSize + 64 / sizeof(double));
+	std::size_t misalignment = reinterpret_cast<std::size_t>(&storage[0]) % 64;
+	block = &storage[0] + (misalignment == 0 ? 0 : (64 - misalignment) / sizeof(double));
+}
+
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+void BoostNormal<Generator, Distribution, Variate>::restart()
+{ // Drops any state the old variate generator kept between calls; it cannot be
+  // assigned, as it holds a reference to rng
+
+	normal.~variate_type();
+	new (&normal) variate_type(rng, dist);
 }
 
-template <typename Generator>
-double BoostNormal<Generator>::RN() const
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+void BoostNormal<Generator, Distribution, Variate>::refill() const
 {
-	return (*myRandom)();
+	for (int i = 0; i < blockSize; ++i)
+	{
+		block[i] = normal();
+	}
+
+	next = block;
+	end = block + blockSize;
 }
 
-template <typename Generator>
-BoostNormal<Generator>::~BoostNormal()
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+void BoostNormal<Generator, Distribution, Variate>::fill(double* out, std::size_t n)
 {
-    std::cerr << "Debug: " << myRandom << std::endl;
-	delete myRandom;
+	std::size_t i = 0;
+	for (; i < n && next != end; ++i)
+	{ // Buffered (or replayed) numbers first
+		out[i] = *next++;
+	}
+
+	for (; i < n; ++i)
+	{
+		out[i] = normal();
+	}
+}
+
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+void BoostNormal<Generator, Distribution, Variate>::getNormalVector()
+{ 
+	if (vec.size() > 0)
+	{
+		fill(&vec[0], vec.size());
+	}
+}
+
+template <typename Generator, typename Distribution, template <typename, typename> class Variate>
+void BoostNormal<Generator, Distribution, Variate>::seed(boost::uint32_t s)
+{
+	rng.seed(s);
+	next = end = 0;		// Drop the numbers of the old seed
+	restart();
+}
+
+
+template <typename Real>
+void matchMoments(Real* z, std::size_t rows, std::size_t cols)
+{ // Accumulate all columns in one sweep over the rows, then correct
+
+	if (rows < 2)
+	{
+		return;
+	}
+
+	std::vector<Real> sum(cols, Real(0)), sumSquares(cols, Real(0));
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		const Real* zi = z + i * cols;
+		for (std::size_t j = 0; j < cols; ++j)
+		{
+			sum[j] += zi[j];
+			sumSquares[j] += zi[j] * zi[j];
+		}
+	}
+
+	for (std::size_t j = 0; j < cols; ++j)
+	{
+		Real mean = sum[j] / rows;
+		Real var = (sumSquares[j] - sum[j] * mean) / (rows - 1);
+		sum[j] = mean;
+		sumSquares[j] = var > Real(0) ? Real(1) / std::sqrt(var) : Real(1);	// Scale
+	}
+
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		Real* zi = z + i * cols;
+		for (std::size_t j = 0; j < cols; ++j)
+		{
+			zi[j] = (zi[j] - sum[j]) * sumSquares[j];
+		}
+	}
 }
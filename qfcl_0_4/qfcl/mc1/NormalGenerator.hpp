@@ -16,6 +16,10 @@
 #ifndef NormalGenerator_HPP
 #define NormalGenerator_HPP
 
+#include <cstddef>
+#include <vector>
+
+#include <boost/cstdint.hpp>
 #include <boost/random.hpp>
 
 #include <boost/numeric/ublas/vector.hpp>
@@ -23,27 +27,77 @@
 
 namespace ublas=boost::numeric::ublas;
 
-template <typename Generator>
+// Normal numbers from an engine owned by value. They are generated in blocks
+// of blockSize into a 64 byte aligned buffer, so RN() is an inlined read of
+// the buffer. Distribution is any distribution usable with Variate (e.g.
+// boost::normal_distribution<> with boost::variate_generator, or a QFCL
+// normal such as normal_box_muller_polar<> with qfcl::random::variate_generator).
+template <typename Generator, typename Distribution = boost::normal_distribution<>,
+		  template <typename, typename> class Variate = boost::variate_generator>
 				class BoostNormal
 {
+public:
+	enum { blockSize = 512 };
+
 private:
-	Generator rng;
-	boost::normal_distribution<> nor;
+	mutable Generator rng;
+	Distribution dist;
+
+	// One variate generator on rng, held by value, so that state kept between calls
+	// (e.g. the second normal of a polar Box-Muller pair) is not lost between blocks.
+	// It refers to rng, so it is rebuilt, not copied, by copies, assignment and seed()
+	typedef Variate<Generator&, Distribution> variate_type;
+	mutable variate_type normal;
+
+	// RN() returns *next++ until next == end; normally [next, end) is part of
+	// block, during replay() it is the supplied numbers
+	std::vector<double> storage;
+	double* block;
+	mutable const double* next;
+	mutable const double* end;
+
+	void allocate();
+	void restart();				// A new variate generator on rng
+	void refill() const;		// Generate a new block
 
 public: // for convenience
 
 	ublas::vector<double> vec;
-	boost::variate_generator<Generator&, boost::normal_distribution<> >* myRandom;
 
-public:
-	BoostNormal() {}
-	BoostNormal(const Generator& generator, long N);	// Generate N N(0,1) numbers
+	BoostNormal();
+	BoostNormal(const Generator& generator, long N);	// Generate N N(0,1) numbers; seeded from the clock
+	BoostNormal(const BoostNormal& other);
+	BoostNormal& operator = (const BoostNormal& other);
+
 	void getNormalVector();
-	double RN() const;
 
-	~BoostNormal();
+	// Restart the generator from a fixed seed, for reproducible runs
+	void seed(boost::uint32_t s);
+
+	double RN() const
+	{
+		if (next == end)
+		{
+			refill();
+		}
+
+		return *next++;
+	}
+
+	// out[0], ..., out[n-1]: the numbers RN() would have returned, in bulk
+	void fill(double* out, std::size_t n);
+
+	// The next n calls of RN() return z[0], ..., z[n-1]; z must stay valid until then.
+	// Used to drive several schemes with the same (or aggregated) normals, e.g. in MLMC.
+	// Numbers still in the block are discarded.
+	void replay(const double* z, long n) { next = z; end = z + n; }
 };
 
+// Moment matching: shift and scale each column of the rows x cols matrix z (row major)
+// to sample mean 0 and sample variance 1. Rows are paths, columns are time steps.
+template <typename Real>
+void matchMoments(Real* z, std::size_t rows, std::size_t cols);
+
 
 
 #endif
@@ -11,6 +11,39 @@
 #include <boost/function.hpp>
 #include "Range.cpp"		// 1d interval [a,b] for Time dimension
 
+// Structure an SDE can declare so that the schemes can precompute their
+// coefficients. For a time-homogeneous SDE with
+//
+//	a(X) = mu X					(linearDrift)
+//	b(X) = sigma X^beta			(powerDiffusion)
+//
+// (CEV, and GBM when beta = 1) the per-step factors of the Euler and Milstein
+// schemes are constants and GBM can be stepped exactly in log space. The
+// declaration must agree with drift and diffusion, which other schemes still
+// use. The default declares nothing.
+template <typename RT = double>
+struct SdeStructure
+{
+	bool timeHomogeneous;
+	bool linearDrift;
+	bool powerDiffusion;
+	RT mu, sigma, beta;
+
+	SdeStructure() : timeHomogeneous(false), linearDrift(false), powerDiffusion(false), mu(0), sigma(0), beta(0) {}
+
+	static SdeStructure cev(RT drift, RT volatility, RT exponent = RT(1))
+	{
+		SdeStructure s;
+		s.timeHomogeneous = s.linearDrift = s.powerDiffusion = true;
+		s.mu = drift; s.sigma = volatility; s.beta = exponent;
+
+		return s;
+	}
+
+	bool isCev() const { return timeHomogeneous && linearDrift && powerDiffusion; }
+	bool isGbm() const { return isCev() && beta == RT(1); }
+};
+
 template <typename X = double, typename Time = double, typename RT = double>
 				class Sde
 { 
@@ -28,6 +61,8 @@ public: // For convenience and performance
 	boost::function<RT (X, Time)> diffusion;
 	boost::function<RT (X, Time)> diffusionDerivative;
 
+	SdeStructure<RT> structure;		// Declared by the client; see SdeStructure
+
 	Sde() :	ic(X()), ran(Range<Time>()), 
 			drift(boost::function<RT (X, Time)> ()), driftCorrected(boost::function<RT (X, Time, X)> ()), diffusion(boost::function<RT (X, Time)> ()),
 			diffusionDerivative(boost::function<RT (X, Time)> ())
@@ -37,7 +72,7 @@ public: // For convenience and performance
 
 	Sde(const Sde<X, Time, RT>& sde2) : ic(sde2.ic), ran(sde2.ran),
 										drift(sde2.drift), driftCorrected(sde2.driftCorrected), diffusion(sde2.diffusion),
-										diffusionDerivative(sde2.diffusionDerivative)
+										diffusionDerivative(sde2.diffusionDerivative), structure(sde2.structure)
 	{
 		
 	}
@@ -0,0 +1,104 @@
+// SdeGradient.hpp
+//
+// A one-factor SDE
+//
+//	dX = a(X, t; theta) dt + b(X, t; theta) dW,	X(0) = X0,
+//
+// depending on P parameters theta, together with the partial derivatives
+// needed to differentiate the Euler and Milstein recurrences (see MCGreeks).
+// The theta derivatives fill arrays of P values.
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef SdeGradient_HPP
+#define SdeGradient_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+
+#include "Range.cpp"
+
+template <typename X = double, typename Time = double>
+				class SdeGradient
+{
+public: // For convenience and performance
+
+	X ic;							// Initial condition X0
+	Range<Time> ran;				// Interval where SDE 'lives'
+	std::vector<std::string> names;	// Names of the P parameters
+
+	boost::function<X (X, Time)> drift;					// a
+	boost::function<X (X, Time)> diffusion;				// b
+	boost::function<X (X, Time)> driftX;				// da/dX
+	boost::function<X (X, Time)> diffusionX;			// db/dX
+	boost::function<X (X, Time)> diffusionXX;			// d2b/dX2 (Milstein only)
+	boost::function<void (X, Time, X*)> driftTheta;		// da/dtheta
+	boost::function<void (X, Time, X*)> diffusionTheta;	// db/dtheta
+	boost::function<void (X, Time, X*)> diffusionXTheta;// d2b/dXdtheta (Milstein only)
+
+	SdeGradient() : ic(X()) {}
+
+	std::size_t parameters() const { return names.size(); }
+};
+
+// CEV model dS = (r - d) S dt + vol S^beta dW with parameters (r, d, vol, beta);
+// beta = 1 is geometric Brownian motion.
+namespace SdeGradientDetail
+{
+	struct Cev
+	{
+		double r, d, vol, beta;
+
+		double drift(double S, double) const { return (r - d) * S; }
+		double diffusion(double S, double) const { return vol * std::pow(S, beta); }
+		double driftX(double, double) const { return r - d; }
+		double diffusionX(double S, double) const { return vol * beta * std::pow(S, beta - 1.0); }
+		double diffusionXX(double S, double) const { return vol * beta * (beta - 1.0) * std::pow(S, beta - 2.0); }
+
+		void driftTheta(double S, double, double* out) const
+		{
+			out[0] = S; out[1] = -S; out[2] = 0.0; out[3] = 0.0;
+		}
+
+		void diffusionTheta(double S, double, double* out) const
+		{
+			double Sb = std::pow(S, beta);
+			out[0] = 0.0; out[1] = 0.0; out[2] = Sb; out[3] = vol * Sb * std::log(S);
+		}
+
+		void diffusionXTheta(double S, double, double* out) const
+		{
+			double Sb1 = std::pow(S, beta - 1.0);
+			out[0] = 0.0; out[1] = 0.0; out[2] = beta * Sb1; out[3] = vol * Sb1 * (1.0 + beta * std::log(S));
+		}
+	};
+}
+
+inline SdeGradient<double, double> cevSdeGradient(double S0, double T, double r, double d, double vol, double beta = 1.0)
+{
+	SdeGradientDetail::Cev cev = { r, d, vol, beta };
+
+	SdeGradient<double, double> sde;
+	sde.ic = S0;
+	sde.ran = Range<double>(0.0, T);
+	sde.names.push_back("r"); sde.names.push_back("d"); sde.names.push_back("vol"); sde.names.push_back("beta");
+
+	sde.drift = boost::bind(&SdeGradientDetail::Cev::drift, cev, _1, _2);
+	sde.diffusion = boost::bind(&SdeGradientDetail::Cev::diffusion, cev, _1, _2);
+	sde.driftX = boost::bind(&SdeGradientDetail::Cev::driftX, cev, _1, _2);
+	sde.diffusionX = boost::bind(&SdeGradientDetail::Cev::diffusionX, cev, _1, _2);
+	sde.diffusionXX = boost::bind(&SdeGradientDetail::Cev::diffusionXX, cev, _1, _2);
+	sde.driftTheta = boost::bind(&SdeGradientDetail::Cev::driftTheta, cev, _1, _2, _3);
+	sde.diffusionTheta = boost::bind(&SdeGradientDetail::Cev::diffusionTheta, cev, _1, _2, _3);
+	sde.diffusionXTheta = boost::bind(&SdeGradientDetail::Cev::diffusionXTheta, cev, _1, _2, _3);
+
+	return sde;
+}
+
+#endif
@@ -0,0 +1,205 @@
+// VarianceReduction.cpp
+//
+// Antithetic variates, control variates and moment matching for the
+// FdmVisitor schemes.
+//
+// 2012-10-19 DD kick off: replaces the standalone MCAntitheticVariate program
+// 2012-10-19 DD recorded samples, for MCTypeDMediator
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef VarianceReduction_CPP
+#define VarianceReduction_CPP
+
+#include "VarianceReduction.hpp"
+#include "FDMVisitor.cpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+// ControlVariateStatistics
+
+inline void ControlVariateStatistics::add(double y, double x)
+{
+	++n;
+	sy += y; sx += x;
+	syy += y * y; sxx += x * x; sxy += x * y;
+}
+
+inline double ControlVariateStatistics::varianceY() const
+{
+	return n > 1 ? (syy - sy * sy / n) / (n - 1) : 0.0;
+}
+
+inline double ControlVariateStatistics::varianceX() const
+{
+	return n > 1 ? (sxx - sx * sx / n) / (n - 1) : 0.0;
+}
+
+inline double ControlVariateStatistics::covariance() const
+{
+	return n > 1 ? (sxy - sx * sy / n) / (n - 1) : 0.0;
+}
+
+inline double ControlVariateStatistics::correlation() const
+{
+	double v = varianceX() * varianceY();
+	return v > 0.0 ? covariance() / std::sqrt(v) : 0.0;
+}
+
+inline double ControlVariateStatistics::beta() const
+{
+	double v = varianceX();
+	return v > 0.0 ? covariance() / v : 0.0;
+}
+
+inline double ControlVariateStatistics::adjustedVariance(double b) const
+{
+	return std::max(varianceY() - 2.0 * b * covariance() + b * b * varianceX(), 0.0);
+}
+
+// TerminalControl
+
+template <typename Distribution>
+double TerminalControl<Distribution>::operator () (const double* z, std::size_t n) const
+{
+	double sum = 0.0;
+	for (std::size_t j = 0; j < n; ++j)
+	{
+		sum += z[j];
+	}
+
+	return dist.value(sum / std::sqrt(double(n)));
+}
+
+// MCVarianceReduction
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+MCVarianceReduction<Real, Counter, Generator, Payoff>::MCVarianceReduction(FdmVisitor<Real, Real, Real, Generator>& myFdm,
+							const Payoff& optionPayoff, const Generator& generator, std::size_t batchSize)
+	: fdm(&myFdm), payoff(optionPayoff), rng(generator), anti(false), mm(false), useControl(false), keep(false),
+	  batch(batchSize), paths(0)
+{
+	z.resize(batch * fdm -> N);
+	mz.resize(fdm -> N);
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+void MCVarianceReduction<Real, Counter, Generator, Payoff>::reset()
+{
+	samples = batches = plain = ControlVariateStatistics();
+	paths = 0;
+	ys.clear();
+	xs.clear();
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+void MCVarianceReduction<Real, Counter, Generator, Payoff>::simulate(Counter NSim)
+{
+	const std::size_t n = fdm -> N;
+	const Counter target = paths + NSim;
+
+	boost::variate_generator<Generator&, boost::normal_distribution<> > nor(rng, boost::normal_distribution<>(0.0, 1.0));
+
+	while (paths < target)
+	{
+		// A. The normals of the batch
+		for (std::size_t j = 0; j < z.size(); ++j)
+		{
+			z[j] = nor();
+		}
+		if (mm)
+		{
+			matchMoments(&z[0], batch, n);
+		}
+
+		// B. One sample per normal vector: a single path or an antithetic pair
+		ControlVariateStatistics current;
+		for (std::size_t m = 0; m < batch; ++m)
+		{
+			const Real* zm = &z[m * n];
+
+			fdm -> generator.replay(zm, static_cast<long>(n));
+			Real y = payoff(fdm -> path());
+			Real x = useControl ? ctrl.value(zm, n) : Real(0);
+			plain.add(y);
+
+			if (anti)
+			{
+				for (std::size_t j = 0; j < n; ++j)
+				{
+					mz[j] = -zm[j];
+				}
+
+				fdm -> generator.replay(&mz[0], static_cast<long>(n));
+				Real y2 = payoff(fdm -> path());
+				plain.add(y2);
+
+				y = 0.5 * (y + y2);
+				if (useControl)
+				{
+					x = 0.5 * (x + ctrl.value(&mz[0], n));
+				}
+			}
+
+			samples.add(y, x);
+			current.add(y, x);
+			if (keep)
+			{
+				ys.push_back(y);
+				xs.push_back(x);
+			}
+		}
+
+		// C. Batch means, for the standard error under moment matching
+		batches.add(current.meanY(), current.meanX());
+		paths += anti ? 2 * batch : batch;
+	}
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCVarianceReduction<Real, Counter, Generator, Payoff>::beta() const
+{
+	return useControl ? samples.beta() : Real(0);
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCVarianceReduction<Real, Counter, Generator, Payoff>::price() const
+{
+	return samples.adjustedMean(ctrl.mean, beta());
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCVarianceReduction<Real, Counter, Generator, Payoff>::standardError() const
+{
+	const ControlVariateStatistics& s = mm ? batches : samples;
+
+	return std::sqrt(s.adjustedVariance(beta()) / s.count());
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+template <typename Vector>
+void MCVarianceReduction<Real, Counter, Generator, Payoff>::adjustedSamples(Vector& out) const
+{
+	const Real b = beta();
+
+	out.resize(ys.size());
+	for (std::size_t i = 0; i < ys.size(); ++i)
+	{
+		out[i] = ys[i] - b * (xs[i] - ctrl.mean);
+	}
+}
+
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+Real MCVarianceReduction<Real, Counter, Generator, Payoff>::factor() const
+{
+	Real se = standardError();
+
+	return se > 0.0 ? plain.varianceY() / paths / (se * se) : Real(0);
+}
+
+#endif	// VarianceReduction_CPP
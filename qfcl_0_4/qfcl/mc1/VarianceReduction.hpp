@@ -0,0 +1,150 @@
+// VarianceReduction.hpp
+//
+// Variance reduction for the FdmVisitor schemes: antithetic variates,
+// control variates and moment matching, usable separately or together.
+//
+// MCVarianceReduction draws the normals of a batch of paths itself and feeds
+// them to the scheme through BoostNormal::replay, so the scheme must draw one
+// normal per time step, in order (ExplicitEuler, ExplicitEulerTypeII, Milstein,
+// PredictorCorrector, PredictorCorrectorClassico).
+//
+//	antithetic:		each normal vector z of the batch also gives the path for -z;
+//					a sample is the average of the two payoffs.
+//	moment matching: per time step, the normals of the batch are shifted and
+//					scaled to sample mean 0 and sample variance 1.
+//	control variate: a control X with known mean E[X], computed from the same
+//					normals (e.g. the closed form GBM call behind
+//					gbm_npv_vanilla_call); the estimate is mean(Y - beta (X - E[X]))
+//					with beta = Cov(X, Y) / Var(X) estimated online.
+//
+// MCTypeDMediator prices through it when given one (MCTypeDMediator::varianceReduction);
+// the samples it reports are then recorded here, see record() and adjustedSamples().
+//
+// The variance reduction factor is the variance of a plain estimator with the
+// same number of paths divided by the variance of this estimator. With moment
+// matching the samples of a batch are dependent, so the standard error is then
+// taken from the batch means.
+//
+// (C) Datasim Education BV 2012
+//
+
+#ifndef VarianceReduction_HPP
+#define VarianceReduction_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "FDMVisitor.hpp"
+
+// Online sums of (Y, X) pairs, with the control variate estimate
+class ControlVariateStatistics
+{
+private:
+	long n;
+	double sy, sx, syy, sxx, sxy;
+
+public:
+	ControlVariateStatistics() : n(0), sy(0.0), sx(0.0), syy(0.0), sxx(0.0), sxy(0.0) {}
+
+	void add(double y, double x = 0.0);
+
+	long count() const { return n; }
+	double meanY() const { return sy / n; }
+	double meanX() const { return sx / n; }
+	double varianceY() const;
+	double varianceX() const;
+	double covariance() const;
+	double correlation() const;
+
+	// Cov(X, Y) / Var(X); 0 when X does not vary
+	double beta() const;
+
+	// Mean and sample variance of Y - beta (X - mean), for beta fixed
+	double adjustedMean(double mean, double b) const { return meanY() - b * (meanX() - mean); }
+	double adjustedVariance(double b) const;
+};
+
+// Control on the path normals: value(z, n) is a function of the n normals of a path
+template <typename Real>
+struct PathControl
+{
+	boost::function<Real (const Real* z, std::size_t n)> value;
+	Real mean;
+
+	PathControl() : mean(0) {}
+	PathControl(const boost::function<Real (const Real*, std::size_t)>& f, Real expectation)
+		: value(f), mean(expectation) {}
+};
+
+// Control from a distribution with value(normal) and mean(), applied to the
+// terminal Brownian value: normal = sum z_j / sqrt(n) (equal time steps).
+template <typename Distribution>
+struct TerminalControl
+{
+	Distribution dist;
+
+	TerminalControl(const Distribution& d) : dist(d) {}
+
+	double operator () (const double* z, std::size_t n) const;
+
+	PathControl<double> control() const { return PathControl<double>(*this, dist.mean()); }
+};
+
+// Payoff must be a functor with signature Real (const pathType<Real>&), as for MCTypeDMediator
+template <typename Real, typename Counter, typename Generator, typename Payoff>
+class MCVarianceReduction
+{
+private:
+	FdmVisitor<Real, Real, Real, Generator>* fdm;
+	Payoff payoff;
+	Generator rng;
+
+	bool anti;				// Antithetic pairs
+	bool mm;				// Moment matching per batch
+	bool useControl;
+	bool keep;				// Record the samples
+	PathControl<Real> ctrl;
+	std::size_t batch;		// Normal vectors per batch
+
+	ControlVariateStatistics samples;	// (Y, X) per sample (antithetic pair or single path)
+	ControlVariateStatistics batches;	// (Y, X) batch means
+	ControlVariateStatistics plain;		// Y per path
+	Counter paths;
+
+	std::vector<Real> z, mz;
+	std::vector<Real> ys, xs;	// Recorded (Y, X) per sample
+
+public:
+	MCVarianceReduction(FdmVisitor<Real, Real, Real, Generator>& myFdm, const Payoff& optionPayoff,
+						const Generator& generator, std::size_t batchSize = 256);
+
+	// Switch the techniques on or off; they combine freely
+	void antithetic(bool on) { anti = on; }
+	void momentMatching(bool on) { mm = on; }
+	void control(const PathControl<Real>& c) { ctrl = c; useControl = true; }
+	void noControl() { useControl = false; }
+
+	// Record each sample, for adjustedSamples(); off by default
+	void record(bool on) { keep = on; }
+
+	// Simulate (at least) NSim more paths, in whole batches
+	void simulate(Counter NSim);
+	void reset();
+
+	Real price() const;
+	Real standardError() const;
+	Real beta() const;
+	Counter pathCount() const { return paths; }
+
+	// The recorded samples Y - beta (X - E[X]), whose mean is price(); with moment matching
+	// they are dependent within a batch
+	template <typename Vector>
+	void adjustedSamples(Vector& out) const;
+
+	// Var(plain estimator) / Var(this estimator), for the same number of paths
+	Real factor() const;
+};
+
+#endif
@@ -0,0 +1,415 @@
+/* qfcl/random/block_producer.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_BLOCK_PRODUCER_HPP
+#define QFCL_RANDOM_BLOCK_PRODUCER_HPP
+
+/*! \file qfcl/random/block_producer.hpp
+	\brief a pipeline stage of producer threads filling blocks of variates for consumer threads
+
+	Dedicated producer threads run a \c variate_generator<Engine, Distribution> and fill blocks of
+	variates into the rings of block_ring.hpp, while the consumer threads (e.g. the workers of a
+	Monte Carlo simulation) pop the blocks, use them in place and release them. Generation thus
+	overlaps with consumption instead of being interleaved with it, and producers can be placed on
+	cores of their own (see \c start). Full rings stall the producers.
+
+	All blocks come from one engine seeded by \c seed: block \c b starts at output <tt>b * stride</tt>
+	of its stream, so the blocks are disjoint segments of the stream and their contents depend on
+	nothing but \c b; \c generate recomputes any block. Each producer keeps one engine and moves it
+	from block to block by \c discard, so \c Engine should jump cheaply (e.g. \c mrg32k3a, or the
+	polynomial jumps of \c sfmt and \c dsfmt). Blocks are assigned to consumers either
+	- \c round_robin: consumer \c c receives blocks <tt>c, c + C, c + 2C, ...</tt>, in this order,
+	  through its own SPSC ring, where \c C is the number of consumers. Both the blocks and their
+	  assignment are reproducible, whatever the number of producers and the timing.
+	- \c shared: any consumer receives the next published block, through one MPMC ring, which
+	  balances uneven consumers. The assignment depends on the timing, but each block is tagged
+	  with \c b, so results keyed by \c b are reproducible.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <qfcl/random/block_ring.hpp>
+#include <qfcl/random/variate_generator.hpp>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! \cond
+namespace detail {
+
+//! waiting on a ring: spin for a while, then give up the core each time
+class ring_backoff
+{
+public:
+	ring_backoff() : spins(0) {}
+
+	void pause()
+	{
+		if (++spins > spin_limit)
+			boost::this_thread::yield();
+	}
+	void reset() {spins = 0;}
+private:
+	static const unsigned int spin_limit = 64;
+	unsigned int spins;
+};
+
+}	// namespace detail
+//! \endcond
+
+/*! \brief Producer threads generating blocks of variates for consumer threads
+
+	\tparam Engine a QFCL (or boost) engine constructible from a seed, with \c discard
+	\tparam Distribution a distribution with a \c variate_generator<Engine, Distribution> specialization,
+		using at most \c stride engine outputs for a block
+*/
+template<typename Engine, typename Distribution>
+class block_producer : boost::noncopyable
+{
+public:
+	typedef variate_generator<Engine, Distribution> generator_type;
+	typedef typename generator_type::result_type value_type;
+	typedef ring_block<value_type> block_type;
+
+	//! how the blocks are assigned to the consumers
+	enum assignment {round_robin, shared};
+
+	/*! \param consumers number of consumer threads
+		\param producers number of producer threads; in \c round_robin mode at most \p consumers are used
+		\param block_size number of variates in a block
+		\param blocks total number of blocks to produce; 0 for no limit (until \c stop)
+		\param ring_capacity blocks per ring, a power of 2; the producers are at most this far ahead
+		\param stride engine outputs reserved for a block; 0 for <tt>4 * block_size</tt>
+	*/
+	block_producer(std::size_t consumers, unsigned int producers, std::size_t block_size, boost::uint64_t blocks = 0,
+				   unsigned long seed = 5489u, assignment mode = round_robin, std::size_t ring_capacity = 8,
+				   Distribution dist = Distribution(), boost::uint64_t stride = 0);
+	//! stops the producers
+	~block_producer() {stop();}
+
+	//! start the producer threads, calling <tt>on_start(p)</tt> first in producer \c p, e.g. to pin it to a core
+	/*! E.g. \c qfcl::numa::pin_worker (see qfcl/utility/numa.hpp). The rings are allocated by the
+		constructor, so construct the producer on the node of its consumers.
+	*/
+	void start( std::function<void (unsigned int)> on_start = std::function<void (unsigned int)>() );
+	//! stop and join the producer threads; consumers waiting in \c pop return \c false
+	void stop();
+
+	/*! \name consumers
+		Consumer \p consumer is in <tt>[0, consumers)</tt>, and in \c round_robin mode must be used by one
+		thread at a time.
+		@{
+	*/
+	//! wait for the next block of \p consumer; \c false when there are no more blocks, or after \c stop
+	bool pop(std::size_t consumer, block_type & b);
+	//! the next block of \p consumer if it is ready, without waiting
+	bool try_pop(std::size_t consumer, block_type & b)
+	{
+		return mode_ == round_robin ? queues[consumer].ring -> try_pop(b) : shared_ring -> try_pop(b);
+	}
+	//! give the popped block \p b back to the producers
+	void release(std::size_t consumer, const block_type & b)
+	{
+		if (mode_ == round_robin)
+			queues[consumer].ring -> release(b);
+		else
+			shared_ring -> release(b);
+	}
+	//!	@}
+
+	//! fill \p out with the \c block_size variates of block \p index, as the producers do
+	void generate(boost::uint64_t index, value_type * out) const;
+
+	std::size_t block_size() const {return block_size_;}
+	boost::uint64_t stride() const {return stride_;}
+	std::size_t consumers() const {return consumers_;}
+	unsigned int producers() const {return producers_;}
+private:
+	//! the ring of a consumer in \c round_robin mode, and the blocks it has popped
+	struct consumer_queue
+	{
+		std::unique_ptr< spsc_block_ring<value_type> > ring;
+		boost::uint64_t popped;
+	};
+
+	//! the engine of a producer, and its position in the stream
+	struct positioned_engine
+	{
+		Engine engine;
+		boost::uint64_t pos;
+
+		explicit positioned_engine(unsigned long seed) : engine(seed), pos(0) {}
+	};
+
+	//! the loop of producer \p p
+	void produce(unsigned int p, std::function<void (unsigned int)> on_start);
+	void produce_round_robin(unsigned int p);
+	void produce_shared();
+
+	//! fill \p out with block \p index, moving \p e to the start of the block
+	void generate(positioned_engine & e, boost::uint64_t index, value_type * out) const;
+
+	//! number of blocks of \p consumer in \c round_robin mode
+	boost::uint64_t consumer_blocks(std::size_t consumer) const
+	{
+		return blocks_ > consumer ? (blocks_ - 1 - consumer) / consumers_ + 1 : 0;
+	}
+
+	const std::size_t consumers_;
+	unsigned int producers_;
+	const std::size_t block_size_;
+	//! total number of blocks; unlimited is the largest \c boost::uint64_t
+	const boost::uint64_t blocks_;
+	const boost::uint64_t stride_;
+	const unsigned long seed_;
+	const assignment mode_;
+	const Distribution dist_;
+
+	std::vector<consumer_queue> queues;
+	std::unique_ptr< mpmc_block_ring<value_type> > shared_ring;
+
+	boost::thread_group group;
+	std::atomic<bool> stopping;
+	//! producer threads still running
+	std::atomic<unsigned int> running;
+	//! next block to produce in \c shared mode
+	std::atomic<boost::uint64_t> next_block;
+};
+
+// ctor
+template<typename Engine, typename Distribution>
+block_producer<Engine, Distribution>::block_producer(std::size_t consumers, unsigned int producers, std::size_t block_size,
+													 boost::uint64_t blocks, unsigned long seed, assignment mode,
+													 std::size_t ring_capacity, Distribution dist, boost::uint64_t stride)
+	: consumers_(consumers), producers_(producers), block_size_(block_size),
+	  blocks_( blocks != 0 ? blocks : std::numeric_limits<boost::uint64_t>::max() ),
+	  stride_( stride != 0 ? stride : 4 * static_cast<boost::uint64_t>(block_size) ), seed_(seed), mode_(mode), dist_(dist),
+	  stopping(false), running(0), next_block(0)
+{
+	if (consumers == 0 || producers == 0)
+		throw std::invalid_argument("block_producer: there must be at least one consumer and one producer");
+
+	if (mode_ == round_robin)
+	{
+		producers_ = static_cast<unsigned int>( std::min<std::size_t>(producers_, consumers_) );
+		queues.resize(consumers_);
+		for (std::size_t c = 0; c < consumers_; ++c)
+		{
+			queues[c].ring.reset( new spsc_block_ring<value_type>(ring_capacity, block_size_) );
+			queues[c].popped = 0;
+		}
+	}
+	else
+		shared_ring.reset( new mpmc_block_ring<value_type>(ring_capacity, block_size_) );
+}
+
+// start
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::start(std::function<void (unsigned int)> on_start)
+{
+	running = producers_;
+	for (unsigned int p = 0; p < producers_; ++p)
+		group.create_thread( boost::bind(&block_producer::produce, this, p, on_start) );
+}
+
+// stop
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::stop()
+{
+	stopping = true;
+	group.join_all();
+}
+
+// pop
+template<typename Engine, typename Distribution>
+bool
+block_producer<Engine, Distribution>::pop(std::size_t consumer, block_type & b)
+{
+	detail::ring_backoff backoff;
+
+	if (mode_ == round_robin)
+	{
+		consumer_queue & q = queues[consumer];
+		if ( q.popped == consumer_blocks(consumer) )
+			return false;
+
+		while ( !q.ring -> try_pop(b) )
+		{
+			if (stopping)
+				return false;
+			backoff.pause();
+		}
+
+		++q.popped;
+		return true;
+	}
+
+	while ( !shared_ring -> try_pop(b) )
+	{
+		if (stopping)
+			return false;
+		// all blocks are published once the producers have finished
+		if (running.load() == 0)
+			return shared_ring -> try_pop(b);
+		backoff.pause();
+	}
+
+	return true;
+}
+
+// generate
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::generate(boost::uint64_t index, value_type * out) const
+{
+	positioned_engine e(seed_);
+	generate(e, index, out);
+}
+
+/*! The generator works on a copy of the engine, so \p e stays at the start of the block and the next
+	block is a jump of a known length away. A producer only goes back (to a block of another of its
+	consumers in \c round_robin mode) by reseeding.
+*/
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::generate(positioned_engine & e, boost::uint64_t index, value_type * out) const
+{
+	const boost::uint64_t start = index * stride_;
+	if (start < e.pos)
+	{
+		e.engine = Engine(seed_);
+		e.pos = 0;
+	}
+	e.engine.discard(start - e.pos);
+	e.pos = start;
+
+	generator_type gen(e.engine, dist_);
+	for (std::size_t j = 0; j < block_size_; ++j)
+		out[j] = gen();
+}
+
+// produce
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::produce(unsigned int p, std::function<void (unsigned int)> on_start)
+{
+	if (on_start)
+		on_start(p);
+
+	if (mode_ == round_robin)
+		produce_round_robin(p);
+	else
+		produce_shared();
+
+	--running;
+}
+
+// produce_round_robin
+/*! Producer \p p serves the consumers <tt>p, p + P, p + 2P, ...</tt>, so each ring has one producer.
+*/
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::produce_round_robin(unsigned int p)
+{
+	// the consumers served, and the number of blocks produced for each
+	std::vector<std::size_t> served;
+	for (std::size_t c = p; c < consumers_; c += producers_)
+		served.push_back(c);
+	std::vector<boost::uint64_t> produced(served.size(), 0);
+
+	positioned_engine e(seed_);
+	detail::ring_backoff backoff;
+	while (!stopping)
+	{
+		bool unfinished = false, progress = false;
+
+		for (std::size_t j = 0; j < served.size(); ++j)
+		{
+			const std::size_t c = served[j];
+			if ( produced[j] == consumer_blocks(c) )
+				continue;
+			unfinished = true;
+
+			block_type b;
+			if ( !queues[c].ring -> try_acquire(b) )
+				continue;
+
+			b.tag = c + produced[j] * consumers_;
+			generate(e, b.tag, b.data);
+			queues[c].ring -> publish(b);
+			++produced[j];
+			progress = true;
+		}
+
+		if (!unfinished)
+			return;
+		if (progress)
+			backoff.reset();
+		else
+			backoff.pause();
+	}
+}
+
+// produce_shared
+template<typename Engine, typename Distribution>
+void
+block_producer<Engine, Distribution>::produce_shared()
+{
+	positioned_engine e(seed_);
+	detail::ring_backoff backoff;
+	while (!stopping)
+	{
+		const boost::uint64_t index = next_block++;
+		if (index >= blocks_)
+			return;
+
+		block_type b;
+		while ( !shared_ring -> try_acquire(b) )
+		{
+			if (stopping)
+				return;
+			backoff.pause();
+		}
+		backoff.reset();
+
+		b.tag = index;
+		generate(e, index, b.data);
+		shared_ring -> publish(b);
+	}
+}
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_BLOCK_PRODUCER_HPP
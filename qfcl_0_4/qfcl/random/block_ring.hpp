@@ -0,0 +1,331 @@
+/* qfcl/random/block_ring.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_BLOCK_RING_HPP
+#define QFCL_RANDOM_BLOCK_RING_HPP
+
+/*! \file qfcl/random/block_ring.hpp
+	\brief lock-free rings of fixed size blocks, filled and read in place
+
+	A ring owns \c capacity blocks of \c block_size elements each, in one allocation, every block
+	starting on a cache line. A producer acquires a free block, fills it in place and publishes it with
+	a tag (e.g. the block index); a consumer pops the oldest published block, reads it in place and
+	releases it. Nothing is copied, and a full ring refuses blocks, which is the backpressure on the
+	producers.
+	- \c spsc_block_ring: one producer and one consumer thread; two atomic counters on separate cache lines.
+	- \c mpmc_block_ring: any number of producer and consumer threads; a bounded queue with a sequence
+	  number per block (D. Vyukov's algorithm), so that a block is handed to exactly one consumer.
+
+	The operations never block: they return \c false when the ring is full (or empty), and the caller
+	decides how to wait (see \c block_producer).
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! a block of a ring, held by a producer between acquire and publish, or by a consumer between pop and release
+template<typename T>
+struct ring_block
+{
+	//! the \c block_size elements, 64 byte aligned
+	T * data;
+	//! set by the producer before publishing, e.g. the index of the block in the stream
+	boost::uint64_t tag;
+	//! position in the ring
+	std::size_t pos;
+
+	ring_block() : data(0), tag(0), pos(0) {}
+};
+
+//! \cond
+namespace detail {
+
+//! the storage of a ring: \p capacity blocks, each starting on a cache line
+/*! The blocks are aligned by hand within an over-sized vector, as Boost.Align is newer than the
+	oldest Boost we support.
+*/
+template<typename T>
+class block_storage : boost::noncopyable
+{
+public:
+	static const std::size_t cache_line = 64;
+
+	block_storage(std::size_t capacity, std::size_t block_size)
+		: size(block_size), stride( (block_size * sizeof(T) + cache_line - 1) / cache_line * cache_line / sizeof(T) ),
+		  mask(capacity - 1)
+	{
+		if ( capacity == 0 || (capacity & (capacity - 1)) != 0 )
+			throw std::invalid_argument("block ring: the capacity must be a power of 2");
+		if (block_size == 0 || cache_line % sizeof(T) != 0)
+			throw std::invalid_argument("block ring: invalid block size or element type");
+
+		// room for the blocks from the first cache line boundary
+		elements.resize(capacity * stride + cache_line / sizeof(T));
+		const std::size_t misalignment = reinterpret_cast<std::size_t>(&elements[0]) % cache_line;
+		first = &elements[0] + (misalignment == 0 ? 0 : (cache_line - misalignment) / sizeof(T));
+	}
+
+	T * block(std::size_t pos) {return first + (pos & mask) * stride;}
+
+	//! elements per block
+	const std::size_t size;
+	//! elements from the start of one block to the next
+	const std::size_t stride;
+	const std::size_t mask;
+private:
+	std::vector<T> elements;
+	//! the first block, on a cache line boundary
+	T * first;
+};
+
+}	// namespace detail
+//! \endcond
+
+//! ring of blocks for one producer and one consumer thread
+template<typename T>
+class spsc_block_ring : boost::noncopyable
+{
+public:
+	typedef ring_block<T> block_type;
+
+	//! \p capacity blocks of \p block_size elements; \p capacity must be a power of 2
+	spsc_block_ring(std::size_t capacity, std::size_t block_size)
+		: storage(capacity, block_size), tags(capacity), head(0), tail(0), tail_seen(0) {}
+
+	std::size_t capacity() const {return storage.mask + 1;}
+	std::size_t block_size() const {return storage.size;}
+
+	/*! \name producer
+		@{
+	*/
+	//! a free block to fill, unless the ring is full
+	bool try_acquire(block_type & b);
+	//! hand the acquired block \p b to the consumer
+	void publish(const block_type & b) {tags[b.pos & storage.mask] = b.tag; head.store(b.pos + 1, std::memory_order_release);}
+	//!	@}
+
+	/*! \name consumer
+		@{
+	*/
+	//! the oldest published block, unless the ring is empty
+	bool try_pop(block_type & b);
+	//! return the popped block \p b to the producer
+	void release(const block_type & b) {tail.store(b.pos + 1, std::memory_order_release);}
+	//!	@}
+private:
+	detail::block_storage<T> storage;
+	std::vector<boost::uint64_t> tags;
+
+	// the padding keeps the counters of the two threads on separate cache lines
+	char padding0[detail::block_storage<T>::cache_line];
+	//! blocks published, written by the producer
+	std::atomic<std::size_t> head;
+	char padding1[detail::block_storage<T>::cache_line];
+	//! blocks released, written by the consumer
+	std::atomic<std::size_t> tail;
+	char padding2[detail::block_storage<T>::cache_line];
+	//! the producer's last reading of \c tail
+	std::size_t tail_seen;
+};
+
+// try_acquire
+template<typename T>
+inline bool
+spsc_block_ring<T>::try_acquire(block_type & b)
+{
+	const std::size_t h = head.load(std::memory_order_relaxed);
+
+	if (h - tail_seen > storage.mask)
+	{
+		tail_seen = tail.load(std::memory_order_acquire);
+		if (h - tail_seen > storage.mask)
+			return false;
+	}
+
+	b.data = storage.block(h);
+	b.pos = h;
+	return true;
+}
+
+// try_pop
+template<typename T>
+inline bool
+spsc_block_ring<T>::try_pop(block_type & b)
+{
+	const std::size_t t = tail.load(std::memory_order_relaxed);
+
+	if ( t == head.load(std::memory_order_acquire) )
+		return false;
+
+	b.data = storage.block(t);
+	b.tag = tags[t & storage.mask];
+	b.pos = t;
+	return true;
+}
+
+//! ring of blocks for any number of producer and consumer threads
+/*! Blocks are handed out in the order they were acquired by the producers. A block held by a slow
+	consumer holds up the producers when they come around to it again, as in any bounded FIFO queue.
+*/
+template<typename T>
+class mpmc_block_ring : boost::noncopyable
+{
+public:
+	typedef ring_block<T> block_type;
+
+	//! \p capacity blocks of \p block_size elements; \p capacity must be a power of 2
+	mpmc_block_ring(std::size_t capacity, std::size_t block_size);
+
+	std::size_t capacity() const {return storage.mask + 1;}
+	std::size_t block_size() const {return storage.size;}
+
+	/*! \name producers
+		@{
+	*/
+	//! a free block to fill, unless the ring is full
+	bool try_acquire(block_type & b);
+	//! hand the acquired block \p b to the consumers
+	void publish(const block_type & b);
+	//!	@}
+
+	/*! \name consumers
+		@{
+	*/
+	//! the oldest published block, unless the ring is empty
+	bool try_pop(block_type & b);
+	//! return the popped block \p b to the producers
+	void release(const block_type & b);
+	//!	@}
+private:
+	struct cell
+	{
+		//! \c pos when free for the producer of position \c pos, <tt>pos + 1</tt> when published
+		std::atomic<std::size_t> sequence;
+		boost::uint64_t tag;
+	};
+
+	detail::block_storage<T> storage;
+	std::vector<cell> cells;
+
+	char padding0[detail::block_storage<T>::cache_line];
+	std::atomic<std::size_t> enqueue_pos;
+	char padding1[detail::block_storage<T>::cache_line];
+	std::atomic<std::size_t> dequeue_pos;
+	char padding2[detail::block_storage<T>::cache_line];
+};
+
+// ctor
+template<typename T>
+mpmc_block_ring<T>::mpmc_block_ring(std::size_t capacity, std::size_t block_size)
+	: storage(capacity, block_size), cells(capacity), enqueue_pos(0), dequeue_pos(0)
+{
+	for (std::size_t k = 0; k < capacity; ++k)
+		cells[k].sequence.store(k, std::memory_order_relaxed);
+}
+
+// try_acquire
+template<typename T>
+bool
+mpmc_block_ring<T>::try_acquire(block_type & b)
+{
+	std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		const std::size_t seq = cells[pos & storage.mask].sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - pos);
+
+		if (dif == 0)
+		{
+			if ( enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				break;
+		}
+		else if (dif < 0)
+			// the block is still held from the previous time around
+			return false;
+		else
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+	}
+
+	b.data = storage.block(pos);
+	b.pos = pos;
+	return true;
+}
+
+// publish
+template<typename T>
+inline void
+mpmc_block_ring<T>::publish(const block_type & b)
+{
+	cell & c = cells[b.pos & storage.mask];
+	c.tag = b.tag;
+	c.sequence.store(b.pos + 1, std::memory_order_release);
+}
+
+// try_pop
+template<typename T>
+bool
+mpmc_block_ring<T>::try_pop(block_type & b)
+{
+	std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		const std::size_t seq = cells[pos & storage.mask].sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>( seq - (pos + 1) );
+
+		if (dif == 0)
+		{
+			if ( dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				break;
+		}
+		else if (dif < 0)
+			// not yet published
+			return false;
+		else
+			pos = dequeue_pos.load(std::memory_order_relaxed);
+	}
+
+	b.data = storage.block(pos);
+	b.tag = cells[pos & storage.mask].tag;
+	b.pos = pos;
+	return true;
+}
+
+// release
+template<typename T>
+inline void
+mpmc_block_ring<T>::release(const block_type & b)
+{
+	cells[b.pos & storage.mask].sequence.store(b.pos + storage.mask + 1, std::memory_order_release);
+}
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_BLOCK_RING_HPP
@@ -0,0 +1,372 @@
+/* qfcl/random/distribution/coordinate_addressed.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_DISTRIBUTION_COORDINATE_ADDRESSED_HPP
+#define QFCL_RANDOM_DISTRIBUTION_COORDINATE_ADDRESSED_HPP
+
+/*! \file qfcl/random/distribution/coordinate_addressed.hpp
+	\brief uniform and normal variates addressed by simulation coordinates, without any generator state
+
+	The variate of the coordinates (path, step, dim) of a Monte Carlo simulation is a function of the key
+	and the coordinates only: the output of a counter-based pseudo-random function (\c boost::random::philox,
+	\c threefry or \c ars) at the counter (step, dim / 2, path), turned into two uniforms in (0, 1) and then
+	two normals, for the dimensions \c 2q and <tt>2q + 1</tt>. Hence
+	- any variate, or any path, is regenerated on its own in O(1), e.g. to debug a single path or to
+	  replay paths for common random numbers when bumping greeks,
+	- work is split among threads or machines by coordinate ranges, with no streams, seeding or
+	  \c discard, and the results do not depend on the split.
+
+	The counter is 128 bits, written as the 32 bit words <tt>(step, dim / 2, low, high word of path)</tt>
+	into the words of the PRF's domain, and the two uniforms take the first 128 bits of its range; so any
+	of these PRFs with at least 128 bit counters (e.g. \c philox<4, uint32_t>, \c philox<2, uint64_t>,
+	\c threefry<4, uint64_t> or \c ars<uint32_t>) may be used.
+
+	The batched \c normal_at fills a box of coordinates, evaluating the PRF on \c coordinate_lanes
+	counters at a time and the transform on the resulting lanes of uniforms. For \c philox<4, uint32_t>
+	the lanes go through each round together, as arrays of words that the compiler vectorizes (e.g. the
+	32 x 32 bit products by \c pmuludq, or \c vpmuludq with AVX2); the other PRFs are evaluated a lane at a time.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/cstdint.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/static_assert.hpp>
+
+#include <qfcl/random/distribution/normal_inversion.hpp>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! the key of the variates: a PRF keyed from a 64 bit seed
+/*! \tparam Prf	a counter-based PRF from \c boost/random, with 32 or 64 bit words, a domain and range of at
+				least 128 bits and a key of at least 64 bits
+*/
+template<typename Prf = boost::random::philox<4, boost::uint32_t> >
+class coordinate_key
+{
+	typedef typename Prf::key_type::value_type word_type;
+	static const std::size_t word_bits = std::numeric_limits<word_type>::digits;
+	BOOST_STATIC_ASSERT( word_bits == 32 || word_bits == 64 );
+	BOOST_STATIC_ASSERT( Prf::domain_type::static_size * word_bits >= 128 );
+	BOOST_STATIC_ASSERT( Prf::range_type::static_size * word_bits >= 128 );
+	BOOST_STATIC_ASSERT( Prf::key_type::static_size * word_bits >= 64 );
+public:
+	typedef Prf prf_type;
+	typedef typename Prf::key_type key_type;
+	typedef typename Prf::domain_type domain_type;
+	typedef typename Prf::range_type range_type;
+
+	//! the key with the low and high 32 bits of \p seed in its first words, and zero elsewhere
+	explicit coordinate_key(boost::uint64_t seed = 0) : prf( seed_key(seed) ) {}
+	//! any key of the PRF
+	explicit coordinate_key(const key_type & k) : prf(k) {}
+
+	key_type key() const {return prf.getkey();}
+
+	//! the random bits of counter \p c
+	range_type operator()(const domain_type & c) const {return prf(c);}
+
+	/*! \name the 32 bit words of the counters and of the random bits
+		Word \c i of an array of 64 bit words is in the low (even \c i) or high (odd \c i) half of element \c i / 2.
+		@{
+	*/
+	template<typename Array>
+	static void set_word(Array & a, std::size_t i, boost::uint32_t w)
+	{
+		a[i * 32 / word_bits] |= static_cast<word_type>(w) << (i * 32 % word_bits);
+	}
+	template<typename Array>
+	static boost::uint32_t get_word(const Array & a, std::size_t i)
+	{
+		return static_cast<boost::uint32_t>( a[i * 32 / word_bits] >> (i * 32 % word_bits) );
+	}
+	//! @}
+private:
+	static key_type seed_key(boost::uint64_t seed)
+	{
+		key_type k;
+		k.assign(0);
+		set_word( k, 0, static_cast<boost::uint32_t>(seed) );
+		set_word( k, 1, static_cast<boost::uint32_t>(seed >> 32) );
+
+		return k;
+	}
+
+	// the PRFs are stateless but their operator() is not const
+	mutable Prf prf;
+};
+
+//! the coordinates <tt>[first, first + size)</tt>
+struct coordinate_range
+{
+	boost::uint64_t first;
+	std::size_t size;
+
+	coordinate_range(boost::uint64_t first_, std::size_t size_) : first(first_), size(size_) {}
+};
+
+//! number of counters evaluated together by the batched \c normal_at
+const std::size_t coordinate_lanes = 8;
+
+//! two standard normals by the Box-Muller transform of two uniforms in (0, 1)
+struct box_muller_transform
+{
+	static void apply(double u1, double u2, double & z0, double & z1)
+	{
+		const double r = std::sqrt( -2.0 * std::log(u1) );
+		const double theta = 2 * 3.14159265358979323846 * u2;
+		z0 = r * std::cos(theta);
+		z1 = r * std::sin(theta);
+	}
+};
+
+//! two standard normals by inverting the normal distribution at two uniforms in (0, 1)
+struct inversion_transform
+{
+	static void apply(double u1, double u2, double & z0, double & z1)
+	{
+		z0 = detail::normal_inv(u1);
+		z1 = detail::normal_inv(u2);
+	}
+};
+
+namespace detail {
+
+//! the uniform in (0, 1) with the 53 high bits of <tt>(hi, lo)</tt>
+inline double coordinate_uniform(boost::uint32_t hi, boost::uint32_t lo)
+{
+	const boost::uint64_t bits = ( static_cast<boost::uint64_t>(hi) << 21 ) | (lo >> 11);
+	return (static_cast<double>(bits) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+//! the counter of the dimensions <tt>2 pair</tt> and <tt>2 pair + 1</tt>
+template<typename Prf>
+typename coordinate_key<Prf>::domain_type coordinate_counter(boost::uint64_t path, boost::uint32_t step, boost::uint32_t pair)
+{
+	typedef coordinate_key<Prf> key_type;
+
+	typename key_type::domain_type c;
+	c.assign(0);
+	key_type::set_word( c, 0, step );
+	key_type::set_word( c, 1, pair );
+	key_type::set_word( c, 2, static_cast<boost::uint32_t>(path) );
+	key_type::set_word( c, 3, static_cast<boost::uint32_t>(path >> 32) );
+
+	return c;
+}
+
+//! the two uniforms of the random bits \p r
+template<typename Prf>
+void coordinate_uniforms(const typename coordinate_key<Prf>::range_type & r, double & u1, double & u2)
+{
+	typedef coordinate_key<Prf> key_type;
+
+	u1 = coordinate_uniform( key_type::get_word(r, 0), key_type::get_word(r, 1) );
+	u2 = coordinate_uniform( key_type::get_word(r, 2), key_type::get_word(r, 3) );
+}
+
+//! the two uniforms of the dimensions <tt>2 pair</tt> and <tt>2 pair + 1</tt>
+template<typename Prf>
+void coordinate_uniforms(const coordinate_key<Prf> & key, boost::uint64_t path, boost::uint32_t step, boost::uint32_t pair,
+						 double & u1, double & u2)
+{
+	coordinate_uniforms<Prf>( key( coordinate_counter<Prf>(path, step, pair) ), u1, u2 );
+}
+
+//! no output for the lane
+const std::size_t coordinate_none = static_cast<std::size_t>(-1);
+
+//! the random bits of the \c coordinate_lanes counters \p c, a lane at a time
+template<typename Prf>
+struct coordinate_prf_lanes
+{
+	static void apply(const coordinate_key<Prf> & key, const typename coordinate_key<Prf>::domain_type (&c)[coordinate_lanes],
+					  typename coordinate_key<Prf>::range_type (&r)[coordinate_lanes])
+	{
+		for (std::size_t j = 0; j < coordinate_lanes; ++j)
+			r[j] = key(c[j]);
+	}
+};
+
+//! Philox4x32 on all lanes at once: the rounds of \c boost::random::philox on arrays of words
+template<unsigned R, typename Constants>
+struct coordinate_prf_lanes< boost::random::philox<4, boost::uint32_t, R, Constants> >
+{
+	typedef boost::random::philox<4, boost::uint32_t, R, Constants> prf_type;
+
+	static void apply(const coordinate_key<prf_type> & key, const typename prf_type::domain_type (&c)[coordinate_lanes],
+					  typename prf_type::range_type (&r)[coordinate_lanes])
+	{
+		const std::size_t L = coordinate_lanes;
+		const typename prf_type::key_type k = key.key();
+
+		boost::uint32_t x0[L], x1[L], x2[L], x3[L];
+		for (std::size_t j = 0; j < L; ++j)
+		{
+			x0[j] = c[j][0];
+			x1[j] = c[j][1];
+			x2[j] = c[j][2];
+			x3[j] = c[j][3];
+		}
+
+		boost::uint32_t k0 = k[0], k1 = k[1];
+		for (unsigned int i = 0; i < R; ++i)
+		{
+			for (std::size_t j = 0; j < L; ++j)
+			{
+				const boost::uint64_t p0 = static_cast<boost::uint64_t>(Constants::M0) * x0[j];
+				const boost::uint64_t p1 = static_cast<boost::uint64_t>(Constants::M1) * x2[j];
+				x0[j] = static_cast<boost::uint32_t>(p1 >> 32) ^ x1[j] ^ k0;
+				x1[j] = static_cast<boost::uint32_t>(p1);
+				x2[j] = static_cast<boost::uint32_t>(p0 >> 32) ^ x3[j] ^ k1;
+				x3[j] = static_cast<boost::uint32_t>(p0);
+			}
+			k0 += Constants::W0;
+			k1 += Constants::W1;
+		}
+
+		for (std::size_t j = 0; j < L; ++j)
+		{
+			r[j][0] = x0[j];
+			r[j][1] = x1[j];
+			r[j][2] = x2[j];
+			r[j][3] = x3[j];
+		}
+	}
+};
+
+//! the normals of the \c coordinate_lanes counters \p c, stored to \c out[to0[j]] and \c out[to1[j]] for the first \p n
+template<typename Transform, typename Prf>
+void coordinate_normal_lanes(const coordinate_key<Prf> & key, const typename coordinate_key<Prf>::domain_type (&c)[coordinate_lanes],
+							 const std::size_t (&to0)[coordinate_lanes], const std::size_t (&to1)[coordinate_lanes],
+							 std::size_t n, double * out)
+{
+	const std::size_t L = coordinate_lanes;
+
+	typename coordinate_key<Prf>::range_type r[L];
+	coordinate_prf_lanes<Prf>::apply(key, c, r);
+
+	double u1[L], u2[L], z0[L], z1[L];
+	for (std::size_t j = 0; j < L; ++j)
+		coordinate_uniforms<Prf>(r[j], u1[j], u2[j]);
+	for (std::size_t j = 0; j < L; ++j)
+		Transform::apply(u1[j], u2[j], z0[j], z1[j]);
+
+	for (std::size_t j = 0; j < n; ++j)
+	{
+		if (to0[j] != coordinate_none)
+			out[to0[j]] = z0[j];
+		if (to1[j] != coordinate_none)
+			out[to1[j]] = z1[j];
+	}
+}
+
+}	// namespace detail
+
+//! the uniform in (0, 1) of the coordinates (\p path, \p step, \p dim)
+/*! This is the uniform transformed by \c inversion_transform in \c normal_at.
+*/
+template<typename Prf>
+double uniform_at(const coordinate_key<Prf> & key, boost::uint64_t path, boost::uint32_t step, boost::uint32_t dim)
+{
+	double u1, u2;
+	detail::coordinate_uniforms(key, path, step, dim / 2, u1, u2);
+	return dim % 2 == 0 ? u1 : u2;
+}
+
+//! the standard normal of the coordinates (\p path, \p step, \p dim)
+/*! \tparam Transform	\c box_muller_transform (the default) or \c inversion_transform
+*/
+template<typename Transform = box_muller_transform, typename Prf>
+double normal_at(const coordinate_key<Prf> & key, boost::uint64_t path, boost::uint32_t step, boost::uint32_t dim)
+{
+	double u1, u2, z0, z1;
+	detail::coordinate_uniforms(key, path, step, dim / 2, u1, u2);
+	Transform::apply(u1, u2, z0, z1);
+	return dim % 2 == 0 ? z0 : z1;
+}
+
+//! the standard normals of all coordinates in <tt>paths x steps x dims</tt>
+/*! \c out[(i * steps.size + j) * dims.size + l] is the normal of the coordinates
+	<tt>(paths.first + i, steps.first + j, dims.first + l)</tt>, the same as from the single \c normal_at.
+	Steps and dimensions are 32 bit coordinates, as there.
+	\tparam Transform	\c box_muller_transform (the default) or \c inversion_transform
+	\throw std::out_of_range if the steps or the dimensions go beyond 32 bits
+*/
+template<typename Transform = box_muller_transform, typename Prf>
+void normal_at(const coordinate_key<Prf> & key, coordinate_range paths, coordinate_range steps, coordinate_range dims, double * out)
+{
+	const std::size_t L = coordinate_lanes;
+	const std::size_t none = detail::coordinate_none;
+
+	const boost::uint64_t limit = boost::uint64_t(1) << 32;
+	if (steps.first > limit || steps.size > limit - steps.first || dims.first > limit || dims.size > limit - dims.first)
+		throw std::out_of_range("normal_at: the steps and dimensions are 32 bit coordinates");
+
+	if (dims.size == 0)
+		return;
+
+	// counters of up to L pairs of dimensions, and where their 2 normals go
+	typename coordinate_key<Prf>::domain_type c[L];
+	std::size_t to0[L], to1[L];
+	std::size_t n = 0;
+
+	const boost::uint32_t first_pair = static_cast<boost::uint32_t>(dims.first / 2);
+	const boost::uint32_t last_pair = static_cast<boost::uint32_t>( (dims.first + dims.size - 1) / 2 );
+	std::size_t row = 0;
+	for (std::size_t i = 0; i < paths.size; ++i)
+	{
+		const boost::uint64_t path = paths.first + i;
+		for (std::size_t j = 0; j < steps.size; ++j, row += dims.size)
+		{
+			const boost::uint32_t step = static_cast<boost::uint32_t>(steps.first + j);
+			for (boost::uint64_t q = first_pair; q <= last_pair; ++q)
+			{
+				c[n] = detail::coordinate_counter<Prf>( path, step, static_cast<boost::uint32_t>(q) );
+				const boost::uint64_t d0 = 2 * q, d1 = 2 * q + 1;
+				to0[n] = d0 >= dims.first ? row + static_cast<std::size_t>(d0 - dims.first) : none;
+				to1[n] = d1 < dims.first + dims.size ? row + static_cast<std::size_t>(d1 - dims.first) : none;
+
+				if (++n == L)
+				{
+					detail::coordinate_normal_lanes<Transform>(key, c, to0, to1, n, out);
+					n = 0;
+				}
+			}
+		}
+	}
+
+	if (n > 0)
+	{
+		// the unused lanes are evaluated but not stored
+		for (std::size_t j = n; j < L; ++j)
+			c[j].assign(0);
+		detail::coordinate_normal_lanes<Transform>(key, c, to0, to1, n, out);
+	}
+}
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_DISTRIBUTION_COORDINATE_ADDRESSED_HPP
@@ -7,6 +7,8 @@
 #define QFCL_RANDOM_DISTRIBUTION_GBM_AT_FIXED_TIME
 
 #include <cmath>
+#include <cstddef>
+#include <qfcl/math/simd/exp.hpp>
 #include <qfcl/random/variate_generator.hpp>
 #include <qfcl/random/distribution/normal_inversion.hpp>
 
@@ -29,15 +31,12 @@ private:
     RealType m_drift;
     RealType m_diffusion;
 
-    // generating normal distributed random numbers
-    qfcl::random_normal_distribution<RealType> nd;
-
 public:
     typedef RealType input_type;
     typedef RealType result_type;
     
     // Constructor
-    gbm_at_fixed_time(
+    gbm_at_fixed_time_distribution(
         RealType S0,
         RealType vol,
         RealType yield,
@@ -48,7 +47,7 @@ public:
         m_yield(yield),
         m_t(t)
     {
-        m_drift = (m_yield - m_r - 0.5*m_vol*m_vol)*m_t;
+        m_drift = (m_yield - 0.5*m_vol*m_vol)*m_t;
         m_diffusion = std::sqrt(m_t)*m_vol;
     }
     
@@ -56,12 +55,29 @@ public:
     template<class Engine>
     result_type operator()(Engine& eng) const
     {
-        qfcl::random::normal_inversion<RealType> ND;
-        RealType N = ND(eng);
+        variate_generator<Engine, normal_inversion_distribution<RealType> > NGen( eng, normal_inversion_distribution<RealType>() );
+        RealType N = NGen();
         
         return m_S0 * std::exp( m_drift + m_diffusion*N );
     }
 
+    // Expectation S0 exp(yield t)
+    result_type mean() const
+    {
+        return m_S0 * std::exp( m_yield*m_t );
+    }
+
+    // Fill out[0], ..., out[n-1] with samples, doing the exp over the whole array
+    template<class Engine>
+    void generate(Engine& eng, RealType* out, std::size_t n) const
+    {
+        variate_generator<Engine, normal_inversion_distribution<RealType> > NGen( eng, normal_inversion_distribution<RealType>() );
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = NGen();
+
+        qfcl::math::exp_affine(out, out, n, m_drift, m_diffusion, m_S0);
+    }
+
 };
 
 typedef gbm_at_fixed_time_distribution<double> gbm_at_fixed_time;
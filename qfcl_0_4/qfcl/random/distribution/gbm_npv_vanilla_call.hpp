@@ -6,7 +6,11 @@
 #ifndef QFCL_RANDOM_DISTRIBUTION_GBM_VANILLA_CALL
 #define QFCL_RANDOM_DISTRIBUTION_GBM_VANILLA_CALL
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <qfcl/finance/analytics/black_scholes.hpp>
+#include <qfcl/math/simd/exp.hpp>
 #include <qfcl/random/variate_generator.hpp>
 #include <qfcl/random/distribution/normal_inversion.hpp>
 
@@ -74,6 +78,31 @@ public:
         return std::max( St - m_npv_strike, 0.);
     }
 
+    // The same payoff for a given standard normal N, e.g. when used as a control variate
+    result_type value(RealType N) const
+    {
+        RealType St = m_S0 * std::exp( m_drift + m_diffusion*N );
+        return std::max( St - m_npv_strike, 0.);
+    }
+
+    // Closed form expectation (Black-Scholes with growth rate yield, discounted at r)
+    result_type mean() const
+    {
+        return qfcl::finance::black_scholes_price(qfcl::finance::CALL, m_S0, m_strike, m_r, m_r - m_yield, m_vol, m_t);
+    }
+
+    // Fill out[0], ..., out[n-1] with samples, doing the exp over the whole array
+    template<class Engine>
+    void generate(Engine& eng, RealType* out, std::size_t n) const
+    {
+        variate_generator<Engine, normal_distribution_type> NGen( eng, normal_distribution_type() );
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = NGen();
+
+        qfcl::math::exp_affine(out, out, n, m_drift, m_diffusion, m_S0);
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::max( out[i] - m_npv_strike, RealType(0) );
+    }
 };
 
 typedef gbm_vanilla_call_distribution<double> gbm_vanilla_call;
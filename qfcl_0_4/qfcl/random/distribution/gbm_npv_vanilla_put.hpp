@@ -6,9 +6,13 @@
 #ifndef QFCL_GBM_VANILLA_PUT_DISTRIBUTION
 #define QFCL_GBM_VANILLA_PUT_DISTRIBUTION
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/normal_distribution.hpp>
+#include <qfcl/finance/analytics/black_scholes.hpp>
+#include <qfcl/math/simd/exp.hpp>
 
 
 template<class RealType = double>
@@ -71,6 +75,32 @@ public:
         return std::max( m_npv_strike - St, 0.);
     }
 
+    // The same payoff for a given standard normal N
+    result_type value(RealType N) const
+    {
+        RealType St = m_S0 * std::exp( m_drift + m_diffusion*N );
+        return std::max( m_npv_strike - St, 0.);
+    }
+
+    // Closed form expectation (Black-Scholes with growth rate yield, discounted at r)
+    result_type mean() const
+    {
+        return qfcl::finance::black_scholes_price(qfcl::finance::PUT, m_S0, m_strike, m_r, m_r - m_yield, m_vol, m_t);
+    }
+
+    // Fill out[0], ..., out[n-1] with samples, doing the exp over the whole array
+    template<class Engine>
+    void generate(Engine& eng, RealType* out, std::size_t n) const
+    {
+        boost::normal_distribution<RealType> ND;
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = ND(eng);
+
+        qfcl::math::exp_affine(out, out, n, m_drift, m_diffusion, m_S0);
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::max( m_npv_strike - out[i], RealType(0) );
+    }
+
 };
 
 
@@ -9,13 +9,14 @@
 #include <qfcl/random/distribution/uniform_0ex_1ex.hpp>
 #include <qfcl/random/variate_generator.hpp>
 #include <cmath>
+#include <limits>
 
 namespace qfcl {
 namespace random {
 
 namespace detail {
 
-    double normal_inv(double p)
+    inline double normal_inv(double p)
     {
         const double A1 = -3.969683028665376e+01;
         const double A2 =  2.209460984245205e+02;
@@ -45,7 +46,8 @@ namespace detail {
         const double P_LOW =    0.02425;
         const double P_HIGH =   0.97575; // P_high = 1 - p_low;
     
-        double x;
+        // the limits of the inverse for p outside (0, 1)
+        double x = p <= 0.0 ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
         double q, r;
     
         if ((0.0 < p )  && (p < P_LOW)) {
@@ -118,8 +120,8 @@ private:
     typedef variate_generator< engine_type, uniform_distribution_type > uniform_rng_type;
 
 private:
-    typename engine_type         _eng;
-    typename distribution_type   _dist;
+    engine_type         _eng;
+    distribution_type   _dist;
     
     uniform_distribution_type _uniform_distribution;
     uniform_rng_type     _uniform_rng;
@@ -152,8 +154,8 @@ private:
     typedef variate_generator< engine_type, uniform_distribution_type > uniform_rng_type;
 
 private:
-    typename engine_type         _eng;
-    typename distribution_type   _dist;
+    engine_type         _eng;
+    distribution_type   _dist;
     
     uniform_distribution_type _uniform_distribution;
     uniform_rng_type     _uniform_rng;
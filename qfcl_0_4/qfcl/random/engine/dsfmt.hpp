@@ -0,0 +1,642 @@
+/* qfcl/random/engine/dsfmt.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_DSFMT_HPP
+#define QFCL_RANDOM_DSFMT_HPP
+
+/*! \file qfcl/random/engine/dsfmt.hpp
+	\brief The double precision SIMD-oriented Fast Mersenne Twister of Saito and Matsumoto
+
+	M. Saito and M. Matsumoto, "A PRNG specialized in double precision floating point numbers using an
+	affine transition", Monte Carlo and Quasi-Monte Carlo Methods 2008, Springer, 2009.
+
+	The state is an array of \f$n\f$ 128 bit words, each holding two doubles in [1, 2), together with
+	an extra word \f$u\f$ (the "lung"):
+	\f[ u \leftarrow (w_i \ll_{64} sl_1) \oplus \sigma(u) \oplus w_{i+pos_1}, \qquad
+		w_{i+n} = w_i \oplus (u \gg_{64} 12) \oplus (u \,\&\, msk), \f]
+	where \f$\sigma\f$ swaps the 32 bit halves of each 64 bit part. The recursion never changes the sign
+	and exponent bits, so the outputs are doubles in [1, 2) with random 52 bit mantissas, without any
+	conversion from integers. Blocks are generated with SSE2 when available (unless
+	\c QFCL_MATH_NO_INTRINSICS is defined), and \c fill generates directly into the caller's array.
+
+	The \c uniform_0in_1ex, \c uniform_0ex_1in, \c uniform_0ex_1ex and \c uniform_0in_1in distributions
+	are specialized to shift these doubles into [0, 1), (0, 1], (0, 1) and [0, 1] respectively.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/mpl/string.hpp>
+
+#include <NTL/GF2X.h>
+#include <NTL/ZZ.h>
+
+#include <qfcl/random/distribution/uniform_0ex_1ex.hpp>
+#include <qfcl/random/distribution/uniform_0ex_1in.hpp>
+#include <qfcl/random/distribution/uniform_0in_1ex.hpp>
+#include <qfcl/random/distribution/uniform_0in_1in.hpp>
+#include <qfcl/utility/tmp.hpp>
+
+#include "polynomial_jump.hpp"
+#include "sfmt.hpp"
+
+#if !defined(QFCL_MATH_NO_INTRINSICS) && (defined(__SSE2__) || defined(_M_X64))
+#define QFCL_RANDOM_SSE2_DSFMT
+#include <emmintrin.h>
+#endif
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! dSFMT parameters
+/*! \tparam mexp	Mersenne exponent of the period \f$2^{mexp} - 1\f$
+	\tparam pos1	the middle word \f$w_{i+pos_1}\f$
+	\tparam sl1		shift of 64 bit parts
+	\tparam msk1, msk2	mask of the lung, low 64 bits first
+	\tparam fix1, fix2, pcv1, pcv2	period certification
+*/
+template<std::size_t mexp, std::size_t pos1, int sl1, boost::uint64_t msk1, boost::uint64_t msk2,
+		 boost::uint64_t fix1, boost::uint64_t fix2, boost::uint64_t pcv1, boost::uint64_t pcv2, typename Name>
+struct dsfmt_traits
+{
+	static const std::size_t	exponent = mexp;
+	//! number of 128 bit words, not counting the lung
+	static const std::size_t	n = (mexp - 128) / 104 + 1;
+	static const std::size_t	middle = pos1;
+	static const int			shift_left_1 = sl1;
+	static const int			shift_right = 12;
+	static const boost::uint64_t	mask1 = msk1, mask2 = msk2;
+	static const boost::uint64_t	fix_1 = fix1, fix_2 = fix2, pcv_1 = pcv1, pcv_2 = pcv2;
+
+	static const boost::uint32_t	default_seed = 5489u;
+
+	//! engine name
+	typedef Name name;
+};
+
+namespace detail {
+
+//! the mantissa bits of a double
+const boost::uint64_t dsfmt_low_mask = UINT64_C(0x000FFFFFFFFFFFFF);
+//! the sign and exponent bits of the doubles in [1, 2)
+const boost::uint64_t dsfmt_high_const = UINT64_C(0x3FF0000000000000);
+
+#ifdef QFCL_RANDOM_SSE2_DSFMT
+typedef __m128i dsfmt_word;
+
+template<typename T>
+inline dsfmt_word dsfmt_load(const T * p) {return _mm_loadu_si128( reinterpret_cast<const __m128i *>(p) );}
+template<typename T>
+inline void dsfmt_store(T * p, dsfmt_word w) {_mm_storeu_si128(reinterpret_cast<__m128i *>(p), w);}
+#else
+//! a 128 bit word, low 64 bits first
+struct dsfmt_word {boost::uint64_t u[2];};
+
+//! from two 64 bit integers or doubles
+template<typename T>
+inline dsfmt_word dsfmt_load(const T * p) {dsfmt_word w; std::memcpy(w.u, p, sizeof(w.u)); return w;}
+template<typename T>
+inline void dsfmt_store(T * p, const dsfmt_word & w) {std::memcpy(p, w.u, sizeof(w.u));}
+#endif
+
+//! the double in [0, 1) with the mantissa of \p d in [1, 2)
+inline double dsfmt_close_open(double d) {return d - 1.0;}
+//! the double in (0, 1] with the mantissa of \p d in [1, 2)
+inline double dsfmt_open_close(double d) {return 2.0 - d;}
+//! the double in (0, 1) with the mantissa of \p d in [1, 2), with its lowest bit set
+inline double dsfmt_open_open(double d)
+{
+	boost::uint64_t u;
+	std::memcpy(&u, &d, sizeof(u));
+	u |= 1;
+	std::memcpy(&d, &u, sizeof(d));
+	return d - 1.0;
+}
+
+}	// namespace detail
+
+//! double precision SIMD-oriented Fast Mersenne Twister, generating doubles in [1, 2)
+/*! The sequence, seeding and jump polynomials are those of the reference implementation, dSFMT 2.2:
+	the \c seed(boost::uint32_t) and \c seed(It, It) are its \c init_gen_rand and \c init_by_array, and
+	\c operator() is \c genrand_close1_open2.
+
+	The state is the last block of \c n words generated and the lung; the first \c idx doubles of the
+	block have been output. A jump of \f$J\f$ words advances the output by \f$2J\f$.
+*/
+template<typename Traits>
+class dsfmt_engine
+{
+public:
+	typedef double result_type;
+	typedef typename Traits::name name;
+	typedef Traits traits_type;
+
+	//! number of 128 bit words, and of doubles, in a block
+	static const std::size_t n = Traits::n;
+	static const std::size_t n64 = 2 * n;
+	//! number of bits of the state, including the lung
+	static const std::size_t state_bits = 128 * (n + 1);
+	//! \c discard jumps by a polynomial beyond this many outputs, and otherwise generates them
+	static const unsigned long long discard_threshold = 1ULL << 25;
+
+	//! ctor
+	/*! \sa seed(boost::uint32_t)
+	*/
+	explicit dsfmt_engine(boost::uint32_t seed_ = Traits::default_seed) {seed(seed_);}
+	//! constructor taking an arbitrarily long sequence of seeds
+	template<typename It>
+	dsfmt_engine(It begin, It end) {seed(begin, end);}
+
+	//! the outputs are in <tt>[min(), max())</tt>
+	static result_type min() {return 1.0;}
+	static result_type max() {return 2.0;}
+
+	//! \c init_gen_rand of the reference implementation
+	void seed(boost::uint32_t seed_ = Traits::default_seed);
+	//! \c init_by_array of the reference implementation
+	template<typename It>
+	void seed(It begin, It end);
+
+	//! generate a random number in [1, 2)
+	result_type operator()()
+	{
+		if (idx >= n64)
+		{
+			gen_rand_all();
+			idx = 0;
+		}
+		double d;
+		std::memcpy(&d, x + idx++, sizeof(d));
+		return d;
+	}
+
+	//! fills <tt>[first, last)</tt> with the next random numbers
+	template<typename OutIt>
+	void generate(OutIt first, OutIt last);
+
+	//! writes the next \p size random numbers, in [1, 2), to \p array
+	/*! The same numbers, and state, as \p size calls of \c operator(), but whole blocks are generated
+		directly in \p array, which need not be aligned.
+	*/
+	void fill(double * array, std::size_t size);
+	//! \c fill, shifted to [0, 1)
+	void fill_close_open(double * array, std::size_t size);
+	//! \c fill, shifted to (0, 1]
+	void fill_open_close(double * array, std::size_t size);
+	//! \c fill, with the lowest mantissa bit set and shifted to (0, 1)
+	void fill_open_open(double * array, std::size_t size);
+
+	//! skips \p z numbers
+	/*! Beyond \c discard_threshold, by a polynomial jump of whole blocks. The state is then the same as
+		after generating \p z numbers.
+	*/
+	void discard(unsigned long long z);
+
+	//! advances the state by the polynomial \p jump_string, in the format of dSFMT-jump
+	/*! For the string of <tt>jump_string(J)</tt>, or one published with the reference implementation
+		for a jump of \f$J\f$ words, this skips \f$2J\f$ numbers. Unless \f$J\f$ is a multiple of \c n,
+		the block is then not aligned with that of the engine that generated the numbers, so they
+		compare unequal although they generate the same sequence.
+		\throw std::invalid_argument if \p jump_string has a character that is not a hexadecimal digit
+	*/
+	void jump(const char * jump_string)
+	{
+		NTL::GF2X q;
+		detail::from_jump_string(q, jump_string);
+		jump_by(q);
+	}
+	//! the jump polynomial of \p J 128 bit words
+	static std::string jump_string(const NTL::ZZ & J)
+	{
+		NTL::GF2X q;
+		detail::jump_polynomial( q, J, minimal_polynomial() );
+		return detail::to_jump_string(q);
+	}
+
+	//! the minimal polynomial of the recursion on the seeded states, computed on first use
+	static const NTL::GF2XModulus & minimal_polynomial()
+	{
+		static const detail::minimal_modulus<ring> m( seeded_rings() );
+		return m.phi;
+	}
+
+	friend bool operator==(const dsfmt_engine & e1, const dsfmt_engine & e2)
+	{
+		return e1.idx == e2.idx && std::equal(e1.x, e1.x + n64 + 2, e2.x);
+	}
+	friend bool operator!=(const dsfmt_engine & e1, const dsfmt_engine & e2) {return !(e1 == e2);}
+
+	//! outputs the state: the \c n64 64 bit parts of the block and the 2 of the lung, followed by \c idx
+	template<typename charT, typename Traits_>
+	friend std::basic_ostream<charT, Traits_> &
+	operator<<(std::basic_ostream<charT, Traits_> & os, const dsfmt_engine & eng)
+	{
+		for (std::size_t j = 0; j < n64 + 2; ++j)
+			os << eng.x[j] << ' ';
+		return os << eng.idx;
+	}
+	//! reads the state written by \c operator<<
+	template<typename charT, typename Traits_>
+	friend std::basic_istream<charT, Traits_> &
+	operator>>(std::basic_istream<charT, Traits_> & is, dsfmt_engine & eng)
+	{
+		for (std::size_t j = 0; j < n64 + 2; ++j)
+			is >> eng.x[j] >> std::ws;
+		return is >> eng.idx;
+	}
+private:
+	//! the block, in 64 bit parts, followed by the lung
+	boost::uint64_t x[n64 + 2];
+	//! number of doubles of the block already output
+	std::size_t idx;
+
+	//! the next word, from \f$w_i\f$ and \f$w_{i+pos_1}\f$, updating the lung
+	static detail::dsfmt_word recursion(detail::dsfmt_word a, detail::dsfmt_word b, detail::dsfmt_word & lung);
+
+	//! replaces the block with the next one
+	void gen_rand_all();
+	//! generates \p m \f$\geq n\f$ words in \p array, and makes the last \c n of them the block
+	void gen_rand_array(double * array, std::size_t m);
+	//! sets the sign and exponent bits of the block for [1, 2)
+	void initial_mask();
+	//! makes the period \f$2^{mexp} - 1\f$ by flipping a bit of the lung, if necessary
+	void period_certification();
+
+	void jump_by(const NTL::GF2X & q);
+
+	struct ring;
+	//! the states of a few seeds, to find the minimal polynomial
+	static std::vector<ring> seeded_rings()
+	{
+		std::vector<ring> rs;
+		for (boost::uint32_t s = 1; s <= 16; ++s)
+			rs.push_back( ring( dsfmt_engine(s) ) );
+		return rs;
+	}
+
+	//! the block as a circular buffer starting at word \c start, and the lung, see polynomial_jump.hpp
+	struct ring
+	{
+		static const std::size_t state_bits = dsfmt_engine::state_bits;
+
+		boost::uint64_t x[n64 + 2];
+		std::size_t start;
+
+		explicit ring(const dsfmt_engine & eng) : start(0) {std::copy(eng.x, eng.x + n64 + 2, x);}
+
+		boost::uint64_t * word(std::size_t j) {return x + 2 * ( (start + j) % n );}
+		const boost::uint64_t * word(std::size_t j) const {return x + 2 * ( (start + j) % n );}
+
+		void next()
+		{
+			detail::dsfmt_word lung = detail::dsfmt_load(x + n64);
+			detail::dsfmt_store( word(0), recursion( detail::dsfmt_load( word(0) ), detail::dsfmt_load( word(Traits::middle) ), lung ) );
+			detail::dsfmt_store(x + n64, lung);
+			start = (start + 1) % n;
+		}
+		void add(const ring & r)
+		{
+			for (std::size_t j = 0; j < n; ++j)
+				for (int k = 0; k < 2; ++k)
+					word(j)[k] ^= r.word(j)[k];
+			x[n64] ^= r.x[n64];
+			x[n64 + 1] ^= r.x[n64 + 1];
+		}
+		void clear() {std::fill(x, x + n64 + 2, 0);}
+		bool is_zero() const {return std::count(x, x + n64 + 2, 0u) == static_cast<std::ptrdiff_t>(n64 + 2);}
+		bool bit(std::size_t b) const {return ( ( word(n - 1)[b / 64] >> (b % 64) ) & 1 ) != 0;}
+	};
+};
+
+/* member functions */
+
+// recursion
+template<typename Traits>
+inline detail::dsfmt_word
+dsfmt_engine<Traits>::recursion(detail::dsfmt_word a, detail::dsfmt_word b, detail::dsfmt_word & lung)
+{
+#ifdef QFCL_RANDOM_SSE2_DSFMT
+	const __m128i mask = _mm_set_epi64x( static_cast<long long>(Traits::mask2), static_cast<long long>(Traits::mask1) );
+
+	// 0x1b reverses the 4 32 bit parts, i.e. swaps the 64 bit parts and the halves of each
+	__m128i y = _mm_shuffle_epi32(lung, 0x1b);
+	y = _mm_xor_si128( y, _mm_xor_si128(_mm_slli_epi64(a, Traits::shift_left_1), b) );
+	lung = y;
+	return _mm_xor_si128( a, _mm_xor_si128(_mm_srli_epi64(y, Traits::shift_right), _mm_and_si128(y, mask)) );
+#else
+	const boost::uint64_t L0 = lung.u[0], L1 = lung.u[1];
+	lung.u[0] = (a.u[0] << Traits::shift_left_1) ^ (L1 >> 32) ^ (L1 << 32) ^ b.u[0];
+	lung.u[1] = (a.u[1] << Traits::shift_left_1) ^ (L0 >> 32) ^ (L0 << 32) ^ b.u[1];
+
+	detail::dsfmt_word r;
+	r.u[0] = (lung.u[0] >> Traits::shift_right) ^ (lung.u[0] & Traits::mask1) ^ a.u[0];
+	r.u[1] = (lung.u[1] >> Traits::shift_right) ^ (lung.u[1] & Traits::mask2) ^ a.u[1];
+	return r;
+#endif
+}
+
+// gen_rand_all
+template<typename Traits>
+void dsfmt_engine<Traits>::gen_rand_all()
+{
+	using detail::dsfmt_load;
+	using detail::dsfmt_store;
+	const std::size_t pos1 = Traits::middle;
+
+	detail::dsfmt_word lung = dsfmt_load(x + n64);
+	std::size_t i = 0;
+	for (; i < n - pos1; ++i)
+		dsfmt_store( x + 2 * i, recursion( dsfmt_load(x + 2 * i), dsfmt_load( x + 2 * (i + pos1) ), lung ) );
+	for (; i < n; ++i)
+		dsfmt_store( x + 2 * i, recursion( dsfmt_load(x + 2 * i), dsfmt_load( x + 2 * (i + pos1 - n) ), lung ) );
+	dsfmt_store(x + n64, lung);
+}
+
+// gen_rand_array
+template<typename Traits>
+void dsfmt_engine<Traits>::gen_rand_array(double * array, std::size_t m)
+{
+	using detail::dsfmt_load;
+	using detail::dsfmt_store;
+	const std::size_t pos1 = Traits::middle;
+
+	detail::dsfmt_word lung = dsfmt_load(x + n64);
+	std::size_t i = 0;
+	// the first block from the state
+	for (; i < n - pos1; ++i)
+		dsfmt_store( array + 2 * i, recursion( dsfmt_load(x + 2 * i), dsfmt_load( x + 2 * (i + pos1) ), lung ) );
+	for (; i < n; ++i)
+		dsfmt_store( array + 2 * i, recursion( dsfmt_load(x + 2 * i), dsfmt_load( array + 2 * (i + pos1 - n) ), lung ) );
+	// the rest from the array
+	for (; i < m; ++i)
+		dsfmt_store( array + 2 * i, recursion( dsfmt_load( array + 2 * (i - n) ), dsfmt_load( array + 2 * (i + pos1 - n) ), lung ) );
+
+	std::memcpy( x, array + 2 * (m - n), n64 * sizeof(double) );
+	dsfmt_store(x + n64, lung);
+}
+
+// initial_mask
+template<typename Traits>
+void dsfmt_engine<Traits>::initial_mask()
+{
+	for (std::size_t j = 0; j < n64; ++j)
+		x[j] = (x[j] & detail::dsfmt_low_mask) | detail::dsfmt_high_const;
+}
+
+// period_certification
+template<typename Traits>
+void dsfmt_engine<Traits>::period_certification()
+{
+	const boost::uint64_t pcv[2] = {Traits::pcv_1, Traits::pcv_2};
+	boost::uint64_t inner = ( (x[n64] ^ Traits::fix_1) & pcv[0] ) ^ ( (x[n64 + 1] ^ Traits::fix_2) & pcv[1] );
+	for (int s = 32; s > 0; s >>= 1)
+		inner ^= inner >> s;
+	if (inner & 1)
+		return;
+
+	// flip the lowest bit of the certification vector, high part first
+	for (int k = 1; k >= 0; --k)
+		if (pcv[k] != 0)
+		{
+			x[n64 + k] ^= pcv[k] & (~pcv[k] + 1);
+			return;
+		}
+}
+
+// seed
+template<typename Traits>
+void dsfmt_engine<Traits>::seed(boost::uint32_t seed_)
+{
+	boost::uint32_t y[2 * (n64 + 2)];
+	detail::sfmt_init_gen_rand(y, 2 * (n64 + 2), seed_);
+	for (std::size_t j = 0; j < n64 + 2; ++j)
+		x[j] = y[2 * j] | (static_cast<boost::uint64_t>(y[2 * j + 1]) << 32);
+
+	initial_mask();
+	idx = n64;
+	period_certification();
+}
+
+// seed
+template<typename Traits>
+template<typename It>
+void dsfmt_engine<Traits>::seed(It begin, It end)
+{
+	boost::uint32_t y[2 * (n64 + 2)];
+	detail::sfmt_init_by_array( y, 2 * (n64 + 2), std::vector<boost::uint32_t>(begin, end) );
+	for (std::size_t j = 0; j < n64 + 2; ++j)
+		x[j] = y[2 * j] | (static_cast<boost::uint64_t>(y[2 * j + 1]) << 32);
+
+	initial_mask();
+	idx = n64;
+	period_certification();
+}
+
+// generate
+template<typename Traits>
+template<typename OutIt>
+void dsfmt_engine<Traits>::generate(OutIt first, OutIt last)
+{
+	for (; first != last; ++first)
+		*first = (*this)();
+}
+
+// fill
+template<typename Traits>
+void dsfmt_engine<Traits>::fill(double * array, std::size_t size)
+{
+	// what is left of the block
+	std::size_t j = std::min<std::size_t>( size, idx < n64 ? n64 - idx : 0 );
+	std::memcpy( array, x + idx, j * sizeof(double) );
+	idx += j;
+
+	// whole blocks, directly into the array
+	const std::size_t blocks = (size - j) / n64;
+	if (blocks > 0)
+	{
+		gen_rand_array(array + j, blocks * n);
+		j += blocks * n64;
+		idx = n64;
+	}
+
+	for (; j < size; ++j)
+		array[j] = (*this)();
+}
+
+// fill_close_open
+template<typename Traits>
+void dsfmt_engine<Traits>::fill_close_open(double * array, std::size_t size)
+{
+	fill(array, size);
+	for (std::size_t j = 0; j < size; ++j)
+		array[j] = detail::dsfmt_close_open(array[j]);
+}
+
+// fill_open_close
+template<typename Traits>
+void dsfmt_engine<Traits>::fill_open_close(double * array, std::size_t size)
+{
+	fill(array, size);
+	for (std::size_t j = 0; j < size; ++j)
+		array[j] = detail::dsfmt_open_close(array[j]);
+}
+
+// fill_open_open
+template<typename Traits>
+void dsfmt_engine<Traits>::fill_open_open(double * array, std::size_t size)
+{
+	fill(array, size);
+	for (std::size_t j = 0; j < size; ++j)
+		array[j] = detail::dsfmt_open_open(array[j]);
+}
+
+// discard
+template<typename Traits>
+void dsfmt_engine<Traits>::discard(unsigned long long z)
+{
+	if (z > discard_threshold)
+	{
+		// whole blocks, so that the state is the same as after generating the numbers
+		NTL::GF2X q;
+		detail::jump_polynomial( q, detail::to_ZZ(z / n64 * n), minimal_polynomial() );
+		jump_by(q);
+		z %= n64;
+	}
+
+	while (z > 0)
+	{
+		if (idx >= n64)
+		{
+			gen_rand_all();
+			idx = 0;
+		}
+		const std::size_t j = static_cast<std::size_t>( std::min<unsigned long long>(z, n64 - idx) );
+		idx += j;
+		z -= j;
+	}
+}
+
+// jump_by
+template<typename Traits>
+void dsfmt_engine<Traits>::jump_by(const NTL::GF2X & q)
+{
+	ring r(*this);
+	detail::apply_polynomial(r, q);
+	std::copy(r.x, r.x + n64 + 2, x);
+}
+
+/* uniform distributions on the native doubles */
+
+//! [0, 1): \f$d - 1\f$
+template<class Traits, class RealType>
+class variate_generator<dsfmt_engine<Traits>, uniform_0in_1ex<RealType> >
+{
+public:
+	typedef dsfmt_engine<Traits>		engine_type;
+	typedef uniform_0in_1ex<RealType>	distribution_type;
+	typedef RealType					result_type;
+
+	variate_generator(engine_type e, distribution_type d) : _eng(e), _dist(d) {}
+
+	result_type operator()() {return result_type( detail::dsfmt_close_open( _eng() ) );}
+private:
+	engine_type			_eng;
+	distribution_type	_dist;
+};
+
+//! (0, 1]: \f$2 - d\f$
+template<class Traits, class RealType>
+class variate_generator<dsfmt_engine<Traits>, uniform_0ex_1in<RealType> >
+{
+public:
+	typedef dsfmt_engine<Traits>		engine_type;
+	typedef uniform_0ex_1in<RealType>	distribution_type;
+	typedef RealType					result_type;
+
+	variate_generator(engine_type e, distribution_type d) : _eng(e), _dist(d) {}
+
+	result_type operator()() {return result_type( detail::dsfmt_open_close( _eng() ) );}
+private:
+	engine_type			_eng;
+	distribution_type	_dist;
+};
+
+//! (0, 1): \f$d - 1\f$ with the lowest mantissa bit of \f$d\f$ set, i.e. the midpoints of \c uniform_0in_1ex
+template<class Traits, class RealType>
+class variate_generator<dsfmt_engine<Traits>, uniform_0ex_1ex<RealType> >
+{
+public:
+	typedef dsfmt_engine<Traits>		engine_type;
+	typedef uniform_0ex_1ex<RealType>	distribution_type;
+	typedef RealType					result_type;
+
+	variate_generator(engine_type e, distribution_type d) : _eng(e), _dist(d) {}
+
+	result_type operator()() {return result_type( detail::dsfmt_open_open( _eng() ) );}
+private:
+	engine_type			_eng;
+	distribution_type	_dist;
+};
+
+//! [0, 1]: \f$(d - 1) \cdot 2^{52} / (2^{52} - 1)\f$
+template<class Traits, class RealType>
+class variate_generator<dsfmt_engine<Traits>, uniform_0in_1in<RealType> >
+{
+public:
+	typedef dsfmt_engine<Traits>		engine_type;
+	typedef uniform_0in_1in<RealType>	distribution_type;
+	typedef RealType					result_type;
+
+	variate_generator(engine_type e, distribution_type d) : _eng(e), _dist(d) {}
+
+	result_type operator()() {return result_type( ( _eng() - 1.0 ) * (4503599627370496.0 / 4503599627370495.0) );}
+private:
+	engine_type			_eng;
+	distribution_type	_dist;
+};
+
+/* engine names */
+
+//! \cond
+namespace detail {
+
+typedef boost::mpl::string<'d', 'S', 'F', 'M', 'T'>::type _dsfmt_prefix;
+typedef qfcl::tmp::concatenate< _dsfmt_prefix, boost::mpl::string<'1', '9', '9', '3', '7'>::type >::type dsfmt19937_name;
+
+}	// namespace detail
+//! \endcond
+
+//! dSFMT with period \f$2^{19937} - 1\f$
+typedef dsfmt_engine< dsfmt_traits< 19937, 117, 19,
+									UINT64_C(0x000ffafffffffb3f), UINT64_C(0x000ffdfffc90fffd),
+									UINT64_C(0x90014964b32f4329), UINT64_C(0x3b8d12ac548a7c7a),
+									UINT64_C(0x3d84e1ac0dc82880), UINT64_C(0x0000000000000001),
+									detail::dsfmt19937_name > > dsfmt19937;
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_DSFMT_HPP
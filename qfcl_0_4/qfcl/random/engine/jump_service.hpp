@@ -0,0 +1,279 @@
+/* qfcl/random/engine/jump_service.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_ENGINE_JUMP_SERVICE_HPP
+#define QFCL_RANDOM_ENGINE_JUMP_SERVICE_HPP
+
+/*! \file qfcl/random/engine/jump_service.hpp
+	\brief concurrency-safe cache of jump operators
+
+	A \c jump_service holds immutable, reference-counted operators (e.g. the transition and jump matrices
+	of a \c linear_generator) keyed by jump size and kind. Once an operator has been computed it is never
+	changed or evicted, so
+	- a lookup that hits is lock-free: a probe of an open addressing table of atomic pointers,
+	- a miss is single-flight: the first thread computes the operator outside of any lock, while other
+	  threads asking for the same key wait for it, and threads asking for other keys proceed.
+
+	References returned by \c get stay valid for the lifetime of the service, which therefore only grows.
+	\c linear_generator keeps one service per engine type holding only the transition matrices and the jump
+	matrices of the powers of 2, at most 64 per direction, and makes every jump from those. So \c discard,
+	\c reverse_discard and \c skip on different engines run in parallel, alternating jump sizes do not
+	recompute or reread anything, and the cache stays bounded whatever jump sizes are asked for.
+
+	On a machine with several NUMA nodes, a \c node_jump_service keeps one \c jump_service per node, so
+	that the (large) matrices are read from local memory: a thread missing on its node copies the operator
+	cached on another node, or computes it if there is none.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <qfcl/utility/numa.hpp>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! key of a jump operator
+struct jump_key
+{
+	//! what the operator does
+	enum kind_type {JUMP, REVERSE_JUMP, TRANSITION, REVERSE_TRANSITION};
+
+	unsigned long long size;
+	kind_type kind;
+
+	jump_key(unsigned long long size_, kind_type kind_) : size(size_), kind(kind_) {}
+
+	friend bool operator==(const jump_key & a, const jump_key & b) {return a.size == b.size && a.kind == b.kind;}
+	friend bool operator<(const jump_key & a, const jump_key & b)
+	{
+		return a.size < b.size || (a.size == b.size && a.kind < b.kind);
+	}
+};
+
+//! concurrency-safe cache of immutable operators of type \p Operator, indexed by \c jump_key
+/*! \tparam Capacity number of slots of the lock-free table, a power of 2. Operators beyond that
+		are still cached, but looked up under the lock.
+*/
+template<typename Operator, std::size_t Capacity = 256>
+class jump_service
+{
+	static_assert( (Capacity & (Capacity - 1)) == 0, "jump_service capacity must be a power of 2" );
+public:
+	typedef std::shared_ptr<const Operator> pointer;
+
+	jump_service() : count(0)
+	{
+		for (std::size_t j = 0; j < Capacity; ++j)
+			slots[j].store(0, std::memory_order_relaxed);
+	}
+
+	~jump_service()
+	{
+		for (std::size_t j = 0; j < Capacity; ++j)
+			delete slots[j].load(std::memory_order_relaxed);
+	}
+
+	//! the operator for \p key, calling \p compute (returning an \c Operator) if it is not yet cached
+	template<typename F>
+	pointer get(const jump_key & key, const F & compute)
+	{
+		const entry * e = find(key);
+		if (e)
+			return e -> value;
+
+		std::unique_lock<std::mutex> lock(m);
+		for (;;)
+		{
+			pointer p = find_locked(key);
+			if (p)
+				return p;
+			if (in_flight.count(key) == 0)
+				break;
+			// another thread is computing this operator
+			cv.wait(lock);
+		}
+		in_flight.insert(key);
+		lock.unlock();
+
+		pointer p;
+		try
+		{
+			p = std::make_shared<const Operator>( compute() );
+		}
+		catch (...)
+		{
+			lock.lock();
+			in_flight.erase(key);
+			cv.notify_all();
+			throw;
+		}
+
+		lock.lock();
+		publish(key, p);
+		in_flight.erase(key);
+		cv.notify_all();
+
+		return p;
+	}
+
+	//! the operator for \p key if it is cached, without computing it
+	pointer lookup(const jump_key & key)
+	{
+		const entry * e = find(key);
+		if (e)
+			return e -> value;
+
+		std::lock_guard<std::mutex> lock(m);
+		return find_locked(key);
+	}
+
+	//! number of cached operators
+	std::size_t size() const {return count.load(std::memory_order_acquire);}
+private:
+	//! a published operator; immutable
+	struct entry
+	{
+		entry(const jump_key & key_, const pointer & value_) : key(key_), value(value_) {}
+
+		const jump_key key;
+		const pointer value;
+	};
+
+	static std::size_t hash(const jump_key & key)
+	{
+		unsigned long long h = (key.size * 4 + key.kind) * 0x9E3779B97F4A7C15ull;
+		return static_cast<std::size_t>(h >> 32);
+	}
+
+	//! lock-free lookup in the table
+	const entry * find(const jump_key & key) const
+	{
+		const std::size_t h = hash(key);
+		for (std::size_t probe = 0; probe < Capacity; ++probe)
+		{
+			const entry * e = slots[(h + probe) & (Capacity - 1)].load(std::memory_order_acquire);
+			if (!e)
+				return 0;
+			if (e -> key == key)
+				return e;
+		}
+
+		return 0;
+	}
+
+	//! lookup in the table and the overflow; requires the lock
+	pointer find_locked(const jump_key & key) const
+	{
+		const entry * e = find(key);
+		if (e)
+			return e -> value;
+
+		for (std::size_t j = 0; j < overflow.size(); ++j)
+			if (overflow[j] -> key == key)
+				return overflow[j] -> value;
+
+		return pointer();
+	}
+
+	//! insert into the first free slot; requires the lock (so there is one writer)
+	void publish(const jump_key & key, const pointer & p)
+	{
+		const std::size_t h = hash(key);
+		for (std::size_t probe = 0; probe < Capacity; ++probe)
+		{
+			std::atomic<const entry *> & slot = slots[(h + probe) & (Capacity - 1)];
+			if (!slot.load(std::memory_order_relaxed))
+			{
+				slot.store(new entry(key, p), std::memory_order_release);
+				count.fetch_add(1, std::memory_order_release);
+				return;
+			}
+		}
+
+		overflow.push_back( std::make_shared<const entry>(key, p) );
+		count.fetch_add(1, std::memory_order_release);
+	}
+
+	std::atomic<const entry *> slots[Capacity];
+	std::atomic<std::size_t> count;
+
+	std::mutex m;
+	std::condition_variable cv;
+	//! keys being computed
+	std::set<jump_key> in_flight;
+	//! entries that did not fit in the table
+	std::vector< std::shared_ptr<const entry> > overflow;
+
+	jump_service(const jump_service &);
+	jump_service & operator=(const jump_service &);
+};
+
+//! a \c jump_service per NUMA node, used by the threads running on that node
+template<typename Operator, std::size_t Capacity = 256>
+class node_jump_service
+{
+public:
+	typedef typename jump_service<Operator, Capacity>::pointer pointer;
+
+	node_jump_service() : services( numa::topology::system().nodes() )
+	{
+		for (std::size_t node = 0; node < services.size(); ++node)
+			services[node].reset( new jump_service<Operator, Capacity> );
+	}
+
+	//! the operator for \p key on the node of the calling thread; a copy of the one of another node, if cached
+	template<typename F>
+	pointer get(const jump_key & key, const F & compute)
+	{
+		if (services.size() == 1)
+			return services[0] -> get(key, compute);
+
+		const std::size_t node = numa::current_node();
+		return services[node] -> get( key, [this, &key, &compute, node]() -> Operator {
+			for (std::size_t other = 0; other < services.size(); ++other)
+			{
+				pointer p = other != node ? services[other] -> lookup(key) : pointer();
+				if (p)
+					return *p;
+			}
+			return compute();
+		} );
+	}
+
+	//! the service of \p node
+	jump_service<Operator, Capacity> & on(std::size_t node) {return *services[node];}
+	std::size_t nodes() const {return services.size();}
+private:
+	std::vector< std::unique_ptr< jump_service<Operator, Capacity> > > services;
+
+	node_jump_service(const node_jump_service &);
+	node_jump_service & operator=(const node_jump_service &);
+};
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_ENGINE_JUMP_SERVICE_HPP
@@ -17,27 +17,31 @@
 	\date March 23, 2012
 */
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <boost/cstdint.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/mpl/string.hpp>
+#include <boost/type_traits/is_base_of.hpp>
 #include <boost/type_traits/is_same.hpp>
 // NOTE: For debugging, to be removed
 #include <boost/timer/timer.hpp>
 
 #include <qfcl/defines.hpp>
-#include <qfcl/math/bits/copy_bits.hpp>
+#include <qfcl/math/bits/pack_bits.hpp>
 #include <qfcl/types.hpp>
 #include <qfcl/utility/tmp.hpp>
 #include <qfcl/utility/io.hpp>
 
 #include "engine.hpp"
+#include "jump_service.hpp"
 #include "matrix.hpp"
 
 #pragma warning(disable:4290)
@@ -71,6 +75,9 @@ output(std::basic_ostream<charT, Traits> & os, const StateType & s)
 	return os;
 }
 
+//! grants the binary snapshot routines direct access to the raw state
+struct snapshot_access;
+
 }	// namespace detail
 
 //! \f$\mathbb F_m\f$-linear generator of dimension k base class
@@ -104,6 +111,11 @@ protected:
  //   static const auto default_seed = EngineTraits::default_seed;
 private:
 	static const size_t k = n * w - r;
+	//! bits and number of words of an \c NTL::vec_GF2 of length \c k
+	static const size_t ntl_w = NTL_BITS_PER_LONG;
+	static const size_t ntl_n = (k + ntl_w - 1) / ntl_w;
+	//! whether the state words are already the words of its \c vector_t, so that jumps can read them in place
+	static const bool gf2_view = r == 0 && w == ntl_w;
 public:
 	typedef Matrix<mod> matrix_t;
 	typedef Vector<mod> vector_t;
@@ -116,17 +128,41 @@ public:
 	//linear_generator(UIntType seed_ = default_seed) {seed(seed_);}
 
 	//! get the next random number to be generated (without changing the state)
+	/*! Takes O(log v) matrix-vector products for large \p v, using the cached jump matrices
+		of the powers of 2.
+	*/
 	result_type peek(unsigned long long v) const;
+	//! \c peek at each of the offsets in <tt>[first, last)</tt>, which must be sorted in increasing order
+	/*! The offsets are visited in one pass, jumping by the differences of consecutive offsets.
+	*/
+	template<typename InIt, typename OutIt>
+	OutIt peek_many(InIt first, InIt last, OutIt dest) const;
+	std::vector<result_type> peek_many(const std::vector<unsigned long long> & offsets) const
+	{
+		std::vector<result_type> values( offsets.size() );
+		peek_many( offsets.begin(), offsets.end(), values.begin() );
+		return values;
+	}
 
 	//! advance the state by \c num steps
 	void discard(unsigned long long num);
+
+	//! \c peek and \c peek_many step over offsets up to this size, which is cheaper than the matrix-vector products of a jump
+	static const unsigned long long step_limit = k * (k / NTL_BITS_PER_LONG + 1);
 	
 	//! returns the transition matrix
-	static matrix_t & TransitionMatrix() {return TransitionMatrix_imp();}
+	static const matrix_t & TransitionMatrix() {return TransitionMatrix_imp();}
 	//! whether the file containing the transition matrix exists
 	static bool TransitionMatrix_file_exists() {return TransitionMatrix_file_exists_imp();}
+	//! shared pointer to an immutable jump matrix
+	typedef typename node_jump_service<matrix_t>::pointer matrix_pointer;
 	//! returns the jump matrix corresponding to the given \p jump_size
-	static matrix_t & JumpMatrix(unsigned long long jump_size)
+	/*! Thread-safe. The matrices of the powers of 2 are computed (or read from file) once per engine type
+		and cached for the lifetime of the program. The matrix of any other size is read from its file, or
+		built from the cached powers of 2 in \p jump_size, and is not cached: each one is as large as the
+		state squared, so caching every size asked for would grow without bound.
+	*/
+	static matrix_pointer JumpMatrix(unsigned long long jump_size)
 	{
 		return JumpMatrix_imp(jump_size, false);
 	}
@@ -199,20 +235,20 @@ public:
 	//! give access to selected subclasses only
 	friend class noninvertible_linear_generator<Derived, EngineTraits>;
 	friend class invertible_linear_generator<Derived, EngineTraits>;
+	//! binary snapshots copy the raw state, bypassing \c rewind_imp
+	friend struct detail::snapshot_access;
 private:
 	//! the RNG state stored as a circular buffer
 	UIntType x[n];
 	//! index within the state of the next random number to be generated
 	std::size_t i;
 
-	//! the jump matrix
-	static matrix_t J;
-	//! whether the jump matrix has been set yet
-	static bool J_set;
-	//! size of the set jump matrix
-	static unsigned long long computed_size;
-	//! whether the set jump matrix corresponds to a reverse jump (only used for \c invertible_linear_generator s)
-	static bool computed_reverse;
+	//! the transition and jump matrices of this engine type, replicated on each NUMA node
+	static node_jump_service<matrix_t> & jumps()
+	{
+		static node_jump_service<matrix_t> service;
+		return service;
+	}
 
 	//! re-seed the generator, \c seed() resets to the default seed
     void seed_imp(UIntType seed_ = EngineTraits::default_seed) {Derived::SeedInitialization(seed_, x, i);}
@@ -234,14 +270,23 @@ private:
 	void TransformedGet0(OutIt dest, size_t num, unsigned long long skip = 0) const;
 	
 	//! common routine for computing the transition matrix
-	static matrix_t & TransitionMatrix_imp(bool reverse = false);
+	static const matrix_t & TransitionMatrix_imp(bool reverse = false);
 	//! common routine for checking whether the transition matrix exists
 	static bool TransitionMatrix_file_exists_imp(bool reverse = false);
 
 	//! common routine for computing the jump matrix
-	static matrix_t & JumpMatrix_imp(unsigned long long v, bool reverse);
+	static matrix_pointer JumpMatrix_imp(unsigned long long v, bool reverse);
 	//! common routine for checking whether the jump matrix exists
 	static bool JumpMatrix_file_exists_imp(unsigned long long jump_size, bool reverse = false);
+	//! the cached jump matrix of size \f$2^j\f$, computed by squaring the one of size \f$2^{j-1}\f$
+	static matrix_pointer JumpMatrix_pow2(size_t j, bool reverse = false);
+
+	//! <tt>s = J s</tt>, working on the words of the state vector (in place if \c gf2_view)
+	static void multiply(const matrix_t & J, state & s);
+	//! advance the state by \p num steps, by the jump matrices of the powers of 2 in \p num
+	void jump_imp(unsigned long long num, bool reverse = false);
+	//! advance the state by \p num steps, by stepping or jumping, whichever is cheaper
+	void advance_imp(unsigned long long num);
 
 	//! the name of the file containing the transition matrix
 	static std::string transition_matrix_filename(bool reverse = false);
@@ -253,7 +298,6 @@ private:
 
 	struct transition_matrix_functor;
 	struct jump_matrix_functor;
-	struct reverse_jump_matrix_functor;
 protected:
 	//! default constructor
 	// to be used as base class only
@@ -276,18 +320,8 @@ template<typename Derived, typename EngineType>
 inline void
 linear_generator<Derived, EngineType>::discard(unsigned long long num)
 {
-	matrix_t J = JumpMatrix(num);
-
-	state s = getState();
-
-	// advance num steps
-	s = J * s;
-
-	// correct the initial r bits of the state
-	Derived::correct(s);
-
-	// upcast to seed
-	static_cast<Derived *>(this) -> seed(s);
+	// by the cached jump matrices of the powers of 2, rather than caching one of size num
+	jump_imp(num);
 }
 
 // peek
@@ -297,9 +331,44 @@ linear_generator<Derived, EngineTraits>::peek(unsigned long long v) const
 {
 	result_type value;
 
-	TransformedGet0(&value, 1, v);
+	if (v <= step_limit)
+	{
+		TransformedGet0(&value, 1, v);
+		return value;
+	}
+
+	// jump a copy
+	Derived eng( static_cast<const Derived &>(*this) );
+	linear_generator & e = eng;
+	e.jump_imp(v);
+
+	return Derived::Transform(e.x, e.i);
+}
+
+// peek_many
+template<typename Derived, typename EngineTraits>
+template<typename InIt, typename OutIt>
+OutIt
+linear_generator<Derived, EngineTraits>::peek_many(InIt first, InIt last, OutIt dest) const
+{
+	Derived eng( static_cast<const Derived &>(*this) );
+	linear_generator & e = eng;
+
+	// offset of e
+	unsigned long long v = 0;
+	for (; first != last; ++first)
+	{
+		const unsigned long long next_v = *first;
+		if (next_v < v)
+			throw std::invalid_argument("peek_many: the offsets must be sorted");
+
+		e.advance_imp(next_v - v);
+		v = next_v;
 
-	return value;
+		*(dest++) = Derived::Transform(e.x, e.i);
+	}
+
+	return dest;
 }
 
 /* member classes */
@@ -335,22 +404,22 @@ struct linear_generator<Derived, EngineTraits>::state
 	//! the number of \c UIntType elements comprising the state
 	static const size_t length() {return n;}
 
+	//! the \c ntl_n words of the \c vector_t representing the state
+	void pack(_ntl_ulong * a) const {qfcl::math::pack_bits<w, ntl_w>(s, r, k, a);}
+	//! set the state from the \c ntl_n words of a \c vector_t; the unused \c r bits are cleared
+	void unpack(const _ntl_ulong * a) {qfcl::math::unpack_bits<ntl_w, w>(a, k, s, r);}
+
 	//! conversion function from state to vector_t<mod>
 	// compiler has problem with out-of-class definition
 	operator Vector<mod>()
 	{
-		using namespace qfcl::math;
-
 		Vector<mod> a;
 		a.SetLength(k);
 
-		// I am assuming that the standard specifices that the 1 byte storage of char
-		// contains exactly 8 bits of information
-		// See also the implicit conversion from Vector<mod> to state.
-		static const size_t ntl_w = sizeof(*a.rep.rep) * 8;
-		copy_bits( make_bit_pseudoiterator<w>(&s[0], r), 
-				   make_bit_pseudoiterator<w>(&s[n], 0),
-				   make_bit_pseudoiterator<ntl_w>(a.rep.rep, 0) );
+		// NTL uses the *first* k bits, whereas we use the *last* k bits of s, 
+		// so that only the upper w - r bits of s[0] are used.
+		// Also, NTL uses the low NTL_BITS_PER_LONG bits of each word, which need not fill the word.
+		pack( a.rep.elts() );
 
 		return a;
 	}
@@ -370,36 +439,9 @@ linear_generator<Derived, EngineTraits>::state::set(const UIntType (&x)[n], size
 template<typename Derived, typename EngineTraits>
 linear_generator<Derived, EngineTraits>::state::state(const Vector<mod> & arr)
 {
-	using namespace qfcl::math;
-
-	// NTL internal representation uses the *first* k bits, 
-	// so that only the lower w - r bits of arr.rep.rep[n - 1] are used, 
-	// whereas we use the *last* k bits so that only the upper w - r
-	// bits of s[0] are used.
-	static const size_t ntl_w = sizeof(*arr.rep.rep) * 8;
-	// r may be greater than ntl_w, and we have to accomodate for r == 0 anyways
-	static const size_t ntl_shift_bits = (ntl_w - r) % ntl_w; 
-	static const size_t ntl_shift_words = (r + ntl_w - 1) / ntl_w; 
-	copy_bits( make_bit_pseudoiterator<ntl_w>(arr.rep.rep, 0),
-			   make_bit_pseudoiterator<ntl_w>( arr.rep.rep + arr.rep.length() - ntl_shift_words, ntl_shift_bits ),
-			   make_bit_pseudoiterator<w>(s, r), true );
+	unpack( arr.rep.elts() );
 }
 
-/* private static data */
-
-template<typename Derived, typename EngineTraits>
-typename linear_generator<Derived, EngineTraits>::matrix_t 
-linear_generator<Derived, EngineTraits>::J;
-
-template<typename Derived, typename EngineTraits>
-bool linear_generator<Derived, EngineTraits>::J_set = false;
-
-template<typename Derived, typename EngineTraits>
-unsigned long long linear_generator<Derived, EngineTraits>::computed_size;
-
-template<typename Derived, typename EngineTraits>
-bool linear_generator<Derived, EngineTraits>::computed_reverse;
-
 /* private static member functors */
 
 // Get
@@ -424,35 +466,10 @@ linear_generator<Derived, EngineTraits>::Get(const UIntType (&x)[n], size_t i, O
 
 // TransitionMatrix_imp
 template<typename Derived, typename EngineType>
-inline typename linear_generator<Derived, EngineType>::matrix_t & 
+inline const typename linear_generator<Derived, EngineType>::matrix_t & 
 linear_generator<Derived, EngineType>::TransitionMatrix_imp(bool reverse)
 {
-	// transition matrix
-	static matrix_t A;
-	static bool A_set = false;
-
-	// reverse transition matrix
-	static matrix_t A_reverse;
-	static bool A_reverse_set = false;
-
-	if (!reverse && A_set)
-		return A;
-	else if (reverse && A_reverse_set)
-		return A_reverse;
-
-	if (!reverse)
-	{
-     //   A = linear_generator<Derived, EngineType>::obtain_matrix( transition_matrix_filename(), transition_matrix_functor() );
-        A = obtain_matrix( transition_matrix_filename(), transition_matrix_functor() );
-		A_set = true;
-		return A;
-	}
-	else
-	{
-		A_reverse = obtain_matrix( transition_matrix_filename(reverse), transition_matrix_functor(reverse) );
-		A_reverse_set = true;
-		return A_reverse;
-	}
+	return *JumpMatrix_pow2(0, reverse);
 }
 
 // TransitionMatrix_file_exists_imp
@@ -462,37 +479,27 @@ linear_generator<Derived, EngineTraits>::TransitionMatrix_file_exists_imp(bool r
 {
 	std::string filename = transition_matrix_filename(reverse);
 
-	return std::ifstream( filename.c_str() );
+	return std::ifstream( filename.c_str() ).good();
 }
 
 // JumpMatrix_imp
 template<typename Derived, typename EngineTraits>
-inline typename linear_generator<Derived, EngineTraits>::matrix_t & 
+inline typename linear_generator<Derived, EngineTraits>::matrix_pointer
 linear_generator<Derived, EngineTraits>::JumpMatrix_imp(unsigned long long jump_size, bool reverse)
 {
 	// -0 = 0
 	reverse = (reverse && jump_size > 0);
 
-	// check whether J currently holds the matrix for this jump, in both size and direction
-	if ( J_set && jump_size == computed_size && computed_reverse == reverse )
-		return J;
-
-	// filename of the jump matrix not reversed
-	std::string filename = jump_matrix_filename(jump_size);
-	
-	if (reverse)
+	// powers of 2 are cached
+	if ( jump_size > 0 && (jump_size & (jump_size - 1)) == 0 )
 	{
-		std::string reverse_filename = jump_matrix_filename(jump_size, reverse);
-		J = obtain_matrix( reverse_filename, reverse_jump_matrix_functor(jump_size, filename) );
+		size_t j = 0;
+		for (; (1ull << j) != jump_size; ++j);
+		return JumpMatrix_pow2(j, reverse);
 	}
-	else
-		J = obtain_matrix( filename, jump_matrix_functor(jump_size) );
 
-	J_set = true;
-	computed_size = jump_size;
-	computed_reverse = reverse;
-
-	return J;
+	return std::make_shared<const matrix_t>( obtain_matrix( jump_matrix_filename(jump_size, reverse), 
+															jump_matrix_functor(jump_size, reverse) ) );
 }
 
 // JumpMatrix_file_exists_imp
@@ -502,7 +509,92 @@ linear_generator<Derived, EngineTraits>::JumpMatrix_file_exists_imp(unsigned lon
 {
 	std::string filename = jump_matrix_filename(jump_size, reverse);
 
-	return std::ifstream( filename.c_str() );
+	return std::ifstream( filename.c_str() ).good();
+}
+
+// JumpMatrix_pow2
+template<typename Derived, typename EngineTraits>
+typename linear_generator<Derived, EngineTraits>::matrix_pointer
+linear_generator<Derived, EngineTraits>::JumpMatrix_pow2(size_t j, bool reverse)
+{
+	if (j == 0)
+	{
+		const jump_key key(1, reverse ? jump_key::REVERSE_TRANSITION : jump_key::TRANSITION);
+
+		return jumps().get( key, [reverse]() { 
+			return obtain_matrix( transition_matrix_filename(reverse), transition_matrix_functor(reverse) ); 
+		} );
+	}
+
+	const unsigned long long jump_size = 1ull << j;
+	const jump_key key(jump_size, reverse ? jump_key::REVERSE_JUMP : jump_key::JUMP);
+
+	// the same file as JumpMatrix(2^j)
+	return jumps().get( key, [j, jump_size, reverse]() -> matrix_t {
+		return obtain_matrix( jump_matrix_filename(jump_size, reverse), [j, reverse]() -> matrix_t {
+			const matrix_pointer P = JumpMatrix_pow2(j - 1, reverse);
+			return *P * *P;
+		} );
+	} );
+}
+
+// multiply
+template<typename Derived, typename EngineTraits>
+inline void
+linear_generator<Derived, EngineTraits>::multiply(const matrix_t & J, state & s)
+{
+	_ntl_ulong y[ntl_n];
+
+	if (gf2_view)
+		J.multiply(s.rep(), y);
+	else
+	{
+		_ntl_ulong a[ntl_n];
+		s.pack(a);
+		J.multiply(a, y);
+	}
+
+	s.unpack(y);
+}
+
+// jump_imp
+template<typename Derived, typename EngineTraits>
+void
+linear_generator<Derived, EngineTraits>::jump_imp(unsigned long long num, bool reverse)
+{
+	state s = getState();
+
+	// multiply the words of the state vector back and forth between two buffers
+	_ntl_ulong a[ntl_n], b[ntl_n];
+	_ntl_ulong * x = a, * y = b;
+	s.pack(x);
+
+	for (size_t j = 0; num > 0; ++j, num >>= 1)
+		if (num & 1)
+		{
+			JumpMatrix_pow2(j, reverse) -> multiply(x, y);
+			std::swap(x, y);
+		}
+
+	s.unpack(x);
+
+	// correct the initial r bits of the state
+	Derived::correct(s);
+
+	// upcast to seed
+	static_cast<Derived *>(this) -> seed(s);
+}
+
+// advance_imp
+template<typename Derived, typename EngineTraits>
+inline void
+linear_generator<Derived, EngineTraits>::advance_imp(unsigned long long num)
+{
+	if (num > step_limit)
+		jump_imp(num);
+	else
+		for (; num > 0; --num)
+			Derived::Next(x, i);
 }
 
 // obtain_matrix
@@ -556,47 +648,58 @@ struct linear_generator<Derived, EngineTraits>::transition_matrix_functor
 
 			// work with A^T instead
 			// note that, as a concept feature, we need a corrected state when going in reverse
-			A[i] = !reverse ? Derived::Transition(x) 
-				: Derived::ReverseTransition( invertible_linear_generator<Derived, EngineTraits>::correct(x) );
+			A[i] = !reverse ? Derived::Transition(x) : ReverseTransition(x, is_invertible());
 		}
 
 		return transpose(A);
 	}
 private:
 	const bool reverse;
-};
 
-// struct jump_matrix_functor
-template<typename Derived, typename EngineTraits>
-struct linear_generator<Derived, EngineTraits>::jump_matrix_functor
-{
-	jump_matrix_functor(unsigned long long _jump_size) : jump_size(_jump_size) {}
+	typedef typename boost::is_base_of< invertible_linear_generator<Derived, EngineTraits>, Derived >::type is_invertible;
 
-    matrix_t operator()() const
+	static state ReverseTransition(const vector_t & x, boost::true_type)
 	{
-		//return NTL::power( TransitionMatrix(), jump_size );
-		return detail::pow( TransitionMatrix_imp(false), jump_size );
+		return Derived::ReverseTransition( invertible_linear_generator<Derived, EngineTraits>::correct(x) );
+	}
+	//! noninvertible generators have no reverse transition
+	static state ReverseTransition(const vector_t &, boost::false_type)
+	{
+		throw std::logic_error("the reverse transition of a noninvertible linear generator");
 	}
-private:
-    const unsigned long long jump_size;
 };
 
-// struct reverse_jump_matrix_functor
+// struct jump_matrix_functor
 template<typename Derived, typename EngineTraits>
-struct linear_generator<Derived, EngineTraits>::reverse_jump_matrix_functor
+struct linear_generator<Derived, EngineTraits>::jump_matrix_functor
 {
-	reverse_jump_matrix_functor(unsigned long long _jump_size, const std::string & _fwd_filename)
-		: jump_size(_jump_size), fwd_filename(_fwd_filename) {}
+	jump_matrix_functor(unsigned long long _jump_size, bool _reverse = false) : jump_size(_jump_size), reverse(_reverse) {}
 
     matrix_t operator()() const
 	{
-		//matrix_t fwd_J = obtain_matrix( fwd_filename, jump_matrix_functor(jump_size) );
-		//return NTL::inv(fwd_J);
-		return detail::pow( TransitionMatrix_imp(true), jump_size );
+		if (jump_size == 0)
+			return detail::pow( TransitionMatrix_imp(reverse), jump_size );
+
+		// the product of the cached matrices of the powers of 2 in jump_size
+		matrix_t J;
+		bool first = true;
+		unsigned long long num = jump_size;
+		for (size_t j = 0; num > 0; ++j, num >>= 1)
+			if (num & 1)
+			{
+				const matrix_pointer P = JumpMatrix_pow2(j, reverse);
+				if (first)
+					J = *P;
+				else
+					J = J * *P;
+				first = false;
+			}
+
+		return J;
 	}
 private:
     const unsigned long long jump_size;
-	std::string fwd_filename;
+	const bool reverse;
 };
 
 // transition_matrix_filename
@@ -707,12 +810,18 @@ public:
     noninvertible_linear_generator(typename base_type::UIntType seed_ = base_type::default_seed) {seed(seed_);}
 
 	//! re-seed the generator, \c seed() resets to the default seed
-    void seed(typename base_type::UIntType seed_ = base_type::default_seed) {seed_imp(seed_);}
+    void seed(typename base_type::UIntType seed_ = base_type::default_seed) {this -> seed_imp(seed_);}
 	//! re-seed the generator with a sequence of seeds of arbitrary length
 	template<typename It>
     void seed(It begin, It end) {this -> seed_imp(begin, end);}
 	//! set the generator by directly providing the state
-    void seed(typename base_type::state & s) {seed_imp(s);}
+    void seed(const typename base_type::state & s) {this -> seed_imp(s);}
+	//! there are no unused bits to correct, as <tt>r = 0</tt>
+	static typename base_type::state & correct(typename base_type::state & s)
+	{
+		static_assert(base_type::r == 0, "noninvertible linear generators must use every bit of the state");
+		return s;
+	}
 	//! generate a random number
     typename base_type::result_type operator()()
     {
@@ -784,9 +893,21 @@ public:
 	//! get the next random number to be generated (without changing the state)
 	result_type peek(long long v) const;
 	result_type reverse_peek(unsigned long long v) const;
+	//! \c peek at each of the offsets in <tt>[first, last)</tt>, which must be sorted in increasing order
+	/*! The offsets can be negative. They are visited in one pass, jumping by the differences
+		of consecutive offsets.
+	*/
+	template<typename InIt, typename OutIt>
+	OutIt peek_many(InIt first, InIt last, OutIt dest) const;
+	std::vector<result_type> peek_many(const std::vector<long long> & offsets) const
+	{
+		std::vector<result_type> values( offsets.size() );
+		peek_many( offsets.begin(), offsets.end(), values.begin() );
+		return values;
+	}
 
 	//! TransitionMatrix and its inverse
-	static matrix_t & TransitionMatrix(bool reverse = false)
+	static const matrix_t & TransitionMatrix(bool reverse = false)
 	{
         return base_type::TransitionMatrix_imp(reverse);
 	}
@@ -796,12 +917,12 @@ public:
         return base_type::TransitionMatrix_file_exists_imp(reverse);
 	}
 
-	//! JumpMatrices for negative jumps too
-	static matrix_t & JumpMatrix(unsigned long long jump_size, bool reverse = false)
+	//! JumpMatrices for negative jumps too; only those of the powers of 2 are cached, see \c linear_generator::JumpMatrix
+	static typename base_type::matrix_pointer JumpMatrix(unsigned long long jump_size, bool reverse = false)
 	{
         return base_type::JumpMatrix_imp(jump_size, reverse);
 	}
-	static matrix_t & JumpMatrix(long long jump_size) {return JumpMatrix( ::abs(jump_size), jump_size < 0 );}
+	static typename base_type::matrix_pointer JumpMatrix(long long jump_size) {return JumpMatrix( ::abs(jump_size), jump_size < 0 );}
 	
 	//! whether the file containing the jump matrix of jump size v exists
 	static bool JumpMatrix_file_exists(unsigned long long jump_size, bool reverse = false)
@@ -837,7 +958,7 @@ template<typename It>
 inline void
 invertible_linear_generator<Derived, EngineType>::seed(It begin, It end)
 {
-	seed_imp(begin, end);
+	this -> seed_imp(begin, end);
 
 	// back up one step, so that s gives the *next* n numbers
 	// this also corrects the lower r bits of x[0]
@@ -903,19 +1024,8 @@ template<typename Derived, typename EngineType>
 inline void
 invertible_linear_generator<Derived, EngineType>::reverse_discard(unsigned long long num)
 {
-	matrix_t J = JumpMatrix(num, true);
-
-	/// NOTE: FACTOR OUT COMMON CODE. FIX THIS
-    state s = this -> getState();
-
-	// advance num steps
-	s = J * s;
-
-	// correct the initial r bits of the state
-	Derived::correct(s);
-
-	// upcast to seed
-	static_cast<Derived *>(this) -> seed(s);
+	// by the cached jump matrices of the powers of 2, as discard
+	base_type::jump_imp(num, true);
 }
 
 // skip
@@ -933,9 +1043,18 @@ invertible_linear_generator<Derived, EngineTraits>::reverse_peek(unsigned long l
 {
 	result_type value;
 
-	ReverseTransformedGet0(&value, 1, v);
+	if (v <= base_type::step_limit)
+	{
+		ReverseTransformedGet0(&value, 1, v);
+		return value;
+	}
+
+	// jump a copy
+	Derived eng( static_cast<const Derived &>(*this) );
+	base_type & e = eng;
+	e.jump_imp(v, true);
 
-	return value;
+	return Derived::Transform(e.x, e.i);
 }
 
 // peek
@@ -943,11 +1062,48 @@ template<typename Derived, typename EngineTraits>
 inline typename invertible_linear_generator<Derived, EngineTraits>::result_type 
 invertible_linear_generator<Derived, EngineTraits>::peek(long long v) const
 {
-	result_type value;
+    return v >= 0 ? base_type::peek( static_cast<unsigned long long>(v) ) : reverse_peek( -v );
+}
+
+// peek_many
+template<typename Derived, typename EngineTraits>
+template<typename InIt, typename OutIt>
+OutIt
+invertible_linear_generator<Derived, EngineTraits>::peek_many(InIt first, InIt last, OutIt dest) const
+{
+	if (first == last)
+		return dest;
+
+	Derived eng( static_cast<const Derived &>(*this) );
+	base_type & e = eng;
 
-    v >= 0 ? this -> TransformedGet0(&value, 1, v) : ReverseTransformedGet0(&value, 1, -v);
+	// offset of e, starting at the first (possibly negative) offset
+	long long v = *first;
+	if (v < 0)
+	{
+		const unsigned long long num = -v;
+		if (num > base_type::step_limit)
+			e.jump_imp(num, true);
+		else
+			for (unsigned long long j = 0; j < num; ++j)
+				Derived::Previous(e.x, e.i);
+	}
+	else
+		e.advance_imp(v);
+
+	for (; first != last; ++first)
+	{
+		const long long next_v = *first;
+		if (next_v < v)
+			throw std::invalid_argument("peek_many: the offsets must be sorted");
+
+		e.advance_imp(next_v - v);
+		v = next_v;
+
+		*(dest++) = Derived::Transform(e.x, e.i);
+	}
 
-	return value;
+	return dest;
 }
 
 /* private member function */
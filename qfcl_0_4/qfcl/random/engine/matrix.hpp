@@ -19,12 +19,14 @@
 
 #pragma warning(disable:4290)
 
+#include <algorithm>
 #include <fstream>
 #include <stdexcept>
 #include <string>
 
 #include <NTL/mat_GF2.h>
 
+#include <qfcl/math/bits/pack_bits.hpp>
 #include <qfcl/utility/io.hpp>
 
 namespace qfcl {
@@ -114,6 +116,14 @@ public:
 	//! implicit conversion from base type
 	Matrix(const NTL::mat_GF2 & M) : NTL::mat_GF2(M) {}
 
+	//! \f$y = A x\f$, with \p x and \p y given by their words of \c NTL_BITS_PER_LONG bits
+	/*! \p x can be any array of words in the layout of an \c NTL::vec_GF2, such as the state of a
+		linear generator with word size \c NTL_BITS_PER_LONG and no masked bits, which is then used
+		in place.
+	*/
+	template<typename Word>
+	void multiply(const Word * x, _ntl_ulong * y) const;
+
 	//! write the matix to the file \c filename
     void write(const std::string & filename) const throw(std::runtime_error);
 	//! read the matrix from the file \c filename, and indicate if it exists
@@ -123,6 +133,28 @@ public:
 template<>
 Matrix<2> identity< Matrix<2> >(const Matrix<2> & M);
 
+// multiply
+template<typename Word>
+inline void Matrix<2>::multiply(const Word * x, _ntl_ulong * y) const
+{
+	static const long ntl_w = NTL_BITS_PER_LONG;
+	const long rows = NumRows(), words = (NumCols() + ntl_w - 1) / ntl_w;
+
+	std::fill( y, y + (rows + ntl_w - 1) / ntl_w, _ntl_ulong(0) );
+
+	// bit i of y is the inner product of row i and x
+	for (long i = 0; i < rows; ++i)
+	{
+		const _ntl_ulong * a = (*this)[i].rep.elts();
+		_ntl_ulong sum = 0;
+		for (long j = 0; j < words; ++j)
+			sum ^= a[j] & static_cast<_ntl_ulong>(x[j]);
+
+		if ( math::parity(sum) )
+			y[i / ntl_w] |= _ntl_ulong(1) << (i % ntl_w);
+	}
+}
+
 //! @}
 
 }	// namespace random
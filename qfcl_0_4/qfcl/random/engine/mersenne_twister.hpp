@@ -470,14 +470,14 @@ template<typename EngineTraits>
 template<typename It>
 mersenne_twister_engine<EngineTraits>::mersenne_twister_engine(It begin, It end)
 {
-	seed(begin, end);
+	this -> seed(begin, end);
 }
 
 // ctor
 template<typename EngineTraits>
 mersenne_twister_engine<EngineTraits>::mersenne_twister_engine(const state & s)
 {
-	seed(s);
+	this -> seed(s);
 }
 
 template<typename EngineTraits>
@@ -814,6 +814,164 @@ mersenne_twister_engine<EngineTraits>::ReverseTransition(const state & s)
     return static_cast<typename mersenne_twister_engine<EngineTraits>::state>(y);
 }
 
+/** incremental twist mode */
+
+/*! \brief The Mersenne Twister with the twist spread evenly over the calls
+
+	\c mersenne_twister_engine twists all \c n words of its state once every \c n calls, so that the
+	time per call is bimodal, with a spike of \c n twists. \c incremental_mersenne_twister_engine
+	instead twists one word per call: the word returned is replaced by the word \c n steps ahead,
+	which only depends on words still in the (circular) buffer. The sequence generated is identical,
+	as is the state (the next \c n words to be generated), while the time per call is flat. This
+	suits latency sensitive callers; the average time per call is slightly higher than with the
+	full twist.
+
+	Seeding, \c discard and state validation go through \c mersenne_twister_engine, which is also
+	how to obtain its other operations, e.g. <tt>engine_type(e.getState())</tt>.
+*/
+template<typename EngineTraits>
+class incremental_mersenne_twister_engine : public EngineTraits
+{
+public:
+	//! the engine with the full twist, generating the same sequence
+	typedef mersenne_twister_engine<EngineTraits> engine_type;
+	typedef typename engine_type::PolicyTraits PolicyTraits;
+	typedef typename engine_type::result_type result_type;
+	typedef typename engine_type::UIntType UIntType;
+	typedef typename engine_type::state state;
+
+	//! engine name
+	typedef typename qfcl::tmp::concatenate< typename EngineTraits::name, mpl::string<'-', 'i', 'n', 'c'>::type >::type name;
+
+	static const size_t n = EngineTraits::state_size;
+	static const size_t m = EngineTraits::shift_size;
+
+	/*! \name constructors
+		@{
+	*/
+	//! default constructor taking optional seed
+	incremental_mersenne_twister_engine(UIntType seed_ = EngineTraits::default_seed) {seed(seed_);}
+	//! constructor taking an arbitrarily long sequence of seeds
+	template<typename It>
+	incremental_mersenne_twister_engine(It begin, It end) {seed(begin, end);}
+	//! constructor directly setting the state
+	/*! \sa seed(const state &)
+	*/
+	incremental_mersenne_twister_engine(const state & s) {seed(s);}
+	//! continues the sequence of \p eng
+	explicit incremental_mersenne_twister_engine(const engine_type & eng) {set( eng.getState() );}
+	//!	@}
+
+	//! re-seed the generator, \c seed() resets to the default seed
+	void seed(UIntType seed_ = EngineTraits::default_seed) {set( engine_type(seed_).getState() );}
+	//! re-seed the generator with a sequence of seeds of arbitrary length
+	template<typename It>
+	void seed(It begin, It end) {set( engine_type(begin, end).getState() );}
+	//! set the generator by directly providing the state \p s; throws \c std::domain_error if \p s is invalid
+	void seed(const state & s) {set( engine_type(s).getState() );}
+
+	//! minimum pseudo random number generated
+	static result_type min() {return engine_type::min();}
+	//! maximum pseudo random number generated
+	static result_type max() {return engine_type::max();}
+
+	//! generate a random number
+	result_type operator()();
+
+	//! advance the state by \c num steps, as \c mersenne_twister_engine::discard does
+	void discard(unsigned long long num);
+
+	//! get the state of the engine: the next \c n words to be generated
+	const state getState() const;
+
+	//! whether the two engines generate the same sequence
+	friend bool operator==(const incremental_mersenne_twister_engine & eng1, const incremental_mersenne_twister_engine & eng2)
+	{
+		const state s1 = eng1.getState(), s2 = eng2.getState();
+		return std::equal(s1.rep(), s1.rep() + n, s2.rep());
+	}
+	//! whether the two engines generate different sequences
+	friend bool operator!=(const incremental_mersenne_twister_engine & eng1, const incremental_mersenne_twister_engine & eng2)
+	{
+		return !(eng1 == eng2);
+	}
+
+	//! outputs the state, in the same format as \c mersenne_twister_engine
+	template<typename charT, typename Traits>
+	friend std::basic_ostream<charT, Traits> &
+	operator<<(std::basic_ostream<charT, Traits> & os, const incremental_mersenne_twister_engine & eng)
+	{
+		return detail::output( os, eng.getState() );
+	}
+	//! sets the state from a \c std::istream, in the same format as \c mersenne_twister_engine
+	template<typename charT, typename Traits>
+	friend std::basic_istream<charT, Traits> &
+	operator>>(std::basic_istream<charT, Traits> & is, incremental_mersenne_twister_engine & eng)
+	{
+		UIntType y[n];
+		for (size_t j = 0; j < n; ++j)
+			is >> y[j] >> std::ws;
+
+		eng.seed(y);
+
+		return is;
+	}
+private:
+	//! the next \c n words to be generated, starting from <tt>x[p]</tt>
+	UIntType x[n];
+	//! index of the next word to be generated
+	size_t p;
+
+	//! set the state, which is assumed valid
+	void set(const state & s)
+	{
+		std::copy(s.rep(), s.rep() + n, x);
+		p = 0;
+	}
+};
+
+// operator()
+/*! <tt>x[p]</tt> is \f$\mathbf{x}_k\f$, and is replaced by \f$\mathbf{x}_{k+n}\f$ by (2.1).
+	\f$\mathbf{x}_{k+1}\f$ and \f$\mathbf{x}_{k+m}\f$ are at <tt>p + 1</tt> and <tt>p + m</tt> (mod \c n):
+	either they have not been generated yet, or (past the end of the buffer) they have already been
+	twisted in their place.
+*/
+template<typename EngineTraits>
+inline typename incremental_mersenne_twister_engine<EngineTraits>::result_type
+incremental_mersenne_twister_engine<EngineTraits>::operator()()
+{
+	const size_t p1 = p + 1 < n ? p + 1 : 0;
+	const size_t pm = p < n - m ? p + m : p - (n - m);
+
+	const UIntType y = x[p];
+	x[p] = PolicyTraits::twist(y, x[p1], x[pm]);
+	p = p1;
+
+	return PolicyTraits::temper(y);
+}
+
+// discard
+template<typename EngineTraits>
+void
+incremental_mersenne_twister_engine<EngineTraits>::discard(unsigned long long num)
+{
+	engine_type eng( getState() );
+	eng.discard(num);
+	set( eng.getState() );
+}
+
+// getState
+template<typename EngineTraits>
+inline const typename incremental_mersenne_twister_engine<EngineTraits>::state
+incremental_mersenne_twister_engine<EngineTraits>::getState() const
+{
+	UIntType y[n];
+	std::copy(x + p, x + n, y);
+	std::copy(x, x + p, y + (n - p));
+
+	return state(y);
+}
+
 /* engine names */
 
 //! \cond
@@ -854,6 +1012,10 @@ typedef mersenne_twister_engine<mt11213a_traits> mt11213a;
 */
 typedef reverse_adapter<mt11213a> reverse_mt11213a;
 
+/*! \brief MT11213A twisting one word per call
+*/
+typedef incremental_mersenne_twister_engine<mt11213a_traits> mt11213a_incremental;
+
 /*! \brief MT11213B (32-bit)
 
 	350-dimensionally equidistributed PRNG from the original paper.
@@ -873,6 +1035,10 @@ typedef mersenne_twister_engine<mt11213b_traits> mt11213b;
 */
 typedef reverse_adapter<mt11213b> reverse_mt11213b;
 
+/*! \brief MT11213B twisting one word per call
+*/
+typedef incremental_mersenne_twister_engine<mt11213b_traits> mt11213b_incremental;
+
 /*! \brief MT19937 (32-bit)
 
 	623-dimensionally equidistributed PRNG from the original paper.
@@ -892,6 +1058,10 @@ typedef mersenne_twister_engine<mt19937_traits> mt19937;
 */
 typedef reverse_adapter<mt19937> reverse_mt19937;
 
+/*! \brief MT19937 twisting one word per call
+*/
+typedef incremental_mersenne_twister_engine<mt19937_traits> mt19937_incremental;
+
 /*! \brief MT19937-64: 64-bit version of the MT19937
 
 	Variant by Matsumoto and Nishimura, dated Feb. 23, 2005. 
@@ -913,6 +1083,10 @@ typedef mersenne_twister_engine<mt19937_64_traits> mt19937_64;
 */
 typedef reverse_adapter<mt19937_64> reverse_mt19937_64;
 
+/*! \brief MT19937-64 twisting one word per call
+*/
+typedef incremental_mersenne_twister_engine<mt19937_64_traits> mt19937_64_incremental;
+
 }	// namespace random
 }	// namespace qfcl
 
@@ -0,0 +1,419 @@
+/* qfcl/random/engine/mrg32k3a.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_MRG32K3A_HPP
+#define QFCL_RANDOM_MRG32K3A_HPP
+
+/*! \file qfcl/random/engine/mrg32k3a.hpp
+	\brief L'Ecuyer's MRG32k3a combined multiple recursive generator, with RngStreams style streams.
+
+	Two recurrences of order 3,
+	\f[ x_{1,n} = (1403580\, x_{1,n-2} - 810728\, x_{1,n-3}) \bmod m_1, \qquad
+		x_{2,n} = (527612\, x_{2,n-1} - 1370589\, x_{2,n-3}) \bmod m_2, \f]
+	with \f$m_1 = 2^{32} - 209\f$ and \f$m_2 = 2^{32} - 22853\f$, are combined as
+	\f$z_n = (x_{1,n} - x_{2,n}) \bmod m_1\f$. The period is about \f$2^{191}\f$.
+
+	Each recurrence is linear in its last 3 values, so \f$n\f$ steps are a product with the \f$n\f$-th power
+	of a \f$3 \times 3\f$ matrix modulo \f$m_i\f$: \c discard is O(log n) multiplications of \f$3 \times 3\f$
+	matrices. As in RngStreams (L'Ecuyer, Simard, Chen and Kelton, 2002), the sequence is split into
+	streams of length \f$2^{127}\f$, each split into substreams of length \f$2^{76}\f$, with the jump matrices
+	precomputed.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+#include <boost/cstdint.hpp>
+#include <boost/mpl/string.hpp>
+#include <boost/static_assert.hpp>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+namespace detail {
+
+//! moduli
+const boost::uint64_t mrg32k3a_m1 = UINT64_C(4294967087);
+const boost::uint64_t mrg32k3a_m2 = UINT64_C(4294944443);
+
+//! one step of the first and second components
+const boost::uint64_t mrg32k3a_A1[3][3] = {
+	{ 0, 1, 0 },
+	{ 0, 0, 1 },
+	{ mrg32k3a_m1 - 810728, 1403580, 0 } };
+const boost::uint64_t mrg32k3a_A2[3][3] = {
+	{ 0, 1, 0 },
+	{ 0, 0, 1 },
+	{ mrg32k3a_m2 - 1370589, 0, 527612 } };
+
+//! \f$2^{76}\f$ steps (a substream)
+const boost::uint64_t mrg32k3a_A1p76[3][3] = {
+	{   82758667, 1871391091, 4127413238 },
+	{ 3672831523,   69195019, 1871391091 },
+	{ 3672091415, 3528743235,   69195019 } };
+const boost::uint64_t mrg32k3a_A2p76[3][3] = {
+	{ 1511326704, 3759209742, 1610795712 },
+	{ 4292754251, 1511326704, 3889917532 },
+	{ 3859662829, 4292754251, 3708466080 } };
+
+//! \f$2^{127}\f$ steps (a stream)
+const boost::uint64_t mrg32k3a_A1p127[3][3] = {
+	{ 2427906178, 3580155704,  949770784 },
+	{  226153695, 1230515664, 3580155704 },
+	{ 1988835001,  986791581, 1230515664 } };
+const boost::uint64_t mrg32k3a_A2p127[3][3] = {
+	{ 1464411153,  277697599, 1610723613 },
+	{   32183930, 1464411153, 1022607788 },
+	{ 2824425944,   32183930, 2093834863 } };
+
+//! \f$3 \times 3\f$ matrices and vectors modulo \c m < \f$2^{32}\f$, so that products fit in 64 bits
+struct mrg32k3a_matrix
+{
+	boost::uint64_t a[3][3];
+
+	mrg32k3a_matrix() {}
+	explicit mrg32k3a_matrix(const boost::uint64_t (&b)[3][3])
+	{
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				a[i][j] = b[i][j];
+	}
+
+	static mrg32k3a_matrix identity()
+	{
+		mrg32k3a_matrix I;
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				I.a[i][j] = i == j;
+		return I;
+	}
+
+	//! <tt>(*this) * B mod m</tt>
+	mrg32k3a_matrix multiply(const mrg32k3a_matrix & B, boost::uint64_t m) const
+	{
+		mrg32k3a_matrix C;
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+			{
+				boost::uint64_t c = 0;
+				for (int k = 0; k < 3; ++k)
+					c = (c + a[i][k] * B.a[k][j] % m) % m;
+				C.a[i][j] = c;
+			}
+		return C;
+	}
+
+	//! <tt>x = (*this) * x mod m</tt>
+	template<typename UIntType>
+	void apply(UIntType (&x)[3], boost::uint64_t m) const
+	{
+		boost::uint64_t y[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			y[i] = 0;
+			for (int k = 0; k < 3; ++k)
+				y[i] = (y[i] + a[i][k] * x[k] % m) % m;
+		}
+		for (int i = 0; i < 3; ++i)
+			x[i] = static_cast<UIntType>(y[i]);
+	}
+
+	//! <tt>(*this)^e mod m</tt>, by repeated squaring
+	mrg32k3a_matrix pow(boost::uint64_t e, boost::uint64_t m) const
+	{
+		mrg32k3a_matrix result = identity(), pow2 = *this;
+		for (; e > 0; e >>= 1)
+		{
+			if (e & 1)
+				result = result.multiply(pow2, m);
+			if (e > 1)
+				pow2 = pow2.multiply(pow2, m);
+		}
+		return result;
+	}
+};
+
+}	// namespace detail
+
+//! L'Ecuyer's MRG32k3a generator
+/*! Generates integers in <tt>[1, m1]</tt>, where <tt>m1 = 4294967087</tt>; dividing by <tt>m1 + 1</tt> gives the
+	uniforms in (0, 1) of the reference implementation.
+
+	The engine keeps, as RngStreams does, the start of its current stream and substream, so that
+	\c reset_stream, \c reset_substream, \c next_stream and \c next_substream replay or skip ahead.
+	Streams of the same seed never overlap (for fewer than \f$2^{64}\f$ streams), which is how to hand
+	out independent generators, e.g. <tt>eng.jump_streams(j)</tt> on a copy for worker \c j.
+*/
+template<typename UIntType, typename Name>
+class mrg32k3a_engine
+{
+public:
+	typedef UIntType result_type;
+	typedef Name name;
+
+	BOOST_STATIC_ASSERT( !std::numeric_limits<UIntType>::is_signed && std::numeric_limits<UIntType>::digits >= 32 );
+
+	static const boost::uint64_t m1 = detail::mrg32k3a_m1;
+	static const boost::uint64_t m2 = detail::mrg32k3a_m2;
+	//! multipliers, with \c a13n and \c a23n negated
+	/*! The recurrences are computed as <tt>a12 x_{1,n-2} + a13n (m1 - x_{1,n-3})</tt>, and similarly for
+		the second, whose terms are below \f$2^{53}\f$.
+	*/
+	static const boost::uint64_t a12 = 1403580, a13n = 810728, a21 = 527612, a23n = 1370589;
+	//! the default seed of RngStreams, for all 6 components
+	static const boost::uint32_t default_seed = 12345;
+
+	//! ctor
+	/*! \sa seed(boost::uint32_t)
+	*/
+	mrg32k3a_engine() {seed();}
+	explicit mrg32k3a_engine(boost::uint32_t seed_) {seed(seed_);}
+	//! takes the 6 components of the state, see \c seed
+	explicit mrg32k3a_engine(const boost::uint32_t (&s)[6]) {seed(s);}
+
+	static result_type min() {return 1;}
+	static result_type max() {return static_cast<result_type>(m1);}
+
+	//! the default seed: all components equal to 12345
+	void seed() {seed_all(default_seed);}
+	//! derives the 6 components from a single seed
+	/*! The components are the seed followed by an LCG in 32 bit words (as in the seeding of the
+		Mersenne twister), reduced modulo \c m1 and \c m2; neither component is all zero.
+	*/
+	void seed(boost::uint32_t seed_);
+	//! sets the state, <tt>x_{1,n-3}, x_{1,n-2}, x_{1,n-1}, x_{2,n-3}, x_{2,n-2}, x_{2,n-1}</tt>
+	/*! This is the start of stream 0.
+		\throw std::invalid_argument if a component is not reduced, or either recurrence is all zero
+	*/
+	void seed(const boost::uint32_t (&s)[6]);
+
+	//! generate a random number
+	result_type operator()()
+	{
+		boost::uint32_t (&x1)[3] = current.x1, (&x2)[3] = current.x2;
+		const boost::uint64_t p1 = step( x1, a12 * x1[1] + a13n * (m1 - x1[0]), m1 );
+		const boost::uint64_t p2 = step( x2, a21 * x2[2] + a23n * (m2 - x2[0]), m2 );
+
+		return static_cast<result_type>( p1 > p2 ? p1 - p2 : p1 + m1 - p2 );
+	}
+
+	//! fills <tt>[first, last)</tt> with the next random numbers
+	template<typename OutIt>
+	void generate(OutIt first, OutIt last);
+
+	//! skips \p z numbers, in O(log z) \f$3 \times 3\f$ matrix products
+	void discard(boost::uint64_t z);
+
+	//! back to the start of the current stream
+	void reset_stream() {substream_start = current = stream_start;}
+	//! back to the start of the current substream
+	void reset_substream() {current = substream_start;}
+	//! to the start of the next substream, \f$2^{76}\f$ numbers after the start of the current one
+	void next_substream() {jump_substreams(1);}
+	//! to the start of the next stream, \f$2^{127}\f$ numbers after the start of the current one
+	void next_stream() {jump_streams(1);}
+
+	//! to the start of the \p j-th substream after the current one
+	void jump_substreams(boost::uint64_t j);
+	//! to the start of the \p j-th stream after the current one
+	void jump_streams(boost::uint64_t j);
+
+	friend bool operator==(const mrg32k3a_engine & e1, const mrg32k3a_engine & e2) {return e1.current == e2.current;}
+	friend bool operator!=(const mrg32k3a_engine & e1, const mrg32k3a_engine & e2) {return !(e1 == e2);}
+
+	//! outputs the current state, the 6 components in the order of \c seed
+	template<typename charT, typename Traits>
+	friend std::basic_ostream<charT, Traits> &
+	operator<<(std::basic_ostream<charT, Traits> & os, const mrg32k3a_engine & eng)
+	{
+		const state & s = eng.current;
+		return os << s.x1[0] << ' ' << s.x1[1] << ' ' << s.x1[2] << ' ' << s.x2[0] << ' ' << s.x2[1] << ' ' << s.x2[2];
+	}
+	//! reads the state, which becomes the start of the stream
+	template<typename charT, typename Traits>
+	friend std::basic_istream<charT, Traits> &
+	operator>>(std::basic_istream<charT, Traits> & is, mrg32k3a_engine & eng)
+	{
+		boost::uint32_t s[6];
+		for (int i = 0; i < 6; ++i)
+			is >> s[i] >> std::ws;
+		eng.seed(s);
+		return is;
+	}
+private:
+	//! the last 3 values of each recurrence, oldest first
+	struct state
+	{
+		boost::uint32_t x1[3], x2[3];
+
+		//! <tt>(x1, x2) = (A1 x1 mod m1, A2 x2 mod m2)</tt>
+		void apply(const detail::mrg32k3a_matrix & A1, const detail::mrg32k3a_matrix & A2)
+		{
+			A1.apply(x1, m1);
+			A2.apply(x2, m2);
+		}
+
+		friend bool operator==(const state & s1, const state & s2)
+		{
+			return std::equal(s1.x1, s1.x1 + 3, s2.x1) && std::equal(s1.x2, s1.x2 + 3, s2.x2);
+		}
+	};
+
+	//! the current state, and the starts of the current substream and stream
+	state current, substream_start, stream_start;
+
+	void seed_all(boost::uint32_t s);
+
+	//! shifts in the next value <tt>y mod m</tt>
+	static boost::uint64_t step(boost::uint32_t (&x)[3], boost::uint64_t y, boost::uint64_t m)
+	{
+		const boost::uint64_t p = y % m;
+		x[0] = x[1];
+		x[1] = x[2];
+		x[2] = static_cast<boost::uint32_t>(p);
+		return p;
+	}
+};
+
+/* member functions */
+
+// seed_all
+template<typename UIntType, typename Name>
+void mrg32k3a_engine<UIntType, Name>::seed_all(boost::uint32_t s)
+{
+	boost::uint32_t state[6];
+	for (int i = 0; i < 6; ++i)
+		state[i] = s;
+
+	seed(state);
+}
+
+// seed
+template<typename UIntType, typename Name>
+void mrg32k3a_engine<UIntType, Name>::seed(boost::uint32_t seed_)
+{
+	boost::uint32_t state[6];
+	boost::uint32_t x = seed_;
+
+	for (int i = 0; i < 6; ++i)
+	{
+		state[i] = static_cast<boost::uint32_t>( x % (i < 3 ? m1 : m2) );
+		x = UINT32_C(1812433253) * (x ^ (x >> 30)) + i + 1;
+	}
+
+	// a zero component would stay zero
+	if (state[0] == 0 && state[1] == 0 && state[2] == 0)
+		state[0] = default_seed;
+	if (state[3] == 0 && state[4] == 0 && state[5] == 0)
+		state[3] = default_seed;
+
+	seed(state);
+}
+
+// seed
+template<typename UIntType, typename Name>
+void mrg32k3a_engine<UIntType, Name>::seed(const boost::uint32_t (&s)[6])
+{
+	for (int i = 0; i < 6; ++i)
+		if ( s[i] >= (i < 3 ? m1 : m2) )
+			throw std::invalid_argument("mrg32k3a: seed component not less than the modulus");
+
+	if ( (s[0] == 0 && s[1] == 0 && s[2] == 0) || (s[3] == 0 && s[4] == 0 && s[5] == 0) )
+		throw std::invalid_argument("mrg32k3a: seed components of a recurrence all zero");
+
+	std::copy(s, s + 3, current.x1);
+	std::copy(s + 3, s + 6, current.x2);
+	substream_start = stream_start = current;
+}
+
+// generate
+template<typename UIntType, typename Name>
+template<typename OutIt>
+void mrg32k3a_engine<UIntType, Name>::generate(OutIt first, OutIt last)
+{
+	// the recurrences in local variables
+	boost::uint32_t (&x1)[3] = current.x1, (&x2)[3] = current.x2;
+	boost::uint64_t a0 = x1[0], a1 = x1[1], a2 = x1[2];
+	boost::uint64_t b0 = x2[0], b1 = x2[1], b2 = x2[2];
+
+	for (; first != last; ++first)
+	{
+		const boost::uint64_t p1 = (a12 * a1 + a13n * (m1 - a0)) % m1;
+		const boost::uint64_t p2 = (a21 * b2 + a23n * (m2 - b0)) % m2;
+		a0 = a1; a1 = a2; a2 = p1;
+		b0 = b1; b1 = b2; b2 = p2;
+
+		*first = static_cast<result_type>( p1 > p2 ? p1 - p2 : p1 + m1 - p2 );
+	}
+
+	x1[0] = static_cast<boost::uint32_t>(a0);
+	x1[1] = static_cast<boost::uint32_t>(a1);
+	x1[2] = static_cast<boost::uint32_t>(a2);
+	x2[0] = static_cast<boost::uint32_t>(b0);
+	x2[1] = static_cast<boost::uint32_t>(b1);
+	x2[2] = static_cast<boost::uint32_t>(b2);
+}
+
+// discard
+template<typename UIntType, typename Name>
+void mrg32k3a_engine<UIntType, Name>::discard(boost::uint64_t z)
+{
+	current.apply( detail::mrg32k3a_matrix(detail::mrg32k3a_A1).pow(z, m1),
+				   detail::mrg32k3a_matrix(detail::mrg32k3a_A2).pow(z, m2) );
+}
+
+// jump_substreams
+template<typename UIntType, typename Name>
+void mrg32k3a_engine<UIntType, Name>::jump_substreams(boost::uint64_t j)
+{
+	substream_start.apply( detail::mrg32k3a_matrix(detail::mrg32k3a_A1p76).pow(j, m1),
+						   detail::mrg32k3a_matrix(detail::mrg32k3a_A2p76).pow(j, m2) );
+	current = substream_start;
+}
+
+// jump_streams
+template<typename UIntType, typename Name>
+void mrg32k3a_engine<UIntType, Name>::jump_streams(boost::uint64_t j)
+{
+	stream_start.apply( detail::mrg32k3a_matrix(detail::mrg32k3a_A1p127).pow(j, m1),
+						detail::mrg32k3a_matrix(detail::mrg32k3a_A2p127).pow(j, m2) );
+	substream_start = current = stream_start;
+}
+
+/* engine name */
+
+//! \cond
+namespace detail {
+
+typedef boost::mpl::string<'M', 'R', 'G', '3', '2', 'k', '3', 'a'>::type mrg32k3a_name;
+
+}	// namespace detail
+//! \endcond
+
+//! MRG32k3a with 32 bit output
+typedef mrg32k3a_engine<boost::uint32_t, detail::mrg32k3a_name> mrg32k3a;
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_MRG32K3A_HPP
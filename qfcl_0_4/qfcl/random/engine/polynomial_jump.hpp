@@ -0,0 +1,232 @@
+/* qfcl/random/engine/polynomial_jump.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_ENGINE_POLYNOMIAL_JUMP_HPP
+#define QFCL_RANDOM_ENGINE_POLYNOMIAL_JUMP_HPP
+
+/*! \file qfcl/random/engine/polynomial_jump.hpp
+	\brief jumping ahead in a GF(2)-linear recursion by a polynomial, as in SFMT-jump (Haramoto et al., 2008)
+
+	If the recursion has transition \f$A\f$ with minimal polynomial \f$\varphi\f$, then \f$J\f$ steps are
+	\f$A^J s = q(A) s\f$ where \f$q(t) = t^J \bmod \varphi\f$, a polynomial of degree less than the
+	number of state bits. \f$q(A) s\f$ is computed by stepping a copy of \f$s\f$ and adding it up at the
+	nonzero coefficients of \f$q\f$, so a jump of any size costs about as much as generating
+	\f$\deg \varphi\f$ words, with no matrices.
+
+	\f$\varphi\f$ is obtained by the Berlekamp-Massey algorithm from a few output bits of a few seeds, so
+	no tables of polynomials are needed. Jump polynomials are interchanged as strings in the format of the reference
+	SFMT-jump and dSFMT-jump code: hexadecimal digits, with bit \f$j\f$ of digit \f$i\f$ the coefficient
+	of \f$t^{4i+j}\f$.
+
+	A recursion is exposed through a \em ring type, which has
+	- \c state_bits, an upper bound on the degree of \f$\varphi\f$,
+	- \c next(), one step of the recursion,
+	- \c add(r), adding the state of \c r,
+	- \c clear() and \c is_zero(),
+	- \c bit(b), bit \p b of the word generated by the last step, for <tt>b < 128</tt>.
+
+	The polynomials are returned through reference arguments, in the style of NTL, since the implicit
+	copy constructor of \c NTL::GF2X is deprecated.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <NTL/GF2X.h>
+#include <NTL/vec_GF2.h>
+#include <NTL/ZZ.h>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+namespace detail {
+
+//! \p phi becomes the least common multiple of \p phi and \p f
+inline void lcm_with(NTL::GF2X & phi, const NTL::GF2X & f)
+{
+	NTL::GF2X g, h;
+	NTL::GCD(g, phi, f);
+	NTL::div(h, f, g);
+	NTL::mul(phi, phi, h);
+}
+
+//! \f$q(A) s\f$, where \p s is the state of \p r
+template<typename Ring>
+void apply_polynomial(Ring & r, const NTL::GF2X & q)
+{
+	Ring work = r;
+	r.clear();
+
+	for (long i = 0; i <= NTL::deg(q); ++i)
+	{
+		if ( NTL::IsOne( NTL::coeff(q, i) ) )
+			r.add(work);
+		if (i < NTL::deg(q))
+			work.next();
+	}
+}
+
+//! \p phi becomes the polynomial that annihilates the state of \p r and all states after it, from the output bits \p probes
+template<typename Ring>
+void annihilator(NTL::GF2X & phi, Ring r, const std::size_t * probes, std::size_t nprobes)
+{
+	const long k = static_cast<long>(Ring::state_bits);
+
+	std::vector<NTL::vec_GF2> seq(nprobes);
+	for (std::size_t b = 0; b < nprobes; ++b)
+		seq[b].SetLength(2 * k);
+
+	for (long i = 0; i < 2 * k; ++i)
+	{
+		r.next();
+		for (std::size_t b = 0; b < nprobes; ++b)
+			seq[b].put( i, r.bit(probes[b]) );
+	}
+
+	// the least common multiple of the minimal polynomials of the bit sequences
+	NTL::set(phi);
+	for (std::size_t b = 0; b < nprobes; ++b)
+	{
+		NTL::GF2X f;
+		NTL::MinPolySeq(f, seq[b], k);
+		lcm_with(phi, f);
+	}
+}
+
+//! the minimal polynomial of the recursion of \c Ring on the span of the states \p rs and those after them
+/*! The polynomial of a single generic state can miss factors that other states have, e.g. those of
+	the constant bits of dSFMT, so the least common multiple is taken over all of \p rs. The output
+	bits are those of a few probe positions; if they miss a factor (which the check
+	\f$\varphi(A) r = 0\f$ detects), all 128 bits are used.
+	\throw std::logic_error if no annihilating polynomial of degree at most \c state_bits is found
+*/
+template<typename Ring>
+void minimal_polynomial(NTL::GF2X & phi, const std::vector<Ring> & rs)
+{
+	static const std::size_t probes[] = {0, 31, 32, 63, 64, 95, 96, 127};
+	std::size_t all[128];
+	for (std::size_t b = 0; b < 128; ++b)
+		all[b] = b;
+
+	NTL::set(phi);
+	for (std::size_t j = 0; j < rs.size(); ++j)
+	{
+		for (int attempt = 0; ; ++attempt)
+		{
+			Ring check = rs[j];
+			apply_polynomial(check, phi);
+			if ( check.is_zero() )
+				break;
+			if (attempt == 2)
+				throw std::logic_error("minimal_polynomial: the recursion is not linear or state_bits is too small");
+
+			NTL::GF2X f;
+			if (attempt == 0)
+				annihilator( f, rs[j], probes, sizeof(probes) / sizeof(probes[0]) );
+			else
+				annihilator(f, rs[j], all, 128);
+			lcm_with(phi, f);
+		}
+	}
+}
+
+//! the minimal polynomial of \c minimal_polynomial, prepared for reductions modulo it
+template<typename Ring>
+struct minimal_modulus
+{
+	explicit minimal_modulus(const std::vector<Ring> & rs)
+	{
+		NTL::GF2X f;
+		minimal_polynomial(f, rs);
+		NTL::build(phi, f);
+	}
+
+	NTL::GF2XModulus phi;
+};
+
+//! \p z as an \c NTL::ZZ, which only converts from \c long
+inline NTL::ZZ to_ZZ(unsigned long long z)
+{
+	NTL::ZZ J;
+	for (int shift = 48; shift >= 0; shift -= 16)
+	{
+		J <<= 16;
+		J += static_cast<long>( (z >> shift) & 0xFFFF );
+	}
+	return J;
+}
+
+//! \p q becomes \f$t^J \bmod \varphi\f$
+inline void jump_polynomial(NTL::GF2X & q, const NTL::ZZ & J, const NTL::GF2XModulus & phi)
+{
+	NTL::PowerXMod(q, J, phi);
+}
+
+//! \p q in the SFMT-jump string format
+inline std::string to_jump_string(const NTL::GF2X & q)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	std::string s;
+	for (long i = 0; i <= NTL::deg(q); i += 4)
+	{
+		int d = 0;
+		for (long j = 0; j < 4; ++j)
+			if ( NTL::IsOne( NTL::coeff(q, i + j) ) )
+				d |= 1 << j;
+		s += digits[d];
+	}
+
+	return s.empty() ? std::string("0") : s;
+}
+
+//! \p q becomes the polynomial of a string in the SFMT-jump format
+/*! \throw std::invalid_argument on a character that is not a hexadecimal digit
+*/
+inline void from_jump_string(NTL::GF2X & q, const char * s)
+{
+	NTL::clear(q);
+	for (long i = 0; s[i] != '\0'; ++i)
+	{
+		int d;
+		const char c = s[i];
+		if (c >= '0' && c <= '9')
+			d = c - '0';
+		else if (c >= 'a' && c <= 'f')
+			d = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			d = c - 'A' + 10;
+		else
+			throw std::invalid_argument("jump string: not a hexadecimal digit");
+
+		for (long j = 0; j < 4; ++j)
+			if ( (d >> j) & 1 )
+				NTL::SetCoeff(q, 4 * i + j);
+	}
+}
+
+}	// namespace detail
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_ENGINE_POLYNOMIAL_JUMP_HPP
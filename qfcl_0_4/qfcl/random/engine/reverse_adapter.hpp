@@ -19,7 +19,9 @@
 	\date February 29, 2012
 */
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include <boost/mpl/string.hpp>
 
@@ -34,6 +36,10 @@ namespace {
 
 typedef boost::mpl::string<'R', 'e', 'v', 'e', 'r', 's', 'e', '-'>::type _reverse_prefix;
 }	// anonymous namespace
+
+namespace detail {
+struct snapshot_access;
+}	// namespace detail
 //! \endcond
 
 /*! \ingroup random
@@ -92,10 +98,32 @@ public:
 	}
 	// note that overflow occurs iff v == numeric_limits<unsigned long long>::max()
 	result_type reverse_peek(unsigned long long v) const {return e.peek(v + 1);}
+	// peek(v) is e.peek(1 - v), so the offsets of e are visited backwards
+	template<typename InIt, typename OutIt>
+	OutIt peek_many(InIt first, InIt last, OutIt dest) const
+	{
+		std::vector<long long> offsets;
+		for (; first != last; ++first)
+			offsets.push_back( 1 - static_cast<long long>(*first) );
+
+		std::vector<result_type> values( offsets.size() );
+		e.peek_many( offsets.rbegin(), offsets.rend(), values.rbegin() );
+
+		return std::copy( values.begin(), values.end(), dest );
+	}
+	std::vector<result_type> peek_many(const std::vector<long long> & offsets) const
+	{
+		std::vector<result_type> values( offsets.size() );
+		peek_many( offsets.begin(), offsets.end(), values.begin() );
+		return values;
+	}
 	
 	void discard(unsigned long long v) {e.reverse_discard(v);}
 	void reverse_discard(unsigned long long v) {e.discard(v);}
 
+	//! that of the underlying engine
+	static const unsigned long long step_limit = Engine::step_limit;
+
 	// use perfect forwarding for seeding
 	void seed() {e.seed();}
 
@@ -133,6 +161,9 @@ public:
 
 	typedef typename qfcl::tmp::concatenate<_reverse_prefix, typename Engine::name>::type name;
 //	typedef typename Engine::parameter parameter;
+
+	//! binary snapshots store the state of the adapted engine
+	friend struct detail::snapshot_access;
 private:
 	Engine e;
 };
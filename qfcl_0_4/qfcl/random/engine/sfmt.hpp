@@ -0,0 +1,573 @@
+/* qfcl/random/engine/sfmt.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_SFMT_HPP
+#define QFCL_RANDOM_SFMT_HPP
+
+/*! \file qfcl/random/engine/sfmt.hpp
+	\brief The SIMD-oriented Fast Mersenne Twister of Saito and Matsumoto
+
+	M. Saito and M. Matsumoto, "SIMD-oriented Fast Mersenne Twister: a 128-bit Pseudorandom Number
+	Generator", Monte Carlo and Quasi-Monte Carlo Methods 2006, Springer, 2008.
+
+	The state is an array of \f$n\f$ 128 bit words, and each new word is
+	\f[ w_{i+n} = w_i \oplus (w_i \ll_{128} 8\, sl_2) \oplus ((w_{i+pos_1} \gg_{32} sr_1) \,\&\, msk)
+		\oplus (w_{i+n-2} \gg_{128} 8\, sr_2) \oplus (w_{i+n-1} \ll_{32} sl_1), \f]
+	where \f$\ll_{32}\f$ shifts each 32 bit part and \f$\ll_{128}\f$ the whole word. A whole block of
+	\f$n\f$ words is generated at once, with SSE2 when available (unless \c QFCL_MATH_NO_INTRINSICS is
+	defined), and the 32 bit outputs are read from it; \c fill generates directly into the caller's
+	array instead.
+
+	Jumps use the polynomial method of SFMT-jump (see polynomial_jump.hpp), and accept the jump
+	polynomials published for the reference implementation.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/mpl/string.hpp>
+
+#include <NTL/GF2X.h>
+#include <NTL/ZZ.h>
+
+#include <qfcl/utility/tmp.hpp>
+
+#include "polynomial_jump.hpp"
+
+#if !defined(QFCL_MATH_NO_INTRINSICS) && (defined(__SSE2__) || defined(_M_X64))
+#define QFCL_RANDOM_SSE2_SFMT
+#include <emmintrin.h>
+#endif
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! SFMT parameters
+/*! \tparam mexp	Mersenne exponent of the period \f$2^{mexp} - 1\f$
+	\tparam pos1	the middle word \f$w_{i+pos_1}\f$
+	\tparam sl1, sr1	shifts of 32 bit parts
+	\tparam sl2, sr2	shifts of 128 bit words, in bytes
+	\tparam msk1, msk2, msk3, msk4	mask of \f$w_{i+pos_1}\f$, lowest 32 bits first
+	\tparam parity1, parity2, parity3, parity4	period certification vector
+*/
+template<std::size_t mexp, std::size_t pos1, int sl1, int sl2, int sr1, int sr2,
+		 boost::uint32_t msk1, boost::uint32_t msk2, boost::uint32_t msk3, boost::uint32_t msk4,
+		 boost::uint32_t parity1, boost::uint32_t parity2, boost::uint32_t parity3, boost::uint32_t parity4,
+		 typename Name>
+struct sfmt_traits
+{
+	static const std::size_t	exponent = mexp;
+	//! number of 128 bit words
+	static const std::size_t	n = mexp / 128 + 1;
+	static const std::size_t	middle = pos1;
+	static const int			shift_left_1 = sl1, shift_left_2 = sl2, shift_right_1 = sr1, shift_right_2 = sr2;
+	static const boost::uint32_t	mask1 = msk1, mask2 = msk2, mask3 = msk3, mask4 = msk4;
+
+	static const boost::uint32_t * parity()
+	{
+		static const boost::uint32_t p[4] = {parity1, parity2, parity3, parity4};
+		return p;
+	}
+
+	static const boost::uint32_t	default_seed = 5489u;
+
+	//! engine name
+	typedef Name name;
+};
+
+namespace detail {
+
+#ifdef QFCL_RANDOM_SSE2_SFMT
+typedef __m128i sfmt_word;
+
+inline sfmt_word sfmt_load(const boost::uint32_t * p) {return _mm_loadu_si128( reinterpret_cast<const __m128i *>(p) );}
+inline void sfmt_store(boost::uint32_t * p, sfmt_word w) {_mm_storeu_si128(reinterpret_cast<__m128i *>(p), w);}
+#else
+//! a 128 bit word, lowest 32 bits first
+struct sfmt_word {boost::uint32_t u[4];};
+
+inline sfmt_word sfmt_load(const boost::uint32_t * p) {sfmt_word w; std::copy(p, p + 4, w.u); return w;}
+inline void sfmt_store(boost::uint32_t * p, const sfmt_word & w) {std::copy(w.u, w.u + 4, p);}
+#endif
+
+//! the scrambling functions of \c init_by_array
+inline boost::uint32_t sfmt_init_f1(boost::uint32_t y) {return ( y ^ (y >> 27) ) * UINT32_C(1664525);}
+inline boost::uint32_t sfmt_init_f2(boost::uint32_t y) {return ( y ^ (y >> 27) ) * UINT32_C(1566083941);}
+
+//! \c init_gen_rand of SFMT and dSFMT, on the \p size 32 bit parts of the state
+inline void sfmt_init_gen_rand(boost::uint32_t * x, std::size_t size, boost::uint32_t seed_)
+{
+	x[0] = seed_;
+	for (std::size_t j = 1; j < size; ++j)
+		x[j] = UINT32_C(1812433253) * ( x[j - 1] ^ (x[j - 1] >> 30) ) + static_cast<boost::uint32_t>(j);
+}
+
+//! \c init_by_array of SFMT and dSFMT, on the \p size 32 bit parts of the state
+inline void sfmt_init_by_array(boost::uint32_t * x, std::size_t size, const std::vector<boost::uint32_t> & key)
+{
+	const std::size_t lag = size >= 623 ? 11 : size >= 68 ? 7 : size >= 39 ? 5 : 3;
+	const std::size_t mid = (size - lag) / 2;
+
+	std::fill(x, x + size, 0x8b8b8b8b);
+	const std::size_t count = std::max(key.size() + 1, size);
+
+	boost::uint32_t r = sfmt_init_f1( x[0] ^ x[mid] ^ x[size - 1] );
+	x[mid] += r;
+	r += static_cast<boost::uint32_t>( key.size() );
+	x[mid + lag] += r;
+	x[0] = r;
+
+	std::size_t i = 1, j = 0;
+	for (; j < count - 1; ++j)
+	{
+		r = sfmt_init_f1( x[i] ^ x[(i + mid) % size] ^ x[(i + size - 1) % size] );
+		x[(i + mid) % size] += r;
+		r += (j < key.size() ? key[j] : 0) + static_cast<boost::uint32_t>(i);
+		x[(i + mid + lag) % size] += r;
+		x[i] = r;
+		i = (i + 1) % size;
+	}
+	for (j = 0; j < size; ++j)
+	{
+		r = sfmt_init_f2( x[i] + x[(i + mid) % size] + x[(i + size - 1) % size] );
+		x[(i + mid) % size] ^= r;
+		r -= static_cast<boost::uint32_t>(i);
+		x[(i + mid + lag) % size] ^= r;
+		x[i] = r;
+		i = (i + 1) % size;
+	}
+}
+
+}	// namespace detail
+
+//! SIMD-oriented Fast Mersenne Twister, generating 32 bit integers
+/*! The sequence, seeding and jump polynomials are those of the reference implementation, SFMT 1.5:
+	the \c seed(boost::uint32_t) and \c seed(It, It) are its \c init_gen_rand and \c init_by_array.
+
+	The state is the last block of \c n words generated, of which the first \c idx 32 bit parts have been
+	output. A jump of \f$J\f$ words moves the whole block ahead, so it advances the output by \f$4J\f$.
+*/
+template<typename Traits>
+class sfmt_engine
+{
+public:
+	typedef boost::uint32_t result_type;
+	typedef typename Traits::name name;
+	typedef Traits traits_type;
+
+	//! number of 128 bit words, and of 32 bit outputs, in a block
+	static const std::size_t n = Traits::n;
+	static const std::size_t n32 = 4 * n;
+	//! number of bits of the state
+	static const std::size_t state_bits = 128 * n;
+	//! \c discard jumps by a polynomial beyond this many outputs, and otherwise generates them
+	static const unsigned long long discard_threshold = 1ULL << 26;
+
+	//! ctor
+	/*! \sa seed(boost::uint32_t)
+	*/
+	explicit sfmt_engine(boost::uint32_t seed_ = Traits::default_seed) {seed(seed_);}
+	//! constructor taking an arbitrarily long sequence of seeds
+	template<typename It>
+	sfmt_engine(It begin, It end) {seed(begin, end);}
+
+	static result_type min() {return 0;}
+	static result_type max() {return 0xFFFFFFFF;}
+
+	//! \c init_gen_rand of the reference implementation
+	void seed(boost::uint32_t seed_ = Traits::default_seed);
+	//! \c init_by_array of the reference implementation
+	template<typename It>
+	void seed(It begin, It end);
+
+	//! generate a random number
+	result_type operator()()
+	{
+		if (idx >= n32)
+		{
+			gen_rand_all();
+			idx = 0;
+		}
+		return x[idx++];
+	}
+
+	//! fills <tt>[first, last)</tt> with the next random numbers
+	template<typename OutIt>
+	void generate(OutIt first, OutIt last);
+
+	//! writes the next \p size random numbers to \p array
+	/*! The same numbers, and state, as \p size calls of \c operator(), but whole blocks are generated
+		directly in \p array, which need not be aligned.
+	*/
+	void fill(result_type * array, std::size_t size);
+
+	//! skips \p z numbers
+	/*! Beyond \c discard_threshold, by a polynomial jump of whole blocks. The state is then the same as
+		after generating \p z numbers.
+	*/
+	void discard(unsigned long long z);
+
+	//! advances the state by the polynomial \p jump_string, in the format of SFMT-jump
+	/*! For the string of <tt>jump_string(J)</tt>, or one published with the reference implementation
+		for a jump of \f$J\f$ words, this skips \f$4J\f$ numbers. Unless \f$J\f$ is a multiple of \c n,
+		the block is then not aligned with that of the engine that generated the numbers, so they
+		compare unequal although they generate the same sequence.
+		\throw std::invalid_argument if \p jump_string has a character that is not a hexadecimal digit
+	*/
+	void jump(const char * jump_string)
+	{
+		NTL::GF2X q;
+		detail::from_jump_string(q, jump_string);
+		jump_by(q);
+	}
+	//! the jump polynomial of \p J 128 bit words
+	static std::string jump_string(const NTL::ZZ & J)
+	{
+		NTL::GF2X q;
+		detail::jump_polynomial( q, J, minimal_polynomial() );
+		return detail::to_jump_string(q);
+	}
+
+	//! the minimal polynomial of the recursion on the seeded states, computed on first use
+	static const NTL::GF2XModulus & minimal_polynomial()
+	{
+		static const detail::minimal_modulus<ring> m( seeded_rings() );
+		return m.phi;
+	}
+
+	friend bool operator==(const sfmt_engine & e1, const sfmt_engine & e2)
+	{
+		return e1.idx == e2.idx && std::equal(e1.x, e1.x + n32, e2.x);
+	}
+	friend bool operator!=(const sfmt_engine & e1, const sfmt_engine & e2) {return !(e1 == e2);}
+
+	//! outputs the state: the \c n32 32 bit parts of the block followed by \c idx
+	template<typename charT, typename Traits_>
+	friend std::basic_ostream<charT, Traits_> &
+	operator<<(std::basic_ostream<charT, Traits_> & os, const sfmt_engine & eng)
+	{
+		for (std::size_t j = 0; j < n32; ++j)
+			os << eng.x[j] << ' ';
+		return os << eng.idx;
+	}
+	//! reads the state written by \c operator<<
+	template<typename charT, typename Traits_>
+	friend std::basic_istream<charT, Traits_> &
+	operator>>(std::basic_istream<charT, Traits_> & is, sfmt_engine & eng)
+	{
+		for (std::size_t j = 0; j < n32; ++j)
+			is >> eng.x[j] >> std::ws;
+		return is >> eng.idx;
+	}
+private:
+	//! the block, in 32 bit parts
+	boost::uint32_t x[n32];
+	//! number of parts of the block already output
+	std::size_t idx;
+
+	//! the next word, from \f$w_i, w_{i+pos_1}, w_{i+n-2}, w_{i+n-1}\f$
+	static detail::sfmt_word recursion(detail::sfmt_word a, detail::sfmt_word b, detail::sfmt_word c, detail::sfmt_word d);
+
+	//! replaces the block with the next one
+	void gen_rand_all();
+	//! generates \p m \f$\geq n\f$ words in \p array, and makes the last \c n of them the block
+	void gen_rand_array(boost::uint32_t * array, std::size_t m);
+	//! makes the period \f$2^{mexp} - 1\f$ by flipping a bit, if necessary
+	void period_certification();
+
+	void jump_by(const NTL::GF2X & q);
+
+	struct ring;
+	//! the states of a few seeds, to find the minimal polynomial
+	static std::vector<ring> seeded_rings()
+	{
+		std::vector<ring> rs;
+		for (boost::uint32_t s = 1; s <= 16; ++s)
+			rs.push_back( ring( sfmt_engine(s) ) );
+		return rs;
+	}
+
+	//! the block as a circular buffer starting at word \c start, see polynomial_jump.hpp
+	struct ring
+	{
+		static const std::size_t state_bits = sfmt_engine::state_bits;
+
+		boost::uint32_t x[n32];
+		std::size_t start;
+
+		explicit ring(const sfmt_engine & eng) : start(0) {std::copy(eng.x, eng.x + n32, x);}
+
+		boost::uint32_t * word(std::size_t j) {return x + 4 * ( (start + j) % n );}
+		const boost::uint32_t * word(std::size_t j) const {return x + 4 * ( (start + j) % n );}
+
+		void next()
+		{
+			detail::sfmt_store( word(0), recursion( detail::sfmt_load( word(0) ), detail::sfmt_load( word(Traits::middle) ),
+													detail::sfmt_load( word(n - 2) ), detail::sfmt_load( word(n - 1) ) ) );
+			start = (start + 1) % n;
+		}
+		void add(const ring & r)
+		{
+			for (std::size_t j = 0; j < n; ++j)
+				for (int k = 0; k < 4; ++k)
+					word(j)[k] ^= r.word(j)[k];
+		}
+		void clear() {std::fill(x, x + n32, 0);}
+		bool is_zero() const {return std::count(x, x + n32, 0u) == static_cast<std::ptrdiff_t>(n32);}
+		bool bit(std::size_t b) const {return ( ( word(n - 1)[b / 32] >> (b % 32) ) & 1 ) != 0;}
+	};
+};
+
+/* member functions */
+
+// recursion
+template<typename Traits>
+inline detail::sfmt_word
+sfmt_engine<Traits>::recursion(detail::sfmt_word a, detail::sfmt_word b, detail::sfmt_word c, detail::sfmt_word d)
+{
+#ifdef QFCL_RANDOM_SSE2_SFMT
+	const __m128i mask = _mm_set_epi32( static_cast<int>(Traits::mask4), static_cast<int>(Traits::mask3),
+										static_cast<int>(Traits::mask2), static_cast<int>(Traits::mask1) );
+
+	__m128i z = _mm_xor_si128( a, _mm_slli_si128(a, Traits::shift_left_2) );
+	z = _mm_xor_si128( z, _mm_and_si128(_mm_srli_epi32(b, Traits::shift_right_1), mask) );
+	z = _mm_xor_si128( z, _mm_srli_si128(c, Traits::shift_right_2) );
+	return _mm_xor_si128( z, _mm_slli_epi32(d, Traits::shift_left_1) );
+#else
+	const boost::uint32_t mask[4] = {Traits::mask1, Traits::mask2, Traits::mask3, Traits::mask4};
+
+	// the 128 bit shifts, in 64 bit halves
+	const int sl2 = 8 * Traits::shift_left_2, sr2 = 8 * Traits::shift_right_2;
+	const boost::uint64_t ah = (static_cast<boost::uint64_t>(a.u[3]) << 32) | a.u[2];
+	const boost::uint64_t al = (static_cast<boost::uint64_t>(a.u[1]) << 32) | a.u[0];
+	const boost::uint64_t ch = (static_cast<boost::uint64_t>(c.u[3]) << 32) | c.u[2];
+	const boost::uint64_t cl = (static_cast<boost::uint64_t>(c.u[1]) << 32) | c.u[0];
+	const boost::uint64_t xh = (ah << sl2) | (al >> (64 - sl2)), xl = al << sl2;
+	const boost::uint64_t yh = ch >> sr2, yl = (cl >> sr2) | (ch << (64 - sr2));
+	const boost::uint32_t xs[4] = { static_cast<boost::uint32_t>(xl), static_cast<boost::uint32_t>(xl >> 32),
+									static_cast<boost::uint32_t>(xh), static_cast<boost::uint32_t>(xh >> 32) };
+	const boost::uint32_t ys[4] = { static_cast<boost::uint32_t>(yl), static_cast<boost::uint32_t>(yl >> 32),
+									static_cast<boost::uint32_t>(yh), static_cast<boost::uint32_t>(yh >> 32) };
+
+	detail::sfmt_word r;
+	for (int k = 0; k < 4; ++k)
+		r.u[k] = a.u[k] ^ xs[k] ^ ( (b.u[k] >> Traits::shift_right_1) & mask[k] ) ^ ys[k] ^ (d.u[k] << Traits::shift_left_1);
+	return r;
+#endif
+}
+
+// gen_rand_all
+template<typename Traits>
+void sfmt_engine<Traits>::gen_rand_all()
+{
+	using detail::sfmt_load;
+	using detail::sfmt_store;
+	const std::size_t pos1 = Traits::middle;
+
+	detail::sfmt_word r1 = sfmt_load( x + 4 * (n - 2) ), r2 = sfmt_load( x + 4 * (n - 1) );
+	std::size_t i = 0;
+	for (; i < n - pos1; ++i)
+	{
+		const detail::sfmt_word r = recursion( sfmt_load(x + 4 * i), sfmt_load( x + 4 * (i + pos1) ), r1, r2 );
+		sfmt_store(x + 4 * i, r);
+		r1 = r2;
+		r2 = r;
+	}
+	for (; i < n; ++i)
+	{
+		const detail::sfmt_word r = recursion( sfmt_load(x + 4 * i), sfmt_load( x + 4 * (i + pos1 - n) ), r1, r2 );
+		sfmt_store(x + 4 * i, r);
+		r1 = r2;
+		r2 = r;
+	}
+}
+
+// gen_rand_array
+template<typename Traits>
+void sfmt_engine<Traits>::gen_rand_array(boost::uint32_t * array, std::size_t m)
+{
+	using detail::sfmt_load;
+	using detail::sfmt_store;
+	const std::size_t pos1 = Traits::middle;
+
+	detail::sfmt_word r1 = sfmt_load( x + 4 * (n - 2) ), r2 = sfmt_load( x + 4 * (n - 1) );
+	std::size_t i = 0;
+	// the first block from the state
+	for (; i < n - pos1; ++i)
+	{
+		const detail::sfmt_word r = recursion( sfmt_load(x + 4 * i), sfmt_load( x + 4 * (i + pos1) ), r1, r2 );
+		sfmt_store(array + 4 * i, r);
+		r1 = r2;
+		r2 = r;
+	}
+	for (; i < n; ++i)
+	{
+		const detail::sfmt_word r = recursion( sfmt_load(x + 4 * i), sfmt_load( array + 4 * (i + pos1 - n) ), r1, r2 );
+		sfmt_store(array + 4 * i, r);
+		r1 = r2;
+		r2 = r;
+	}
+	// the rest from the array
+	for (; i < m; ++i)
+	{
+		const detail::sfmt_word r = recursion( sfmt_load( array + 4 * (i - n) ), sfmt_load( array + 4 * (i + pos1 - n) ), r1, r2 );
+		sfmt_store(array + 4 * i, r);
+		r1 = r2;
+		r2 = r;
+	}
+
+	std::copy( array + 4 * (m - n), array + 4 * m, x );
+}
+
+// period_certification
+template<typename Traits>
+void sfmt_engine<Traits>::period_certification()
+{
+	const boost::uint32_t * parity = Traits::parity();
+
+	boost::uint32_t inner = 0;
+	for (int k = 0; k < 4; ++k)
+		inner ^= x[k] & parity[k];
+	for (int s = 16; s > 0; s >>= 1)
+		inner ^= inner >> s;
+	if (inner & 1)
+		return;
+
+	// flip the lowest bit of the parity vector
+	for (int k = 0; k < 4; ++k)
+		if (parity[k] != 0)
+		{
+			x[k] ^= parity[k] & (~parity[k] + 1);
+			return;
+		}
+}
+
+// seed
+template<typename Traits>
+void sfmt_engine<Traits>::seed(boost::uint32_t seed_)
+{
+	detail::sfmt_init_gen_rand(x, n32, seed_);
+	idx = n32;
+	period_certification();
+}
+
+// seed
+template<typename Traits>
+template<typename It>
+void sfmt_engine<Traits>::seed(It begin, It end)
+{
+	detail::sfmt_init_by_array( x, n32, std::vector<boost::uint32_t>(begin, end) );
+	idx = n32;
+	period_certification();
+}
+
+// generate
+template<typename Traits>
+template<typename OutIt>
+void sfmt_engine<Traits>::generate(OutIt first, OutIt last)
+{
+	for (; first != last; ++first)
+		*first = (*this)();
+}
+
+// fill
+template<typename Traits>
+void sfmt_engine<Traits>::fill(result_type * array, std::size_t size)
+{
+	// what is left of the block
+	std::size_t j = std::min<std::size_t>( size, idx < n32 ? n32 - idx : 0 );
+	std::copy(x + idx, x + idx + j, array);
+	idx += j;
+
+	// whole blocks, directly into the array
+	const std::size_t blocks = (size - j) / n32;
+	if (blocks > 0)
+	{
+		gen_rand_array(array + j, blocks * n);
+		j += blocks * n32;
+		idx = n32;
+	}
+
+	for (; j < size; ++j)
+		array[j] = (*this)();
+}
+
+// discard
+template<typename Traits>
+void sfmt_engine<Traits>::discard(unsigned long long z)
+{
+	if (z > discard_threshold)
+	{
+		// whole blocks, so that the state is the same as after generating the numbers
+		NTL::GF2X q;
+		detail::jump_polynomial( q, detail::to_ZZ(z / n32 * n), minimal_polynomial() );
+		jump_by(q);
+		z %= n32;
+	}
+
+	while (z > 0)
+	{
+		if (idx >= n32)
+		{
+			gen_rand_all();
+			idx = 0;
+		}
+		const std::size_t j = static_cast<std::size_t>( std::min<unsigned long long>(z, n32 - idx) );
+		idx += j;
+		z -= j;
+	}
+}
+
+// jump_by
+template<typename Traits>
+void sfmt_engine<Traits>::jump_by(const NTL::GF2X & q)
+{
+	ring r(*this);
+	detail::apply_polynomial(r, q);
+	std::copy(r.x, r.x + n32, x);
+}
+
+/* engine names */
+
+//! \cond
+namespace detail {
+
+typedef boost::mpl::string<'S', 'F', 'M', 'T'>::type _sfmt_prefix;
+typedef qfcl::tmp::concatenate< _sfmt_prefix, boost::mpl::string<'1', '9', '9', '3', '7'>::type >::type sfmt19937_name;
+
+}	// namespace detail
+//! \endcond
+
+//! SFMT with period \f$2^{19937} - 1\f$
+typedef sfmt_engine< sfmt_traits< 19937, 122, 18, 1, 11, 1,
+								  0xdfffffefU, 0xddfecb7fU, 0xbffaffffU, 0xbffffff6U,
+								  0x00000001U, 0x00000000U, 0x00000000U, 0x13c9e684U,
+								  detail::sfmt19937_name > > sfmt19937;
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_SFMT_HPP
@@ -0,0 +1,491 @@
+/* qfcl/random/engine/snapshot.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_SNAPSHOT_HPP
+#define QFCL_RANDOM_SNAPSHOT_HPP
+
+/*! \file qfcl/random/engine/snapshot.hpp
+	\brief Binary checkpoint and restore of engine states.
+
+	A snapshot is a fixed, endian-neutral image of an engine state: a 32 byte
+	\c snapshot_header followed by \c word_count little-endian words of
+	\c word_bytes bytes each. Unlike the stream operators, which write the state
+	as decimal text and reconstruct it through \c rewind_imp, the raw state
+	is copied in and out directly.
+
+	\c restore_snapshot reads straight from the given buffer, so a checkpoint file
+	can be memory mapped and engines restored from it with no parsing and no intermediate copy.
+	Both \c save_snapshot and \c restore_snapshot return one past the end of the snapshot,
+	so the snapshots of many engines are simply laid out back to back.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/endian/integers.hpp>
+#include <boost/mpl/string.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/counter_based_urng.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+#include "linear_generator.hpp"
+#include "reverse_adapter.hpp"
+
+namespace boost {
+namespace random {
+
+// the counter based PRFs, for \c detail::prf_snapshot_traits
+template<unsigned N, typename Uint, unsigned R, typename Constants> struct philox;
+template<unsigned N, typename Uint, unsigned R, typename Constants> struct threefry;
+template<typename Uint, unsigned R, typename Constants> struct ars;
+template<typename Uint> struct aes;
+
+}	// namespace random
+}	// namespace boost
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! the fixed layout header preceding every engine snapshot
+struct snapshot_header
+{
+	//! the bytes "QFSN"
+	static const boost::uint32_t magic_number = 0x4E534651;
+	//! the layout version written by \c save_snapshot
+	static const boost::uint16_t current_version = 1;
+
+	boost::endian::ulittle32_t magic;
+	boost::endian::ulittle16_t version;
+	//! size in bytes of each state word
+	boost::endian::ulittle16_t word_bytes;
+	//! number of state words following the header
+	boost::endian::ulittle32_t word_count;
+	//! position within the state, e.g. the index of the next word to be generated
+	boost::endian::ulittle32_t position;
+	//! fingerprint of the engine type
+	boost::endian::ulittle64_t engine_id;
+	//! reserved, always 0
+	boost::endian::ulittle64_t reserved;
+};
+
+BOOST_STATIC_ASSERT( sizeof(snapshot_header) == 32 );
+
+//! \cond
+namespace detail {
+
+//! 64-bit FNV-1a hash of a C string
+inline boost::uint64_t snapshot_hash(const char * s, boost::uint64_t h = 14695981039346656037ULL)
+{
+	for (; *s; ++s)
+	{
+		h ^= static_cast<unsigned char>(*s);
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+//! 64-bit FNV-1a hash of an integer, taken over its little-endian bytes
+inline boost::uint64_t snapshot_hash(boost::uint64_t v, boost::uint64_t h)
+{
+	for (size_t k = 0; k < 8; ++k, v >>= 8)
+	{
+		h ^= v & 0xFF;
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+//! fingerprint of a model of the Named concept
+template<typename Engine>
+inline boost::uint64_t named_snapshot_id()
+{
+	return snapshot_hash( boost::mpl::c_str<typename Engine::name>::value );
+}
+
+template<typename UIntType>
+inline char * store_words(const UIntType * first, size_t count, char * dest)
+{
+	BOOST_STATIC_ASSERT( boost::is_integral<UIntType>::value );
+#ifdef BOOST_LITTLE_ENDIAN
+	std::memcpy( dest, first, count * sizeof(UIntType) );
+#else
+	for (size_t k = 0; k < count; ++k)
+		boost::detail::store_little_endian<UIntType, sizeof(UIntType)>( dest + k * sizeof(UIntType), first[k] );
+#endif
+	return dest + count * sizeof(UIntType);
+}
+
+template<typename UIntType>
+inline const char * load_words(const char * src, size_t count, UIntType * dest)
+{
+	BOOST_STATIC_ASSERT( boost::is_integral<UIntType>::value );
+#ifdef BOOST_LITTLE_ENDIAN
+	std::memcpy( dest, src, count * sizeof(UIntType) );
+#else
+	for (size_t k = 0; k < count; ++k)
+		dest[k] = boost::detail::load_little_endian<UIntType, sizeof(UIntType)>( src + k * sizeof(UIntType) );
+#endif
+	return src + count * sizeof(UIntType);
+}
+
+inline char * store_header(char * buf, size_t word_bytes, size_t word_count, size_t position, boost::uint64_t id)
+{
+	snapshot_header & h = *reinterpret_cast<snapshot_header *>(buf);
+
+	h.magic			= snapshot_header::magic_number;
+	h.version		= snapshot_header::current_version;
+	h.word_bytes	= static_cast<boost::uint16_t>(word_bytes);
+	h.word_count	= static_cast<boost::uint32_t>(word_count);
+	h.position		= static_cast<boost::uint32_t>(position);
+	h.engine_id		= id;
+	h.reserved		= 0;
+
+	return buf + sizeof(snapshot_header);
+}
+
+//! validates the header against the engine being restored, and returns the position
+inline size_t load_header(const char * buf, size_t word_bytes, size_t word_count, boost::uint64_t id)
+{
+	const snapshot_header & h = *reinterpret_cast<const snapshot_header *>(buf);
+
+	if (h.magic != snapshot_header::magic_number)
+		throw std::runtime_error("restore_snapshot: buffer does not contain an engine snapshot");
+	if (h.version != snapshot_header::current_version)
+		throw std::runtime_error("restore_snapshot: unsupported snapshot version");
+	if (h.engine_id != id || h.word_bytes != word_bytes || h.word_count != word_count)
+		throw std::runtime_error("restore_snapshot: snapshot was taken from a different engine type");
+
+	return h.position;
+}
+
+struct snapshot_access
+{
+	template<typename Derived, typename EngineTraits>
+	static const typename linear_generator<Derived, EngineTraits>::UIntType *
+	words(const linear_generator<Derived, EngineTraits> & eng) {return eng.x;}
+
+	template<typename Derived, typename EngineTraits>
+	static typename linear_generator<Derived, EngineTraits>::UIntType *
+	words(linear_generator<Derived, EngineTraits> & eng) {return eng.x;}
+
+	template<typename Derived, typename EngineTraits>
+	static size_t & index(linear_generator<Derived, EngineTraits> & eng) {return eng.i;}
+
+	template<typename Derived, typename EngineTraits>
+	static size_t index(const linear_generator<Derived, EngineTraits> & eng) {return eng.i;}
+
+	template<typename Engine>
+	static const Engine & base(const reverse_adapter<Engine> & ra) {return ra.e;}
+
+	template<typename Engine>
+	static Engine & base(reverse_adapter<Engine> & ra) {return ra.e;}
+};
+
+template<typename Derived, typename EngineTraits>
+char * save_linear_snapshot(const linear_generator<Derived, EngineTraits> & eng, char * buf, boost::uint64_t id)
+{
+	typedef typename EngineTraits::UIntType UIntType;
+	static const size_t n = EngineTraits::state_size;
+
+	buf = store_header( buf, sizeof(UIntType), n, snapshot_access::index(eng), id );
+
+	return store_words( snapshot_access::words(eng), n, buf );
+}
+
+template<typename Derived, typename EngineTraits>
+const char * restore_linear_snapshot(linear_generator<Derived, EngineTraits> & eng, const char * buf, boost::uint64_t id)
+{
+	typedef typename EngineTraits::UIntType UIntType;
+	static const size_t n = EngineTraits::state_size;
+
+	const size_t i = load_header( buf, sizeof(UIntType), n, id );
+	if (i >= n)
+		throw std::runtime_error("restore_snapshot: state index out of range");
+
+	snapshot_access::index(eng) = i;
+
+	return load_words( buf + sizeof(snapshot_header), n, snapshot_access::words(eng) );
+}
+
+//! the family and number of rounds of a counter based PRF
+/*! Only the PRFs of \c boost/random are specialized, so a snapshot of an engine over any other PRF
+	does not compile rather than sharing a fingerprint with one of these.
+*/
+template<typename Prf>
+struct prf_snapshot_traits;
+
+template<unsigned N, typename Uint, unsigned R, typename Constants>
+struct prf_snapshot_traits< boost::random::philox<N, Uint, R, Constants> >
+{
+	static const char * family() {return "philox";}
+	static const unsigned int rounds = R;
+};
+
+template<unsigned N, typename Uint, unsigned R, typename Constants>
+struct prf_snapshot_traits< boost::random::threefry<N, Uint, R, Constants> >
+{
+	static const char * family() {return "threefry";}
+	static const unsigned int rounds = R;
+};
+
+template<typename Uint, unsigned R, typename Constants>
+struct prf_snapshot_traits< boost::random::ars<Uint, R, Constants> >
+{
+	static const char * family() {return "ars";}
+	static const unsigned int rounds = R;
+};
+
+template<typename Uint>
+struct prf_snapshot_traits< boost::random::aes<Uint> >
+{
+	static const char * family() {return "aes";}
+	static const unsigned int rounds = 10;
+};
+
+//! fingerprint of a counter based engine: its kind, the family and rounds of its PRF, and the PRF's shape
+template<typename Prf>
+inline boost::uint64_t counter_based_snapshot_id(const char * kind)
+{
+	typedef typename Prf::domain_type domain_type;
+	typedef typename Prf::key_type key_type;
+
+	boost::uint64_t h = snapshot_hash(kind);
+	h = snapshot_hash( prf_snapshot_traits<Prf>::family(), h );
+	h = snapshot_hash( prf_snapshot_traits<Prf>::rounds, h );
+	h = snapshot_hash( domain_type::static_size, h );
+	h = snapshot_hash( Prf::range_type::static_size, h );
+	h = snapshot_hash( key_type::static_size, h );
+	return snapshot_hash( sizeof(typename key_type::value_type), h );
+}
+
+template<typename Prf>
+struct counter_based_snapshot_traits
+{
+	typedef typename Prf::domain_type domain_type;
+	typedef typename Prf::key_type key_type;
+	typedef typename key_type::value_type word_type;
+
+	BOOST_STATIC_ASSERT(( boost::is_same<typename domain_type::value_type, word_type>::value ));
+
+	//! the key followed by the counter
+	static const size_t word_count = key_type::static_size + domain_type::static_size;
+};
+
+}	// namespace detail
+//! \endcond
+
+/*! \name linear generators
+	The snapshot holds the circular state buffer and the index \c i as is.
+	@{
+*/
+
+//! the number of bytes occupied by a snapshot of \p eng
+template<typename Derived, typename EngineTraits>
+inline size_t snapshot_size(const linear_generator<Derived, EngineTraits> &)
+{
+	return sizeof(snapshot_header) + EngineTraits::state_size * sizeof(typename EngineTraits::UIntType);
+}
+
+//! writes a snapshot of \p eng to \p buf, returning one past its end
+template<typename Derived, typename EngineTraits>
+inline char * save_snapshot(const linear_generator<Derived, EngineTraits> & eng, char * buf)
+{
+	return detail::save_linear_snapshot( eng, buf, detail::named_snapshot_id<EngineTraits>() );
+}
+
+//! restores \p eng from the snapshot at \p buf, returning one past its end
+/*! \throw std::runtime_error if \p buf does not hold a snapshot of an engine of the same type
+*/
+template<typename Derived, typename EngineTraits>
+inline const char * restore_snapshot(linear_generator<Derived, EngineTraits> & eng, const char * buf)
+{
+	return detail::restore_linear_snapshot( eng, buf, detail::named_snapshot_id<EngineTraits>() );
+}
+
+//! @}
+
+/*! \name reverse adapters
+	The snapshot is that of the adapted engine, but tagged with the name of the reverse engine.
+	@{
+*/
+
+template<typename Engine>
+inline size_t snapshot_size(const reverse_adapter<Engine> & ra)
+{
+	return snapshot_size( detail::snapshot_access::base(ra) );
+}
+
+template<typename Engine>
+inline char * save_snapshot(const reverse_adapter<Engine> & ra, char * buf)
+{
+	return detail::save_linear_snapshot( detail::snapshot_access::base(ra), buf, 
+										 detail::named_snapshot_id< reverse_adapter<Engine> >() );
+}
+
+template<typename Engine>
+inline const char * restore_snapshot(reverse_adapter<Engine> & ra, const char * buf)
+{
+	return detail::restore_linear_snapshot( detail::snapshot_access::base(ra), buf, 
+											detail::named_snapshot_id< reverse_adapter<Engine> >() );
+}
+
+//! @}
+
+/*! \name counter based engines
+	The snapshot holds the key followed by the counter, and the position
+	within the current block of output.
+	@{
+*/
+
+template<typename Prf>
+inline size_t snapshot_size(const boost::random::counter_based_engine<Prf> &)
+{
+	typedef detail::counter_based_snapshot_traits<Prf> traits;
+
+	return sizeof(snapshot_header) + traits::word_count * sizeof(typename traits::word_type);
+}
+
+template<typename Prf>
+char * save_snapshot(const boost::random::counter_based_engine<Prf> & eng, char * buf)
+{
+	typedef detail::counter_based_snapshot_traits<Prf> traits;
+
+	const typename boost::random::counter_based_engine<Prf>::pos_type pos = eng.tell();
+	const typename traits::key_type key = eng.getseed();
+
+	buf = detail::store_header( buf, sizeof(typename traits::word_type), traits::word_count, pos.second,
+								detail::counter_based_snapshot_id<Prf>("counter_based_engine") );
+	buf = detail::store_words( key.data(), key.size(), buf );
+
+	return detail::store_words( pos.first.data(), pos.first.size(), buf );
+}
+
+template<typename Prf>
+const char * restore_snapshot(boost::random::counter_based_engine<Prf> & eng, const char * buf)
+{
+	typedef detail::counter_based_snapshot_traits<Prf> traits;
+
+	typename boost::random::counter_based_engine<Prf>::pos_type pos;
+	typename traits::key_type key;
+
+	pos.second = detail::load_header( buf, sizeof(typename traits::word_type), traits::word_count,
+									  detail::counter_based_snapshot_id<Prf>("counter_based_engine") );
+	if (pos.second > Prf::range_type::static_size)
+		throw std::runtime_error("restore_snapshot: output position out of range");
+
+	buf = detail::load_words( buf + sizeof(snapshot_header), key.size(), key.data() );
+	buf = detail::load_words( buf, pos.first.size(), pos.first.data() );
+
+	eng.seed(key);
+	eng.seek(pos);
+
+	return buf;
+}
+
+template<typename Prf>
+inline size_t snapshot_size(const boost::random::counter_based_urng<Prf> &)
+{
+	typedef detail::counter_based_snapshot_traits<Prf> traits;
+
+	return sizeof(snapshot_header) + traits::word_count * sizeof(typename traits::word_type);
+}
+
+template<typename Prf>
+char * save_snapshot(const boost::random::counter_based_urng<Prf> & eng, char * buf)
+{
+	typedef detail::counter_based_snapshot_traits<Prf> traits;
+
+	const typename boost::random::counter_based_urng<Prf>::pos_type pos = eng.tell();
+	const typename traits::key_type key = eng.getprf().getkey();
+
+	buf = detail::store_header( buf, sizeof(typename traits::word_type), traits::word_count, pos.second,
+								detail::counter_based_snapshot_id<Prf>("counter_based_urng") );
+	buf = detail::store_words( key.data(), key.size(), buf );
+
+	return detail::store_words( pos.first.data(), pos.first.size(), buf );
+}
+
+template<typename Prf>
+const char * restore_snapshot(boost::random::counter_based_urng<Prf> & eng, const char * buf)
+{
+	typedef detail::counter_based_snapshot_traits<Prf> traits;
+
+	typename boost::random::counter_based_urng<Prf>::pos_type pos;
+	typename traits::key_type key;
+
+	pos.second = detail::load_header( buf, sizeof(typename traits::word_type), traits::word_count,
+									  detail::counter_based_snapshot_id<Prf>("counter_based_urng") );
+	if (pos.second > Prf::range_type::static_size)
+		throw std::runtime_error("restore_snapshot: output position out of range");
+
+	buf = detail::load_words( buf + sizeof(snapshot_header), key.size(), key.data() );
+	buf = detail::load_words( buf, pos.first.size(), pos.first.data() );
+
+	// the constructor only accepts a counter at the start of a stream, so seek to it afterwards
+	typename traits::domain_type c0;
+	c0.fill( Prf::domain_array_min() );
+	eng = boost::random::counter_based_urng<Prf>( Prf(key), c0 );
+	eng.seek(pos);
+
+	return buf;
+}
+
+//! @}
+
+/*! \name stream convenience functions
+	For checkpointing to a file. Restoring many engines is faster from a memory mapped
+	file using \c restore_snapshot directly.
+	@{
+*/
+
+//! writes a snapshot of \p eng to the binary stream \p os
+template<typename Engine>
+std::ostream & write_snapshot(std::ostream & os, const Engine & eng)
+{
+	std::vector<char> buf( snapshot_size(eng) );
+	save_snapshot( eng, &buf[0] );
+
+	return os.write( &buf[0], buf.size() );
+}
+
+//! reads a snapshot of \p eng from the binary stream \p is
+template<typename Engine>
+std::istream & read_snapshot(std::istream & is, Engine & eng)
+{
+	std::vector<char> buf( snapshot_size(eng) );
+	if ( is.read( &buf[0], buf.size() ) )
+		restore_snapshot( eng, &buf[0] );
+
+	return is;
+}
+
+//! @}
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_SNAPSHOT_HPP
@@ -0,0 +1,448 @@
+/* qfcl/random/engine/sobol.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_SOBOL_HPP
+#define QFCL_RANDOM_SOBOL_HPP
+
+/*! \file qfcl/random/engine/sobol.hpp
+	\brief Sobol low-discrepancy (quasi-random) sequences.
+
+	Points are generated in Gray code order (Antonov and Saleev): point \c n is
+	\f$\bigoplus_k g_k(n) v_k\f$, where \f$g(n) = n \oplus (n \gg 1)\f$, so consecutive points differ
+	by a single direction number. This makes the next point one XOR per dimension, and any point
+	directly computable, which is used by \c seek to split the sequence between workers.
+
+	The direction numbers are those of Joe and Kuo, see \c sobol_table.hpp.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/mpl/string.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/static_assert.hpp>
+
+#include <qfcl/random/engine/sobol_table.hpp>
+#include <qfcl/utility/tmp.hpp>
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+//! primitive polynomials and initial direction numbers of a Sobol sequence
+/*! Holds one record <tt>(s, a, m_1, ..., m_s)</tt> per dimension after the first,
+	as in the direction number files of Joe and Kuo.
+*/
+class sobol_direction_numbers
+{
+public:
+	//! the built-in table
+	/*! \throw std::invalid_argument if \p dimension exceeds \c detail::sobol_table::max_dimension
+	*/
+	explicit sobol_direction_numbers(size_t dimension);
+	//! reads the first \p dimension dimensions from a file in the format of Joe and Kuo
+	/*! The file starts with a header line, followed by one line <tt>d s a m_1 ... m_s</tt> per dimension <tt>d >= 2</tt>.
+		\throw std::invalid_argument if the file is malformed or has fewer than \p dimension dimensions
+	*/
+	sobol_direction_numbers(std::istream & is, size_t dimension);
+
+	size_t dimension() const {return degree.size() + 1;}
+
+	/*! \brief the direction numbers \f$v_k\f$, <tt>k = 0, ..., digits - 1</tt>, of dimension \p d (0 based),
+		scaled to \p digits bits
+	*/
+	template<typename UIntType>
+	void direction_numbers(size_t d, int digits, UIntType * v) const;
+private:
+	std::vector<unsigned> degree;				// s
+	std::vector<boost::uint32_t> coefficients;	// a
+	std::vector<size_t> offset;					// offset of m_1 in initial
+	std::vector<boost::uint32_t> initial;		// m_1, ..., m_s
+
+	void add(unsigned s, boost::uint32_t a, const boost::uint32_t * m);
+};
+
+//! Sobol quasi-random sequence
+/*!	As an engine, \c operator() returns the coordinates of the successive points, that is
+	one point per \c dimension() calls. The first point is the origin.
+
+	\tparam UIntType unsigned integer type holding one coordinate, at most \c std::numeric_limits<UIntType>::digits
+	bits of each coordinate are significant, and the sequence has \f$2^{digits}\f$ points.
+*/
+template<typename UIntType, typename Name>
+class sobol_engine
+{
+public:
+	typedef UIntType result_type;
+	typedef Name name;
+
+	//! number of bits of each coordinate
+	static const int digits = std::numeric_limits<UIntType>::digits;
+
+	BOOST_STATIC_ASSERT( !std::numeric_limits<UIntType>::is_signed && digits >= 32 );
+
+	//! uses the built-in direction numbers
+	explicit sobol_engine(size_t dimension);
+	explicit sobol_engine(const sobol_direction_numbers & numbers);
+
+	size_t dimension() const {return D;}
+
+	static result_type min() {return 0;}
+	static result_type max() {return std::numeric_limits<result_type>::max();}
+
+	//! next coordinate
+	result_type operator()();
+	//! skips \p z coordinates
+	void discard(boost::uint64_t z);
+	//! restarts the sequence, keeping any scrambling
+	void seed() {seek(0);}
+
+	//! the index of the next point
+	boost::uint64_t tell() const {return index;}
+	//! the next point will be point \p n, in O(dimension() * log n) operations
+	/*! Together with \c tell, this splits the sequence between workers, e.g. worker \c j gets
+		the points <tt>[j * m, (j + 1) * m)</tt>.
+		\throw std::out_of_range if \p n is beyond the end of the sequence
+	*/
+	void seek(boost::uint64_t n);
+
+	//! writes the next point to \p x[0], ..., \p x[dimension() - 1]
+	/*! Must not be mixed with partially consumed points of \c operator().
+	*/
+	void generate(result_type * x);
+
+	//! writes the next \p n points to \p out in structure of arrays layout: coordinate \c d of point \c i goes to <tt>out[d * n + i]</tt>
+	/*! The coordinates are mapped to the midpoints of their dyadic intervals, so lie strictly in (0,1)
+		and can be passed directly to an inverse normal CDF.
+	*/
+	template<typename RealType>
+	void generate_block(RealType * out, size_t n);
+
+	//! random affine scrambling (Matousek): a random linear scramble of the digits plus a random digital shift
+	/*! Randomizes the sequence while preserving its equidistribution properties, so that independent
+		replications give an error estimate. Restarts the sequence.
+	*/
+	template<typename Engine>
+	void scramble(Engine & eng);
+
+	bool operator==(const sobol_engine & other) const
+	{
+		return D == other.D && index == other.index && coordinate == other.coordinate && x == other.x
+			&& v == other.v && shift == other.shift;
+	}
+	bool operator!=(const sobol_engine & other) const {return !(*this == other);}
+private:
+	size_t D;
+	boost::uint64_t index;				// index of the next point, x holds point index - 1 unless index == 0
+	size_t coordinate;					// next coordinate of x returned by operator()
+	std::vector<result_type> x;			// current point
+	std::vector<result_type> v;			// direction numbers, v[k * D + d] is v_k of dimension d
+	std::vector<result_type> shift;		// digital shift
+
+	void initialize(const sobol_direction_numbers & numbers);
+	//! advances x to point index, and increments index
+	void advance();
+};
+
+/* sobol_direction_numbers */
+
+inline sobol_direction_numbers::sobol_direction_numbers(size_t dimension)
+{
+	if ( dimension == 0 || dimension > detail::sobol_table::max_dimension )
+		throw std::invalid_argument("sobol_direction_numbers: dimension not covered by the built-in table");
+
+	const boost::uint16_t * record = detail::sobol_table::records();
+	for (size_t d = 1; d < dimension; ++d)
+	{
+		boost::uint32_t m[std::numeric_limits<boost::uint16_t>::digits];
+		std::copy( record + 2, record + 2 + record[0], m );
+		add( record[0], record[1], m );
+		record += 2 + record[0];
+	}
+}
+
+inline sobol_direction_numbers::sobol_direction_numbers(std::istream & is, size_t dimension)
+{
+	if (dimension == 0)
+		throw std::invalid_argument("sobol_direction_numbers: dimension must be positive");
+
+	std::string line;
+	std::getline(is, line);	// header
+
+	while ( this->dimension() < dimension && std::getline(is, line) )
+	{
+		std::istringstream iss(line);
+		size_t d;
+		unsigned s;
+		boost::uint32_t a;
+		if ( !(iss >> d >> s >> a) )
+			continue;
+		if ( d != this->dimension() + 1 || s == 0 || s > 31 )
+			throw std::invalid_argument("sobol_direction_numbers: malformed direction number file");
+
+		boost::uint32_t m[31];
+		for (unsigned k = 0; k < s; ++k)
+			if ( !(iss >> m[k]) )
+				throw std::invalid_argument("sobol_direction_numbers: malformed direction number file");
+
+		add(s, a, m);
+	}
+
+	if (this->dimension() < dimension)
+		throw std::invalid_argument("sobol_direction_numbers: too few dimensions in direction number file");
+}
+
+inline void sobol_direction_numbers::add(unsigned s, boost::uint32_t a, const boost::uint32_t * m)
+{
+	degree.push_back(s);
+	coefficients.push_back(a);
+	offset.push_back( initial.size() );
+	initial.insert( initial.end(), m, m + s );
+}
+
+template<typename UIntType>
+void sobol_direction_numbers::direction_numbers(size_t d, int digits, UIntType * v) const
+{
+	if (d == 0)
+	{
+		// van der Corput
+		for (int k = 0; k < digits; ++k)
+			v[k] = UIntType(1) << (digits - 1 - k);
+		return;
+	}
+
+	const unsigned s = degree[d - 1];
+	const boost::uint32_t a = coefficients[d - 1];
+	const boost::uint32_t * m = &initial[ offset[d - 1] ];
+
+	for (int k = 0; k < digits; ++k)
+	{
+		if ( k < static_cast<int>(s) )
+			v[k] = static_cast<UIntType>(m[k]) << (digits - 1 - k);
+		else
+		{
+			v[k] = v[k - s] ^ (v[k - s] >> s);
+			for (unsigned j = 1; j < s; ++j)
+				if ( (a >> (s - 1 - j)) & 1 )
+					v[k] ^= v[k - j];
+		}
+	}
+}
+
+/* sobol_engine */
+
+template<typename UIntType, typename Name>
+sobol_engine<UIntType, Name>::sobol_engine(size_t dimension)
+{
+	initialize( sobol_direction_numbers(dimension) );
+}
+
+template<typename UIntType, typename Name>
+sobol_engine<UIntType, Name>::sobol_engine(const sobol_direction_numbers & numbers)
+{
+	initialize(numbers);
+}
+
+template<typename UIntType, typename Name>
+void sobol_engine<UIntType, Name>::initialize(const sobol_direction_numbers & numbers)
+{
+	D = numbers.dimension();
+	v.resize(digits * D);
+	shift.assign(D, 0);
+
+	std::vector<result_type> vd(digits);
+	for (size_t d = 0; d < D; ++d)
+	{
+		numbers.direction_numbers(d, digits, &vd[0]);
+		for (int k = 0; k < digits; ++k)
+			v[k * D + d] = vd[k];
+	}
+
+	seek(0);
+}
+
+template<typename UIntType, typename Name>
+inline void sobol_engine<UIntType, Name>::advance()
+{
+	if (index == 0)
+		x = shift;
+	else
+	{
+		// flip the lowest zero bit of index - 1
+		int c = 0;
+		for (boost::uint64_t n = index - 1; n & 1; n >>= 1)
+			++c;
+		if (c >= digits)
+			throw std::out_of_range("sobol_engine: end of sequence");
+
+		const result_type * vc = &v[c * D];
+		for (size_t d = 0; d < D; ++d)
+			x[d] ^= vc[d];
+	}
+
+	++index;
+}
+
+template<typename UIntType, typename Name>
+void sobol_engine<UIntType, Name>::seek(boost::uint64_t n)
+{
+	if ( digits < 64 && n > ( boost::uint64_t(1) << (digits < 64 ? digits : 0) ) )
+		throw std::out_of_range("sobol_engine::seek: beyond the end of the sequence");
+
+	index = n;
+	coordinate = D;
+	x.assign(D, 0);
+	if (n == 0)
+		return;
+
+	// x is point n - 1
+	x = shift;
+	const boost::uint64_t g = (n - 1) ^ ((n - 1) >> 1);
+	for (int k = 0; k < digits && k < 64; ++k)
+		if ( (g >> k) & 1 )
+		{
+			const result_type * vk = &v[k * D];
+			for (size_t d = 0; d < D; ++d)
+				x[d] ^= vk[d];
+		}
+}
+
+template<typename UIntType, typename Name>
+inline typename sobol_engine<UIntType, Name>::result_type sobol_engine<UIntType, Name>::operator()()
+{
+	if (coordinate == D)
+	{
+		advance();
+		coordinate = 0;
+	}
+
+	return x[coordinate++];
+}
+
+template<typename UIntType, typename Name>
+void sobol_engine<UIntType, Name>::discard(boost::uint64_t z)
+{
+	// finish the current point, jump over whole points, then start the last one
+	const boost::uint64_t remaining = D - coordinate;
+	if (z <= remaining)
+	{
+		coordinate += static_cast<size_t>(z);
+		return;
+	}
+	z -= remaining;
+
+	seek( index + (z - 1) / D );
+	advance();
+	coordinate = static_cast<size_t>( (z - 1) % D + 1 );
+}
+
+template<typename UIntType, typename Name>
+void sobol_engine<UIntType, Name>::generate(result_type * out)
+{
+	advance();
+	coordinate = D;
+	std::copy( x.begin(), x.end(), out );
+}
+
+template<typename UIntType, typename Name>
+template<typename RealType>
+void sobol_engine<UIntType, Name>::generate_block(RealType * out, size_t n)
+{
+	// keep as many leading bits as RealType can represent exactly
+	const int bits = std::min( digits, std::numeric_limits<RealType>::digits );
+	const RealType scale = RealType(1) / ( RealType( UIntType(1) << (bits - 1) ) * 2 );
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		advance();
+		for (size_t d = 0; d < D; ++d)
+			out[d * n + i] = ( RealType( x[d] >> (digits - bits) ) + RealType(0.5) ) * scale;
+	}
+	coordinate = D;
+}
+
+template<typename UIntType, typename Name>
+template<typename Engine>
+void sobol_engine<UIntType, Name>::scramble(Engine & eng)
+{
+	boost::random::uniform_int_distribution<result_type> bits(0, max());
+
+	for (size_t d = 0; d < D; ++d)
+	{
+		// lower triangular matrix with unit diagonal: output digit j (from the most significant)
+		// is the parity of the input digits selected by row[j], which has digit j and random higher digits
+		std::vector<result_type> row(digits);
+		for (int j = 0; j < digits; ++j)
+		{
+			const result_type digit = result_type(1) << (digits - 1 - j);
+			const result_type higher = j == 0 ? 0 : static_cast<result_type>( ~result_type(0) << (digits - j) );
+			row[j] = digit | (bits(eng) & higher);
+		}
+
+		for (int k = 0; k < digits; ++k)
+		{
+			result_type & vk = v[k * D + d];
+			result_type scrambled = 0;
+			for (int j = 0; j < digits; ++j)
+			{
+				result_type y = vk & row[j];
+				// parity of y
+				int p = 0;
+				while (y)
+				{
+					y &= y - 1;
+					p ^= 1;
+				}
+				if (p)
+					scrambled |= result_type(1) << (digits - 1 - j);
+			}
+			vk = scrambled;
+		}
+
+		shift[d] = bits(eng);
+	}
+
+	seek(0);
+}
+
+namespace detail {
+
+// alias
+namespace mpl = boost::mpl;
+
+typedef mpl::string<'s','o','b','o','l'>::type sobol_name;
+typedef qfcl::tmp::concatenate< sobol_name, mpl::string<'_','6','4'>::type >::type sobol_64_name;
+
+}	// namespace detail
+
+//! 32 bit coordinates, \f$2^{32}\f$ points
+typedef sobol_engine<boost::uint32_t, detail::sobol_name> sobol;
+//! 64 bit coordinates, \f$2^{64}\f$ points
+typedef sobol_engine<boost::uint64_t, detail::sobol_64_name> sobol_64;
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_SOBOL_HPP
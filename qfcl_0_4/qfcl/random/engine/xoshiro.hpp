@@ -0,0 +1,626 @@
+/* qfcl/random/engine/xoshiro.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_RANDOM_XOSHIRO_HPP
+#define QFCL_RANDOM_XOSHIRO_HPP
+
+/*! \file qfcl/random/engine/xoshiro.hpp
+	\brief The xoshiro and xoroshiro generators of Blackman and Vigna
+
+	D. Blackman and S. Vigna, "Scrambled linear pseudorandom number generators", ACM Transactions on
+	Mathematical Software, Vol. 47, No. 4, 2021. See also <a href="https://prng.di.unimi.it">prng.di.unimi.it</a>.
+
+	Each generator is an \f$\mathbb F_2\f$-linear transition of a small state of 64 bit words (xoshiro:
+	xor, shift, rotate; xoroshiro: xor, rotate, shift, rotate), followed by a nonlinear \em scrambler
+	(\c + or \c **) applied to the output only. The linear part is a \c linear_generator, so \c discard,
+	\c peek and the transition and jump matrices come from the base class. In addition each generator has
+	the published jump polynomials: \c jump and \c long_jump advance by \f$2^{k/2}\f$ and \f$2^{3k/4}\f$
+	steps, for a state of \f$k\f$ bits, in \f$k\f$ steps and no matrices.
+
+	\c multi_lane_xoshiro runs 4 or 8 copies of a generator, spaced \c jump apart, interleaved in
+	\c math::u64x4 words, i.e. in AVX2 registers when available.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include <boost/cstdint.hpp>
+#include <boost/mpl/string.hpp>
+
+#include <qfcl/math/simd/u64x4.hpp>
+#include <qfcl/utility/tmp.hpp>
+
+#include "engine.hpp"
+#include "linear_generator.hpp"
+
+namespace qfcl {
+
+namespace random {
+
+/*! \ingroup random
+	@{
+*/
+
+namespace detail {
+
+//! SplitMix64, the recommended way to fill the state from a 64 bit seed
+inline boost::uint64_t splitmix64(boost::uint64_t & z)
+{
+	boost::uint64_t y = (z += UINT64_C(0x9e3779b97f4a7c15));
+	y = ( y ^ (y >> 30) ) * UINT64_C(0xbf58476d1ce4e5b9);
+	y = ( y ^ (y >> 27) ) * UINT64_C(0x94d049bb133111eb);
+	return y ^ (y >> 31);
+}
+
+}	// namespace detail
+
+/** linear transitions */
+
+/*! The transitions and scramblers are templated on the word type \c V, which is either
+	\c boost::uint64_t or \c math::u64x4 (4 independent generators).
+*/
+
+//! the linear engine of xoshiro256, with jumps of \f$2^{128}\f$ and \f$2^{192}\f$
+struct xoshiro256_transition
+{
+	static const std::size_t state_size = 4;
+	static const int jump_exponent = 128;
+	static const int long_jump_exponent = 192;
+
+	static const boost::uint64_t * jump_polynomial()
+	{
+		static const boost::uint64_t p[state_size] = {
+			UINT64_C(0x180ec6d33cfd0aba), UINT64_C(0xd5a61266f0c9392c), UINT64_C(0xa9582618e03fc9aa), UINT64_C(0x39abdc4529b1661c) };
+		return p;
+	}
+	static const boost::uint64_t * long_jump_polynomial()
+	{
+		static const boost::uint64_t p[state_size] = {
+			UINT64_C(0x76e15d3efefdcbbf), UINT64_C(0xc5004e441c522fb3), UINT64_C(0x77710069854ee241), UINT64_C(0x39109bb02acbe635) };
+		return p;
+	}
+
+	template<typename V>
+	static void next(V (&s)[state_size])
+	{
+		const V t = s[1] << 17;
+
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+
+		s[2] ^= t;
+
+		s[3] = math::rotl(s[3], 45);
+	}
+};
+
+//! the linear engine of xoshiro512, with jumps of \f$2^{256}\f$ and \f$2^{384}\f$
+struct xoshiro512_transition
+{
+	static const std::size_t state_size = 8;
+	static const int jump_exponent = 256;
+	static const int long_jump_exponent = 384;
+
+	static const boost::uint64_t * jump_polynomial()
+	{
+		static const boost::uint64_t p[state_size] = {
+			UINT64_C(0x33ed89b6e7a353f9), UINT64_C(0x760083d7955323be), UINT64_C(0x2837f2fbb5f22fae), UINT64_C(0x4b8c5674d309511c),
+			UINT64_C(0xb11ac47a7ba28c25), UINT64_C(0xf1be7667092bcc1c), UINT64_C(0x53851efdb6df0aaf), UINT64_C(0x1ebbc8b23eaf25db) };
+		return p;
+	}
+	static const boost::uint64_t * long_jump_polynomial()
+	{
+		static const boost::uint64_t p[state_size] = {
+			UINT64_C(0x11467fef8f921d28), UINT64_C(0xa2a819f2e79c8ea8), UINT64_C(0xa8299fc284b3959a), UINT64_C(0xb4d347340ca63ee1),
+			UINT64_C(0x1cb0940bedbff6ce), UINT64_C(0xd956c5c4fa1f8e17), UINT64_C(0x915e38fd4eda93bc), UINT64_C(0x5b3ccdfa5d7daca5) };
+		return p;
+	}
+
+	template<typename V>
+	static void next(V (&s)[state_size])
+	{
+		const V t = s[1] << 11;
+
+		s[2] ^= s[0];
+		s[5] ^= s[1];
+		s[1] ^= s[2];
+		s[7] ^= s[3];
+		s[3] ^= s[4];
+		s[4] ^= s[5];
+		s[0] ^= s[6];
+		s[6] ^= s[7];
+
+		s[6] ^= t;
+
+		s[7] = math::rotl(s[7], 21);
+	}
+};
+
+//! the linear engine of xoroshiro128 (the 2018 parameters 24, 16, 37), with jumps of \f$2^{64}\f$ and \f$2^{96}\f$
+struct xoroshiro128_transition
+{
+	static const std::size_t state_size = 2;
+	static const int jump_exponent = 64;
+	static const int long_jump_exponent = 96;
+
+	static const boost::uint64_t * jump_polynomial()
+	{
+		static const boost::uint64_t p[state_size] = { UINT64_C(0xdf900294d8f554a5), UINT64_C(0x170865df4b3201fc) };
+		return p;
+	}
+	static const boost::uint64_t * long_jump_polynomial()
+	{
+		static const boost::uint64_t p[state_size] = { UINT64_C(0xd2a98b26625eee7b), UINT64_C(0xdddf9b1090aa7ac1) };
+		return p;
+	}
+
+	template<typename V>
+	static void next(V (&s)[state_size])
+	{
+		const V s0 = s[0];
+		const V s1 = s[1] ^ s0;
+
+		s[0] = math::rotl(s0, 24) ^ s1 ^ (s1 << 16);
+		s[1] = math::rotl(s1, 37);
+	}
+};
+
+/** scramblers */
+
+//! <tt>s[i] + s[j]</tt>
+template<std::size_t i, std::size_t j>
+struct plus_scrambler
+{
+	template<typename V, std::size_t N>
+	static V scramble(const V (&s)[N]) {return s[i] + s[j];}
+};
+
+//! <tt>rotl(s[i] * a, k) * b</tt>
+template<std::size_t i, boost::uint64_t a, int k, boost::uint64_t b>
+struct starstar_scrambler
+{
+	template<typename V, std::size_t N>
+	static V scramble(const V (&s)[N]) {return math::rotl(s[i] * a, k) * b;}
+};
+
+//! traits of a xoshiro or xoroshiro generator
+/*! \tparam Transition the linear engine
+	\tparam Scrambler the output function
+	\tparam Name engine name
+*/
+template<typename Transition, typename Scrambler, typename Name>
+struct xoshiro_traits : public engine_traits<linear_generator_engine_tag, boost::uint64_t>
+{
+	typedef xoshiro_traits EngineTraits;
+    //! type of pseudo-random number generated
+	typedef boost::uint64_t result_type;
+
+	typedef Transition transition_type;
+	typedef Scrambler scrambler_type;
+
+	static const size_t		word_size = 64;
+	static const size_t		state_size = Transition::state_size;
+	static const size_t		mask_bits = 0;
+	static const UIntType	default_seed = 5489u;
+
+	static const size_t		modulus = 2;
+
+	//! engine name
+	typedef Name name;
+};
+
+//! a xoshiro or xoroshiro generator
+/*! The whole state is replaced at each step, so unlike the Mersenne twister the state is not a circular
+	buffer: the index \c i of the \c linear_generator is always 0, and the state vector is the array of
+	state words itself.
+
+	\note The state must not be 0, which \c seed guarantees.
+*/
+template<typename EngineTraits>
+class xoshiro_engine : public noninvertible_linear_generator< xoshiro_engine<EngineTraits>, EngineTraits >
+{
+	typedef noninvertible_linear_generator< xoshiro_engine<EngineTraits>, EngineTraits > base_type;
+	typedef linear_generator< xoshiro_engine<EngineTraits>, EngineTraits > generator_type;
+public:
+	typedef typename EngineTraits::transition_type transition_type;
+	typedef typename EngineTraits::scrambler_type scrambler_type;
+	QFCL_USING_TYPE(result_type, generator_type);
+	QFCL_USING_TYPE(UIntType, generator_type);
+	QFCL_USING_TYPE(state, generator_type);
+	using generator_type::default_seed;
+	using generator_type::n;
+
+	/*! \name constructors
+		@{
+	*/
+	//! default constructor taking optional seed
+	/*! The state words are the outputs of SplitMix64 started at \p seed_.
+	*/
+	xoshiro_engine(UIntType seed_ = default_seed) : base_type(seed_) {}
+	//! constructor taking an arbitrarily long sequence of seeds
+	template<typename It>
+	xoshiro_engine(It begin, It end) {this -> seed(begin, end);}
+	//! constructor directly setting the state
+	xoshiro_engine(const state & s) {this -> seed(s);}
+	//!	@}
+
+	//! minimum pseudo random number generated
+	static result_type min() {return 0;}
+	//! maximum pseudo random number generated
+	static result_type max() {return ~result_type(0);}
+
+	//! advance by \f$2^{\mathrm{jump\_exponent}}\f$ steps, using the published jump polynomial
+	/*! Consecutive jumps give non-overlapping streams for parallel computations.
+	*/
+	void jump() {apply_polynomial( transition_type::jump_polynomial() );}
+	//! advance by \f$2^{\mathrm{long\_jump\_exponent}}\f$ steps, e.g. to give each machine its own set of \c jump streams
+	void long_jump() {apply_polynomial( transition_type::long_jump_polynomial() );}
+
+	friend class linear_generator< xoshiro_engine<EngineTraits>, EngineTraits >;
+	friend class noninvertible_linear_generator< xoshiro_engine<EngineTraits>, EngineTraits >;
+private:
+	//! returns the transition applied to the state \p s
+	static state Transition(const state & s)
+	{
+		UIntType y[n];
+		std::copy(s.rep(), s.rep() + n, y);
+		transition_type::next(y);
+
+		return static_cast<state>(y);
+	}
+
+	//! re-seed the generator
+	static void SeedInitialization(UIntType seed_, UIntType (&x)[n], size_t & i)
+	{
+		UIntType z = seed_;
+		for (size_t j = 0; j < n; ++j)
+			x[j] = detail::splitmix64(z);
+
+		i = 0;
+	}
+	//! re-seed the generator with a sequence of seeds of arbitrary length
+	/*! If the length of the sequence is 0 or 1, then this agrees with the seeding from a single seed.
+	*/
+	template<typename It>
+	static void SeedInitialization(It begin, It end, UIntType (&x)[n], size_t & i);
+
+	//! advance to the next state
+	static void Next(UIntType (&x)[n], size_t &) {transition_type::next(x);}
+	//! apply the output transformation
+	static result_type Transform(const UIntType (&x)[n], size_t) {return scrambler_type::scramble(x);}
+
+	//! word \p i of the state vector
+	static UIntType GetNext(const UIntType (&x)[n], size_t i) {return x[i];}
+	//! the last word of the state vector, which \c Get reads after the first <tt>n - 1</tt> from \c GetNext
+	static UIntType GetNextState(UIntType (&x)[n], size_t & i, const UIntType (&previous)[n]) {return x[i] = previous[i];}
+
+	//! <tt>p(A) s</tt>, for the polynomial with coefficients the bits of \p p and the transition \c A
+	void apply_polynomial(const boost::uint64_t * p);
+};
+
+/* member definitions */
+
+// SeedInitialization
+template<typename EngineTraits>
+template<typename It>
+void
+xoshiro_engine<EngineTraits>::SeedInitialization(It begin, It end, UIntType (&x)[n], size_t & i)
+{
+	const size_t key_length = std::distance(begin, end);
+
+	if (key_length <= 1)
+	{
+		SeedInitialization(key_length == 0 ? default_seed : UIntType(*begin), x, i);
+		return;
+	}
+
+	SeedInitialization(default_seed, x, i);
+
+	// mix each seed into a word of the state
+	UIntType z = default_seed;
+	size_t j = 0;
+	for (It it = begin; it != end; ++it, ++j)
+	{
+		z ^= static_cast<UIntType>(*it);
+		x[j % n] ^= detail::splitmix64(z);
+	}
+
+	// guarantee a non-zero state
+	if ( std::count(x, x + n, UIntType(0)) == static_cast<std::ptrdiff_t>(n) )
+		x[0] = 1;
+}
+
+// apply_polynomial
+template<typename EngineTraits>
+void
+xoshiro_engine<EngineTraits>::apply_polynomial(const boost::uint64_t * p)
+{
+	const state s = this -> getState();
+
+	UIntType y[n], result[n];
+	std::copy(s.rep(), s.rep() + n, y);
+	std::fill(result, result + n, UIntType(0));
+
+	for (size_t j = 0; j < n; ++j)
+		for (int b = 0; b < 64; ++b)
+		{
+			if ( (p[j] >> b) & 1 )
+				for (size_t l = 0; l < n; ++l)
+					result[l] ^= y[l];
+
+			transition_type::next(y);
+		}
+
+	this -> seed( state(result) );
+}
+
+//! \c L copies of a xoshiro or xoroshiro \c Engine, interleaved
+/*! Lane \c j starts from the seeding engine after \c j calls of \c jump, so the lanes are non-overlapping
+	streams. The numbers are generated a step of all lanes at a time and returned in lane order: the output is
+	lane 0, lane 1, ..., lane <tt>L - 1</tt>, lane 0, ...
+
+	The state is kept as <tt>n</tt> rows of \c L words, and each step does the transition and scrambler of
+	\c Engine on \c math::u64x4 words, i.e. 4 lanes per instruction with AVX2. \c generate keeps the state
+	in registers for many steps.
+
+	\tparam L the number of lanes, 4 or 8
+*/
+template<typename Engine, std::size_t L>
+class multi_lane_xoshiro
+{
+public:
+	typedef Engine engine_type;
+	typedef typename Engine::result_type result_type;
+	typedef typename Engine::UIntType UIntType;
+	typedef typename Engine::transition_type transition_type;
+	typedef typename Engine::scrambler_type scrambler_type;
+	//! e.g. Xoshiro256StarStar-x4
+	typedef typename qfcl::tmp::concatenate< typename Engine::name, typename boost::mpl::string<'-', 'x', '0' + L>::type >::type name;
+
+	static const std::size_t lanes = L;
+	static const std::size_t n = transition_type::state_size;
+
+	static_assert(L == 4 || L == 8, "the number of lanes must be 4 or 8");
+
+	//! lanes from \c Engine(seed_)
+	explicit multi_lane_xoshiro(UIntType seed_ = Engine::default_seed) {seed(seed_);}
+	//! lanes from \p eng
+	explicit multi_lane_xoshiro(const Engine & eng) {seed(eng);}
+
+	void seed(UIntType seed_ = Engine::default_seed) {seed( Engine(seed_) );}
+	//! lane \c j is \p eng after \c j jumps
+	void seed(const Engine & eng);
+
+	static result_type min() {return 0;}
+	static result_type max() {return ~result_type(0);}
+
+	//! generate a random number
+	result_type operator()()
+	{
+		if (pos == L)
+		{
+			steps(buffer, 1);
+			pos = 0;
+		}
+
+		return buffer[pos++];
+	}
+
+	//! fills <tt>[first, last)</tt> with the next random numbers
+	template<typename OutIt>
+	void generate(OutIt first, OutIt last);
+
+	//! the engine of lane \p j
+	/*! Its next number is the next one of lane \p j after those of the last step, which \c operator()
+		may not have returned yet.
+	*/
+	Engine lane(std::size_t j) const;
+
+	//! \c long_jump every lane, giving \c L new streams
+	void long_jump();
+
+	friend bool operator==(const multi_lane_xoshiro & e1, const multi_lane_xoshiro & e2)
+	{
+		if (e1.pos != e2.pos || !std::equal(e1.buffer + e1.pos, e1.buffer + L, e2.buffer + e2.pos))
+			return false;
+
+		for (std::size_t k = 0; k < n; ++k)
+			if ( !std::equal(e1.s[k], e1.s[k] + L, e2.s[k]) )
+				return false;
+
+		return true;
+	}
+	friend bool operator!=(const multi_lane_xoshiro & e1, const multi_lane_xoshiro & e2) {return !(e1 == e2);}
+private:
+	//! word \c k of lane \c j is <tt>s[k][j]</tt>
+	boost::uint64_t s[n][L];
+	//! the numbers of the last step, and the next one to return
+	result_type buffer[L];
+	std::size_t pos;
+
+	//! \p m steps of all lanes; the numbers of step \c t go to <tt>out[t * L, (t + 1) * L)</tt>
+	void steps(result_type * out, std::size_t m);
+};
+
+// seed
+template<typename Engine, std::size_t L>
+void
+multi_lane_xoshiro<Engine, L>::seed(const Engine & eng)
+{
+	Engine e(eng);
+
+	for (std::size_t j = 0; j < L; ++j)
+	{
+		const typename Engine::state st = e.getState();
+		for (std::size_t k = 0; k < n; ++k)
+			s[k][j] = st.rep()[k];
+
+		e.jump();
+	}
+
+	pos = L;
+}
+
+// steps
+template<typename Engine, std::size_t L>
+void
+multi_lane_xoshiro<Engine, L>::steps(result_type * out, std::size_t m)
+{
+	typedef math::u64x4 V;
+
+	for (std::size_t b = 0; b < L; b += 4)
+	{
+		V v[n];
+		for (std::size_t k = 0; k < n; ++k)
+			v[k] = V::load(&s[k][b]);
+
+		for (std::size_t t = 0; t < m; ++t)
+		{
+			scrambler_type::scramble(v).store(out + t * L + b);
+			transition_type::next(v);
+		}
+
+		for (std::size_t k = 0; k < n; ++k)
+			v[k].store(&s[k][b]);
+	}
+}
+
+// generate
+template<typename Engine, std::size_t L>
+template<typename OutIt>
+void
+multi_lane_xoshiro<Engine, L>::generate(OutIt first, OutIt last)
+{
+	// numbers left from the last step
+	for (; pos < L && first != last; ++first)
+		*first = buffer[pos++];
+
+	static const std::size_t chunk = 64;
+	result_type tmp[chunk * L];
+
+	for (std::size_t remaining = std::distance(first, last); remaining >= L; )
+	{
+		const std::size_t m = std::min(chunk, remaining / L);
+		steps(tmp, m);
+		first = std::copy(tmp, tmp + m * L, first);
+		remaining -= m * L;
+	}
+
+	for (; first != last; ++first)
+		*first = (*this)();
+}
+
+// lane
+template<typename Engine, std::size_t L>
+Engine
+multi_lane_xoshiro<Engine, L>::lane(std::size_t j) const
+{
+	UIntType x[n];
+	for (std::size_t k = 0; k < n; ++k)
+		x[k] = s[k][j];
+
+	return Engine( (typename Engine::state(x)) );
+}
+
+// long_jump
+template<typename Engine, std::size_t L>
+void
+multi_lane_xoshiro<Engine, L>::long_jump()
+{
+	for (std::size_t j = 0; j < L; ++j)
+	{
+		UIntType x[n];
+		for (std::size_t k = 0; k < n; ++k)
+			x[k] = s[k][j];
+
+		Engine e( (typename Engine::state(x)) );
+		e.long_jump();
+
+		const typename Engine::state st = e.getState();
+		for (std::size_t k = 0; k < n; ++k)
+			s[k][j] = st.rep()[k];
+	}
+
+	pos = L;
+}
+
+/* engine names */
+
+//! \cond
+namespace detail {
+
+typedef boost::mpl::string<'X', 'o', 's', 'h', 'i', 'r', 'o'>::type _xoshiro_prefix;
+typedef boost::mpl::string<'X', 'o', 'r', 'o', 's', 'h', 'i', 'r'>::type _xoroshiro_prefix;
+typedef boost::mpl::string<'S', 't', 'a', 'r', 'S', 't', 'a', 'r'>::type _starstar_suffix;
+typedef boost::mpl::string<'P', 'l', 'u', 's'>::type _plus_suffix;
+
+typedef qfcl::tmp::concatenate< _xoshiro_prefix, boost::mpl::string<'2', '5', '6'>::type, _starstar_suffix >::type xoshiro256starstar_name;
+typedef qfcl::tmp::concatenate< _xoshiro_prefix, boost::mpl::string<'2', '5', '6'>::type, _plus_suffix >::type xoshiro256plus_name;
+typedef qfcl::tmp::concatenate< _xoroshiro_prefix, boost::mpl::string<'o', '1', '2', '8'>::type, _plus_suffix >::type xoroshiro128plus_name;
+typedef qfcl::tmp::concatenate< _xoshiro_prefix, boost::mpl::string<'5', '1', '2'>::type, _starstar_suffix >::type xoshiro512starstar_name;
+
+}	// namespace detail
+//! \endcond
+
+/*! \brief xoshiro256** (64-bit)
+
+	The all-purpose generator of Blackman and Vigna: 256 bits of state, period \f$2^{256} - 1\f$,
+	4-dimensionally equidistributed.
+*/
+typedef xoshiro_engine< xoshiro_traits< xoshiro256_transition, starstar_scrambler<1, 5, 7, 9>, detail::xoshiro256starstar_name > >
+	xoshiro256starstar;
+
+/*! \brief xoshiro256+ (64-bit)
+
+	Faster than xoshiro256** but the lowest bits have low linear complexity, so it is meant for
+	floating point numbers, which use the upper 53 bits.
+*/
+typedef xoshiro_engine< xoshiro_traits< xoshiro256_transition, plus_scrambler<0, 3>, detail::xoshiro256plus_name > >
+	xoshiro256plus;
+
+/*! \brief xoroshiro128+ (64-bit)
+
+	128 bits of state, period \f$2^{128} - 1\f$; as for xoshiro256+, for floating point numbers.
+*/
+typedef xoshiro_engine< xoshiro_traits< xoroshiro128_transition, plus_scrambler<0, 1>, detail::xoroshiro128plus_name > >
+	xoroshiro128plus;
+
+/*! \brief xoshiro512** (64-bit)
+
+	512 bits of state, period \f$2^{512} - 1\f$, 8-dimensionally equidistributed, for very many parallel streams.
+*/
+typedef xoshiro_engine< xoshiro_traits< xoshiro512_transition, starstar_scrambler<1, 5, 7, 9>, detail::xoshiro512starstar_name > >
+	xoshiro512starstar;
+
+/*! \name multi-lane generators
+	@{
+*/
+typedef multi_lane_xoshiro<xoshiro256starstar, 4> xoshiro256starstar_x4;
+typedef multi_lane_xoshiro<xoshiro256starstar, 8> xoshiro256starstar_x8;
+typedef multi_lane_xoshiro<xoshiro256plus, 4> xoshiro256plus_x4;
+typedef multi_lane_xoshiro<xoshiro256plus, 8> xoshiro256plus_x8;
+typedef multi_lane_xoshiro<xoroshiro128plus, 4> xoroshiro128plus_x4;
+typedef multi_lane_xoshiro<xoroshiro128plus, 8> xoroshiro128plus_x8;
+typedef multi_lane_xoshiro<xoshiro512starstar, 4> xoshiro512starstar_x4;
+typedef multi_lane_xoshiro<xoshiro512starstar, 8> xoshiro512starstar_x8;
+//!	@}
+
+//! @}
+
+}	// namespace random
+
+}	// namespace qfcl
+
+#endif	// QFCL_RANDOM_XOSHIRO_HPP
@@ -0,0 +1,489 @@
+/* qfcl/statistics/column_store.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file qfcl/statistics/column_store.hpp
+	\brief Memory mapped columnar storage of simulation results.
+
+	A column store file holds a fixed number of named columns of equal length,
+	e.g. one column per payoff, greek or path statistic. The layout is
+	- a 64 byte \c column_store_header,
+	- one 64 byte \c column_descriptor per column,
+	- the columns, each contiguous, 64 byte aligned and of room for \c capacity elements.
+
+	All header fields and all values are little-endian, so the files are portable between hosts
+	and self-describing: a reader needs nothing but the file.
+
+	Rows are appended in chunks. \c column_store_writer::append reserves a block of rows atomically,
+	so many threads can fill their own chunks concurrently, and \c chunk::commit marks a chunk as written.
+	The row count of the file only ever covers committed rows, so a reader never sees a row that was
+	reserved but not (or only partly) written. \c column_store_reader maps a file read only
+	and hands out \c column_view s, which are plain <tt>const T *</tt> ranges into the mapping.
+	These can be given directly to \c DescriptiveStatistics without loading the column into a vector.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#ifndef	QFCL_STATISTICS_COLUMN_STORE_HPP
+#define	QFCL_STATISTICS_COLUMN_STORE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/endian/integers.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+
+namespace qfcl {
+
+namespace statistics {
+
+//! element types that can be stored in a column
+enum column_type {COLUMN_DOUBLE = 1, COLUMN_FLOAT, COLUMN_INT64, COLUMN_UINT64};
+
+//! \cond
+namespace detail {
+
+template<typename T> struct column_type_of;
+template<> struct column_type_of<double>			{static const column_type value = COLUMN_DOUBLE;};
+template<> struct column_type_of<float>				{static const column_type value = COLUMN_FLOAT;};
+template<> struct column_type_of<boost::int64_t>	{static const column_type value = COLUMN_INT64;};
+template<> struct column_type_of<boost::uint64_t>	{static const column_type value = COLUMN_UINT64;};
+
+inline size_t column_element_bytes(column_type type)
+{
+	return type == COLUMN_FLOAT ? 4 : 8;
+}
+
+//! columns start on cache line boundaries
+inline boost::uint64_t column_align(boost::uint64_t offset)
+{
+	return (offset + 63) & ~boost::uint64_t(63);
+}
+
+}	// namespace detail
+//! \endcond
+
+//! the file header
+struct column_store_header
+{
+	//! the bytes "QFCS"
+	static const boost::uint32_t magic_number = 0x53434651;
+	//! the layout version written by \c column_store_writer
+	static const boost::uint16_t current_version = 1;
+
+	boost::endian::ulittle32_t magic;
+	boost::endian::ulittle16_t version;
+	boost::endian::ulittle16_t column_count;
+	//! number of elements each column has room for
+	boost::endian::ulittle64_t capacity;
+	//! number of rows written
+	boost::endian::ulittle64_t row_count;
+	char reserved[40];
+};
+
+//! describes one column
+struct column_descriptor
+{
+	//! maximum length of a column name
+	static const size_t max_name_length = 40;
+
+	//! NUL padded
+	char name[max_name_length];
+	//! a \c column_type
+	boost::endian::ulittle16_t type;
+	boost::endian::ulittle16_t element_bytes;
+	boost::endian::ulittle32_t reserved0;
+	//! offset of the first element from the start of the file
+	boost::endian::ulittle64_t offset;
+	boost::endian::ulittle64_t reserved1;
+
+	std::string get_name() const {return std::string( name, std::find(name, name + max_name_length, '\0') );}
+};
+
+BOOST_STATIC_ASSERT( sizeof(column_store_header) == 64 );
+BOOST_STATIC_ASSERT( sizeof(column_descriptor) == 64 );
+
+//! a read only, zero-copy view of a column
+template<typename T>
+class column_view
+{
+public:
+	typedef T value_type;
+	typedef const T * const_iterator;
+	typedef const_iterator iterator;
+
+	column_view(const T * first, size_t n) : first_(first), n_(n) {}
+
+	const_iterator begin() const {return first_;}
+	const_iterator end() const {return first_ + n_;}
+	size_t size() const {return n_;}
+	bool empty() const {return n_ == 0;}
+	const T & operator[](size_t i) const {return first_[i];}
+private:
+	const T * first_;
+	size_t n_;
+};
+
+//! specification of a column to be created
+struct column_spec
+{
+	column_spec(const std::string & name_, column_type type_ = COLUMN_DOUBLE) : name(name_), type(type_) {}
+
+	std::string name;
+	column_type type;
+};
+
+//! creates a column store and appends rows to it
+/*! \c append and \c chunk::commit may be called concurrently from any number of threads.
+	The row count in the header is updated by \c flush and on destruction, to the number of rows
+	before the first chunk that is not committed.
+*/
+class column_store_writer : boost::noncopyable
+{
+public:
+	//! a block of consecutive rows reserved by \c append
+	class chunk
+	{
+	public:
+		//! index of the first row of the chunk
+		boost::uint64_t first_row() const {return first;}
+		//! number of rows in the chunk
+		size_t size() const {return n;}
+
+		//! writes \c size() values to column \p k, converting them to little-endian
+		template<typename T>
+		void write(size_t k, const T * values) const {write(k, values, 0, n);}
+		//! writes \p count values to column \p k starting at row <tt>first_row() + offset</tt>
+		template<typename T>
+		void write(size_t k, const T * values, size_t offset, size_t count) const;
+
+		//! marks the rows of the chunk as written, once all of its columns are; call it once per chunk
+		void commit() const {store -> commit(first, n);}
+	private:
+		friend class column_store_writer;
+		chunk(column_store_writer & store_, boost::uint64_t first_, size_t n_)
+			: store(&store_), first(first_), n(n_) {}
+
+		column_store_writer * store;
+		boost::uint64_t first;
+		size_t n;
+	};
+
+	//! creates (or truncates) \p filename with the given columns, each with room for \p capacity rows
+	column_store_writer(const std::string & filename, const std::vector<column_spec> & columns, boost::uint64_t capacity);
+	//! records the number of rows and flushes the mapping
+	~column_store_writer();
+
+	//! reserves the next \p rows rows
+	/*! \throw std::length_error if the store would exceed its capacity
+	*/
+	chunk append(size_t rows);
+
+	//! the number of rows reserved so far
+	boost::uint64_t size() const {return reserved;}
+	//! the number of leading rows committed so far, which \c flush records
+	boost::uint64_t committed() const;
+	boost::uint64_t capacity() const {return capacity_;}
+	size_t columns() const {return header().column_count;}
+	//! the index of the column named \p name
+	/*! \throw std::out_of_range if there is no such column
+	*/
+	size_t column_index(const std::string & name) const;
+
+	//! writes the number of committed rows to the header and flushes the mapping to disk
+	void flush();
+private:
+	boost::interprocess::mapped_region region;
+	boost::uint64_t capacity_;
+	std::atomic<boost::uint64_t> reserved;
+
+	mutable std::mutex m;
+	//! rows [0, committed_) are committed
+	boost::uint64_t committed_;
+	//! committed chunks after the first uncommitted one: first row -> number of rows
+	std::map<boost::uint64_t, boost::uint64_t> pending;
+
+	void commit(boost::uint64_t first, boost::uint64_t n);
+
+	char * base() const {return static_cast<char *>(region.get_address());}
+	column_store_header & header() const {return *reinterpret_cast<column_store_header *>(base());}
+	const column_descriptor & descriptor(size_t k) const
+	{
+		return reinterpret_cast<const column_descriptor *>(base() + sizeof(column_store_header))[k];
+	}
+
+	static boost::interprocess::mapped_region create(const std::string & filename, const std::vector<column_spec> & columns,
+													 boost::uint64_t capacity);
+};
+
+//! maps a column store read only
+class column_store_reader : boost::noncopyable
+{
+public:
+	//! \throw std::runtime_error if \p filename is not a column store, or a column does not fit in it
+	explicit column_store_reader(const std::string & filename);
+
+	//! the number of rows
+	size_t size() const {return static_cast<size_t>(header().row_count);}
+	size_t columns() const {return header().column_count;}
+	std::string name(size_t k) const;
+	column_type type(size_t k) const {return static_cast<column_type>(static_cast<boost::uint16_t>(descriptor(k).type));}
+	//! the index of the column named \p name
+	/*! \throw std::out_of_range if there is no such column
+	*/
+	size_t column_index(const std::string & name) const;
+
+	//! zero-copy view of column \p k
+	/*! Only available on little-endian hosts, elsewhere use \c read_column.
+		\throw std::runtime_error if the column is not of type \c T
+	*/
+	template<typename T>
+	column_view<T> column(size_t k) const;
+	template<typename T>
+	column_view<T> column(const std::string & name) const {return column<T>( column_index(name) );}
+
+	//! copy of column \p k, in native byte order
+	template<typename T>
+	std::vector<T> read_column(size_t k) const;
+private:
+	boost::interprocess::file_mapping file;
+	boost::interprocess::mapped_region region;
+
+	const char * base() const {return static_cast<const char *>(region.get_address());}
+	const column_store_header & header() const {return *reinterpret_cast<const column_store_header *>(base());}
+	const column_descriptor & descriptor(size_t k) const
+	{
+		return reinterpret_cast<const column_descriptor *>(base() + sizeof(column_store_header))[k];
+	}
+	template<typename T>
+	const T * data(size_t k) const;
+};
+
+/* column_store_writer */
+
+inline boost::interprocess::mapped_region
+column_store_writer::create(const std::string & filename, const std::vector<column_spec> & columns, boost::uint64_t capacity)
+{
+	using namespace boost::interprocess;
+
+	if ( columns.empty() || columns.size() > 0xFFFF )
+		throw std::invalid_argument("column_store_writer: invalid number of columns");
+
+	// lay out the columns
+	std::vector<boost::uint64_t> offsets( columns.size() );
+	boost::uint64_t offset = detail::column_align( sizeof(column_store_header) + columns.size() * sizeof(column_descriptor) );
+	for (size_t k = 0; k < columns.size(); ++k)
+	{
+		if ( columns[k].name.size() >= column_descriptor::max_name_length )
+			throw std::invalid_argument("column_store_writer: column name too long: " + columns[k].name);
+
+		offsets[k] = offset;
+		offset = detail::column_align( offset + capacity * detail::column_element_bytes(columns[k].type) );
+	}
+
+	// size the file
+	{
+		std::filebuf fbuf;
+		if ( !fbuf.open( filename.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary ) )
+			throw std::runtime_error("column_store_writer: cannot create " + filename);
+		fbuf.pubseekoff( offset - 1, std::ios_base::beg );
+		fbuf.sputc(0);
+	}
+
+	file_mapping fm( filename.c_str(), read_write );
+	mapped_region region( fm, read_write );
+
+	char * base = static_cast<char *>( region.get_address() );
+	std::memset( base, 0, sizeof(column_store_header) + columns.size() * sizeof(column_descriptor) );
+
+	column_store_header & h = *reinterpret_cast<column_store_header *>(base);
+	h.magic			= column_store_header::magic_number;
+	h.version		= column_store_header::current_version;
+	h.column_count	= static_cast<boost::uint16_t>( columns.size() );
+	h.capacity		= capacity;
+	h.row_count		= 0;
+
+	column_descriptor * d = reinterpret_cast<column_descriptor *>(base + sizeof(column_store_header));
+	for (size_t k = 0; k < columns.size(); ++k)
+	{
+		std::copy( columns[k].name.begin(), columns[k].name.end(), d[k].name );
+		d[k].type			= static_cast<boost::uint16_t>(columns[k].type);
+		d[k].element_bytes	= static_cast<boost::uint16_t>( detail::column_element_bytes(columns[k].type) );
+		d[k].offset			= offsets[k];
+	}
+
+	return region;
+}
+
+inline
+column_store_writer::column_store_writer(const std::string & filename, const std::vector<column_spec> & columns,
+										 boost::uint64_t capacity)
+	: region( create(filename, columns, capacity) ), capacity_(capacity), reserved(0), committed_(0)
+{
+}
+
+inline column_store_writer::~column_store_writer()
+{
+	try
+	{
+		flush();
+	}
+	catch (...) {}
+}
+
+inline column_store_writer::chunk column_store_writer::append(size_t rows)
+{
+	boost::uint64_t first = reserved.load();
+	do
+	{
+		if (rows > capacity_ - first)
+			throw std::length_error("column_store_writer::append: capacity exceeded");
+	}
+	while ( !reserved.compare_exchange_weak(first, first + rows) );
+
+	return chunk(*this, first, rows);
+}
+
+inline size_t column_store_writer::column_index(const std::string & name) const
+{
+	for (size_t k = 0; k < columns(); ++k)
+		if ( descriptor(k).get_name() == name )
+			return k;
+
+	throw std::out_of_range("column_store: no column named " + name);
+}
+
+inline boost::uint64_t column_store_writer::committed() const
+{
+	std::lock_guard<std::mutex> lock(m);
+	return committed_;
+}
+
+inline void column_store_writer::commit(boost::uint64_t first, boost::uint64_t n)
+{
+	std::lock_guard<std::mutex> lock(m);
+	if (first != committed_)
+	{
+		pending[first] = n;
+		return;
+	}
+
+	committed_ += n;
+	// absorb the chunks that were waiting for this one
+	for (auto next = pending.begin(); next != pending.end() && next -> first == committed_; next = pending.erase(next))
+		committed_ += next -> second;
+}
+
+inline void column_store_writer::flush()
+{
+	header().row_count = committed();
+	region.flush();
+}
+
+template<typename T>
+inline void column_store_writer::chunk::write(size_t k, const T * values, size_t offset, size_t count) const
+{
+	const column_descriptor & d = store -> descriptor(k);
+	if (d.type != detail::column_type_of<T>::value)
+		throw std::runtime_error("column_store_writer::chunk::write: wrong column type");
+	if (offset + count > n)
+		throw std::out_of_range("column_store_writer::chunk::write: outside of chunk");
+
+	T * dest = reinterpret_cast<T *>( store -> base() + d.offset ) + first + offset;
+	boost::endian::native_to_little( values, dest, count );
+}
+
+/* column_store_reader */
+
+inline column_store_reader::column_store_reader(const std::string & filename)
+	: file( filename.c_str(), boost::interprocess::read_only ), region( file, boost::interprocess::read_only )
+{
+	if ( region.get_size() < sizeof(column_store_header) || header().magic != column_store_header::magic_number )
+		throw std::runtime_error("column_store_reader: " + filename + " is not a column store");
+	if ( header().version != column_store_header::current_version )
+		throw std::runtime_error("column_store_reader: unsupported version in " + filename);
+
+	// check that the descriptors and every column lie within the file, without overflowing
+	const boost::uint64_t file_size = region.get_size();
+	if ( sizeof(column_store_header) + columns() * sizeof(column_descriptor) > file_size )
+		throw std::runtime_error("column_store_reader: " + filename + " is truncated");
+
+	const boost::uint64_t rows = header().capacity;
+	if ( header().row_count > rows )
+		throw std::runtime_error("column_store_reader: " + filename + " is corrupt");
+	for (size_t k = 0; k < columns(); ++k)
+	{
+		const column_descriptor & d = descriptor(k);
+		if ( type(k) < COLUMN_DOUBLE || type(k) > COLUMN_UINT64 || d.element_bytes != detail::column_element_bytes( type(k) ) )
+			throw std::runtime_error("column_store_reader: " + filename + " is corrupt");
+		if ( d.offset > file_size || rows > (file_size - d.offset) / d.element_bytes )
+			throw std::runtime_error("column_store_reader: " + filename + " is truncated");
+	}
+}
+
+inline std::string column_store_reader::name(size_t k) const
+{
+	return descriptor(k).get_name();
+}
+
+inline size_t column_store_reader::column_index(const std::string & name_) const
+{
+	for (size_t k = 0; k < columns(); ++k)
+		if (name(k) == name_)
+			return k;
+
+	throw std::out_of_range("column_store: no column named " + name_);
+}
+
+template<typename T>
+inline const T * column_store_reader::data(size_t k) const
+{
+	if ( type(k) != detail::column_type_of<T>::value || descriptor(k).element_bytes != sizeof(T) )
+		throw std::runtime_error("column_store_reader: wrong column type");
+
+	return reinterpret_cast<const T *>( base() + descriptor(k).offset );
+}
+
+template<typename T>
+inline column_view<T> column_store_reader::column(size_t k) const
+{
+#ifdef BOOST_LITTLE_ENDIAN
+	return column_view<T>( data<T>(k), size() );
+#else
+	throw std::runtime_error("column_store_reader::column: zero-copy views require a little-endian host, use read_column");
+#endif
+}
+
+template<typename T>
+inline std::vector<T> column_store_reader::read_column(size_t k) const
+{
+	std::vector<T> v( size() );
+	if ( !v.empty() )
+		boost::endian::little_to_native( data<T>(k), &v[0], v.size() );
+
+	return v;
+}
+
+}	// namespace statistics
+
+}	// namespace qfcl
+
+#endif	// !QFCL_STATISTICS_COLUMN_STORE_HPP
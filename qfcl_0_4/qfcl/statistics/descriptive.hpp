@@ -19,6 +19,7 @@
 #ifndef	QFCL_STATISTICS_DESCRIPTIVE_HPP
 #define	QFCL_STATISTICS_DESCRIPTIVE_HPP
 
+#include <algorithm>
 #include <functional>
 #include <iomanip>
 #include <map>
@@ -145,6 +146,10 @@ private:
 	ValType value;
 };
 
+//! tag for the \c DescriptiveStatistics constructor that uses the sample in place, without copying it
+struct in_place_t {};
+const in_place_t in_place = in_place_t();
+
 template<typename T = double>
 class DescriptiveStatistics
 {
@@ -159,6 +164,7 @@ public:
 	DescriptiveStatistics(const std::map<Key, CounterType> & m); /// sample is given as a map, allow key to be converted to T
 	template <typename RealIter>
 	DescriptiveStatistics(RealIter begin, RealIter end);	/// sample is given as an iterator range
+	DescriptiveStatistics(const T * begin, const T * end, in_place_t);	/// sample is used in place, e.g. a memory mapped column; it must outlive *this
 
 	size_t size() const {return n;}
 	T min() const {return computeProperty(MIN);}			/// min
@@ -168,7 +174,7 @@ public:
 	T median() const {return computeProperty(MEDIAN);}	/// median (roughly, the 50% quantile: middle number when odd length, avg. of 2 mid numbers when even length)
 	Set mode() const;										/// mode (high frequency, when defined)
 	T var() const {return computeProperty(VAR);}			/// sample variance (unbiased, cf. variance())
-    Vector sample() const {return v;}                   /// returns the sample as a vector
+    Vector sample() const {return Vector( v.begin(), v.end() );}	/// returns (a copy of) the sample as a vector
 	T sd() const {return computeProperty(SD);}			/// sample standard deviation = sqrt(var())
 	T se() const {return computeProperty(SE);}			/// sample standard error = sd() / n
 	T skew() const {return computeProperty(SKEW);}		/// sample Fisher Skew (cf. FisherSkew())
@@ -207,7 +213,33 @@ public:
 	std::ostream & log_distribution_histogram(std::ostream & os, size_t slots, T from, T end, 
 		size_t num_rows = QFCL_STATISTICS_NUMROWS, size_t prec = QFCL_STATISTICS_PRECISION) const;
 private:
-	const Vector v;
+	/// the sample, either owned or viewed in place
+	class sample_type
+	{
+	public:
+		typedef const T * const_iterator;
+		typedef const_iterator iterator;
+		typedef T value_type;
+
+		explicit sample_type(const Vector & values) : owned(values), first(owned.data()), last(first + owned.size()) {}
+		sample_type(const T * first_, const T * last_) : first(first_), last(last_) {}
+		sample_type(const sample_type & s) : owned(s.owned), first(s.owns() ? owned.data() : s.first), last(first + s.size()) {}
+
+		const_iterator begin() const {return first;}
+		const_iterator end() const {return last;}
+		size_t size() const {return last - first;}
+		const T & operator[](size_t i) const {return first[i];}
+	private:
+		bool owns() const {return !owned.empty();}
+
+		Vector owned;
+		const T * first;
+		const T * last;
+
+		sample_type & operator=(const sample_type &);
+	};
+
+	const sample_type v;
 	//mutable MSet sorted_;		/// sorted values
 	//mutable Map sorted_;
 	mutable Map mapped_;		/// mapped (i.e. counted) values
@@ -285,6 +317,11 @@ private:
 
 	T compute_JB() const;
 
+	/// sum of x^k over the sample, in a single pass without temporaries
+	T moment_sum(unsigned k) const;
+	/// sum of (x - mean)^k over the sample, in a single pass without temporaries
+	T central_moment_sum(unsigned k) const;
+
 	T compute_mapped() const;
 	T compute_log_mapped() const;
 	T compute_cdf() const;
@@ -311,7 +348,7 @@ void DescriptiveStatistics<T>::initialize()
 // vector ctor
 template<typename T>
 DescriptiveStatistics<T>::DescriptiveStatistics(const typename DescriptiveStatistics<T>::Vector & values)
-	: v(values), n(v.size()), centered_(n), zscores_(n)
+	: v(values), n(v.size()), computedZScores(false)
 {
 	initialize();
 }
@@ -342,7 +379,7 @@ DescriptiveStatistics<T>::map_to_vector(const std::map<Key, CounterType> & m)
 template<typename T>
 template<typename Key, typename CounterType>
 DescriptiveStatistics<T>::DescriptiveStatistics(const std::map<Key, CounterType> & m)
-	: v(map_to_vector(m)), n(v.size()), centered_(n), zscores_(n)
+	: v(map_to_vector(m)), n(v.size()), computedZScores(false)
 {
 	initialize();
 }
@@ -351,7 +388,15 @@ DescriptiveStatistics<T>::DescriptiveStatistics(const std::map<Key, CounterType>
 template<typename T>
 template<typename RealIter>
 DescriptiveStatistics<T>::DescriptiveStatistics(RealIter begin, RealIter end) 
-	: v(begin, end), n( v.size() ), centered_(n), zscores_(n)
+	: v( Vector(begin, end) ), n( v.size() ), computedZScores(false)
+{
+	initialize();
+}
+
+// in place ctor
+template<typename T>
+DescriptiveStatistics<T>::DescriptiveStatistics(const T * begin, const T * end, in_place_t)
+	: v(begin, end), n( v.size() ), computedZScores(false)
 {
 	initialize();
 }
@@ -385,21 +430,21 @@ T DescriptiveStatistics<T>::computeProperty(PropertyType p) const
 template<typename T>
 T DescriptiveStatistics<T>::compute_min() const
 {
-	return *min_element( begin(v), end(v) );
+	return *std::min_element( v.begin(), v.end() );
 }
 
 // max
 template<typename T>
 T DescriptiveStatistics<T>::compute_max() const
 {
-	return *max_element( begin(v), end(v) );
+	return *std::max_element( v.begin(), v.end() );
 }
 
 // mean
 template<typename T>
 T DescriptiveStatistics<T>::compute_mean() const
 {
-	T sum = std::accumulate( begin(v), end(v), 0.);
+	T sum = std::accumulate( v.begin(), v.end(), 0.);
 
 	return sum / n;
 }
@@ -435,6 +480,7 @@ T DescriptiveStatistics<T>::compute_centered() const
 {
 	using namespace std;
 
+	centered_.resize(n);
 	transform( begin(v), end(v), begin(centered_), boost::bind( minus<T>(), _1, mean() ) );
 
 	return 0.;
@@ -497,26 +543,13 @@ T DescriptiveStatistics<T>::compute_quantile() const
 template<typename T>
 T DescriptiveStatistics<T>::compute_EmpVar() const
 {
-	/// computed centered values
-	computeProperty(CENTERED);
-
-	Vector temp(n);
-	square_transform( begin(centered_), end(centered_), begin(temp) );
-	
-	T sum = accumulate( begin(temp), end(temp), 0.);
-
-	return sum / n;
+	return central_moment_sum(2) / n;
 }
 
 template<typename T>
 T DescriptiveStatistics<T>::compute_EmpM2() const
 {
-	Vector temp(n);
-	square_transform( begin(v), end(v), begin(temp) );
-
-	T sum = accumulate(temp.begin(), temp.end(), 0.);
-	
-	return sum / n;
+	return moment_sum(2) / n;
 }
 
 /// var
@@ -571,26 +604,14 @@ T DescriptiveStatistics<T>::compute_se() const
 template<typename T>
 T DescriptiveStatistics<T>::compute_EmpCM3() const
 {
-	computeProperty(CENTERED);
-
-	Vector temp(n);
-	cube_transform( begin(centered_), end(centered_), begin(temp) );
-
-	T sum = accumulate( begin(temp), end(temp), 0. );
-
-	return sum / n;
+	return central_moment_sum(3) / n;
 }
 
 /// Emprical 3rd moment
 template<typename T>
 T DescriptiveStatistics<T>::compute_EmpM3() const
 {
-	Vector temp(n);
-	cube_transform( begin(v), end(v), begin(temp) );
-
-	T sum = accumulate( begin(temp), end(temp), 0. );
-
-	return sum / n;
+	return moment_sum(3) / n;
 }
 
 /// Empirical Skew
@@ -629,26 +650,14 @@ T DescriptiveStatistics<T>::compute_skew() const
 template<typename T>
 T DescriptiveStatistics<T>::compute_EmpM4() const
 {
-	Vector temp(n);
-	quad_transform( begin(v), end(v), begin(temp) );
-
-	T sum = accumulate( begin(temp), end(temp), 0. );
-
-	return sum / n;
+	return moment_sum(4) / n;
 }
 
 /// Empirical central 4th moment
 template<typename T>
 T DescriptiveStatistics<T>::compute_EmpCM4() const
 {
-	computeProperty(CENTERED);
-
-	Vector temp(n);
-	quad_transform( begin(centered_), end(centered_), temp.begin() );
-
-	T sum = accumulate( begin(temp), end(temp), 0. );
-
-	return sum / n;
+	return central_moment_sum(4) / n;
 }
 
 /// Empirical Kurtosis
@@ -749,9 +758,6 @@ T DescriptiveStatistics<T>::CM(unsigned k) const
 template<typename T>
 T DescriptiveStatistics<T>::EmpMoment(unsigned k) const
 {
-    using namespace std;
-    using std::placeholders::_1;
-
 	switch( k )
 	{
 	case 0:
@@ -765,11 +771,7 @@ T DescriptiveStatistics<T>::EmpMoment(unsigned k) const
 	case 4:
 		return computeProperty(EMP_M4);
 	default:	/// k > 4
-		Vector temp(n);
-        transform( v.begin(), v.end(), temp.begin(), bind( pow<T>, _1, k ) );
-
-        auto sum = accumulate(temp.begin(), temp.end(), 0.);
-		return sum / n;
+		return moment_sum(k) / n;
 	}
 }
 
@@ -777,9 +779,6 @@ T DescriptiveStatistics<T>::EmpMoment(unsigned k) const
 template<typename T>
 T DescriptiveStatistics<T>::EmpCM(unsigned k) const
 {
-    using namespace std;
-    using std::placeholders::_1;
-
 	switch( k )
 	{
 	case 0:
@@ -793,14 +792,57 @@ T DescriptiveStatistics<T>::EmpCM(unsigned k) const
 	case 4:
 		return computeProperty(EMP_CM4);
 	default:	/// k > 4
-		computeProperty(CENTERED);
+		return central_moment_sum(k) / n;
+	}
+}
+
+/// moment_sum
+template<typename T>
+T DescriptiveStatistics<T>::moment_sum(unsigned k) const
+{
+	T sum = 0;
+
+	switch (k)
+	{
+	case 2:
+		BOOST_FOREACH(T x, v) sum += x * x;
+		break;
+	case 3:
+		BOOST_FOREACH(T x, v) sum += x * x * x;
+		break;
+	case 4:
+		BOOST_FOREACH(T x, v) {T x2 = x * x; sum += x2 * x2;}
+		break;
+	default:
+		BOOST_FOREACH(T x, v) sum += pow(x, static_cast<T>(k));
+	}
+
+	return sum;
+}
 
-		Vector temp(n);
-        transform( centered_.begin(), centered_.end(), temp.begin(), bind( pow<T>, _1, k ) );
+/// central_moment_sum
+template<typename T>
+T DescriptiveStatistics<T>::central_moment_sum(unsigned k) const
+{
+	const T mu = mean();
+	T sum = 0;
 
-		T sum = accumulate(temp.begin(), temp.end(), 0.);
-		return sum / n;
+	switch (k)
+	{
+	case 2:
+		BOOST_FOREACH(T x, v) {T y = x - mu; sum += y * y;}
+		break;
+	case 3:
+		BOOST_FOREACH(T x, v) {T y = x - mu; sum += y * y * y;}
+		break;
+	case 4:
+		BOOST_FOREACH(T x, v) {T y = x - mu; T y2 = y * y; sum += y2 * y2;}
+		break;
+	default:
+		BOOST_FOREACH(T x, v) sum += pow(x - mu, static_cast<T>(k));
 	}
+
+	return sum;
 }
 
 /// JB
@@ -818,6 +860,7 @@ void DescriptiveStatistics<T>::computeZScores() const
 {
 	if (!computedZScores)
 	{
+		zscores_.resize(n);
         transform( v.begin(), v.end(), zscores_.begin(), boost::bind( std::divides<T>(), boost::bind( std::minus<T>(), _1, mean() ), sd() ) );
 
 		computedZScores = true;
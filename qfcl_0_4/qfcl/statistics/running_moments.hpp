@@ -0,0 +1,83 @@
+/* qfcl/statistics/running_moments.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file qfcl/statistics/running_moments.hpp
+	\brief Online mean and variance that can be merged.
+
+	\c running_moments is an accumulator in the sense of boost::accumulators (it is fed one value at a time
+	by <tt>operator()</tt>), which in addition can be merged with another one, using the pairwise update of
+	Chan, Golub and LeVeque. This is what a multi-threaded simulation needs: one accumulator per thread,
+	merged at the end.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#ifndef	QFCL_STATISTICS_RUNNING_MOMENTS_HPP
+#define	QFCL_STATISTICS_RUNNING_MOMENTS_HPP
+
+#include <cmath>
+#include <cstddef>
+
+namespace qfcl {
+namespace statistics {
+
+//! Count, mean and sum of squared deviations of a sample, updated online
+template<typename T = double>
+class running_moments
+{
+public:
+	typedef T result_type;
+
+	running_moments() : n_(0), mean_(0), M2_(0) {}
+
+	//! adds \p x to the sample
+	void operator()(T x)
+	{
+		++n_;
+		T delta = x - mean_;
+		mean_ += delta / n_;
+		M2_ += delta * (x - mean_);
+	}
+
+	//! adds the sample of \p other
+	void merge(const running_moments & other)
+	{
+		if (other.n_ == 0)
+			return;
+		if (n_ == 0)
+		{
+			*this = other;
+			return;
+		}
+
+		std::size_t n = n_ + other.n_;
+		T delta = other.mean_ - mean_;
+		mean_ += delta * other.n_ / n;
+		M2_ += other.M2_ + delta * delta * (T(n_) * other.n_ / n);
+		n_ = n;
+	}
+
+	std::size_t count() const {return n_;}
+	T mean() const {return mean_;}
+	//! sample variance
+	T variance() const {return n_ > 1 ? M2_ / (n_ - 1) : T(0);}
+	//! standard error of the mean
+	T standard_error() const {return n_ > 0 ? std::sqrt(variance() / n_) : T(0);}
+
+private:
+	std::size_t n_;
+	T mean_;
+	T M2_;
+};
+
+}	// namespace statistics
+}	// namespace qfcl
+
+#endif	// QFCL_STATISTICS_RUNNING_MOMENTS_HPP
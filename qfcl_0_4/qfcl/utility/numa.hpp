@@ -0,0 +1,201 @@
+/* qfcl/utility/numa.hpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+#ifndef QFCL_UTILITY_NUMA_HPP
+#define QFCL_UTILITY_NUMA_HPP
+
+/*! \file qfcl/utility/numa.hpp
+	\brief NUMA topology and thread pinning
+
+	Memory is placed on the node of the thread that first writes it (first touch), so data used by one
+	worker thread should be allocated and initialized by that worker, after it has been pinned to a CPU.
+
+	The topology is read from \c /sys/devices/system/node on Linux, restricted to the CPUs the process may
+	run on; nodes without such CPUs are left out, and the others are numbered from 0. Elsewhere, or if it
+	cannot be read, the machine is one node, and pinning is not supported. No NUMA library is needed, and
+	only the standard library's threads are used, so that the engines including this header (through
+	their jump matrix cache) do not need to link Boost.Thread.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace qfcl {
+namespace numa {
+
+//! \cond
+namespace detail {
+
+//! the numbers in a Linux cpu or node list such as "0-3,8-11"
+inline std::vector<unsigned int> parse_list(const std::string & list)
+{
+	std::vector<unsigned int> numbers;
+	std::istringstream in(list);
+	std::string range;
+	while ( std::getline(in, range, ',') )
+	{
+		unsigned int first, last;
+		char dash;
+		std::istringstream r(range);
+		if ( !(r >> first) )
+			continue;
+		if ( !(r >> dash >> last) || dash != '-' )
+			last = first;
+		for (unsigned int n = first; n <= last; ++n)
+			numbers.push_back(n);
+	}
+
+	return numbers;
+}
+
+//! the first line of \p filename, or the empty string
+inline std::string read_line(const std::string & filename)
+{
+	std::ifstream in( filename.c_str() );
+	std::string line;
+	std::getline(in, line);
+
+	return line;
+}
+
+}	// namespace detail
+//! \endcond
+
+//! the NUMA nodes of the machine, and their CPUs
+class topology
+{
+public:
+	//! the topology of this machine, read once
+	static const topology & system()
+	{
+		static const topology t;
+		return t;
+	}
+
+	std::size_t nodes() const {return node_cpus.size();}
+	//! the CPUs of \p node
+	const std::vector<unsigned int> & cpus(std::size_t node) const {return node_cpus[node];}
+	//! the node of \p cpu
+	std::size_t node_of_cpu(unsigned int cpu) const {return cpu < cpu_node.size() ? cpu_node[cpu] : 0;}
+
+	/*! \name placement of workers
+		Workers <tt>0, 1, 2, ...</tt> are dealt to the nodes in turn, and within a node to its CPUs in turn,
+		so any number of workers is spread evenly over the nodes.
+		@{
+	*/
+	std::size_t worker_node(std::size_t worker) const {return worker % nodes();}
+	unsigned int worker_cpu(std::size_t worker) const
+	{
+		const std::vector<unsigned int> & c = node_cpus[worker_node(worker)];
+		return c[(worker / nodes()) % c.size()];
+	}
+	//!	@}
+private:
+	topology();
+
+	std::vector< std::vector<unsigned int> > node_cpus;
+	std::vector<std::size_t> cpu_node;
+};
+
+// ctor
+inline topology::topology()
+{
+#if defined(__linux__)
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	const bool restricted = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+	const std::string root = "/sys/devices/system/node/";
+	const std::vector<unsigned int> online = detail::parse_list( detail::read_line(root + "online") );
+	for (std::size_t k = 0; k < online.size(); ++k)
+	{
+		std::ostringstream filename;
+		filename << root << "node" << online[k] << "/cpulist";
+
+		std::vector<unsigned int> cpus;
+		const std::vector<unsigned int> listed = detail::parse_list( detail::read_line( filename.str() ) );
+		for (std::size_t j = 0; j < listed.size(); ++j)
+			if ( !restricted || (listed[j] < CPU_SETSIZE && CPU_ISSET(listed[j], &allowed)) )
+				cpus.push_back(listed[j]);
+		if ( cpus.empty() )
+			continue;
+
+		for (std::size_t j = 0; j < cpus.size(); ++j)
+		{
+			if (cpus[j] >= cpu_node.size())
+				cpu_node.resize(cpus[j] + 1, 0);
+			cpu_node[cpus[j]] = node_cpus.size();
+		}
+		node_cpus.push_back(cpus);
+	}
+#endif
+
+	if ( node_cpus.empty() )
+	{
+		// one node
+		node_cpus.resize(1);
+		const unsigned int n = std::thread::hardware_concurrency();
+		for (unsigned int cpu = 0; cpu < (n > 0 ? n : 1); ++cpu)
+			node_cpus[0].push_back(cpu);
+		cpu_node.assign(node_cpus[0].size(), 0);
+	}
+}
+
+//! pin the calling thread to \p cpu; \c false if it could not be pinned
+inline bool pin_this_thread(unsigned int cpu)
+{
+#if defined(__linux__)
+	if (cpu >= CPU_SETSIZE)
+		return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+//! pin the calling thread to the CPU of \p worker (see \c topology::worker_cpu)
+inline bool pin_worker(std::size_t worker)
+{
+	return pin_this_thread( topology::system().worker_cpu(worker) );
+}
+
+//! the node the calling thread is running on
+inline std::size_t current_node()
+{
+#if defined(__linux__)
+	if (topology::system().nodes() == 1)
+		return 0;
+	const int cpu = sched_getcpu();
+
+	return cpu < 0 ? 0 : topology::system().node_of_cpu(cpu);
+#else
+	return 0;
+#endif
+}
+
+}	// namespace numa
+}	// namespace qfcl
+
+#endif	// QFCL_UTILITY_NUMA_HPP
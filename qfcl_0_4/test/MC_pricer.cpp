@@ -0,0 +1,266 @@
+/* test/MC_pricer.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/MC_pricer.cpp
+	\brief Tests the Monte Carlo pricer on barrier options.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/math/distributions/normal.hpp>
+
+#include <qfcl/finance/MC_pricer.hpp>
+#include <qfcl/finance/instruments/barrier_option.hpp>
+#include <qfcl/finance/markets/gbm_market.hpp>
+#include <qfcl/statistics/running_moments.hpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+using namespace qfcl::finance;
+using qfcl::statistics::running_moments;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+struct call
+{
+	explicit call(double K) : K(K) {}
+	double operator()(double S) const {return std::max(S - K, 0.0);}
+	double K;
+};
+
+typedef barrier_option<double, call> option_type;
+typedef MC_pricer< gbm_market<>, running_moments<>, option_type > pricer_type;
+
+const gbm_market<> market(100.0, 0.05, 0.0, 0.2);
+
+//! 52 weekly monitoring dates over one year (364 days)
+std::vector<date_type> weekly_dates()
+{
+	std::vector<date_type> dates;
+	date_type d(2013, 1, 1);
+	for (int i = 0; i < 52; ++i)
+		dates.push_back( d += boost::gregorian::days(7) );
+	return dates;
+}
+
+running_moments<> price(const option_type & option, long N, unsigned int threads)
+{
+	pricer_type pricer(market, running_moments<>(), option, 1000, threads);
+	pricer.simulate(N);
+	return pricer.get_statistics();
+}
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(MC_pricer_suite)
+
+//! merged accumulators agree with one accumulator of the whole sample
+BOOST_AUTO_TEST_CASE(merge)
+{
+	BOOST_TEST_MESSAGE("\nTesting the Monte Carlo pricer:\n\nTesting merging of statistics ...");
+
+	running_moments<> all, first, second;
+	for (int i = 0; i < 1000; ++i)
+	{
+		double x = std::sin(i * 0.37) * (i % 7);
+		all(x);
+		(i < 300 ? first : second)(x);
+	}
+	first.merge(second);
+
+	BOOST_CHECK_EQUAL( first.count(), all.count() );
+	BOOST_CHECK_CLOSE( first.mean(), all.mean(), 1e-10 );
+	BOOST_CHECK_CLOSE( first.variance(), all.variance(), 1e-10 );
+}
+
+//! without barriers: the Black-Scholes price
+BOOST_AUTO_TEST_CASE(vanilla)
+{
+	BOOST_TEST_MESSAGE("Testing a call without barriers ...");
+
+	std::vector<date_type> expiry(1, date_type(2013, 1, 1) + boost::gregorian::days(365));
+	option_type option( _payoff = call(100.0), _t0 = date_type(2013, 1, 1), _dates = expiry );
+
+	running_moments<> stats = price(option, 200000, 4);
+	BOOST_CHECK_EQUAL( stats.count(), 200000u );
+	BOOST_CHECK( std::abs(stats.mean() - 10.4506) < 4 * stats.standard_error() );
+}
+
+//! knock-in plus knock-out is the vanilla option, path by path
+BOOST_AUTO_TEST_CASE(in_out_parity)
+{
+	BOOST_TEST_MESSAGE("Testing in-out parity ...");
+
+	const date_type t0(2013, 1, 1);
+	const std::vector<date_type> dates = weekly_dates();
+
+	option_type vanilla( _payoff = call(100.0), _t0 = t0, _dates = dates );
+	option_type down_out( _payoff = call(100.0), _t0 = t0, _dates = dates, _lower_barrier = 90.0, _down = OUT );
+	option_type down_in( _payoff = call(100.0), _t0 = t0, _dates = dates, _lower_barrier = 90.0, _down = IN );
+	option_type up_out( _payoff = call(100.0), _t0 = t0, _dates = dates, _upper_barrier = 130.0, _up = OUT );
+	option_type up_in( _payoff = call(100.0), _t0 = t0, _dates = dates, _upper_barrier = 130.0, _up = IN );
+
+	const long N = 50000;
+	const double v = price(vanilla, N, 2).mean();
+	const double out = price(down_out, N, 2).mean(), in = price(down_in, N, 2).mean();
+
+	BOOST_CHECK_CLOSE( in + out, v, 1e-9 );
+	BOOST_CHECK( in > 0 && out > 0 && out < v );
+	BOOST_CHECK_CLOSE( price(up_in, N, 2).mean() + price(up_out, N, 2).mean(), v, 1e-9 );
+}
+
+//! the scenarios do not depend on the number of threads
+BOOST_AUTO_TEST_CASE(threads)
+{
+	BOOST_TEST_MESSAGE("Testing independence of the number of threads ...");
+
+	option_type option( _payoff = call(100.0), _t0 = date_type(2013, 1, 1), _dates = weekly_dates(),
+						_lower_barrier = 80.0, _down = OUT, _upper_barrier = 140.0, _up = OUT );
+
+	running_moments<> one = price(option, 20500, 1), many = price(option, 20500, 4);
+	BOOST_CHECK_EQUAL( one.count(), many.count() );
+	BOOST_CHECK_CLOSE( one.mean(), many.mean(), 1e-9 );
+	BOOST_CHECK_CLOSE( one.variance(), many.variance(), 1e-9 );
+
+	// statistics passed to the pricer keep their samples, and are counted once
+	running_moments<> initial;
+	for (int i = 0; i < 100; ++i)
+		initial(1.0 + i % 3);
+	pricer_type continued(market, initial, option, 1000, 4);
+	continued.simulate(20500);
+	running_moments<> expected = initial;
+	expected.merge(one);
+	BOOST_CHECK_EQUAL( continued.get_statistics().count(), expected.count() );
+	BOOST_CHECK_CLOSE( continued.get_statistics().mean(), expected.mean(), 1e-9 );
+
+	// two calls continue the sequence of batches
+	pricer_type pricer(market, running_moments<>(), option, 1000, 3);
+	pricer.simulate(10000);
+	pricer.simulate(10500);
+	BOOST_CHECK_CLOSE( pricer.get_statistics().mean(), one.mean(), 1e-9 );
+}
+
+//! pinning the workers to the NUMA nodes does not change the scenarios
+BOOST_AUTO_TEST_CASE(pinned_threads)
+{
+	BOOST_TEST_MESSAGE("Testing pinned worker threads ...");
+
+	option_type option( _payoff = call(100.0), _t0 = date_type(2013, 1, 1), _dates = weekly_dates(),
+						_lower_barrier = 80.0, _down = OUT );
+
+	pricer_type pricer(market, running_moments<>(), option, 1000, 4);
+	pricer.pin_threads(true);
+	pricer.simulate(20500);
+
+	const running_moments<> unpinned = price(option, 20500, 1);
+	BOOST_CHECK_EQUAL( pricer.get_statistics().count(), unpinned.count() );
+	BOOST_CHECK_CLOSE( pricer.get_statistics().mean(), unpinned.mean(), 1e-9 );
+
+	const qfcl::numa::topology & t = qfcl::numa::topology::system();
+	BOOST_CHECK( t.nodes() >= 1 && t.node_of_cpu( t.worker_cpu(5) ) == t.worker_node(5) );
+}
+
+//! Brownian bridge monitoring on a coarse grid gives the continuously monitored price
+BOOST_AUTO_TEST_CASE(continuous_monitoring)
+{
+	BOOST_TEST_MESSAGE("Testing continuous barrier monitoring ...");
+
+	// 5 dates, 73 days apart
+	const date_type t0(2013, 1, 1);
+	std::vector<date_type> dates;
+	for (int i = 1; i <= 5; ++i)
+		dates.push_back( t0 + boost::gregorian::days(73 * i) );
+
+	// closed form down-and-out call, H < K (Reiner and Rubinstein)
+	const double S = 100, K = 100, H = 90, r = 0.05, sigma = 0.2, T = 1;
+	const double sqrtT = sigma * std::sqrt(T);
+	const double lambda = (r + 0.5 * sigma * sigma) / (sigma * sigma);
+	const double y = std::log(H * H / (S * K)) / sqrtT + lambda * sqrtT;
+	boost::math::normal N;
+	const double down_in = S * std::pow(H / S, 2 * lambda) * cdf(N, y)
+						 - K * std::exp(-r * T) * std::pow(H / S, 2 * lambda - 2) * cdf(N, y - sqrtT);
+	const double down_out = 10.4506 - down_in;
+
+	option_type continuous( _payoff = call(K), _t0 = t0, _dates = dates, _lower_barrier = H, _down = OUT,
+							_monitoring = CONTINUOUS );
+	option_type discrete( _payoff = call(K), _t0 = t0, _dates = dates, _lower_barrier = H, _down = OUT );
+
+	running_moments<> c = price(continuous, 200000, 4), d = price(discrete, 200000, 4);
+	BOOST_CHECK( std::abs(c.mean() - down_out) < 4 * c.standard_error() );
+	BOOST_CHECK( d.mean() - down_out > 4 * d.standard_error() );
+	BOOST_TEST_MESSAGE("closed form " << down_out << ", Brownian bridge " << c.mean() << " +- " << c.standard_error()
+					   << ", discrete " << d.mean() << " +- " << d.standard_error());
+
+	// knock-in: the complementary probabilities
+	option_type continuous_in( _payoff = call(K), _t0 = t0, _dates = dates, _lower_barrier = H, _down = IN,
+							   _monitoring = CONTINUOUS );
+	option_type vanilla( _payoff = call(K), _t0 = t0, _dates = dates );
+	BOOST_CHECK_CLOSE( price(continuous_in, 200000, 4).mean() + c.mean(), price(vanilla, 200000, 4).mean(), 1e-9 );
+}
+
+//! antithetic variates and moment matching are unbiased, reduce the standard error and do not depend on the threads
+BOOST_AUTO_TEST_CASE(variance_reduction)
+{
+	BOOST_TEST_MESSAGE("Testing variance reduction ...");
+
+	std::vector<date_type> expiry(1, date_type(2013, 1, 1) + boost::gregorian::days(365));
+	option_type option( _payoff = call(100.0), _t0 = date_type(2013, 1, 1), _dates = expiry );
+	const long N = 100000;
+
+	const running_moments<> plain = price(option, N, 4);
+
+	pricer_type antithetic(market, running_moments<>(), option, 1000, 4);
+	antithetic.antithetic(true);
+	antithetic.simulate(N);
+	const running_moments<> a = antithetic.get_statistics();
+	BOOST_CHECK_EQUAL( a.count(), static_cast<std::size_t>(N / 2) );
+	BOOST_CHECK( std::abs(a.mean() - 10.4506) < 4 * a.standard_error() );
+	BOOST_CHECK_LT( a.standard_error(), plain.standard_error() / 1.3 );
+
+	// an odd batch leaves one path unpaired
+	pricer_type odd(market, running_moments<>(), option, 999, 1);
+	odd.antithetic(true);
+	odd.simulate(999);
+	BOOST_CHECK_EQUAL( odd.get_statistics().count(), 500u );
+
+	pricer_type matched(market, running_moments<>(), option, 1000, 4);
+	matched.moment_matching(true);
+	matched.simulate(N);
+	const running_moments<> m = matched.get_statistics();
+	BOOST_CHECK_EQUAL( m.count(), static_cast<std::size_t>(N) );
+	BOOST_CHECK( std::abs(m.mean() - 10.4506) < 4 * m.standard_error() + 10.4506 / 1000 );
+
+	// both, path dependent, with one and with several threads
+	option_type barrier( _payoff = call(100.0), _t0 = date_type(2013, 1, 1), _dates = weekly_dates(),
+						 _lower_barrier = 80.0, _down = OUT );
+	pricer_type one(market, running_moments<>(), barrier, 1000, 1), many(market, running_moments<>(), barrier, 1000, 4);
+	one.antithetic(true);
+	one.moment_matching(true);
+	many.antithetic(true);
+	many.moment_matching(true);
+	one.simulate(20500);
+	many.simulate(20500);
+	BOOST_CHECK_EQUAL( one.get_statistics().count(), many.get_statistics().count() );
+	BOOST_CHECK_CLOSE( one.get_statistics().mean(), many.get_statistics().mean(), 1e-9 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -137,6 +137,7 @@ struct MC_functor
 		// Create the basic SDE (Context class)
 		Range<double> range (0.0, T);
 		sde = Sde<double, double, double>(initialCondition, range, drift, driftCorrected, diffusion, diffusionDerivative);
+		sde.structure = SdeStructure<double>::cev(r - d, vol, beta);	// OneFactorSDE is CEV; remove for CIRSDE
 	}
 
 	typedef void result_type;
@@ -197,11 +198,9 @@ void MC_functor<CounterType>::operator()(Engine & e, FDM & f)
 	//Milstein<double,double,double,Engine> fdm(N, sde, rng); // Slight improvement on Euler
 
 	// Karhunen-Loeve family
-	double tol = 0.01; // Determines number of terms in truncated KL expansion
-	//cout << "tol: "; cin >> tol;
-	//KarhunenLoeve<double,double,double,Engine> fdm(N, sde, rng, tol); // Euler + KL
-	//KarhunenLoeve<double,double,double,boost::lagged_fibonacci607> fdm(N, sde, rng, tol); // Euler + KL
-	//PredictorCorrectorKL<double,double,double,Engine> fdm(N, sde, rng, 0.5, 0.5, tol); // PC + KL
+	//KarhunenLoeve<double,double,double,Engine> fdm(N, sde, rng); // Euler + KL
+	//KarhunenLoeve<double,double,double,boost::lagged_fibonacci607> fdm(N, sde, rng); // Euler + KL
+	//PredictorCorrectorKL<double,double,double,Engine> fdm(N, sde, rng, 0.5, 0.5); // PC + KL
 				
 	MCReporter mcr(precision, histogram_display, num_bins, num_rows);
 
@@ -0,0 +1,164 @@
+/* test/black_scholes.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/black_scholes.cpp
+	\brief Tests the GBM analytics: Black-Scholes greeks, the array exponential and the batch samplers.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/finance/analytics/black_scholes.hpp>
+#include <qfcl/math/simd/exp.hpp>
+#include <qfcl/random/distribution/gbm_at_fixed_time.hpp>
+#include <qfcl/random/distribution/gbm_npv_vanilla_call.hpp>
+#include <qfcl/random/distribution/gbm_npv_vanilla_put.hpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+using namespace qfcl::finance;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+double price(call_put type, double S, double r, double sigma, double t)
+{
+	return black_scholes_price(type, S, 100.0, r, 0.02, sigma, t);
+}
+
+//! whether the mean of the samples \p x is within 4 standard errors of \p expected
+bool mean_agrees(const std::vector<double> & x, double expected)
+{
+	const std::size_t n = x.size();
+	double sum = 0, sum2 = 0;
+	for (std::size_t i = 0; i < n; ++i)
+		sum += x[i], sum2 += x[i] * x[i];
+	const double mean = sum / n, se = std::sqrt((sum2 / n - mean * mean) / n);
+
+	return std::abs(mean - expected) < 4 * se;
+}
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(GBM_analytics)
+
+//! known value and put-call parity
+BOOST_AUTO_TEST_CASE(prices)
+{
+	BOOST_TEST_MESSAGE("\nTesting the GBM analytics:\n\nTesting Black-Scholes prices ...");
+
+	BOOST_CHECK_CLOSE( black_scholes_price(CALL, 100.0, 100.0, 0.05, 0.0, 0.2, 1.0), 10.450583572185565, 1e-10 );
+
+	const double strikes[] = {60, 90, 100, 110, 150};
+	for (int i = 0; i < 5; ++i)
+	{
+		const double K = strikes[i];
+		double c = black_scholes_price(CALL, 100.0, K, 0.03, 0.01, 0.25, 2.0);
+		double p = black_scholes_price(PUT, 100.0, K, 0.03, 0.01, 0.25, 2.0);
+		BOOST_CHECK_CLOSE( c - p, 100.0 * std::exp(-0.02) - K * std::exp(-0.06), 1e-8 );
+	}
+
+	// no volatility: discounted intrinsic value on the forward
+	BOOST_CHECK_CLOSE( black_scholes_price(CALL, 100.0, 90.0, 0.05, 0.0, 0.0, 1.0), 100.0 - 90.0 * std::exp(-0.05), 1e-12 );
+	BOOST_CHECK_EQUAL( black_scholes_price(PUT, 100.0, 90.0, 0.05, 0.0, 0.2, 0.0), 0.0 );
+}
+
+//! greeks against central differences
+BOOST_AUTO_TEST_CASE(greeks)
+{
+	BOOST_TEST_MESSAGE("Testing greeks ...");
+
+	const double S = 105, r = 0.04, sigma = 0.3, t = 0.75, h = 1e-4;
+	const call_put types[] = {CALL, PUT};
+	for (int i = 0; i < 2; ++i)
+	{
+		const call_put type = types[i];
+		black_scholes_greeks<double> g = black_scholes(type, S, 100.0, r, 0.02, sigma, t);
+
+		BOOST_CHECK_CLOSE( g.delta, (price(type, S + h, r, sigma, t) - price(type, S - h, r, sigma, t)) / (2 * h), 1e-5 );
+		BOOST_CHECK_CLOSE( g.gamma, (price(type, S + 0.01, r, sigma, t) - 2 * g.price + price(type, S - 0.01, r, sigma, t)) / 1e-4, 1e-3 );
+		BOOST_CHECK_CLOSE( g.vega, (price(type, S, r, sigma + h, t) - price(type, S, r, sigma - h, t)) / (2 * h), 1e-5 );
+		BOOST_CHECK_CLOSE( g.theta, -(price(type, S, r, sigma, t + h) - price(type, S, r, sigma, t - h)) / (2 * h), 1e-5 );
+		BOOST_CHECK_CLOSE( g.rho, (price(type, S, r + h, sigma, t) - price(type, S, r - h, sigma, t)) / (2 * h), 1e-5 );
+	}
+}
+
+//! the array exponential agrees with std::exp
+BOOST_AUTO_TEST_CASE(array_exp)
+{
+	BOOST_TEST_MESSAGE("Testing the array exponential ...");
+
+	std::vector<double> x, out;
+	for (int i = -20000; i <= 20000; ++i)
+		x.push_back(i * 0.0371);
+	x.push_back(-745.2);
+	x.push_back(710.0);
+	x.push_back(-710.0);
+	x.push_back(std::numeric_limits<double>::quiet_NaN());
+	x.push_back(0.0);
+	out.resize(x.size());
+
+	qfcl::math::exp_affine(&x[0], &out[0], x.size(), 0.0, 1.0);
+	double max_error = 0;
+	for (std::size_t i = 0; i + 5 < x.size(); ++i)
+		max_error = std::max( max_error, std::abs(out[i] / std::exp(x[i]) - 1) );
+	BOOST_CHECK( max_error < 4 * std::numeric_limits<double>::epsilon() );
+
+	const std::size_t n = x.size();
+	BOOST_CHECK_EQUAL( out[n - 5], std::exp(-745.2) );
+	BOOST_CHECK( out[n - 4] == std::numeric_limits<double>::infinity() );
+	BOOST_CHECK_EQUAL( out[n - 3], std::exp(-710.0) );
+	BOOST_CHECK( out[n - 2] != out[n - 2] );
+	BOOST_CHECK_EQUAL( out[n - 1], 1.0 );
+
+	// in place, with the affine map
+	qfcl::math::exp_affine(&x[0], &x[0], 1000, 0.5, -0.25, 3.0);
+	BOOST_CHECK_CLOSE( x[10], 3.0 * std::exp(0.5 - 0.25 * (-20000 + 10) * 0.0371), 1e-12 );
+}
+
+//! batch sampling agrees with the closed form means
+BOOST_AUTO_TEST_CASE(batch_sampling)
+{
+	BOOST_TEST_MESSAGE("Testing batch sampling ...");
+
+	const std::size_t n = 400000;
+	std::vector<double> out(n);
+	boost::random::mt19937 eng;
+
+	qfcl::random::gbm_vanilla_call call(100, 0.2, 0.05, 0.05, 100, 1);
+	gbm_vanilla_put_distribution<> put(100, 0.2, 0.05, 0.05, 100, 1);
+	qfcl::random::gbm_at_fixed_time S(100, 0.2, 0.05, 1);
+
+	BOOST_CHECK_CLOSE( call.mean(), 10.450583572185565, 1e-10 );
+	BOOST_CHECK_CLOSE( call.mean() - put.mean(), 100 - 100 * std::exp(-0.05), 1e-8 );
+
+	call.generate(eng, &out[0], n);
+	BOOST_CHECK( mean_agrees(out, call.mean()) );
+
+	put.generate(eng, &out[0], n);
+	BOOST_CHECK( mean_agrees(out, put.mean()) );
+
+	S.generate(eng, &out[0], n);
+	BOOST_CHECK( mean_agrees(out, S.mean()) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,285 @@
+/* test/block_producer.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/block_producer.cpp
+	\brief Tests the block rings and the block producer.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <qfcl/random/block_producer.hpp>
+#include <qfcl/random/block_ring.hpp>
+#include <qfcl/random/distribution/uniform_0in_1ex.hpp>
+#include <qfcl/random/engine/mrg32k3a.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+typedef block_producer< mrg32k3a, uniform_0in_1ex<> > producer_type;
+
+//! the blocks, with their tags, popped by one consumer thread
+struct consumed
+{
+	std::vector<boost::uint64_t> tags;
+	//! whether each block was the one \c generate gives for its tag
+	bool contents_ok;
+	//! whether each block was 64 byte aligned
+	bool aligned;
+
+	consumed() : contents_ok(true), aligned(true) {}
+};
+
+//! pops blocks of consumer \p c until there are none
+void consume(producer_type & producer, std::size_t c, consumed & result, std::size_t max_blocks = ~std::size_t(0))
+{
+	std::vector<double> expected( producer.block_size() );
+
+	producer_type::block_type b;
+	for (std::size_t k = 0; k < max_blocks && producer.pop(c, b); ++k)
+	{
+		result.tags.push_back(b.tag);
+		result.aligned = result.aligned && reinterpret_cast<std::size_t>(b.data) % 64 == 0;
+
+		producer.generate( b.tag, &expected[0] );
+		result.contents_ok = result.contents_ok && std::equal( expected.begin(), expected.end(), b.data );
+
+		producer.release(c, b);
+	}
+}
+
+//! fills blocks with <tt>tag * block_size + j</tt>, for the tags <tt>first, first + step, ...</tt> below \p last
+template<typename Ring>
+void fill_ring(Ring & ring, boost::uint64_t first, boost::uint64_t last, boost::uint64_t step)
+{
+	for (boost::uint64_t tag = first; tag < last; tag += step)
+	{
+		typename Ring::block_type b;
+		while ( !ring.try_acquire(b) )
+			boost::this_thread::yield();
+		for (std::size_t j = 0; j < ring.block_size(); ++j)
+			b.data[j] = tag * ring.block_size() + j;
+		b.tag = tag;
+		ring.publish(b);
+	}
+}
+
+//! pops \p count blocks, recording their tags and checking their contents
+template<typename Ring>
+void drain_ring(Ring & ring, std::size_t count, std::vector<boost::uint64_t> & tags, bool & contents_ok)
+{
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		typename Ring::block_type b;
+		while ( !ring.try_pop(b) )
+			boost::this_thread::yield();
+		tags.push_back(b.tag);
+		for (std::size_t j = 0; j < ring.block_size(); ++j)
+			contents_ok = contents_ok && b.data[j] == b.tag * ring.block_size() + j;
+		ring.release(b);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(block_producer_suite)
+
+//! the SPSC ring delivers every block, in order
+BOOST_AUTO_TEST_CASE(spsc_ring)
+{
+	BOOST_TEST_MESSAGE("\nTesting the block rings and the block producer:\n\nTesting the SPSC ring ...");
+
+	BOOST_CHECK_THROW( spsc_block_ring<boost::uint64_t>(6, 10), std::invalid_argument );
+
+	// every block starts on a cache line, whatever the element size and block size
+	spsc_block_ring<float> small(4, 3);
+	bool aligned = true;
+	for (int k = 0; k < 4; ++k)
+	{
+		spsc_block_ring<float>::block_type b;
+		BOOST_REQUIRE( small.try_acquire(b) );
+		aligned = aligned && reinterpret_cast<std::size_t>(b.data) % 64 == 0;
+		small.publish(b);
+	}
+	BOOST_CHECK(aligned);
+
+	const boost::uint64_t N = 20000;
+	spsc_block_ring<boost::uint64_t> ring(4, 37);
+	std::vector<boost::uint64_t> tags;
+	bool contents_ok = true;
+
+	boost::thread producer( [&ring, N]() { fill_ring(ring, 0, N, 1); } );
+	drain_ring(ring, N, tags, contents_ok);
+	producer.join();
+
+	bool in_order = true;
+	for (boost::uint64_t k = 0; k < N; ++k)
+		in_order = in_order && tags[k] == k;
+	BOOST_CHECK(in_order);
+	BOOST_CHECK(contents_ok);
+}
+
+//! the MPMC ring delivers every block exactly once
+BOOST_AUTO_TEST_CASE(mpmc_ring)
+{
+	BOOST_TEST_MESSAGE("Testing the MPMC ring ...");
+
+	const unsigned int P = 3, C = 2;
+	const boost::uint64_t N = 30000;
+	mpmc_block_ring<boost::uint64_t> ring(8, 21);
+
+	boost::thread_group producers, consumers;
+	for (unsigned int p = 0; p < P; ++p)
+		producers.create_thread( [&ring, p, N]() { fill_ring(ring, p, N, P); } );
+
+	std::vector< std::vector<boost::uint64_t> > tags(C);
+	bool contents_ok[C] = {true, true};
+	for (unsigned int c = 0; c < C; ++c)
+		consumers.create_thread( [&ring, &tags, &contents_ok, c, N]() { drain_ring(ring, N / C, tags[c], contents_ok[c]); } );
+	producers.join_all();
+	consumers.join_all();
+
+	std::vector<boost::uint64_t> all(tags[0]);
+	all.insert( all.end(), tags[1].begin(), tags[1].end() );
+	std::sort( all.begin(), all.end() );
+	bool each_once = all.size() == N;
+	for (boost::uint64_t k = 0; each_once && k < N; ++k)
+		each_once = all[k] == k;
+	BOOST_CHECK(each_once);
+	BOOST_CHECK(contents_ok[0] && contents_ok[1]);
+}
+
+//! in \c round_robin mode consumer \c c receives blocks c, c + C, ..., whatever the number of producers
+BOOST_AUTO_TEST_CASE(round_robin)
+{
+	BOOST_TEST_MESSAGE("Testing the block producer ...");
+
+	const std::size_t C = 3;
+	const boost::uint64_t blocks = 50;
+	const unsigned int producer_counts[] = {1, 2, 5};
+
+	for (int t = 0; t < 3; ++t)
+	{
+		producer_type producer(C, producer_counts[t], 100, blocks, 2012, producer_type::round_robin, 4);
+		producer.start();
+
+		std::vector<consumed> results(C);
+		boost::thread_group consumers;
+		for (std::size_t c = 0; c < C; ++c)
+			consumers.create_thread( [&producer, &results, c]() { consume(producer, c, results[c]); } );
+		consumers.join_all();
+
+		for (std::size_t c = 0; c < C; ++c)
+		{
+			bool assigned = results[c].tags.size() == (blocks - c + C - 1) / C;
+			for (std::size_t k = 0; assigned && k < results[c].tags.size(); ++k)
+				assigned = results[c].tags[k] == c + k * C;
+			BOOST_CHECK(assigned);
+			BOOST_CHECK(results[c].contents_ok);
+			BOOST_CHECK(results[c].aligned);
+		}
+	}
+}
+
+//! in \c shared mode every block is consumed exactly once, by some consumer
+BOOST_AUTO_TEST_CASE(shared)
+{
+	const std::size_t C = 3;
+	const boost::uint64_t blocks = 60;
+	producer_type producer(C, 3, 64, blocks, 7, producer_type::shared, 4);
+	producer.start();
+
+	std::vector<consumed> results(C);
+	boost::thread_group consumers;
+	for (std::size_t c = 0; c < C; ++c)
+		consumers.create_thread( [&producer, &results, c]() { consume(producer, c, results[c]); } );
+	consumers.join_all();
+
+	std::vector<boost::uint64_t> all;
+	for (std::size_t c = 0; c < C; ++c)
+	{
+		all.insert( all.end(), results[c].tags.begin(), results[c].tags.end() );
+		BOOST_CHECK(results[c].contents_ok);
+		BOOST_CHECK(results[c].aligned);
+	}
+	std::sort( all.begin(), all.end() );
+	bool each_once = all.size() == blocks;
+	for (boost::uint64_t k = 0; each_once && k < blocks; ++k)
+		each_once = all[k] == k;
+	BOOST_CHECK(each_once);
+}
+
+//! an unlimited stream stops on request
+BOOST_AUTO_TEST_CASE(stop)
+{
+	producer_type producer(2, 2, 32);
+	std::vector<unsigned int> started;
+	boost::mutex m;
+	producer.start( [&started, &m](unsigned int p) { boost::mutex::scoped_lock lock(m); started.push_back(p); } );
+
+	consumed result;
+	consume(producer, 1, result, 20);
+	BOOST_CHECK_EQUAL( result.tags.size(), 20u );
+	BOOST_CHECK(result.contents_ok);
+
+	producer.stop();
+	producer_type::block_type b;
+	std::size_t left = 0;
+	while ( producer.pop(1, b) )
+	{
+		producer.release(1, b);
+		++left;
+	}
+	// only the blocks already in the ring
+	BOOST_CHECK_LE(left, 8u);
+
+	std::sort( started.begin(), started.end() );
+	BOOST_CHECK( started.size() == 2 && started[0] == 0 && started[1] == 1 );
+}
+
+//! the blocks are the segments of one stream starting at the multiples of the stride
+BOOST_AUTO_TEST_CASE(stream_segments)
+{
+	const std::size_t n = 100;
+	std::vector<double> blocks(3 * n), stream(3 * n);
+
+	// with stride = block_size the blocks are consecutive
+	producer_type consecutive(1, 1, n, 0, 2012, producer_type::round_robin, 4, uniform_0in_1ex<>(), n);
+	variate_generator< mrg32k3a, uniform_0in_1ex<> > gen( mrg32k3a(2012), uniform_0in_1ex<>() );
+	for (std::size_t k = 0; k < 3; ++k)
+		consecutive.generate( k, &blocks[k * n] );
+	for (std::size_t j = 0; j < 3 * n; ++j)
+		stream[j] = gen();
+	BOOST_CHECK( blocks == stream );
+
+	// by default, 4 * block_size outputs apart
+	producer_type spaced(1, 1, n, 0, 2012);
+	BOOST_CHECK_EQUAL( spaced.stride(), 4u * n );
+	spaced.generate( 2, &blocks[0] );
+	mrg32k3a eng(2012);
+	eng.discard(8 * n);
+	variate_generator< mrg32k3a, uniform_0in_1ex<> > jumped( eng, uniform_0in_1ex<>() );
+	bool same = true;
+	for (std::size_t j = 0; j < n; ++j)
+		same = same && blocks[j] == jumped();
+	BOOST_CHECK(same);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,329 @@
+/* test/column_store.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/column_store.cpp
+	\brief Tests the memory mapped column stores, and the descriptive statistics over their columns.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <qfcl/statistics/column_store.hpp>
+#include <qfcl/statistics/descriptive.hpp>
+using namespace qfcl::statistics;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+//! a file removed at the end of the test
+struct temporary_file
+{
+	explicit temporary_file(const std::string & name_) : name(name_) {}
+	~temporary_file() {std::remove( name.c_str() );}
+
+	const std::string name;
+};
+
+//! a double, an int64 and a float column
+std::vector<column_spec> test_columns()
+{
+	std::vector<column_spec> specs;
+	specs.push_back( column_spec("payoff") );
+	specs.push_back( column_spec("path", COLUMN_INT64) );
+	specs.push_back( column_spec("delta", COLUMN_FLOAT) );
+	return specs;
+}
+
+//! overwrites \p n bytes of \p filename at \p position with the little-endian \p value
+void patch(const std::string & filename, std::streamoff position, boost::uint64_t value, std::size_t n)
+{
+	std::fstream f( filename.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::binary );
+	f.seekp(position);
+	for (std::size_t i = 0; i < n; ++i)
+		f.put( static_cast<char>(value >> (8 * i)) );
+}
+
+BOOST_AUTO_TEST_SUITE(column_store)
+
+//! what is written is read back after reopening the file, through views and copies
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+	BOOST_TEST_MESSAGE("\nTesting column stores:\n\nTesting a round trip ...");
+
+	const temporary_file file("column_store_round_trip.qfcs");
+	const size_t N = 1000;
+
+	std::vector<double> payoffs(N);
+	std::vector<boost::int64_t> paths(N);
+	std::vector<float> deltas(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		payoffs[i] = std::sqrt( static_cast<double>(i) ) - 7.5;
+		paths[i] = static_cast<boost::int64_t>(i) * -0x100000001LL;
+		deltas[i] = static_cast<float>(i) / 3;
+	}
+
+	{
+		column_store_writer writer( file.name, test_columns(), 2 * N );
+		BOOST_CHECK_EQUAL( writer.column_index("path"), 1u );
+		// chunks of uneven sizes
+		for (size_t first = 0; first < N; )
+		{
+			const size_t rows = std::min<size_t>(N - first, 1 + first % 97);
+			column_store_writer::chunk c = writer.append(rows);
+			BOOST_REQUIRE_EQUAL( c.first_row(), first );
+			c.write( 0, &payoffs[first] );
+			c.write( 1, &paths[first] );
+			c.write( 2, &deltas[first] );
+			c.commit();
+			first += rows;
+		}
+		BOOST_CHECK_EQUAL( writer.committed(), N );
+	}
+
+	const column_store_reader reader(file.name);
+	BOOST_REQUIRE_EQUAL( reader.size(), N );
+	BOOST_REQUIRE_EQUAL( reader.columns(), 3u );
+	BOOST_CHECK_EQUAL( reader.name(0), "payoff" );
+	BOOST_CHECK_EQUAL( reader.name(2), "delta" );
+	BOOST_CHECK( reader.type(1) == COLUMN_INT64 );
+	BOOST_CHECK_EQUAL( reader.column_index("delta"), 2u );
+	BOOST_CHECK_THROW( reader.column_index("gamma"), std::out_of_range );
+	BOOST_CHECK_THROW( reader.read_column<float>(0), std::runtime_error );
+
+	const std::vector<double> p = reader.read_column<double>(0);
+	const std::vector<boost::int64_t> q = reader.read_column<boost::int64_t>(1);
+	const std::vector<float> d = reader.read_column<float>(2);
+	BOOST_CHECK( p == payoffs );
+	BOOST_CHECK( q == paths );
+	BOOST_CHECK( d == deltas );
+
+#ifdef BOOST_LITTLE_ENDIAN
+	const column_view<double> view = reader.column<double>("payoff");
+	BOOST_REQUIRE_EQUAL( view.size(), N );
+	BOOST_CHECK( std::equal( view.begin(), view.end(), payoffs.begin() ) );
+#endif
+}
+
+//! only the rows before the first uncommitted chunk are recorded
+BOOST_AUTO_TEST_CASE(committed_rows)
+{
+	BOOST_TEST_MESSAGE("Testing that only committed rows are recorded ...");
+
+	const temporary_file file("column_store_committed.qfcs");
+	const std::vector<double> values(10, 1.5);
+	const boost::int64_t paths[10] = {0};
+	const float deltas[10] = {0};
+
+	{
+		column_store_writer writer( file.name, test_columns(), 100 );
+		column_store_writer::chunk a = writer.append(10), b = writer.append(10), c = writer.append(10);
+		c.write( 0, &values[0] );
+		c.commit();
+		a.write( 0, &values[0] );
+		a.commit();
+		// b is reserved but never written
+		BOOST_CHECK_EQUAL( writer.size(), 30u );
+		BOOST_CHECK_EQUAL( writer.committed(), 10u );
+		writer.flush();
+		BOOST_CHECK_EQUAL( column_store_reader(file.name).size(), 10u );
+
+		// committing b makes c count too
+		b.write( 0, &values[0] );
+		b.write( 1, paths );
+		b.write( 2, deltas );
+		b.commit();
+		BOOST_CHECK_EQUAL( writer.committed(), 30u );
+
+		BOOST_CHECK_THROW( writer.append(71), std::length_error );
+		writer.append(5);
+	}
+
+	// the destructor flushes, without the last (uncommitted) chunk
+	BOOST_CHECK_EQUAL( column_store_reader(file.name).size(), 30u );
+}
+
+//! a file whose descriptors do not match its columns is refused before anything is read
+BOOST_AUTO_TEST_CASE(corrupt_files)
+{
+	BOOST_TEST_MESSAGE("Testing corrupt files ...");
+
+	const temporary_file file("column_store_corrupt.qfcs");
+	// the header is 64 bytes; descriptor k starts at 64 (k + 1), with its element size at 42 and its offset at 48
+	const std::streamoff column_count = 6, element_bytes = 64 + 42, offset = 64 + 48;
+	const auto write_store = [&file]() { column_store_writer( file.name, test_columns(), 100 ); };
+
+	write_store();
+	BOOST_CHECK_NO_THROW( column_store_reader(file.name) );
+
+	// a column past the end of the file, also when the offset plus the length overflows
+	write_store();
+	patch(file.name, offset, 4096, 8);
+	BOOST_CHECK_THROW( column_store_reader(file.name), std::runtime_error );
+	write_store();
+	patch(file.name, offset, ~boost::uint64_t(0) - 63, 8);
+	BOOST_CHECK_THROW( column_store_reader(file.name), std::runtime_error );
+
+	// an element size other than that of the column type
+	write_store();
+	patch(file.name, element_bytes, 4, 2);
+	BOOST_CHECK_THROW( column_store_reader(file.name), std::runtime_error );
+
+	// more descriptors than the file holds
+	write_store();
+	patch(file.name, column_count, 0xFFFF, 2);
+	BOOST_CHECK_THROW( column_store_reader(file.name), std::runtime_error );
+}
+
+//! chunks appended from many threads cover every row exactly once
+BOOST_AUTO_TEST_CASE(concurrent_append)
+{
+	BOOST_TEST_MESSAGE("Testing concurrent appends ...");
+
+	const temporary_file file("column_store_concurrent.qfcs");
+	const size_t threads = 8, chunks = 200, rows = 37;
+	const size_t N = threads * chunks * rows;
+
+	{
+		column_store_writer writer( file.name, test_columns(), N );
+
+		boost::thread_group group;
+		for (size_t t = 0; t < threads; ++t)
+			group.create_thread( [&writer, t, chunks, rows]() {
+				std::vector<double> payoffs(rows);
+				std::vector<boost::int64_t> ids(rows);
+				std::vector<float> deltas(rows, static_cast<float>(t));
+				for (size_t j = 0; j < chunks; ++j)
+				{
+					column_store_writer::chunk c = writer.append(rows);
+					// each row holds its own index, and the thread that wrote it
+					for (size_t i = 0; i < rows; ++i)
+					{
+						ids[i] = static_cast<boost::int64_t>(c.first_row() + i);
+						payoffs[i] = static_cast<double>(ids[i]) / 2;
+					}
+					c.write( 0, &payoffs[0] );
+					c.write( 1, &ids[0] );
+					c.write( 2, &deltas[0] );
+					c.commit();
+					boost::this_thread::yield();
+				}
+			} );
+		group.join_all();
+
+		BOOST_CHECK_EQUAL( writer.size(), N );
+		BOOST_CHECK_EQUAL( writer.committed(), N );
+	}
+
+	const column_store_reader reader(file.name);
+	BOOST_REQUIRE_EQUAL( reader.size(), N );
+	const std::vector<double> payoffs = reader.read_column<double>(0);
+	const std::vector<boost::int64_t> ids = reader.read_column<boost::int64_t>(1);
+	const std::vector<float> deltas = reader.read_column<float>(2);
+
+	bool rows_ok = true;
+	std::vector<size_t> per_thread(threads);
+	for (size_t i = 0; i < N; ++i)
+	{
+		rows_ok = rows_ok && ids[i] == static_cast<boost::int64_t>(i) && payoffs[i] == static_cast<double>(i) / 2;
+		// chunks are never split between threads
+		rows_ok = rows_ok && (i % rows == 0 || deltas[i] == deltas[i - 1]);
+		++per_thread[ static_cast<size_t>(deltas[i]) ];
+	}
+	BOOST_CHECK(rows_ok);
+	for (size_t t = 0; t < threads; ++t)
+		BOOST_CHECK_EQUAL( per_thread[t], chunks * rows );
+}
+
+//! the statistics over a mapped column agree with a naive computation
+BOOST_AUTO_TEST_CASE(descriptive_statistics)
+{
+	BOOST_TEST_MESSAGE("Testing descriptive statistics over a mapped column ...");
+
+	const temporary_file file("column_store_statistics.qfcs");
+	const size_t N = 100001;
+
+	// lognormal, so that the skew and kurtosis are far from 0 and 3
+	boost::random::mt19937 eng(2012);
+	boost::random::normal_distribution<> normal(0.1, 0.5);
+	std::vector<double> x(N);
+	for (size_t i = 0; i < N; ++i)
+		x[i] = std::exp( normal(eng) );
+
+	{
+		std::vector<column_spec> specs(1, column_spec("terminal_value"));
+		column_store_writer writer( file.name, specs, N );
+		column_store_writer::chunk c = writer.append(N);
+		c.write( 0, &x[0] );
+		c.commit();
+	}
+
+	const column_store_reader reader(file.name);
+	const std::vector<double> column = reader.read_column<double>(0);
+#ifdef BOOST_LITTLE_ENDIAN
+	const column_view<double> view = reader.column<double>(0);
+	const DescriptiveStatistics<> stats( view.begin(), view.end(), in_place );
+#else
+	const DescriptiveStatistics<> stats( column.begin(), column.end() );
+#endif
+
+	// naive two pass moments
+	const double n = static_cast<double>(N);
+	const double mean = std::accumulate( x.begin(), x.end(), 0.0 ) / n;
+	double cm2 = 0, cm3 = 0, cm4 = 0;
+	for (size_t i = 0; i < N; ++i)
+	{
+		const double d = x[i] - mean;
+		cm2 += d * d;
+		cm3 += d * d * d;
+		cm4 += d * d * d * d;
+	}
+	cm2 /= n; cm3 /= n; cm4 /= n;
+
+	std::vector<double> sorted(x);
+	std::sort( sorted.begin(), sorted.end() );
+
+	BOOST_CHECK_EQUAL( stats.size(), N );
+	BOOST_CHECK_EQUAL( stats.min(), sorted.front() );
+	BOOST_CHECK_EQUAL( stats.max(), sorted.back() );
+	BOOST_CHECK_EQUAL( stats.median(), sorted[N / 2] );
+	BOOST_CHECK_CLOSE( stats.mean(), mean, 1e-10 );
+	BOOST_CHECK_CLOSE( stats.EmpVar(), cm2, 1e-9 );
+	BOOST_CHECK_CLOSE( stats.var(), cm2 * n / (n - 1), 1e-9 );
+	BOOST_CHECK_CLOSE( stats.EmpSkew(), cm3 / std::pow(cm2, 1.5), 1e-8 );
+	BOOST_CHECK_CLOSE( stats.EmpKurt(), cm4 / (cm2 * cm2), 1e-8 );
+	BOOST_CHECK_CLOSE( stats.EmpCM(3), cm3, 1e-8 );
+
+	// and with the copied column
+	const DescriptiveStatistics<> copied( column );
+	BOOST_CHECK_EQUAL( copied.mean(), stats.mean() );
+	BOOST_CHECK_EQUAL( copied.skew(), stats.skew() );
+	BOOST_CHECK_EQUAL( copied.kurt(), stats.kurt() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
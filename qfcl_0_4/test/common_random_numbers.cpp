@@ -0,0 +1,280 @@
+/* test/common_random_numbers.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/common_random_numbers.cpp
+	\brief Tests the common random numbers of mc1: seeded normals, their replay, and scenario differences.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/mc1/CommonRandomNumbers.cpp>
+#include <qfcl/random/distribution/normal_box_muller_polar.hpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+typedef boost::random::mt19937 generator_type;
+typedef Sde<double, double, double> sde_type;
+typedef ExplicitEuler<double, double, double, generator_type> scheme_type;
+
+const double r = 0.05, sigma = 0.2, T = 1.0, K = 100.0;
+const long steps = 16;
+
+double drift(double X, double) {return r * X;}
+double diffusion(double X, double) {return sigma * X;}
+double diffusionDerivative(double, double) {return sigma;}
+double driftCorrected(double X, double, double B) {return r * X - B * sigma * sigma * X;}
+
+//! GBM on [0, T] from \p X0
+sde_type gbm(double X0)
+{
+	return sde_type( X0, Range<double>(0.0, T), drift, driftCorrected, diffusion, diffusionDerivative );
+}
+
+//! the discounted call on the terminal value of a path
+struct discounted_call
+{
+	double operator()(const pathType<double> & path) const {return std::exp(-r * T) * std::max(path[path.size() - 1] - K, 0.0);}
+};
+
+typedef MCScenarios<double, long, generator_type, discounted_call> scenarios_type;
+
+//! normals in pairs, the second of which the variate generator keeps for the next call
+typedef BoostNormal<generator_type, qfcl::random::normal_box_muller_polar<>, qfcl::random::variate_generator> polar_normal;
+
+//! the next \p n numbers of \p normal
+template<typename Normal>
+std::vector<double> draw(Normal & normal, std::size_t n)
+{
+	std::vector<double> z(n);
+	for (std::size_t j = 0; j < n; ++j)
+		z[j] = normal.RN();
+	return z;
+}
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(common_random_numbers)
+
+//! reseeding the normals restarts them, across block boundaries
+BOOST_AUTO_TEST_CASE(seed)
+{
+	BOOST_TEST_MESSAGE("\nTesting common random numbers:\n\nTesting seeded normals ...");
+
+	const std::size_t n = 3 * BoostNormal<generator_type>::blockSize + 5;
+	BoostNormal<generator_type> normal( generator_type(), 0 );
+
+	normal.seed(2012);
+	const std::vector<double> first = draw(normal, n);
+	normal.seed(2012);
+	BOOST_CHECK( draw(normal, n) == first );
+
+	// a copy, or an assigned generator, continues from the same seed on its own engine
+	normal.seed(2012);
+	BoostNormal<generator_type> copy(normal), assigned( generator_type(), 0 );
+	assigned = normal;
+	BOOST_CHECK( draw(copy, n) == first );
+	BOOST_CHECK( draw(assigned, n) == first );
+	BOOST_CHECK( draw(normal, n) == first );
+
+	normal.seed(2013);
+	BOOST_CHECK( draw(normal, n) != first );
+}
+
+//! a batch of the cache depends only on the seed and its index, not on the batches drawn before it
+BOOST_AUTO_TEST_CASE(block_cache)
+{
+	BOOST_TEST_MESSAGE("Testing the normal block cache ...");
+
+	const long M = 50, n = steps;
+	NormalBlockCache<generator_type> cache(M, n, 7);
+	BOOST_CHECK_EQUAL( cache.batch(), -1 );
+
+	cache.fill(3);
+	BOOST_CHECK_EQUAL( cache.batch(), 3 );
+	const std::vector<double> batch3( cache.path(0), cache.path(0) + M * n );
+
+	cache.fill(0);
+	const std::vector<double> batch0( cache.path(0), cache.path(0) + M * n );
+	BOOST_CHECK( batch0 != batch3 );
+
+	cache.fill(3);
+	BOOST_CHECK( std::equal( batch3.begin(), batch3.end(), cache.path(0) ) );
+
+	// a new cache with the same seed, and the seed of batch 3 for batch 0
+	NormalBlockCache<generator_type> same(M, n, 7), shifted(M, n, 10);
+	same.fill(3);
+	shifted.fill(0);
+	BOOST_CHECK( std::equal( batch3.begin(), batch3.end(), same.path(0) ) );
+	BOOST_CHECK( std::equal( batch3.begin(), batch3.end(), shifted.path(0) ) );
+
+	cache.seed(8);
+	BOOST_CHECK_EQUAL( cache.batch(), -1 );
+	cache.fill(3);
+	BOOST_CHECK( !std::equal( batch3.begin(), batch3.end(), cache.path(0) ) );
+
+	BOOST_CHECK_THROW( NormalBlockCache<generator_type>(0, n), std::invalid_argument );
+}
+
+//! a replayed path is driven by exactly the supplied normals, and a reset run repeats itself
+BOOST_AUTO_TEST_CASE(replay)
+{
+	BOOST_TEST_MESSAGE("Testing replayed scenarios ...");
+
+	NormalBlockCache<generator_type> cache(4, steps, 11);
+	cache.fill(0);
+
+	sde_type sde = gbm(100.0);
+	scheme_type euler( steps, sde, generator_type() );
+	euler.generator.replay( cache.path(2), steps );
+	const pathType<double> path = euler.path();
+
+	// the Euler path with the cached normals
+	double X = 100.0;
+	bool same = path[0] == X;
+	for (long i = 0; i < steps; ++i)
+	{
+		X += r * X * euler.k + sigma * X * euler.sqrk * cache.path(2)[i];
+		same = same && std::abs(path[i + 1] - X) < 1e-12 * X;
+	}
+	BOOST_CHECK(same);
+
+	// the same scenario twice has no difference at all, and a reset run gives the same prices
+	scheme_type base( steps, sde, generator_type() ), again( steps, sde, generator_type() );
+	scenarios_type scenarios(64, steps, 5);
+	scenarios.addScenario( base, discounted_call() );
+	scenarios.addScenario( again, discounted_call() );
+	scenarios.simulate(1000);
+	BOOST_CHECK_EQUAL( scenarios.pathCount(), 1024 );
+	BOOST_CHECK_EQUAL( scenarios.price(1), scenarios.price(0) );
+	BOOST_CHECK_EQUAL( scenarios.difference(1), 0.0 );
+	BOOST_CHECK_EQUAL( scenarios.differenceError(1), 0.0 );
+
+	const double price = scenarios.price(0), error = scenarios.standardError(0);
+	scenarios.reset();
+	BOOST_CHECK_EQUAL( scenarios.pathCount(), 0 );
+	scenarios.simulate(1000);
+	BOOST_CHECK_EQUAL( scenarios.price(0), price );
+	BOOST_CHECK_EQUAL( scenarios.standardError(0), error );
+
+	scenarios.seed(6);
+	scenarios.simulate(1000);
+	BOOST_CHECK_NE( scenarios.price(0), price );
+
+	scheme_type other( steps + 1, sde, generator_type() );
+	BOOST_CHECK_THROW( scenarios.addScenario( other, discounted_call() ), std::invalid_argument );
+}
+
+//! the difference of a bumped scenario with common normals is far less noisy than that of independent runs
+BOOST_AUTO_TEST_CASE(bumped_difference)
+{
+	BOOST_TEST_MESSAGE("Testing the variance of bumped differences ...");
+
+	const double S0 = 100.0, h = 1.0;
+	const long paths = 20000;
+	sde_type sde = gbm(S0), bumped = gbm(S0 + h);
+	scheme_type base( steps, sde, generator_type() ), up( steps, bumped, generator_type() );
+
+	scenarios_type crn(256, steps, 2012);
+	crn.addScenario( base, discounted_call() );
+	crn.addScenario( up, discounted_call() );
+	crn.simulate(paths);
+
+	// the bumped scenario on its own, with other normals
+	scheme_type independent( steps, bumped, generator_type() );
+	scenarios_type other(256, steps, 1000000);
+	other.addScenario( independent, discounted_call() );
+	other.simulate(paths);
+
+	const double crn_error = crn.differenceError(1);
+	const double independent_error = std::sqrt( crn.standardError(0) * crn.standardError(0) + other.standardError(0) * other.standardError(0) );
+	// the variance ratio is about 2 Var(P) / (h^2 Var(delta)), some hundreds here
+	BOOST_CHECK_LT( crn_error * crn_error, independent_error * independent_error / 100 );
+
+	// both estimate the same difference, about delta h
+	BOOST_CHECK_CLOSE( crn.difference(1), crn.price(1) - crn.price(0), 1e-8 );
+	BOOST_CHECK_SMALL( crn.difference(1) - (other.price(0) - crn.price(0)), 4 * independent_error );
+	BOOST_CHECK_CLOSE( crn.difference(1) / h, 0.64, 5 );
+}
+
+//! bulk fills return the numbers of repeated RN() calls, and none of the pairs of a polar normal is split
+BOOST_AUTO_TEST_CASE(fill)
+{
+	BOOST_TEST_MESSAGE("Testing bulk fills ...");
+
+	// odd counts, across block boundaries
+	const std::size_t counts[] = {3, 5, polar_normal::blockSize, 1, 2 * polar_normal::blockSize + 7, 11};
+	const std::size_t parts = sizeof(counts) / sizeof(counts[0]);
+	std::size_t n = 0;
+	for (std::size_t j = 0; j < parts; ++j)
+		n += counts[j];
+
+	// the sequence of a single variate generator on the engine
+	generator_type eng(2012);
+	qfcl::random::variate_generator<generator_type &, qfcl::random::normal_box_muller_polar<> > nor( eng, qfcl::random::normal_box_muller_polar<>() );
+	std::vector<double> expected(n);
+	for (std::size_t i = 0; i < n; ++i)
+		expected[i] = nor();
+
+	polar_normal single( generator_type(), 0 );
+	single.seed(2012);
+	BOOST_CHECK( draw(single, n) == expected );
+
+	// alternating RN() and fill()
+	polar_normal mixed( generator_type(), 0 );
+	mixed.seed(2012);
+	std::vector<double> z(n);
+	for (std::size_t j = 0, i = 0; j < parts; i += counts[j++])
+	{
+		if (j % 2 == 0)
+			for (std::size_t l = 0; l < counts[j]; ++l)
+				z[i + l] = mixed.RN();
+		else
+			mixed.fill( &z[i], counts[j] );
+	}
+	BOOST_CHECK( z == expected );
+
+	// only fill()
+	polar_normal bulk( generator_type(), 0 );
+	bulk.seed(2012);
+	for (std::size_t j = 0, i = 0; j < parts; i += counts[j++])
+		bulk.fill( &z[i], counts[j] );
+	BOOST_CHECK( z == expected );
+
+	// seed() also drops the second normal of a pair
+	bulk.seed(2012);
+	BOOST_CHECK( draw(bulk, 3) == std::vector<double>( expected.begin(), expected.begin() + 3 ) );
+	bulk.seed(2012);
+	BOOST_CHECK( draw(bulk, n) == expected );
+
+	// as does the assignment of a freshly seeded generator
+	polar_normal assigned( generator_type(), 0 );
+	draw(assigned, 1);
+	single.seed(2012);
+	assigned = single;
+	BOOST_CHECK( draw(assigned, n) == expected );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,181 @@
+/* test/coordinate_addressed.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/coordinate_addressed.cpp
+	\brief Tests the coordinate addressed variates, over Philox, Threefry and ARS.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/random/ars.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+
+#include <qfcl/random/distribution/coordinate_addressed.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+typedef boost::random::philox<4, boost::uint32_t> philox4x32;
+
+typedef boost::mpl::list< philox4x32, boost::random::philox<2, boost::uint64_t>, boost::random::threefry<4, boost::uint32_t>,
+						  boost::random::threefry<4, boost::uint64_t>, boost::random::ars<boost::uint32_t> > prfs;
+
+//! the batched \c normal_at agrees with the single one, for any box of coordinates
+template<typename Transform, typename Prf>
+void check_batched(const coordinate_key<Prf> & key)
+{
+	// odd and even ends of the dimensions, single coordinates, paths beyond 32 bits, and the last steps and dimensions
+	const coordinate_range paths[] = { coordinate_range(0, 3), coordinate_range(5, 1), coordinate_range(0x100000000ULL - 2, 4) };
+	const coordinate_range steps[] = { coordinate_range(0, 1), coordinate_range(7, 5), coordinate_range(0x100000000ULL - 2, 2) };
+	const coordinate_range dims[] = { coordinate_range(0, 1), coordinate_range(1, 4), coordinate_range(0, 16), coordinate_range(3, 11),
+									  coordinate_range(0x100000000ULL - 5, 5) };
+
+	BOOST_FOREACH(const coordinate_range & P, paths)
+		BOOST_FOREACH(const coordinate_range & S, steps)
+			BOOST_FOREACH(const coordinate_range & D, dims)
+			{
+				std::vector<double> out(P.size * S.size * D.size);
+				normal_at<Transform>( key, P, S, D, &out[0] );
+
+				bool same = true;
+				for (std::size_t i = 0; i < P.size; ++i)
+					for (std::size_t j = 0; j < S.size; ++j)
+						for (std::size_t l = 0; l < D.size; ++l)
+							same = same && out[(i * S.size + j) * D.size + l] ==
+								normal_at<Transform>( key, P.first + i, static_cast<boost::uint32_t>(S.first + j),
+													  static_cast<boost::uint32_t>(D.first + l) );
+				BOOST_CHECK(same);
+			}
+
+	// steps and dimensions are 32 bit coordinates
+	double z;
+	BOOST_CHECK_THROW( normal_at<Transform>( key, coordinate_range(0, 1), coordinate_range(0x100000000ULL - 1, 2), coordinate_range(0, 1), &z ),
+					   std::out_of_range );
+	BOOST_CHECK_THROW( normal_at<Transform>( key, coordinate_range(0, 1), coordinate_range(0, 1), coordinate_range(0x100000000ULL, 1), &z ),
+					   std::out_of_range );
+}
+
+//! the variates depend on the key and each coordinate, and are distributed correctly
+template<typename Transform, typename Prf>
+void check_moments()
+{
+	const coordinate_key<Prf> key(2012), other(2013);
+	BOOST_CHECK( normal_at<Transform>(key, 1, 2, 3) != normal_at<Transform>(other, 1, 2, 3) );
+	BOOST_CHECK( normal_at<Transform>(key, 1, 2, 3) != normal_at<Transform>(key, 0, 2, 3) );
+	BOOST_CHECK( normal_at<Transform>(key, 1, 2, 3) != normal_at<Transform>(key, 1, 1, 3) );
+	BOOST_CHECK( normal_at<Transform>(key, 1, 2, 3) != normal_at<Transform>(key, 1, 2, 2) );
+	BOOST_CHECK( normal_at<Transform>(key, 0x100000001ULL, 2, 3) != normal_at<Transform>(key, 1, 2, 3) );
+
+	// dimensions 2q and 2q + 1 share a counter but are uncorrelated
+	const std::size_t N = 1 << 18;
+	std::vector<double> out(N);
+	normal_at<Transform>( key, coordinate_range(0, N / 64), coordinate_range(0, 8), coordinate_range(0, 8), &out[0] );
+
+	double sum = 0, sum2 = 0, cross = 0;
+	for (std::size_t i = 0; i < N; i += 2)
+	{
+		sum += out[i] + out[i + 1];
+		sum2 += out[i] * out[i] + out[i + 1] * out[i + 1];
+		cross += out[i] * out[i + 1];
+	}
+	const double mean = sum / N, variance = sum2 / N - mean * mean, correlation = cross / (N / 2);
+	const double tolerance = 5 / std::sqrt( static_cast<double>(N) );
+	BOOST_CHECK_SMALL( mean, tolerance );
+	BOOST_CHECK_SMALL( variance - 1, 3 * tolerance );
+	BOOST_CHECK_SMALL( correlation, 2 * tolerance );
+}
+
+BOOST_AUTO_TEST_SUITE(coordinate_addressed)
+
+//! the variates are the PRF's output at the documented counter
+BOOST_AUTO_TEST_CASE(counters)
+{
+	BOOST_TEST_MESSAGE("\nTesting coordinate addressed variates:\n\nTesting the counters ...");
+
+	// the key words of the seed, and the counter words of the coordinates
+	const coordinate_key<philox4x32> key(0x299f31d0a4093822ULL);
+	BOOST_CHECK( key.key()[0] == 0xa4093822 && key.key()[1] == 0x299f31d0 );
+
+	// the last known answer of Philox4x32-10 in the Random123 distribution
+	const philox4x32::domain_type c = {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+	const philox4x32::range_type r = key(c);
+	BOOST_CHECK( r[0] == 0xd16cfe09 && r[1] == 0x94fdcceb && r[2] == 0x5001e420 && r[3] == 0x24126ea1 );
+
+	// coordinates (path, step, dim) = (0x100000002, 5, 2 * 3) are the counter (5, 3, 2, 1)
+	const philox4x32::domain_type c1 = {{5, 3, 2, 1}};
+	const philox4x32::range_type r1 = key(c1);
+	BOOST_CHECK_EQUAL( uniform_at(key, 0x100000002ULL, 5, 6), qfcl::random::detail::coordinate_uniform(r1[0], r1[1]) );
+	BOOST_CHECK_EQUAL( uniform_at(key, 0x100000002ULL, 5, 7), qfcl::random::detail::coordinate_uniform(r1[2], r1[3]) );
+
+	// with 64 bit words the same 32 bit words are packed low half first
+	typedef boost::random::philox<2, boost::uint64_t> philox2x64;
+	const coordinate_key<philox2x64> wide(0x0123456789abcdefULL);
+	BOOST_CHECK( wide.key()[0] == 0x0123456789abcdefULL );
+	const philox2x64::domain_type c2 = {{0x0000000300000005ULL, 0x0000000100000002ULL}};
+	const philox2x64::range_type r2 = wide(c2);
+	BOOST_CHECK_EQUAL( uniform_at(wide, 0x100000002ULL, 5, 6),
+					   qfcl::random::detail::coordinate_uniform( static_cast<boost::uint32_t>(r2[0]),
+																  static_cast<boost::uint32_t>(r2[0] >> 32) ) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(batched, Prf, prfs)
+{
+	BOOST_TEST_MESSAGE("Testing batched normals ...");
+
+	const coordinate_key<Prf> key(0x0123456789abcdefULL);
+	check_batched<box_muller_transform>(key);
+	check_batched<inversion_transform>(key);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(moments, Prf, prfs)
+{
+	check_moments<box_muller_transform, Prf>();
+	check_moments<inversion_transform, Prf>();
+}
+
+//! the PRFs give different variates for the same seed
+BOOST_AUTO_TEST_CASE(prf_families)
+{
+	const double z0 = normal_at( coordinate_key<philox4x32>(7), 1, 2, 3 );
+	const double z1 = normal_at( coordinate_key< boost::random::threefry<4, boost::uint32_t> >(7), 1, 2, 3 );
+	const double z2 = normal_at( coordinate_key< boost::random::ars<boost::uint32_t> >(7), 1, 2, 3 );
+	BOOST_CHECK( z0 != z1 && z0 != z2 && z1 != z2 );
+}
+
+//! the uniforms are in (0, 1) and are the ones inverted
+BOOST_AUTO_TEST_CASE_TEMPLATE(uniforms, Prf, prfs)
+{
+	const coordinate_key<Prf> key(99);
+	bool in_range = true, inverted = true;
+	for (boost::uint32_t d = 0; d < 10000; ++d)
+	{
+		const double u = uniform_at(key, 4, 2, d);
+		in_range = in_range && 0 < u && u < 1;
+		inverted = inverted && normal_at<inversion_transform>(key, 4, 2, d) == qfcl::random::detail::normal_inv(u);
+	}
+	BOOST_CHECK(in_range);
+	BOOST_CHECK(inverted);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
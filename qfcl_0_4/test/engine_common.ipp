@@ -10,8 +10,11 @@ namespace mpl = boost::mpl;
 
 #include <qfcl/random/engine/counting.hpp>
 #include <qfcl/random/engine/mersenne_twister.hpp>
+#include <qfcl/random/engine/mrg32k3a.hpp>
 #include <qfcl/random/engine/named_adapter.hpp>
+#include <qfcl/random/engine/sfmt.hpp>
 #include <qfcl/random/engine/twisted_generalized_feedback_shift_register.hpp>
+#include <qfcl/random/engine/xoshiro.hpp>
 #include <qfcl/utility/tmp.hpp>
 
 // list of engines
@@ -32,6 +35,7 @@ typedef mpl::push_back<reversible_linear_generator_engines, qfcl::random::boost_
 
 //! List of all engines
 typedef mpl::vector< qfcl::random::mt19937,
+					 qfcl::random::mt19937_incremental,
 					 qfcl::random::boost_mt19937,
 					 qfcl::random::reverse_mt19937,
 					 qfcl::random::mt19937_64,	
@@ -45,7 +49,11 @@ typedef mpl::vector< qfcl::random::mt19937,
 					 qfcl::random::tt800,		
 					 qfcl::random::reverse_tt800,
 					 qfcl::random::micro_mt,	
-					 qfcl::random::reverse_micro_mt
+					 qfcl::random::reverse_micro_mt,
+					 qfcl::random::mrg32k3a,
+					 qfcl::random::xoshiro256starstar,
+					 qfcl::random::xoshiro256starstar_x4,
+					 qfcl::random::sfmt19937
 				   > all_engines;
 
 /// NOTE: Put somewhere else?
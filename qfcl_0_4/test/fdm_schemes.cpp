@@ -0,0 +1,317 @@
+/* test/fdm_schemes.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/fdm_schemes.cpp
+	\brief Tests the finite difference schemes of mc1.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/mc1/FDMVisitor.cpp>
+#include <qfcl/mc1/FDMVisitor_named.hpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+typedef boost::random::mt19937 generator_type;
+typedef Sde<double, double, double> sde_type;
+
+//! dX = mu X dt + sigma X^beta dW
+struct cev_coefficients
+{
+	cev_coefficients(double mu_, double sigma_, double beta_ = 1.0) : mu(mu_), sigma(sigma_), beta(beta_) {}
+
+	double drift(double X, double) const {return mu * X;}
+	double diffusion(double X, double) const {return sigma * std::pow(X, beta);}
+	double diffusionDerivative(double X, double) const {return sigma * beta * std::pow(X, beta - 1.0);}
+	double driftCorrected(double X, double t, double B) const {return drift(X, t) - B * diffusion(X, t) * diffusionDerivative(X, t);}
+
+	double mu, sigma, beta;
+};
+
+//! the SDE on [0, T] from \p X0, with its structure left undeclared, so that the schemes take their generic paths
+sde_type make_sde(const cev_coefficients & c, double X0, double T)
+{
+	return sde_type( X0, Range<double>(0.0, T),
+					 boost::bind(&cev_coefficients::drift, c, _1, _2),
+					 boost::bind(&cev_coefficients::driftCorrected, c, _1, _2, _3),
+					 boost::bind(&cev_coefficients::diffusion, c, _1, _2),
+					 boost::bind(&cev_coefficients::diffusionDerivative, c, _1, _2) );
+}
+
+//! the same SDE, declaring its CEV structure, so that the schemes that can take their fast paths
+sde_type make_cev_sde(const cev_coefficients & c, double X0, double T)
+{
+	sde_type sde = make_sde(c, X0, T);
+	sde.structure = SdeStructure<double>::cev(c.mu, c.sigma, c.beta);
+	return sde;
+}
+
+//! the largest relative difference between two paths
+double path_difference(const pathType<double> & a, const pathType<double> & b)
+{
+	double difference = 0;
+	for (std::size_t i = 0; i < a.size(); ++i)
+		difference = std::max( difference, std::abs(a[i] - b[i]) / std::abs(b[i]) );
+	return difference;
+}
+
+//! \p scheme visiting \p sde with its normals from \p seed
+template<typename Scheme>
+pathType<double> seeded_path(Scheme & scheme, sde_type & sde, boost::uint32_t seed)
+{
+	scheme.generator.seed(seed);
+	scheme.Visit(sde);
+	return scheme.res;
+}
+
+//! the terminal value of a path of \p scheme
+template<typename Scheme>
+double terminal_value(Scheme & scheme)
+{
+	const pathType<double> & path = scheme.path();
+	return path[path.size() - 1];
+}
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(fdm_schemes)
+
+//! without diffusion every scheme solves dX = mu X dt, so each step must start from the previous one
+BOOST_AUTO_TEST_CASE(deterministic_growth)
+{
+	BOOST_TEST_MESSAGE("\nTesting the FDM schemes:\n\nTesting deterministic growth ...");
+
+	const double X0 = 60.0, mu = 0.5, T = 1.0;
+	const long N = 200;
+	sde_type sde = make_sde( cev_coefficients(mu, 0.0), X0, T );
+	const generator_type gen;
+	const double exact = X0 * std::exp(mu * T);
+
+	// first order schemes are within about (mu T)^2 / (2N) relatively (the tolerance is in percent),
+	// while restarting each step from X0 ends near X0 (1 + mu T / N)
+	const double tolerance = 100 * (mu * T) * (mu * T) / N;
+
+	ExplicitEuler<double, double, double, generator_type> euler(N, sde, gen);
+	BOOST_CHECK_CLOSE( terminal_value(euler), X0 * std::pow(1 + mu * T / N, static_cast<double>(N)), 1e-10 );
+
+	ExplicitEulerTypeII<double, double, double, generator_type> typeII(N, sde, gen);
+	BOOST_CHECK_CLOSE( terminal_value(typeII), exact, tolerance );
+
+	ExplicitEulerMM<double, double, double, generator_type> mm(N, sde, gen);
+	BOOST_CHECK_CLOSE( terminal_value(mm), exact, tolerance );
+
+	ExplicitEulerBridge<double, double, double, generator_type> bridge(N, sde, gen, 16);
+	BOOST_CHECK_CLOSE( terminal_value(bridge), X0 * std::pow(1 + mu * T / N, static_cast<double>(N)), 1e-10 );
+
+	PredictorCorrector<double, double, double, generator_type> pc(N, sde, gen, 0.5, 0.5);
+	BOOST_CHECK_CLOSE( terminal_value(pc), exact, tolerance );
+
+	PredictorCorrectorClassico<double, double, double, generator_type> classico(N, sde, gen, 0.5, 0.5);
+	BOOST_CHECK_CLOSE( terminal_value(classico), exact, tolerance );
+
+	Milstein<double, double, double, generator_type> milstein(N, sde, gen);
+	BOOST_CHECK_CLOSE( terminal_value(milstein), exact, tolerance );
+
+	KarhunenLoeve<double, double, double, generator_type> kl(N, sde, gen);
+	BOOST_CHECK_CLOSE( terminal_value(kl), X0 * std::pow(1 + mu * T / N, static_cast<double>(N)), 1e-10 );
+
+	PredictorCorrectorKL<double, double, double, generator_type> pckl(N, sde, gen, 0.5, 0.5);
+	BOOST_CHECK_CLOSE( terminal_value(pckl), exact, tolerance );
+
+	// and the whole path, not only its end
+	const pathType<double> & path = euler.path();
+	bool monotone = true;
+	for (std::size_t i = 1; i < path.size(); ++i)
+		monotone = monotone && path[i] > path[i - 1];
+	BOOST_CHECK(monotone);
+}
+
+//! the precomputed CEV factors give the paths of the generic schemes, and come from the SDE being visited
+BOOST_AUTO_TEST_CASE(cev_fast_path)
+{
+	BOOST_TEST_MESSAGE("Testing the CEV fast paths ...");
+
+	const double X0 = 100.0, T = 1.0;
+	const long N = 50;
+	const generator_type gen;
+	const cev_coefficients models[] = { cev_coefficients(0.05, 0.2), cev_coefficients(0.05, 2.0, 0.5), cev_coefficients(-0.1, 0.02, 1.5) };
+
+	for (std::size_t j = 0; j < sizeof(models) / sizeof(models[0]); ++j)
+	{
+		sde_type generic = make_sde(models[j], X0, T), cev = make_cev_sde(models[j], X0, T);
+
+		ExplicitEuler<double, double, double, generator_type> euler(N, generic, gen), fastEuler(N, cev, gen);
+		BOOST_REQUIRE( !euler.cev && fastEuler.cev );
+		for (boost::uint32_t seed = 1; seed <= 10; ++seed)
+			BOOST_CHECK_SMALL( path_difference( seeded_path(fastEuler, cev, seed), seeded_path(euler, generic, seed) ), 1e-12 );
+
+		Milstein<double, double, double, generator_type> milstein(N, generic, gen), fastMilstein(N, cev, gen);
+		for (boost::uint32_t seed = 1; seed <= 10; ++seed)
+			BOOST_CHECK_SMALL( path_difference( seeded_path(fastMilstein, cev, seed), seeded_path(milstein, generic, seed) ), 1e-12 );
+	}
+
+	// a scheme visiting another SDE than its own steps that SDE, not the one it was constructed with
+	sde_type gbm = make_cev_sde(models[0], X0, T), root = make_cev_sde(models[1], X0, T);
+	ExplicitEuler<double, double, double, generator_type> euler(N, gbm, gen), rootEuler(N, root, gen);
+	BOOST_CHECK_SMALL( path_difference( seeded_path(euler, root, 7), seeded_path(rootEuler, root, 7) ), 1e-15 );
+
+	Milstein<double, double, double, generator_type> milstein(N, gbm, gen), rootMilstein(N, root, gen);
+	BOOST_CHECK_SMALL( path_difference( seeded_path(milstein, root, 7), seeded_path(rootMilstein, root, 7) ), 1e-15 );
+
+	// and an undeclared SDE takes the generic path
+	sde_type generic = make_sde(models[1], X0, T);
+	ExplicitEuler<double, double, double, generator_type> genericEuler(N, generic, gen);
+	BOOST_CHECK_SMALL( path_difference( seeded_path(euler, generic, 7), seeded_path(genericEuler, generic, 7) ), 1e-15 );
+	BOOST_CHECK( !euler.cev );
+}
+
+//! the mean of X_T over \p M paths of \p scheme, and its standard error
+template<typename Scheme>
+std::pair<double, double> terminal_mean(Scheme & scheme, long M)
+{
+	double sum = 0, sum2 = 0;
+	for (long m = 0; m < M; ++m)
+	{
+		const double X = terminal_value(scheme);
+		sum += X;
+		sum2 += X * X;
+	}
+	const double mean = sum / M;
+	return std::make_pair( mean, std::sqrt( (sum2 / M - mean * mean) / M ) );
+}
+
+//! the KL schemes converge to the Ito solution: with increments of a truncated expansion E X_T would tend to the Stratonovich X0 exp((mu + sigma^2 / 2) T)
+BOOST_AUTO_TEST_CASE(karhunen_loeve_ito)
+{
+	BOOST_TEST_MESSAGE("Testing the Karhunen-Loeve schemes against the Ito mean ...");
+
+	const double X0 = 100.0, mu = 0.05, sigma = 0.4, T = 1.0;
+	const long N = 200, M = 40000;
+	sde_type sde = make_sde( cev_coefficients(mu, sigma), X0, T );
+
+	// Euler on GBM has E X_T = X0 (1 + mu T / N)^N exactly, whatever the increments, as long as they are independent N(0, T / N)
+	KarhunenLoeve<double, double, double, generator_type> kl( N, sde, generator_type(2012) );
+	const std::pair<double, double> euler = terminal_mean(kl, M);
+	BOOST_CHECK_SMALL( euler.first - X0 * std::pow(1 + mu * T / N, static_cast<double>(N)), 5 * euler.second );
+
+	// the predictor-corrector is within its discretization error of X0 exp(mu T), here far below the standard error
+	PredictorCorrectorKL<double, double, double, generator_type> pckl( N, sde, generator_type(2013), 0.5, 0.5 );
+	const std::pair<double, double> pc = terminal_mean(pckl, M);
+	BOOST_CHECK_SMALL( pc.first - X0 * std::exp(mu * T), 5 * pc.second );
+
+	// and the Stratonovich mean, about 8.7 higher, is well outside
+	BOOST_CHECK_GT( X0 * std::exp((mu + 0.5 * sigma * sigma) * T) - X0 * std::exp(mu * T), 20 * std::max(euler.second, pc.second) );
+}
+
+//! Euler on Brownian bridge paths has the moments of Euler on independent increments, across batches of any size
+BOOST_AUTO_TEST_CASE(euler_bridge)
+{
+	BOOST_TEST_MESSAGE("Testing Euler on Brownian bridge paths ...");
+
+	const double X0 = 100.0, mu = 0.05, sigma = 0.3, T = 1.0;
+	const long N = 16, M = 40000;
+	const double k = T / N;
+	sde_type sde = make_sde( cev_coefficients(mu, sigma), X0, T );
+
+	// E X_T = X0 (1 + mu k)^N and E X_T^2 = X0^2 ((1 + mu k)^2 + sigma^2 k)^N, since the steps multiply X by 1 + mu k + sigma dW
+	const double expectedMean = X0 * std::pow(1 + mu * k, static_cast<double>(N));
+	const double expectedSecond = X0 * X0 * std::pow((1 + mu * k) * (1 + mu * k) + sigma * sigma * k, static_cast<double>(N));
+	const double sd = std::sqrt(expectedSecond - expectedMean * expectedMean);
+
+	// a batch of one path, batches not dividing M and the default
+	const std::size_t batches[] = {1, 37, 1024};
+	for (std::size_t j = 0; j < sizeof(batches) / sizeof(batches[0]); ++j)
+	{
+		ExplicitEulerBridge<double, double, double, generator_type> bridge( N, sde, generator_type(2012 + j), batches[j] );
+
+		double sum = 0, sum2 = 0, previous = 0;
+		bool distinct = true;
+		for (long m = 0; m < M; ++m)
+		{
+			const pathType<double> & path = bridge.path();
+			BOOST_REQUIRE_EQUAL( path[0], X0 );
+			const double X = path[path.size() - 1];
+			distinct = distinct && X != previous;
+			previous = X;
+			sum += X;
+			sum2 += X * X;
+		}
+		BOOST_CHECK(distinct);
+		BOOST_CHECK_SMALL( sum / M - expectedMean, 5 * sd / std::sqrt(static_cast<double>(M)) );
+		BOOST_CHECK_CLOSE( sum2 / M, expectedSecond, 2 );
+	}
+
+	qfcl::mc1::ExplicitEulerBridge_named<double, double, double, generator_type> named(N, sde, generator_type(), 8);
+	BOOST_CHECK_EQUAL( named.path()[0], X0 );
+}
+
+//! exact log stepping has the moments of GBM at every step size, and needs a GBM
+BOOST_AUTO_TEST_CASE(exact_log)
+{
+	BOOST_TEST_MESSAGE("Testing exact log stepping ...");
+
+	const double X0 = 100.0, mu = 0.05, sigma = 0.3, T = 2.0;
+	const long N = 4, M = 100000;
+	sde_type sde = make_cev_sde( cev_coefficients(mu, sigma), X0, T );
+	ExactLog<double, double, double, generator_type> exact( N, sde, generator_type() );
+	exact.generator.seed(2012);
+
+	double sum = 0, sum2 = 0, logSum = 0, logSum2 = 0;
+	for (long m = 0; m < M; ++m)
+	{
+		const double X = terminal_value(exact), L = std::log(X / X0);
+		sum += X;
+		sum2 += X * X;
+		logSum += L;
+		logSum2 += L * L;
+	}
+	const double mean = sum / M, variance = sum2 / M - mean * mean;
+	const double logMean = logSum / M, logVariance = logSum2 / M - logMean * logMean;
+
+	// log(X_T / X0) ~ N((mu - sigma^2 / 2) T, sigma^2 T)
+	BOOST_CHECK_SMALL( logMean - (mu - 0.5 * sigma * sigma) * T, 5 * sigma * std::sqrt(T / M) );
+	BOOST_CHECK_CLOSE( logVariance, sigma * sigma * T, 100 * 5 * std::sqrt(2.0 / M) );
+
+	// E X_T = X0 exp(mu T), Var X_T = X0^2 exp(2 mu T) (exp(sigma^2 T) - 1)
+	const double expectedMean = X0 * std::exp(mu * T);
+	const double expectedVariance = expectedMean * expectedMean * (std::exp(sigma * sigma * T) - 1);
+	BOOST_CHECK_SMALL( mean - expectedMean, 5 * std::sqrt(expectedVariance / M) );
+	BOOST_CHECK_CLOSE( variance, expectedVariance, 5 );
+
+	// the path starts at X0 and stays positive
+	const pathType<double> & path = exact.path();
+	BOOST_CHECK_EQUAL( path[0], X0 );
+	BOOST_CHECK( *std::min_element( path.begin(), path.end() ) > 0 );
+
+	sde_type root = make_cev_sde( cev_coefficients(mu, sigma, 0.5), X0, T ), generic = make_sde( cev_coefficients(mu, sigma), X0, T );
+	BOOST_CHECK_THROW( (ExactLog<double, double, double, generator_type>( N, root, generator_type() )), std::invalid_argument );
+	BOOST_CHECK_THROW( (ExactLog<double, double, double, generator_type>( N, generic, generator_type() )), std::invalid_argument );
+	BOOST_CHECK_THROW( exact.Visit(root), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,130 @@
+/* test/greeks.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/greeks.cpp
+	\brief Tests the Monte Carlo sensitivities of mc1 against the Black-Scholes closed form.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cmath>
+#include <cstddef>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/finance/analytics/black_scholes.hpp>
+#include <qfcl/mc1/Greeks.cpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+typedef boost::random::mt19937 generator_type;
+
+const double S0 = 100.0, K = 100.0, r = 0.05, d = 0.0, vol = 0.2, T = 1.0;
+const long steps = 20;
+
+//! the sensitivities of \c cevSdeGradient: X0, then the parameters (r, d, vol, beta)
+enum {DELTA = 0, RHO = 1, VEGA = 3};
+
+const qfcl::finance::black_scholes_greeks<double> & exact()
+{
+	static const qfcl::finance::black_scholes_greeks<double> g = qfcl::finance::black_scholes(qfcl::finance::CALL, S0, K, r, d, vol, T);
+	return g;
+}
+
+//! \p estimate is \p expected within 4 standard errors, and the relative discretization error \p bias of \c steps Euler steps
+void check_estimate(double estimate, double error, double expected, double bias = 0.01)
+{
+	BOOST_CHECK_SMALL( estimate - expected, 4 * error + bias * std::abs(expected) );
+}
+
+//! the price, delta, rho and vega of a GBM call by \p method
+template<typename Method>
+void check_call(GreeksScheme scheme, Method method, long paths, double tolerance_factor)
+{
+	MCGreeks<generator_type> greeks( cevSdeGradient(S0, T, r, d, vol), steps, scheme, generator_type(2012) );
+	BOOST_REQUIRE_EQUAL( greeks.size(), 5u );
+
+	(greeks.*method)( callPayoff(K, r, T), paths );
+
+	check_estimate( greeks.price(), greeks.priceError(), exact().price );
+	check_estimate( greeks.sensitivity(DELTA), greeks.sensitivityError(DELTA), exact().delta );
+	check_estimate( greeks.sensitivity(RHO), greeks.sensitivityError(RHO), exact().rho );
+	check_estimate( greeks.sensitivity(VEGA), greeks.sensitivityError(VEGA), exact().vega );
+
+	// the standard errors are small enough for the checks to mean something
+	BOOST_CHECK_LT( greeks.sensitivityError(DELTA), tolerance_factor * 0.01 * exact().delta );
+	BOOST_CHECK_LT( greeks.sensitivityError(VEGA), tolerance_factor * 0.01 * exact().vega );
+}
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(greeks)
+
+//! pathwise delta, rho and vega of the Euler scheme
+BOOST_AUTO_TEST_CASE(pathwise_euler)
+{
+	BOOST_TEST_MESSAGE("\nTesting Monte Carlo greeks against Black-Scholes:\n\nTesting pathwise greeks (Euler) ...");
+
+	check_call( EulerGreeks, &MCGreeks<generator_type>::adjoint, 100000, 1 );
+}
+
+//! pathwise delta, rho and vega of the Milstein scheme
+BOOST_AUTO_TEST_CASE(pathwise_milstein)
+{
+	BOOST_TEST_MESSAGE("Testing pathwise greeks (Milstein) ...");
+
+	check_call( MilsteinGreeks, &MCGreeks<generator_type>::adjoint, 100000, 1 );
+}
+
+//! likelihood ratio delta, rho and vega, which have larger variances
+BOOST_AUTO_TEST_CASE(likelihood_ratio)
+{
+	BOOST_TEST_MESSAGE("Testing likelihood ratio greeks ...");
+
+	check_call( EulerGreeks, &MCGreeks<generator_type>::likelihoodRatio, 400000, 5 );
+
+	MCGreeks<generator_type> milstein( cevSdeGradient(S0, T, r, d, vol), steps, MilsteinGreeks, generator_type() );
+	BOOST_CHECK_THROW( milstein.likelihoodRatio( callPayoff(K, r, T), 1 ), std::logic_error );
+}
+
+//! the pathwise derivatives are those of the simulated paths: a bump of X0 with the same normals
+BOOST_AUTO_TEST_CASE(pathwise_bump)
+{
+	BOOST_TEST_MESSAGE("Testing pathwise greeks against bumped prices ...");
+
+	const double h = 1e-4;
+	const long paths = 2000;
+	MCGreeks<generator_type> base( cevSdeGradient(S0, T, r, d, vol), steps, MilsteinGreeks, generator_type(5) );
+	MCGreeks<generator_type> up( cevSdeGradient(S0 + h, T, r, d, vol), steps, MilsteinGreeks, generator_type(5) );
+	MCGreeks<generator_type> down( cevSdeGradient(S0 - h, T, r, d, vol), steps, MilsteinGreeks, generator_type(5) );
+	base.adjoint( callPayoff(K, r, T), paths );
+	up.adjoint( callPayoff(K, r, T), paths );
+	down.adjoint( callPayoff(K, r, T), paths );
+
+	BOOST_CHECK_CLOSE( base.sensitivity(DELTA), (up.price() - down.price()) / (2 * h), 0.1 );
+
+	MCGreeks<generator_type> vol_up( cevSdeGradient(S0, T, r, d, vol + h), steps, MilsteinGreeks, generator_type(5) );
+	MCGreeks<generator_type> vol_down( cevSdeGradient(S0, T, r, d, vol - h), steps, MilsteinGreeks, generator_type(5) );
+	vol_up.adjoint( callPayoff(K, r, T), paths );
+	vol_down.adjoint( callPayoff(K, r, T), paths );
+
+	BOOST_CHECK_CLOSE( base.sensitivity(VEGA), (vol_up.price() - vol_down.price()) / (2 * h), 0.1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -38,6 +38,7 @@ using std::swap;
 #include <boost/mpl/insert.hpp>
 #include <boost/mpl/list.hpp>
 #include <boost/mpl/front.hpp>
+#include <boost/mpl/if.hpp>
 #include <boost/mpl/pair.hpp>
 #include <boost/mpl/placeholders.hpp>
 #include <boost/mpl/string.hpp>
@@ -46,6 +47,7 @@ using std::swap;
 #include <boost/random/mersenne_twister.hpp>
 
 #include <qfcl/random/engine/mersenne_twister.hpp>
+#include <qfcl/random/engine/snapshot.hpp>
 #include <qfcl/random/engine/twisted_generalized_feedback_shift_register.hpp>
 using namespace qfcl::random;
 #include <qfcl/utility/names.hpp>
@@ -221,6 +223,44 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(streaming, Engine, all_linear_generator_engines)
 	}
 }
 
+//! check that binary snapshots restore the state exactly
+BOOST_AUTO_TEST_CASE_TEMPLATE(snapshot, Engine, all_linear_generator_engines)
+{
+	if ( qfcl::tmp::is_first<all_linear_generator_engines, Engine>::value )
+		BOOST_TEST_MESSAGE("Testing binary snapshots of the generator state ...");
+
+	// use the default seed
+	Engine eng;
+
+#ifdef	QFCL_VERBOSE_TEST
+	print_engine_name(eng, " ...");
+#endif	// QFCL_VERBOSE_TEST
+
+	// move ahead n / 2 numbers, so that the state index is not 0
+	for (size_t i = 0; i < Engine::state_size / 2; ++i)
+		eng();
+
+	std::vector<char> buffer( snapshot_size(eng) );
+	BOOST_REQUIRE( save_snapshot(eng, &buffer[0]) == &buffer[0] + buffer.size() );
+
+	const typename Engine::result_type seed = 987654321u;
+	Engine engOther(seed);
+	BOOST_CHECK(eng != engOther);
+
+	BOOST_REQUIRE( restore_snapshot(engOther, &buffer[0]) == &buffer[0] + buffer.size() );
+	BOOST_CHECK(eng == engOther);
+
+	const size_t testSize = 10000;
+
+	for (size_t i = 0; i < testSize; ++i)
+		BOOST_REQUIRE_EQUAL( eng(), engOther() );
+
+	// a snapshot of a different engine must be rejected
+	typedef typename boost::mpl::if_< boost::is_same<Engine, mt19937>, tt800, mt19937 >::type OtherEngine;
+	OtherEngine different;
+	BOOST_CHECK_THROW( restore_snapshot(different, &buffer[0]), std::runtime_error );
+}
+
 //! test that changing \c UIntType results in equivalent generator
 BOOST_AUTO_TEST_CASE(UIntType)
 {
@@ -363,6 +403,69 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(peek, Engine, all_linear_generator_engines)
 	BOOST_REQUIRE_EQUAL( eng1(), eng2.peek(discard_size + 1) );
 }
 
+//! the number at offset \p v of \p eng, by \c discard or \c reverse_discard followed by the next number
+template<typename Engine>
+typename Engine::result_type discard_next(Engine eng, long long v)
+{
+	if (v > 0)
+		eng.discard(v - 1);
+	else
+		eng.reverse_discard(1 - v);
+
+	return eng();
+}
+
+//! Tests peek_many
+BOOST_AUTO_TEST_CASE_TEMPLATE(peek_many, Engine, all_linear_generator_engines)
+{
+	if( qfcl::tmp::is_first<all_linear_generator_engines, Engine>::value )
+		BOOST_TEST_MESSAGE("Testing peek_many() ...");
+
+	const long long n = Engine::state_size;
+
+	// use default seed
+	Engine eng;
+	
+#ifdef	QFCL_VERBOSE_TEST
+	print_engine_name(eng, " ...");
+#endif	// QFCL_VERBOSE_TEST
+
+	std::vector<long long> offsets;
+	offsets.push_back(0);
+	offsets.push_back(1);
+	offsets.push_back(1);
+	offsets.push_back(10 * n);
+	offsets.push_back(10 * n + 1);
+	offsets.push_back(25 * n);
+
+	// compare with peek at each offset
+	typedef typename Engine::result_type result_t;
+	std::vector<result_t> values = eng.peek_many(offsets);
+	BOOST_REQUIRE_EQUAL( values.size(), offsets.size() );
+	for (size_t j = 0; j < offsets.size(); ++j)
+		BOOST_REQUIRE_EQUAL( values[j], eng.peek(offsets[j]) );
+
+	// offsets beyond the step limit in both directions, and gaps beyond it, which are jumped rather than stepped
+	const long long limit = static_cast<long long>(Engine::step_limit);
+	std::vector<long long> far_offsets;
+	far_offsets.push_back(-2 * limit - 3);
+	far_offsets.push_back(-limit - 1);
+	far_offsets.push_back(-5);
+	far_offsets.push_back(limit + 1);
+	far_offsets.push_back(limit + 2);
+	far_offsets.push_back(3 * limit + n);
+
+	// compare with discard (or reverse_discard) and the next number
+	values = eng.peek_many(far_offsets);
+	BOOST_REQUIRE_EQUAL( values.size(), far_offsets.size() );
+	for (size_t j = 0; j < far_offsets.size(); ++j)
+		BOOST_REQUIRE_EQUAL( values[j], discard_next(eng, far_offsets[j]) );
+
+	// the offsets must be sorted
+	std::swap(offsets[0], offsets[3]);
+	BOOST_CHECK_THROW( eng.peek_many(offsets), std::invalid_argument );
+}
+
 //! Tests reverse_peek and peek(long long)
 BOOST_AUTO_TEST_CASE_TEMPLATE(reverse_peek, Engine, reversible_linear_generator_engines)
 {
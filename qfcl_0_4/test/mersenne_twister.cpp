@@ -81,6 +81,14 @@ typedef mpl::list< mpl::pair<mt11213b,		boost::random::mt11213b>,
 				   mpl::pair<mt19937_64,	boost::random::mt19937_64> >
 boost_regression;
 
+/*! \brief The mersenne twisters paired with their incremental twist modes.
+*/
+typedef mpl::list< mpl::pair<mt11213a,		mt11213a_incremental>,
+				   mpl::pair<mt11213b,		mt11213b_incremental>,
+				   mpl::pair<mt19937,		mt19937_incremental>,
+				   mpl::pair<mt19937_64,	mt19937_64_incremental> >
+incremental_twist_pairs;
+
 //! for formatting output
 const size_t indent_width = 10;
 
@@ -689,6 +697,51 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(ctor_seed, Engine, mersenne_twister_engines)
 	BOOST_CHECK(mt4 == mtSeed);
 }
 
+//! The incremental twist generates the same sequence, with the same state, as the full twist
+BOOST_AUTO_TEST_CASE_TEMPLATE(incremental_twist, pair, incremental_twist_pairs)
+{
+	if( qfcl::tmp::is_first<incremental_twist_pairs, pair>::value )
+		BOOST_TEST_MESSAGE("Testing the incremental twist ...");
+
+	typedef typename pair::first Engine;
+	typedef typename pair::second Incremental;
+
+	QFCL_CREATE_VECTOR(key, unsigned long, 12345, 67890, 1111111111u, 0);
+	Engine mt( key.begin(), key.end() );
+	Incremental inc( key.begin(), key.end() );
+
+	// several full twists, ending part way through the state
+	const size_t length = 3 * Engine::state_size + 5;
+	bool same = true;
+	for (size_t i = 0; i < length; ++i)
+		same = same && mt() == inc();
+	BOOST_CHECK(same);
+
+	const typename Engine::state s1 = mt.getState(), s2 = inc.getState();
+	BOOST_CHECK( std::equal(s1.rep(), s1.rep() + Engine::state_size, s2.rep()) );
+
+	// the streams are interchangeable
+	std::stringstream ss, inc_ss;
+	ss << mt;
+	inc_ss << inc;
+	BOOST_CHECK_EQUAL( ss.str(), inc_ss.str() );
+	Incremental streamed;
+	ss >> streamed;
+	BOOST_CHECK(streamed == inc);
+
+	// continuing the sequence of the full twist
+	Incremental continued(mt);
+	BOOST_CHECK(continued == inc);
+	BOOST_CHECK_EQUAL( continued(), mt() );
+
+	// seeds
+	BOOST_CHECK( Incremental() == Incremental(Engine::default_seed) );
+	BOOST_CHECK( Incremental(209419383) != Incremental() );
+	Incremental seeded;
+	seeded.seed(209419383);
+	BOOST_CHECK_EQUAL( seeded(), Engine(209419383)() );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 //!	@}
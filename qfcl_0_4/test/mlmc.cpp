@@ -0,0 +1,109 @@
+/* test/mlmc.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/mlmc.cpp
+	\brief Tests the multilevel Monte Carlo driver of mc1 against Black-Scholes.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/finance/analytics/black_scholes.hpp>
+#include <qfcl/mc1/MLMC.cpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+typedef boost::random::mt19937 generator_type;
+typedef Sde<double, double, double> sde_type;
+
+const double S0 = 100.0, K = 100.0, r = 0.05, sigma = 0.2, T = 1.0;
+
+double drift(double X, double) {return r * X;}
+double diffusion(double X, double) {return sigma * X;}
+double diffusionDerivative(double, double) {return sigma;}
+double driftCorrected(double X, double, double B) {return r * X - B * sigma * sigma * X;}
+
+sde_type gbm()
+{
+	return sde_type( S0, Range<double>(0.0, T), drift, driftCorrected, diffusion, diffusionDerivative );
+}
+
+//! the discounted call on the terminal value of a path
+struct discounted_call
+{
+	double operator()(const pathType<double> & path) const {return std::exp(-r * T) * std::max(path[path.size() - 1] - K, 0.0);}
+};
+
+double exact_price()
+{
+	return qfcl::finance::black_scholes(qfcl::finance::CALL, S0, K, r, 0.0, sigma, T).price;
+}
+
+//! the estimate of \p mlmc is within its root mean square error \p eps of Black-Scholes, and the variances of the corrections decay
+template<typename Driver>
+void check_estimate(Driver & mlmc, double eps, double decay)
+{
+	const double price = mlmc.estimate(eps, 2000, 2012);
+	BOOST_CHECK_SMALL( price - exact_price(), 3 * eps );
+
+	const std::vector<typename Driver::Level> & levels = mlmc.statistics();
+	BOOST_REQUIRE_GE( levels.size(), 3u );
+	for (std::size_t l = 2; l < levels.size(); ++l)
+		BOOST_CHECK_LT( levels[l].variance(), levels[l - 1].variance() / decay );
+
+	// the cost is the number of time steps, N0 on level 0 and 3 N0 2^(l-1) on level l
+	BOOST_CHECK_EQUAL( levels[0].cost(), 4.0 );
+	for (std::size_t l = 1; l < levels.size(); ++l)
+		BOOST_CHECK_EQUAL( levels[l].cost(), 12.0 * (1 << (l - 1)) );
+
+	double total = 0;
+	for (std::size_t l = 0; l < levels.size(); ++l)
+		total += levels[l].N * levels[l].cost();
+	BOOST_CHECK_EQUAL( mlmc.totalCost(), total );
+}
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(mlmc)
+
+//! Euler: the variance of the level corrections decays like 2^-l
+BOOST_AUTO_TEST_CASE(euler)
+{
+	BOOST_TEST_MESSAGE("\nTesting the multilevel Monte Carlo driver:\n\nTesting Euler ...");
+
+	MLMC<ExplicitEuler, generator_type, discounted_call> mlmc( gbm(), discounted_call(), 4, 8 );
+	check_estimate(mlmc, 0.02, 1.4);
+}
+
+//! Milstein: strong order 1, so the variance decays like 2^-2l
+BOOST_AUTO_TEST_CASE(milstein)
+{
+	BOOST_TEST_MESSAGE("Testing Milstein ...");
+
+	MLMC<Milstein, generator_type, discounted_call> mlmc( gbm(), discounted_call(), 4, 8 );
+	check_estimate(mlmc, 0.02, 2.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
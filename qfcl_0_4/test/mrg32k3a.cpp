@@ -0,0 +1,176 @@
+/* test/mrg32k3a.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/mrg32k3a.cpp
+	\brief Tests the MRG32k3a engine.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/foreach.hpp>
+
+#include <qfcl/random/engine/mrg32k3a.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+//! checks that the \f$3 \times 3\f$ matrix \p A is \f$B^{2^e}\f$ modulo \p m
+bool is_power_of_2(const boost::uint64_t (&A)[3][3], const boost::uint64_t (&B)[3][3], int e, boost::uint64_t m)
+{
+	qfcl::random::detail::mrg32k3a_matrix C(B);
+	for (int i = 0; i < e; ++i)
+		C = C.multiply(C, m);
+
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			if (C.a[i][j] != A[i][j])
+				return false;
+
+	return true;
+}
+
+BOOST_AUTO_TEST_SUITE(MRG32k3a)
+
+//! the first outputs of the reference implementation, with the default seed
+BOOST_AUTO_TEST_CASE(known_values)
+{
+	BOOST_TEST_MESSAGE("\nTesting the MRG32k3a engine:\n\nTesting known values ...");
+
+	mrg32k3a eng;
+	BOOST_CHECK_CLOSE( eng() / 4294967088.0, 0.1270111220, 1e-7 );
+	BOOST_CHECK_CLOSE( eng() / 4294967088.0, 0.3185275654, 1e-7 );
+	BOOST_CHECK_CLOSE( eng() / 4294967088.0, 0.3091860156, 1e-7 );
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		const mrg32k3a::result_type x = eng();
+		BOOST_CHECK( x >= mrg32k3a::min() && x <= mrg32k3a::max() );
+	}
+}
+
+//! \c discard and \c generate agree with sequential generation
+BOOST_AUTO_TEST_CASE(skip_ahead)
+{
+	BOOST_TEST_MESSAGE("Testing discard and generate ...");
+
+	mrg32k3a sequential(5489);
+	std::vector<mrg32k3a::result_type> values(2000);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = sequential();
+
+	const boost::uint64_t skips[] = {0, 1, 2, 3, 4, 63, 64, 100, 1000, 1999};
+	BOOST_FOREACH(boost::uint64_t z, skips)
+	{
+		mrg32k3a eng(5489);
+		eng.discard(z);
+		BOOST_CHECK_EQUAL( eng(), values[z] );
+	}
+
+	mrg32k3a eng(5489);
+	std::vector<mrg32k3a::result_type> block(values.size());
+	eng.generate(block.begin(), block.end());
+	BOOST_CHECK( block == values );
+	BOOST_CHECK( eng == sequential );
+}
+
+//! the precomputed jump matrices are \f$A^{2^{76}}\f$ and \f$A^{2^{127}}\f$
+BOOST_AUTO_TEST_CASE(jump_matrices)
+{
+	BOOST_TEST_MESSAGE("Testing the jump matrices ...");
+
+	using namespace qfcl::random::detail;
+
+	BOOST_CHECK( is_power_of_2(mrg32k3a_A1p76, mrg32k3a_A1, 76, mrg32k3a_m1) );
+	BOOST_CHECK( is_power_of_2(mrg32k3a_A2p76, mrg32k3a_A2, 76, mrg32k3a_m2) );
+	BOOST_CHECK( is_power_of_2(mrg32k3a_A1p127, mrg32k3a_A1, 127, mrg32k3a_m1) );
+	BOOST_CHECK( is_power_of_2(mrg32k3a_A2p127, mrg32k3a_A2, 127, mrg32k3a_m2) );
+}
+
+//! streams and substreams
+BOOST_AUTO_TEST_CASE(streams)
+{
+	BOOST_TEST_MESSAGE("Testing streams and substreams ...");
+
+	const mrg32k3a start;
+	mrg32k3a eng(start), other(start);
+
+	// 2^127 = 2^51 substreams
+	eng.next_stream();
+	other.jump_substreams( boost::uint64_t(1) << 51 );
+	BOOST_CHECK( eng == other );
+
+	// substreams of a stream
+	mrg32k3a s1(eng), s3(eng);
+	s1.next_substream();
+	s3.jump_substreams(3);
+	s1.next_substream();
+	s1.next_substream();
+	BOOST_CHECK( s1 == s3 );
+
+	// jumps of several streams
+	mrg32k3a t(start);
+	t.jump_streams(2);
+	eng.next_stream();
+	BOOST_CHECK( t == eng );
+
+	// resetting
+	const mrg32k3a::result_type first = t();
+	t();
+	t.reset_substream();
+	BOOST_CHECK_EQUAL( t(), first );
+	t.next_substream();
+	t();
+	t.reset_stream();
+	BOOST_CHECK_EQUAL( t(), first );
+
+	// the substream jump starts from the substream start, not the current state
+	mrg32k3a u(start), v(start);
+	u();
+	u.next_substream();
+	v.next_substream();
+	BOOST_CHECK( u == v );
+}
+
+//! seeding and serialization
+BOOST_AUTO_TEST_CASE(state)
+{
+	BOOST_TEST_MESSAGE("Testing seeding and serialization ...");
+
+	const boost::uint32_t s[6] = {12345, 12345, 12345, 12345, 12345, 12345};
+	BOOST_CHECK( mrg32k3a(s) == mrg32k3a() );
+
+	const boost::uint32_t zero[6] = {0, 0, 0, 1, 2, 3};
+	BOOST_CHECK_THROW( mrg32k3a eng(zero), std::invalid_argument );
+	const boost::uint32_t big[6] = {1, 2, 4294967087u, 1, 2, 3};
+	BOOST_CHECK_THROW( mrg32k3a eng(big), std::invalid_argument );
+
+	mrg32k3a eng(42), other;
+	BOOST_CHECK( eng != other );
+	eng.discard(12345);
+
+	std::stringstream ss;
+	ss << eng;
+	ss >> other;
+	BOOST_CHECK( eng == other );
+	BOOST_CHECK_EQUAL( eng(), other() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,169 @@
+/* test/pack_bits.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/pack_bits.cpp
+	\brief Tests the packing of bit streams against a naive bit by bit loop.
+
+	Built as \c pack_bits with the default flags, and as \c pack_bits_avx2 with \c -mavx2 when
+	\c QFCL_AVX2_TESTS is set, so that both the scalar and the AVX2 funnel shifts are tested.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/math/bits/pack_bits.hpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+//! bit \p j of the stream \p in
+template<std::size_t inSize, typename InWord>
+bool naive_bit(const InWord * in, std::size_t j)
+{
+	return ( (in[j / inSize] >> (j % inSize)) & 1 ) != 0;
+}
+
+//! \c pack_bits one bit at a time
+template<std::size_t inSize, std::size_t outSize, typename InWord, typename OutWord>
+std::vector<OutWord> naive_pack(const InWord * in, std::size_t shift, std::size_t nbits)
+{
+	std::vector<OutWord> out( (nbits + outSize - 1) / outSize, 0 );
+	for (std::size_t j = 0; j < nbits; ++j)
+		if ( naive_bit<inSize>(in, shift + j) )
+			out[j / outSize] |= OutWord(1) << (j % outSize);
+
+	return out;
+}
+
+//! \c unpack_bits one bit at a time
+template<std::size_t inSize, std::size_t outSize, typename InWord, typename OutWord>
+std::vector<OutWord> naive_unpack(const InWord * in, std::size_t nbits, std::size_t shift)
+{
+	std::vector<OutWord> out( (shift + nbits + outSize - 1) / outSize, 0 );
+	for (std::size_t j = 0; j < nbits; ++j)
+		if ( naive_bit<inSize>(in, j) )
+			out[(shift + j) / outSize] |= OutWord(1) << ((shift + j) % outSize);
+
+	return out;
+}
+
+//! random words, with the bits above \c inSize set at random too, as they must be ignored
+template<typename Word>
+std::vector<Word> random_words(std::size_t count, boost::random::mt19937_64 & rng)
+{
+	std::vector<Word> words(count);
+	for (std::size_t j = 0; j < count; ++j)
+		words[j] = static_cast<Word>( rng() );
+
+	return words;
+}
+
+//! \c pack_bits, \c unpack_bits and the round trip agree with the naive loops, for lengths and shifts that are not multiples of the word sizes
+template<std::size_t inSize, std::size_t outSize, typename InWord, typename OutWord>
+void check_pack_bits()
+{
+	boost::random::mt19937_64 rng(2012);
+
+	const std::size_t lengths[] = {1, 5, outSize - 1, outSize + 1, 2 * inSize + 3, 4 * outSize + 1, 9 * 64 + 17, 19937};
+	const std::size_t shifts[] = {0, 1, 7, inSize - 1, inSize, inSize + 1, 3 * inSize + 5};
+
+	bool packed = true, unpacked = true, round_trip = true;
+	for (std::size_t a = 0; a < sizeof(lengths) / sizeof(lengths[0]); ++a)
+		for (std::size_t b = 0; b < sizeof(shifts) / sizeof(shifts[0]); ++b)
+		{
+			const std::size_t nbits = lengths[a], shift = shifts[b];
+			// a spare word past the end, as the funnel shifts may read it
+			const std::vector<InWord> in = random_words<InWord>( (shift + nbits) / inSize + 2, rng );
+
+			std::vector<OutWord> out( (nbits + outSize - 1) / outSize + 1, OutWord(0x5A) );
+			qfcl::math::pack_bits<inSize, outSize>( &in[0], shift, nbits, &out[0] );
+			const std::vector<OutWord> expected = naive_pack<inSize, outSize, InWord, OutWord>(&in[0], shift, nbits);
+			packed = packed && std::equal( expected.begin(), expected.end(), out.begin() ) && out.back() == OutWord(0x5A);
+
+			const std::vector<OutWord> source = random_words<OutWord>( nbits / outSize + 2, rng );
+			std::vector<InWord> back( (shift + nbits + inSize - 1) / inSize + 1, InWord(0x5A) );
+			qfcl::math::unpack_bits<outSize, inSize>( &source[0], nbits, &back[0], shift );
+			const std::vector<InWord> expected_back = naive_unpack<outSize, inSize, OutWord, InWord>(&source[0], nbits, shift);
+			unpacked = unpacked && std::equal( expected_back.begin(), expected_back.end(), back.begin() ) && back.back() == InWord(0x5A);
+
+			// unpacking what was packed restores the bits [shift, shift + nbits), and clears the others
+			std::vector<InWord> restored( (shift + nbits + inSize - 1) / inSize + 1 );
+			qfcl::math::unpack_bits<outSize, inSize>( &out[0], nbits, &restored[0], shift );
+			for (std::size_t j = 0; j < shift + nbits; ++j)
+				round_trip = round_trip && naive_bit<inSize>(&restored[0], j) == (j >= shift && naive_bit<inSize>(&in[0], j));
+		}
+
+	BOOST_CHECK(packed);
+	BOOST_CHECK(unpacked);
+	BOOST_CHECK(round_trip);
+}
+
+BOOST_AUTO_TEST_SUITE(pack_bits)
+
+BOOST_AUTO_TEST_CASE(equal_word_sizes)
+{
+#ifdef QFCL_MATH_AVX2_BITS
+	BOOST_TEST_MESSAGE("\nTesting the packing of bit streams, with AVX2:\n\nTesting equal word sizes ...");
+#else
+	BOOST_TEST_MESSAGE("\nTesting the packing of bit streams, without AVX2:\n\nTesting equal word sizes ...");
+#endif
+
+	check_pack_bits<64, 64, boost::uint64_t, boost::uint64_t>();
+	check_pack_bits<32, 32, boost::uint32_t, boost::uint32_t>();
+	check_pack_bits<31, 31, boost::uint32_t, boost::uint32_t>();
+	check_pack_bits<31, 31, boost::uint64_t, boost::uint64_t>();
+}
+
+BOOST_AUTO_TEST_CASE(different_word_sizes)
+{
+	BOOST_TEST_MESSAGE("Testing different word sizes ...");
+
+	check_pack_bits<32, 64, boost::uint32_t, boost::uint64_t>();
+	check_pack_bits<64, 32, boost::uint64_t, boost::uint32_t>();
+	check_pack_bits<31, 64, boost::uint32_t, boost::uint64_t>();
+	check_pack_bits<64, 31, boost::uint64_t, boost::uint32_t>();
+}
+
+#ifdef QFCL_MATH_AVX2_BITS
+//! the AVX2 funnel shift agrees with the scalar one
+BOOST_AUTO_TEST_CASE(funnel_shift_avx2)
+{
+	BOOST_TEST_MESSAGE("Testing the AVX2 funnel shift ...");
+
+	boost::random::mt19937_64 rng(7);
+	const std::vector<boost::uint64_t> in = random_words<boost::uint64_t>(40, rng);
+
+	bool same = true;
+	for (std::size_t s = 1; s < 64; ++s)
+		for (std::size_t m = 0; m < 39; ++m)
+		{
+			std::vector<boost::uint64_t> out(m + 1, 0);
+			const std::size_t done = qfcl::math::detail::funnel_shift_avx2(&in[0], s, m, &out[0]);
+			same = same && done <= m && m - done < 4;
+			for (std::size_t q = 0; q < done; ++q)
+				same = same && out[q] == ( (in[q] >> s) | (in[q + 1] << (64 - s)) );
+			same = same && out[m] == 0;
+		}
+	BOOST_CHECK(same);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
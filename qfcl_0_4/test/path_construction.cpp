@@ -0,0 +1,298 @@
+/* test/path_construction.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/path_construction.cpp
+	\brief Tests the constructions of Brownian paths of the mc1 schemes.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <qfcl/mc1/BrownianBridge.cpp>
+#include <qfcl/mc1/KLPathGenerator.cpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+//! a non-uniform mesh of \p N intervals on [t0, T], with N not a power of 2
+boost::numeric::ublas::vector<double> test_mesh(std::size_t N = 37, double t0 = 0.5, double T = 2.0)
+{
+	boost::numeric::ublas::vector<double> t(N + 1);
+	for (std::size_t i = 0; i <= N; ++i)
+		t[i] = t0 + (T - t0) * (static_cast<double>(i) / N) * (static_cast<double>(i) / N);
+	return t;
+}
+
+//! \p count standard normals
+std::vector<double> normals(std::size_t count, boost::random::mt19937 & eng)
+{
+	boost::variate_generator< boost::random::mt19937 &, boost::normal_distribution<> > nor( eng, boost::normal_distribution<>() );
+	std::vector<double> z(count);
+	for (std::size_t j = 0; j < count; ++j)
+		z[j] = nor();
+	return z;
+}
+
+//! the relative error allowed for a sample variance of \p M values, about 5 standard deviations
+double variance_tolerance(std::size_t M)
+{
+	return 5 * std::sqrt( 2.0 / M );
+}
+
+BOOST_AUTO_TEST_SUITE(path_construction)
+
+//! the paths start at 0, the terminal point is sqrt(T - t0) times the first normal, and batches agree with single paths
+BOOST_AUTO_TEST_CASE(bridge_endpoints)
+{
+	BOOST_TEST_MESSAGE("\nTesting path construction:\n\nTesting the Brownian bridge endpoints ...");
+
+	const boost::numeric::ublas::vector<double> t = test_mesh();
+	const BrownianBridge<> bridge(t);
+	const std::size_t N = t.size() - 1, M = 5;
+	BOOST_REQUIRE_EQUAL( bridge.dimension(), N );
+	BOOST_REQUIRE_EQUAL( bridge.points(), N + 1 );
+
+	boost::random::mt19937 eng(2012);
+	const std::vector<double> z = normals(N * M, eng);
+	std::vector<double> w( (N + 1) * M );
+	bridge.buildPaths( &z[0], &w[0], M );
+
+	std::vector<double> zm(N), wm(N + 1);
+	bool start = true, end = true, single = true;
+	for (std::size_t m = 0; m < M; ++m)
+	{
+		start = start && w[m] == 0;
+		end = end && std::abs( w[N * M + m] - std::sqrt(t[N] - t[0]) * z[m] ) < 1e-15;
+
+		for (std::size_t d = 0; d < N; ++d)
+			zm[d] = z[d * M + m];
+		bridge.buildPath( &zm[0], &wm[0] );
+		for (std::size_t i = 0; i <= N; ++i)
+			single = single && wm[i] == w[i * M + m];
+	}
+	BOOST_CHECK(start);
+	BOOST_CHECK(end);
+	BOOST_CHECK(single);
+
+	// a mesh of one interval is fine, but not of none, nor a decreasing one
+	BOOST_CHECK_NO_THROW( BrownianBridge<>( test_mesh(1) ) );
+	BOOST_CHECK_THROW( BrownianBridge<>( boost::numeric::ublas::vector<double>(1, 0.0) ), std::invalid_argument );
+	BOOST_CHECK_THROW( BrownianBridge<>( -t ), std::invalid_argument );
+}
+
+//! the variance of W(t_i) is t_i - t0
+BOOST_AUTO_TEST_CASE(bridge_variance)
+{
+	BOOST_TEST_MESSAGE("Testing the Brownian bridge variance ...");
+
+	const boost::numeric::ublas::vector<double> t = test_mesh();
+	const BrownianBridge<> bridge(t);
+	const std::size_t N = t.size() - 1, M = 100000;
+
+	boost::random::mt19937 eng(7);
+	const std::vector<double> z = normals(N * M, eng);
+	std::vector<double> w( (N + 1) * M );
+	bridge.buildPaths( &z[0], &w[0], M );
+
+	bool ok = true;
+	for (std::size_t i = 1; i <= N; ++i)
+	{
+		double sum2 = 0;
+		for (std::size_t m = 0; m < M; ++m)
+			sum2 += w[i * M + m] * w[i * M + m];
+		const double variance = t[i] - t[0];
+		ok = ok && std::abs(sum2 / M - variance) < variance * variance_tolerance(M);
+	}
+	BOOST_CHECK(ok);
+}
+
+//! given W(T), W(t_i) has mean W(T) (t_i - t0) / (T - t0) and variance (t_i - t0)(T - t_i) / (T - t0)
+BOOST_AUTO_TEST_CASE(bridge_conditional_variance)
+{
+	BOOST_TEST_MESSAGE("Testing the Brownian bridge conditional variance ...");
+
+	const boost::numeric::ublas::vector<double> t = test_mesh();
+	const BrownianBridge<> bridge(t);
+	const std::size_t N = t.size() - 1, M = 100000;
+	const double span = t[N] - t[0];
+
+	// the first normal fixes the terminal point of every path
+	boost::random::mt19937 eng(99);
+	std::vector<double> z = normals(N * M, eng);
+	const double zT = 1.3, WT = std::sqrt(span) * zT;
+	for (std::size_t m = 0; m < M; ++m)
+		z[m] = zT;
+
+	std::vector<double> w( (N + 1) * M );
+	bridge.buildPaths( &z[0], &w[0], M );
+
+	bool means = true, variances = true;
+	for (std::size_t i = 1; i < N; ++i)
+	{
+		double sum = 0, sum2 = 0;
+		for (std::size_t m = 0; m < M; ++m)
+		{
+			sum += w[i * M + m];
+			sum2 += w[i * M + m] * w[i * M + m];
+		}
+		const double mean = sum / M, variance = sum2 / M - mean * mean;
+		const double expected_mean = WT * (t[i] - t[0]) / span;
+		const double expected_variance = (t[i] - t[0]) * (t[N] - t[i]) / span;
+		means = means && std::abs(mean - expected_mean) < 5 * std::sqrt(expected_variance / M);
+		variances = variances && std::abs(variance - expected_variance) < expected_variance * variance_tolerance(M);
+	}
+	BOOST_CHECK(means);
+	BOOST_CHECK(variances);
+
+	// and the terminal point does not vary
+	bool fixed = true;
+	for (std::size_t m = 0; m < M; ++m)
+		fixed = fixed && w[N * M + m] == w[N * M];
+	BOOST_CHECK(fixed);
+}
+
+//! the largest difference between the covariance of the truncated KL expansion with \p K terms and min(s, t) - t0, over the mesh
+double kl_covariance_error(const boost::numeric::ublas::vector<double> & t, std::size_t K)
+{
+	const KLPathGenerator<> kl(t, K);
+	const std::size_t N = t.size() - 1;
+
+	double error = 0;
+	for (std::size_t i = 0; i <= N; ++i)
+		for (std::size_t j = i; j <= N; ++j)
+		{
+			double covariance = 0;
+			for (std::size_t n = 0; n < K; ++n)
+				covariance += kl.basis(i, n) * kl.basis(j, n);
+			error = std::max( error, std::abs(covariance - (t[i] - t[0])) );
+		}
+
+	return error;
+}
+
+//! the covariance sum_n phi_n(s) phi_n(t) of the truncated expansion converges to min(s, t)
+BOOST_AUTO_TEST_CASE(kl_covariance)
+{
+	BOOST_TEST_MESSAGE("Testing the convergence of the Karhunen-Loeve covariance ...");
+
+	const boost::numeric::ublas::vector<double> t = test_mesh();
+	const double T = t[t.size() - 1] - t[0];
+
+	// the tail sum_{n >= K} phi_n(s) phi_n(t) is at most 8T / pi^2 sum_{n >= K} 1 / (2n + 1)^2 <= 2T / (pi^2 K)
+	const std::size_t terms[] = {1, 4, 16, 64, 256, 1024};
+	double previous = T;
+	for (std::size_t j = 0; j < sizeof(terms) / sizeof(terms[0]); ++j)
+	{
+		const std::size_t K = terms[j];
+		const double error = kl_covariance_error(t, K);
+		BOOST_CHECK_LE( error, 2 * T / ( qfcl::math::pi<double>() * qfcl::math::pi<double>() * K ) );
+		BOOST_CHECK_LT( error, previous );
+		previous = error;
+	}
+	BOOST_CHECK_LT( previous, 1e-3 );
+
+	// the truncation for a tolerance is enough for the covariance to be within it
+	const std::size_t K = KLPathGenerator<>::truncation(T, 0.01);
+	BOOST_CHECK_LE( kl_covariance_error(t, K), 0.01 );
+}
+
+//! the discrete expansion has the covariance min(s, t) - t0 on the mesh exactly, so its increments are independent
+BOOST_AUTO_TEST_CASE(kl_discrete)
+{
+	BOOST_TEST_MESSAGE("Testing the discrete Karhunen-Loeve expansion ...");
+
+	const std::size_t steps[] = {1, 2, 37, 200};
+	for (std::size_t j = 0; j < sizeof(steps) / sizeof(steps[0]); ++j)
+	{
+		const boost::numeric::ublas::vector<double> t = test_mesh(steps[j]);
+		const std::size_t N = t.size() - 1;
+		const KLPathGenerator<> kl(t);
+		BOOST_REQUIRE_EQUAL( kl.terms(), N );
+
+		double error = 0;
+		for (std::size_t i = 0; i <= N; ++i)
+			for (std::size_t k = i; k <= N; ++k)
+			{
+				double covariance = 0;
+				for (std::size_t n = 0; n < N; ++n)
+					covariance += kl.basis(i, n) * kl.basis(k, n);
+				error = std::max( error, std::abs(covariance - (t[i] - t[0])) );
+			}
+		BOOST_CHECK_SMALL( error, 1e-12 );
+	}
+
+	// on a uniform mesh it is the principal component decomposition, with decreasing variances sum_i phi_n(t_i)^2
+	boost::numeric::ublas::vector<double> t(51);
+	for (std::size_t i = 0; i < t.size(); ++i)
+		t[i] = 0.02 * i;
+	const KLPathGenerator<> kl(t);
+	double previous = 1e300;
+	bool decreasing = true;
+	for (std::size_t n = 0; n < kl.terms(); ++n)
+	{
+		double variance = 0;
+		for (std::size_t i = 0; i < t.size(); ++i)
+			variance += kl.basis(i, n) * kl.basis(i, n);
+		decreasing = decreasing && variance < previous;
+		previous = variance;
+	}
+	BOOST_CHECK(decreasing);
+
+	BOOST_CHECK_THROW( KLPathGenerator<>( boost::numeric::ublas::vector<double>(1) ), std::invalid_argument );
+}
+
+//! the paths and increments are the products of the normals and the basis
+BOOST_AUTO_TEST_CASE(kl_paths)
+{
+	BOOST_TEST_MESSAGE("Testing the Karhunen-Loeve paths ...");
+
+	const boost::numeric::ublas::vector<double> t = test_mesh();
+	// more terms and paths than the blocks of the product
+	const std::size_t K = 150, M = 70, N = t.size() - 1;
+	const KLPathGenerator<> kl(t, K);
+	BOOST_REQUIRE_EQUAL( kl.points(), N + 1 );
+
+	boost::random::mt19937 eng(11);
+	const std::vector<double> z = normals(M * K, eng);
+	std::vector<double> w( M * (N + 1) ), dw( M * N );
+	kl.buildPaths( &z[0], &w[0], M );
+	kl.buildIncrements( &z[0], &dw[0], M );
+
+	bool paths = true, increments = true;
+	for (std::size_t m = 0; m < M; ++m)
+		for (std::size_t i = 0; i <= N; ++i)
+		{
+			double expected = 0;
+			for (std::size_t n = 0; n < K; ++n)
+				expected += z[m * K + n] * kl.basis(i, n);
+			paths = paths && std::abs(w[m * (N + 1) + i] - expected) < 1e-12;
+			if (i < N)
+				increments = increments && std::abs( dw[m * N + i] - (w[m * (N + 1) + i + 1] - w[m * (N + 1) + i]) ) < 1e-12;
+		}
+	BOOST_CHECK(paths);
+	BOOST_CHECK(increments);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
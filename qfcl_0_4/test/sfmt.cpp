@@ -0,0 +1,173 @@
+/* test/sfmt.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/sfmt.cpp
+	\brief Tests the SFMT and dSFMT engines.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <sstream>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/mpl/string.hpp>
+
+#include <qfcl/random/engine/dsfmt.hpp>
+#include <qfcl/random/engine/sfmt.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+typedef boost::mpl::list<sfmt19937, dsfmt19937> sfmt_engines;
+
+BOOST_AUTO_TEST_SUITE(SFMT)
+
+//! the first outputs of the reference implementations
+BOOST_AUTO_TEST_CASE(known)
+{
+	BOOST_TEST_MESSAGE("\nTesting the SFMT engines:\n\nTesting known values ...");
+
+	// init_gen_rand(1234)
+	const boost::uint32_t sfmt_expected[] = { 3440181298u, 1564997079u, 1510669302u, 2930277156u, 1452439940u,
+											  3796268453u, 423124208u, 2143818589u, 3827219408u, 2987036003u };
+	sfmt19937 s(1234);
+	bool sfmt_known = true;
+	BOOST_FOREACH(boost::uint32_t x, sfmt_expected)
+		sfmt_known = sfmt_known && s() == x;
+	BOOST_CHECK(sfmt_known);
+
+	// init_gen_rand(0), genrand_close1_open2
+	dsfmt19937 d(0);
+	BOOST_CHECK_CLOSE( d(), 1.030581026769374, 1e-13 );
+	BOOST_CHECK_CLOSE( d(), 1.213140320067012, 1e-13 );
+}
+
+//! \c fill gives the numbers and state of repeated calls
+BOOST_AUTO_TEST_CASE_TEMPLATE(fill, Engine, sfmt_engines)
+{
+	BOOST_TEST_MESSAGE( "Testing " << boost::mpl::c_str<typename Engine::name>::value << " ..." );
+
+	typedef typename Engine::result_type result_type;
+
+	// less than a block, and several blocks with parts at both ends
+	const std::size_t sizes[] = {3, 5 * Engine::n + 7, 3 * Engine::n * 4 + 1};
+	BOOST_FOREACH(std::size_t size, sizes)
+	{
+		Engine filled(2012), stepped(2012);
+		filled();
+		stepped();
+
+		std::vector<result_type> values(size);
+		filled.fill( &values[0], values.size() );
+
+		bool same = true;
+		BOOST_FOREACH(result_type x, values)
+			same = same && stepped() == x;
+		BOOST_CHECK(same);
+		BOOST_CHECK( filled == stepped );
+	}
+}
+
+//! jumps and \c discard agree with generating the numbers
+BOOST_AUTO_TEST_CASE_TEMPLATE(jumps, Engine, sfmt_engines)
+{
+	// numbers per 128 bit word
+	const std::size_t per_word = 16 / sizeof(typename Engine::result_type);
+
+	// the recursion is found in full
+	const long degree = NTL::deg( Engine::minimal_polynomial().val() );
+	BOOST_CHECK( degree >= 19937 && degree <= static_cast<long>(Engine::state_bits) );
+
+	// words, including part of a block
+	const unsigned long words[] = {0, 1, 3, Engine::n, 2 * Engine::n + 5, 100003};
+	BOOST_FOREACH(unsigned long J, words)
+	{
+		Engine jumped(31), stepped(31);
+		jumped();
+		stepped();
+
+		jumped.jump( Engine::jump_string( qfcl::random::detail::to_ZZ(J) ).c_str() );
+		for (unsigned long i = 0; i < J * per_word; ++i)
+			stepped();
+
+		bool same = true;
+		for (int i = 0; i < 1000; ++i)
+			same = same && jumped() == stepped();
+		BOOST_CHECK(same);
+	}
+
+	// beyond the threshold discard jumps
+	const unsigned long long skips[] = {0, 1, 1000, Engine::discard_threshold + 12345};
+	BOOST_FOREACH(unsigned long long z, skips)
+	{
+		Engine discarded(5), stepped(5);
+		discarded.discard(z);
+		for (unsigned long long i = 0; i < z; ++i)
+			stepped();
+		BOOST_CHECK( discarded == stepped );
+	}
+}
+
+//! streaming, and seeding from a sequence
+BOOST_AUTO_TEST_CASE_TEMPLATE(state, Engine, sfmt_engines)
+{
+	const boost::uint32_t key[] = {0x1234, 0x5678, 0x9abc, 0xdef0};
+	Engine eng(key, key + 4), other;
+	BOOST_CHECK( eng != other );
+
+	eng();
+	std::stringstream ss;
+	ss << eng;
+	ss >> other;
+	BOOST_CHECK( eng == other );
+	BOOST_CHECK_EQUAL( eng(), other() );
+}
+
+//! the uniform distributions on the native doubles of dSFMT
+BOOST_AUTO_TEST_CASE(dsfmt_uniform)
+{
+	const dsfmt19937 eng(777);
+	variate_generator< dsfmt19937, uniform_0in_1ex<> > u_0in_1ex( eng, uniform_0in_1ex<>() );
+	variate_generator< dsfmt19937, uniform_0ex_1in<> > u_0ex_1in( eng, uniform_0ex_1in<>() );
+	variate_generator< dsfmt19937, uniform_0ex_1ex<> > u_0ex_1ex( eng, uniform_0ex_1ex<>() );
+	variate_generator< dsfmt19937, uniform_0in_1in<> > u_0in_1in( eng, uniform_0in_1in<>() );
+
+	dsfmt19937 native(eng);
+	bool in_range = true, shifted = true;
+	for (int i = 0; i < 100000; ++i)
+	{
+		const double d = native();
+		const double a = u_0in_1ex(), b = u_0ex_1in(), c = u_0ex_1ex(), e = u_0in_1in();
+		in_range = in_range && 0 <= a && a < 1 && 0 < b && b <= 1 && 0 < c && c < 1 && 0 <= e && e <= 1;
+		shifted = shifted && a == d - 1 && b == 2 - d;
+	}
+	BOOST_CHECK(in_range);
+	BOOST_CHECK(shifted);
+
+	// fill in the same ranges
+	dsfmt19937 bulk(eng);
+	std::vector<double> values(10000);
+	bulk.fill_open_open( &values[0], values.size() );
+	bool open_open = true;
+	BOOST_FOREACH(double x, values)
+		open_open = open_open && 0 < x && x < 1;
+	BOOST_CHECK(open_open);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
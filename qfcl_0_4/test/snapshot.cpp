@@ -0,0 +1,138 @@
+/* test/snapshot.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/snapshot.cpp
+	\brief Tests the binary snapshots of the counter based engines.
+
+	The snapshots of the linear generators are tested with the generators, in test/linear_generator.cpp.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/mpl/list.hpp>
+#include <boost/random/ars.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/counter_based_urng.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+
+#include <qfcl/random/engine/snapshot.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+typedef boost::random::philox<4, boost::uint32_t> philox4x32;
+typedef boost::random::threefry<4, boost::uint32_t> threefry4x32;
+typedef boost::random::ars<boost::uint32_t> ars4x32;
+
+typedef boost::mpl::list< philox4x32, boost::random::philox<2, boost::uint64_t>, threefry4x32,
+						  boost::random::threefry<2, boost::uint64_t>, ars4x32 > prfs;
+
+//! saves \p eng and restores it into \p other
+template<typename Engine, typename OtherEngine>
+void restore_from(const Engine & eng, OtherEngine & other)
+{
+	std::vector<char> buffer( snapshot_size(eng) );
+	BOOST_REQUIRE( save_snapshot(eng, &buffer[0]) == &buffer[0] + buffer.size() );
+	restore_snapshot(other, &buffer[0]);
+}
+
+BOOST_AUTO_TEST_SUITE(snapshot)
+
+//! a restored \c counter_based_engine continues exactly where the saved one was
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine, Prf, prfs)
+{
+	if ( qfcl::tmp::is_first<prfs, Prf>::value )
+		BOOST_TEST_MESSAGE("\nTesting snapshots of counter based engines:\n\nTesting counter_based_engine ...");
+
+	typedef boost::random::counter_based_engine<Prf> Engine;
+
+	typename Prf::key_type key;
+	for (std::size_t k = 0; k < key.size(); ++k)
+		key[k] = static_cast<typename Prf::key_type::value_type>(2012 + k);
+	Engine eng;
+	eng.seed(key);
+	// stop within a block of output
+	for (int i = 0; i < 11; ++i)
+		eng();
+
+	Engine other;
+	restore_from(eng, other);
+
+	bool same = true;
+	for (int i = 0; i < 1000; ++i)
+		same = same && eng() == other();
+	BOOST_CHECK(same);
+}
+
+//! a restored \c counter_based_urng continues exactly where the saved one was
+BOOST_AUTO_TEST_CASE_TEMPLATE(urng, Prf, prfs)
+{
+	if ( qfcl::tmp::is_first<prfs, Prf>::value )
+		BOOST_TEST_MESSAGE("Testing counter_based_urng ...");
+
+	typedef boost::random::counter_based_urng<Prf> Urng;
+
+	typename Prf::key_type key;
+	for (std::size_t k = 0; k < key.size(); ++k)
+		key[k] = static_cast<typename Prf::key_type::value_type>(7 * k + 1);
+	typename Prf::domain_type c0;
+	c0.fill( Prf::domain_array_min() );
+	c0[0] = 99;
+
+	Urng eng( Prf(key), c0 );
+	for (int i = 0; i < 5; ++i)
+		eng();
+
+	Urng other( Prf(), c0 );
+	restore_from(eng, other);
+
+	bool same = true;
+	for (int i = 0; i < 1000; ++i)
+		same = same && eng() == other();
+	BOOST_CHECK(same);
+}
+
+//! a snapshot is rejected by an engine over a PRF of another family, or with other rounds, even of the same shape
+BOOST_AUTO_TEST_CASE(prf_type)
+{
+	BOOST_TEST_MESSAGE("Testing that snapshots of other PRFs are rejected ...");
+
+	// all three have 4 x 32 bit counters, range and key
+	boost::random::counter_based_engine<threefry4x32> threefry;
+	boost::random::counter_based_engine<ars4x32> ars;
+	boost::random::counter_based_engine< boost::random::threefry<4, boost::uint32_t, 13> > threefry13;
+
+	BOOST_CHECK_THROW( restore_from(threefry, ars), std::runtime_error );
+	BOOST_CHECK_THROW( restore_from(ars, threefry), std::runtime_error );
+	BOOST_CHECK_THROW( restore_from(threefry, threefry13), std::runtime_error );
+
+	// and the same for the URNG adaptor
+	threefry4x32::domain_type c0;
+	c0.fill(0);
+	boost::random::counter_based_urng<threefry4x32> threefry_urng( threefry4x32(), c0 );
+	boost::random::counter_based_urng<ars4x32> ars_urng( ars4x32(), c0 );
+	BOOST_CHECK_THROW( restore_from(threefry_urng, ars_urng), std::runtime_error );
+
+	// nor is an engine snapshot restored into a URNG
+	BOOST_CHECK_THROW( restore_from(threefry, threefry_urng), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,173 @@
+/* test/sobol.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/sobol.cpp
+	\brief Tests the Sobol quasi-random engine.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/random/engine/sobol.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+//! checks that the first \f$2^m\f$ points take each value of \f$\{0, 1, \ldots, 2^m - 1\}\f$ once in each coordinate, in the top \p m bits
+template<typename Engine>
+bool stratified(Engine eng, int m)
+{
+	const size_t n = size_t(1) << m;
+	std::vector< std::set<typename Engine::result_type> > cells( eng.dimension() );
+	std::vector<typename Engine::result_type> x( eng.dimension() );
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		eng.generate(&x[0]);
+		for (size_t d = 0; d < eng.dimension(); ++d)
+			cells[d].insert( x[d] >> (Engine::digits - m) );
+	}
+
+	for (size_t d = 0; d < eng.dimension(); ++d)
+		if (cells[d].size() != n)
+			return false;
+
+	return true;
+}
+
+BOOST_AUTO_TEST_SUITE(Sobol)
+
+//! the first points of the first 3 dimensions
+BOOST_AUTO_TEST_CASE(known_values)
+{
+	BOOST_TEST_MESSAGE("\nTesting the Sobol engine:\n\nTesting known values ...");
+
+	const double expected[5][3] = { {0, 0, 0}, {0.5, 0.5, 0.5}, {0.75, 0.25, 0.25}, {0.25, 0.75, 0.75}, {0.375, 0.375, 0.625} };
+
+	sobol eng(3);
+	for (size_t i = 0; i < 5; ++i)
+		for (size_t d = 0; d < 3; ++d)
+			BOOST_CHECK_EQUAL( eng() / 4294967296.0, expected[i][d] );
+}
+
+//! \c seek and \c discard agree with sequential generation
+BOOST_AUTO_TEST_CASE(skip_ahead)
+{
+	BOOST_TEST_MESSAGE("Testing seek and discard ...");
+
+	const size_t D = 17;
+	sobol sequential(D);
+	std::vector<sobol::result_type> values(1000 * D);
+	for (size_t j = 0; j < values.size(); ++j)
+		values[j] = sequential();
+
+	const size_t points[] = {0, 1, 2, 3, 7, 8, 255, 256, 511, 999};
+	BOOST_FOREACH(size_t n, points)
+	{
+		sobol eng(D);
+		eng.seek(n);
+		BOOST_CHECK_EQUAL( eng.tell(), n );
+		for (size_t d = 0; d < D; ++d)
+			BOOST_CHECK_EQUAL( eng(), values[n * D + d] );
+	}
+
+	const size_t skips[] = {1, 5, 16, 17, 18, 100, 3 * D, 3 * D + 1};
+	BOOST_FOREACH(size_t z, skips)
+	{
+		sobol eng(D);
+		eng();
+		eng.discard(z);
+		BOOST_CHECK_EQUAL( eng(), values[z + 1] );
+	}
+
+	sobol eng(D);
+	eng.seek(sobol::max() + boost::uint64_t(1));
+	BOOST_CHECK_THROW( eng(), std::out_of_range );
+	BOOST_CHECK_THROW( eng.seek(sobol::max() + boost::uint64_t(2)), std::out_of_range );
+}
+
+//! \c generate_block agrees with \c generate
+BOOST_AUTO_TEST_CASE(block)
+{
+	BOOST_TEST_MESSAGE("Testing bulk generation ...");
+
+	const size_t D = 40, n = 100;
+	sobol eng(D), other(D);
+	std::vector<double> out(D * n);
+	std::vector<sobol::result_type> x(D);
+
+	eng.generate_block(&out[0], n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		other.generate(&x[0]);
+		for (size_t d = 0; d < D; ++d)
+		{
+			BOOST_CHECK_EQUAL( out[d * n + i], (x[d] + 0.5) / 4294967296.0 );
+			BOOST_CHECK( out[d * n + i] > 0 && out[d * n + i] < 1 );
+		}
+	}
+	BOOST_CHECK(eng == other);
+}
+
+//! equidistribution of the unscrambled and scrambled sequences
+BOOST_AUTO_TEST_CASE(equidistribution)
+{
+	BOOST_TEST_MESSAGE("Testing equidistribution ...");
+
+	sobol eng(100);
+	BOOST_CHECK( stratified(eng, 10) );
+
+	sobol_64 eng64(100);
+	BOOST_CHECK( stratified(eng64, 10) );
+
+	boost::random::mt19937 rng;
+	sobol scrambled(eng);
+	scrambled.scramble(rng);
+	BOOST_CHECK( scrambled != eng );
+	BOOST_CHECK( stratified(scrambled, 10) );
+	BOOST_CHECK( scrambled() != 0 );
+}
+
+//! the built-in table agrees with one read in the format of Joe and Kuo
+BOOST_AUTO_TEST_CASE(direction_numbers)
+{
+	BOOST_TEST_MESSAGE("Testing direction numbers ...");
+
+	std::stringstream ss;
+	ss << "d       s       a       m_i" << std::endl
+	   << "2       1       0       1" << std::endl
+	   << "3       2       1       1 3" << std::endl
+	   << "4       3       1       1 3 1" << std::endl
+	   << "5       3       2       1 1 1" << std::endl;
+
+	BOOST_CHECK( sobol( sobol_direction_numbers(ss, 5) ) == sobol(5) );
+
+	BOOST_CHECK_NO_THROW( sobol(qfcl::random::detail::sobol_table::max_dimension).dimension() );
+	BOOST_CHECK_THROW( sobol(qfcl::random::detail::sobol_table::max_dimension + 1).dimension(), std::invalid_argument );
+
+	std::stringstream short_file("d s a m_i\n2 1 0 1\n");
+	BOOST_CHECK_THROW( sobol_direction_numbers(short_file, 5), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
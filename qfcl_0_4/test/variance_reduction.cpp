@@ -0,0 +1,241 @@
+/* test/variance_reduction.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/variance_reduction.cpp
+	\brief Tests the variance reduction of the mc1 schemes against a known price.
+
+	The model is one Euler step of GBM, S_T = S0 (1 + r T + sigma sqrt(T) Z), so that the call
+	price of the simulated model is known exactly (a Bachelier price) and any bias would show.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/math/distributions/normal.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <qfcl/mc1/VarianceReduction.cpp>
+// MCPostProcess.hpp, included by the mediator, expects the names of std to be visible
+using namespace std;
+#include <qfcl/mc1/MCMediator.hpp>
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+namespace {
+
+typedef boost::random::mt19937 generator_type;
+typedef Sde<double, double, double> sde_type;
+
+const double S0 = 100.0, K = 105.0, r = 0.05, sigma = 0.3, T = 1.0;
+
+double drift(double X, double) {return r * X;}
+double diffusion(double X, double) {return sigma * X;}
+double diffusionDerivative(double, double) {return sigma;}
+double driftCorrected(double X, double, double B) {return r * X - B * sigma * sigma * X;}
+
+//! the discounted call on the terminal value of a path
+struct discounted_call
+{
+	double operator()(const pathType<double> & path) const {return std::exp(-r * T) * std::max(path[path.size() - 1] - K, 0.0);}
+};
+
+//! the call price when S_T is normal with mean S0 (1 + r T) and standard deviation S0 sigma sqrt(T)
+double exact_price()
+{
+	const double m = S0 * (1 + r * T), s = S0 * sigma * std::sqrt(T), d = (m - K) / s;
+	const boost::math::normal N01;
+	return std::exp(-r * T) * ( (m - K) * boost::math::cdf(N01, d) + s * boost::math::pdf(N01, d) );
+}
+
+//! the discounted terminal value, a control with mean S0 (1 + r T) exp(-r T)
+double discounted_terminal(const double * z, std::size_t)
+{
+	return std::exp(-r * T) * S0 * (1 + r * T + sigma * std::sqrt(T) * z[0]);
+}
+
+enum technique {PLAIN, ANTITHETIC, CONTROL, MOMENT_MATCHING};
+
+//! the price estimates of \p R independent runs of \p paths paths each
+std::vector<double> replicate(technique t, std::size_t R, long paths)
+{
+	sde_type sde( S0, Range<double>(0.0, T), drift, driftCorrected, diffusion, diffusionDerivative );
+	ExplicitEuler<double, double, double, generator_type> euler( 1, sde, generator_type() );
+
+	std::vector<double> prices(R);
+	for (std::size_t j = 0; j < R; ++j)
+	{
+		MCVarianceReduction<double, long, generator_type, discounted_call>
+			vr( euler, discounted_call(), generator_type( static_cast<boost::uint32_t>(2012 + j) ), 256 );
+		vr.antithetic(t == ANTITHETIC);
+		vr.momentMatching(t == MOMENT_MATCHING);
+		if (t == CONTROL)
+			vr.control( PathControl<double>( &discounted_terminal, S0 * (1 + r * T) * std::exp(-r * T) ) );
+
+		vr.simulate(paths);
+		BOOST_REQUIRE_EQUAL( vr.pathCount(), paths );
+		prices[j] = vr.price();
+	}
+
+	return prices;
+}
+
+double mean(const std::vector<double> & x)
+{
+	double sum = 0;
+	for (std::size_t j = 0; j < x.size(); ++j)
+		sum += x[j];
+	return sum / x.size();
+}
+
+double variance(const std::vector<double> & x)
+{
+	const double m = mean(x);
+	double sum2 = 0;
+	for (std::size_t j = 0; j < x.size(); ++j)
+		sum2 += (x[j] - m) * (x[j] - m);
+	return sum2 / (x.size() - 1);
+}
+
+const std::size_t R = 100;
+const long paths = 4096;
+
+//! the runs of the plain estimator, the reference for the variances
+const std::vector<double> & plain_runs()
+{
+	static const std::vector<double> prices = replicate(PLAIN, R, paths);
+	return prices;
+}
+
+//! the mean of the runs is the exact price, within 4 standard errors of the mean of the runs and \p bias
+void check_unbiased(const std::vector<double> & prices, double bias = 0)
+{
+	BOOST_CHECK_SMALL( mean(prices) - exact_price(), bias + 4 * std::sqrt( variance(prices) / prices.size() ) );
+}
+
+//! a reporter for MCTypeDMediator that keeps the values it is sent
+struct value_reporter
+{
+	void operator()(Status) {}
+	void operator()(const boost::numeric::ublas::vector<double> & v) {values = v;}
+
+	boost::numeric::ublas::vector<double> values;
+};
+
+}	// namespace
+
+BOOST_AUTO_TEST_SUITE(variance_reduction)
+
+BOOST_AUTO_TEST_CASE(plain)
+{
+	BOOST_TEST_MESSAGE("\nTesting variance reduction:\n\nTesting the plain estimator ...");
+
+	check_unbiased( plain_runs() );
+}
+
+//! antithetic pairs (with the same number of paths) are unbiased and, for a monotone payoff, reduce the variance
+BOOST_AUTO_TEST_CASE(antithetic)
+{
+	BOOST_TEST_MESSAGE("Testing antithetic variates ...");
+
+	const std::vector<double> prices = replicate(ANTITHETIC, R, paths);
+	check_unbiased(prices);
+	BOOST_CHECK_LT( variance(prices), variance( plain_runs() ) / 1.5 );
+}
+
+//! the control variate is unbiased, and removes most of the variance of a payoff so correlated with it
+BOOST_AUTO_TEST_CASE(control_variate)
+{
+	BOOST_TEST_MESSAGE("Testing control variates ...");
+
+	const std::vector<double> prices = replicate(CONTROL, R, paths);
+	check_unbiased(prices);
+	BOOST_CHECK_LT( variance(prices), variance( plain_runs() ) / 2.5 );
+}
+
+//! moment matching the batches has a bias of order 1 / batch size, and reduces the variance
+BOOST_AUTO_TEST_CASE(moment_matching)
+{
+	BOOST_TEST_MESSAGE("Testing moment matching ...");
+
+	const std::vector<double> prices = replicate(MOMENT_MATCHING, R, paths);
+	check_unbiased( prices, exact_price() / 256 );
+	BOOST_CHECK_LT( variance(prices), variance( plain_runs() ) );
+}
+
+//! the reported standard error and reduction factor agree with those of independent runs
+BOOST_AUTO_TEST_CASE(standard_error)
+{
+	BOOST_TEST_MESSAGE("Testing the standard errors ...");
+
+	sde_type sde( S0, Range<double>(0.0, T), drift, driftCorrected, diffusion, diffusionDerivative );
+	ExplicitEuler<double, double, double, generator_type> euler( 1, sde, generator_type() );
+	MCVarianceReduction<double, long, generator_type, discounted_call> vr( euler, discounted_call(), generator_type(7), 256 );
+	vr.control( PathControl<double>( &discounted_terminal, S0 * (1 + r * T) * std::exp(-r * T) ) );
+	vr.simulate(paths);
+
+	const double se = std::sqrt( variance( replicate(CONTROL, R, paths) ) );
+	BOOST_CHECK_CLOSE( vr.standardError(), se, 25 );
+	BOOST_CHECK_CLOSE( vr.factor(), variance( plain_runs() ) / (se * se), 40 );
+}
+
+//! MCTypeDMediator prices through the variance reduction when given one, and reports its samples
+BOOST_AUTO_TEST_CASE(mediator)
+{
+	BOOST_TEST_MESSAGE("Testing variance reduction through the mediator ...");
+
+	typedef MCTypeDMediator<double, long, generator_type, discounted_call, value_reporter> mediator_type;
+	const long NSim = 20000;
+
+	sde_type sde( S0, Range<double>(0.0, T), drift, driftCorrected, diffusion, diffusionDerivative );
+	ExplicitEuler<double, double, double, generator_type> euler( 1, sde, generator_type() );
+	euler.generator.seed(2012);
+
+	value_reporter plainReport;
+	mediator_type plainMediator( euler, plainReport, NSim, discounted_call(), Progress<long>::function(), false );
+	plainMediator.price();
+	BOOST_REQUIRE_EQUAL( plainReport.values.size(), static_cast<std::size_t>(NSim) );
+	const std::vector<double> plain( plainReport.values.begin(), plainReport.values.end() );
+
+	MCVarianceReduction<double, long, generator_type, discounted_call> vr( euler, discounted_call(), generator_type(2013), 250 );
+	vr.antithetic(true);
+	vr.control( PathControl<double>( &discounted_terminal, S0 * (1 + r * T) * std::exp(-r * T) ) );
+
+	value_reporter report;
+	mediator_type mediator( euler, report, NSim, discounted_call(), Progress<long>::function(), false );
+	mediator.varianceReduction(vr);
+	mediator.price();
+
+	// one value per antithetic pair, with mean the price of the variance reduction
+	BOOST_REQUIRE_EQUAL( vr.pathCount(), NSim );
+	BOOST_REQUIRE_EQUAL( report.values.size(), static_cast<std::size_t>(NSim / 2) );
+	const std::vector<double> reduced( report.values.begin(), report.values.end() );
+	BOOST_CHECK_CLOSE( mean(reduced), vr.price(), 1e-10 );
+	BOOST_CHECK_CLOSE( std::sqrt( variance(reduced) / reduced.size() ), vr.standardError(), 1e-6 );
+
+	BOOST_CHECK_SMALL( mean(plain) - exact_price(), 4 * std::sqrt( variance(plain) / plain.size() ) );
+	BOOST_CHECK_SMALL( mean(reduced) - exact_price(), 4 * vr.standardError() );
+	BOOST_CHECK_LT( variance(reduced) / reduced.size(), variance(plain) / plain.size() / 1.5 );
+
+	// a second price() simulates afresh
+	mediator.price();
+	BOOST_CHECK_EQUAL( report.values.size(), static_cast<std::size_t>(NSim / 2) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}
@@ -0,0 +1,178 @@
+/* test/xoshiro.cpp
+ *
+ * Copyright (C) 2012 James Hirschorn <James.Hirschorn@gmail.com>
+ *
+ * Use, modification and distribution are subject to
+ * the BOOST Software License, Version 1.0.
+ * (See accompanying file LICENSE.txt)
+ */
+
+/*! \file test/xoshiro.cpp
+	\brief Tests the xoshiro and xoroshiro engines.
+
+	\author James Hirschorn
+	\date October 19, 2012
+*/
+
+#include <sstream>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/mpl/string.hpp>
+
+#include <qfcl/random/engine/xoshiro.hpp>
+using namespace qfcl::random;
+
+#include "test_generator.ipp"
+using namespace boost::unit_test_framework;
+
+/*! \ingroup TestSuite
+	@{
+*/
+
+typedef boost::mpl::list<xoshiro256starstar, xoshiro256plus, xoroshiro128plus, xoshiro512starstar> xoshiro_engines;
+typedef boost::mpl::list< xoshiro256starstar_x4, xoshiro256starstar_x8, xoshiro256plus_x4, xoshiro256plus_x8,
+						  xoroshiro128plus_x4, xoroshiro128plus_x8, xoshiro512starstar_x4, xoshiro512starstar_x8 > multi_lane_engines;
+
+//! checks the first numbers generated from the state \p s against the reference implementation
+template<typename Engine, size_t N>
+bool known_values(const boost::uint64_t (&s)[Engine::n], const boost::uint64_t (&expected)[N])
+{
+	Engine eng( (typename Engine::state(s)) );
+
+	for (size_t i = 0; i < N; ++i)
+		if (eng() != expected[i])
+			return false;
+
+	return true;
+}
+
+//! \p eng advanced by \f$2^e\f$ steps, using the transition matrix
+template<typename Engine>
+Engine power_of_2_jump(const Engine & eng, int e)
+{
+	typename Engine::matrix_t J = Engine::TransitionMatrix();
+	for (int i = 0; i < e; ++i)
+		J = J * J;
+
+	typename Engine::state s = eng.getState();
+	typename Engine::vector_t v = s;
+	typename Engine::vector_t w = J * v;
+
+	return Engine( (typename Engine::state(w)) );
+}
+
+BOOST_AUTO_TEST_SUITE(Xoshiro)
+
+//! the first outputs of the reference implementations
+BOOST_AUTO_TEST_CASE(known)
+{
+	BOOST_TEST_MESSAGE("\nTesting the xoshiro engines:\n\nTesting known values ...");
+
+	const boost::uint64_t s4[4] = {1, 2, 3, 4};
+	const boost::uint64_t starstar256[] = { UINT64_C(11520), UINT64_C(0), UINT64_C(1509978240), UINT64_C(1215971899390074240),
+		UINT64_C(1216172134540287360), UINT64_C(607988272756665600), UINT64_C(16172922978634559625),
+		UINT64_C(8476171486693032832), UINT64_C(10595114339597558777), UINT64_C(2904607092377533576) };
+	BOOST_CHECK( known_values<xoshiro256starstar>(s4, starstar256) );
+
+	const boost::uint64_t plus256[] = { UINT64_C(5), UINT64_C(211106232532999), UINT64_C(211106635186183),
+		UINT64_C(9223759065350669058), UINT64_C(9250833439874351877) };
+	BOOST_CHECK( known_values<xoshiro256plus>(s4, plus256) );
+
+	const boost::uint64_t s2[2] = {1, 2};
+	const boost::uint64_t plus128[] = { UINT64_C(3), UINT64_C(412333834243), UINT64_C(2360170716294286339), UINT64_C(9295852285959843169) };
+	BOOST_CHECK( known_values<xoroshiro128plus>(s2, plus128) );
+
+	const boost::uint64_t s8[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	const boost::uint64_t starstar512[] = { UINT64_C(11520), UINT64_C(0), UINT64_C(23040), UINT64_C(23667840),
+		UINT64_C(144955163520), UINT64_C(303992986974289920) };
+	BOOST_CHECK( known_values<xoshiro512starstar>(s8, starstar512) );
+}
+
+//! the jump polynomials agree with powers of the transition matrix
+BOOST_AUTO_TEST_CASE_TEMPLATE(jumps, Engine, xoshiro_engines)
+{
+	BOOST_TEST_MESSAGE( "Testing the jumps of " << boost::mpl::c_str<typename Engine::name>::value << " ..." );
+
+	typedef typename Engine::transition_type transition_type;
+
+	const Engine eng(12345);
+
+	Engine j(eng);
+	j.jump();
+	BOOST_CHECK( j == power_of_2_jump(eng, transition_type::jump_exponent) );
+
+	Engine lj(eng);
+	lj.long_jump();
+	BOOST_CHECK( lj == power_of_2_jump(eng, transition_type::long_jump_exponent) );
+}
+
+//! \c discard, \c peek and streaming from the \c linear_generator base
+BOOST_AUTO_TEST_CASE_TEMPLATE(linear_generator_base, Engine, xoshiro_engines)
+{
+	const unsigned long long skips[] = {0, 1, 5, 100, 1000, 5000};
+	BOOST_FOREACH(unsigned long long z, skips)
+	{
+		Engine stepped(777), discarded(777);
+		const Engine peeked(777);
+
+		for (unsigned long long i = 0; i < z; ++i)
+			stepped();
+		discarded.discard(z);
+
+		BOOST_CHECK( stepped == discarded );
+		BOOST_CHECK_EQUAL( peeked.peek(z), stepped() );
+	}
+
+	Engine eng(99), other;
+	eng();
+	std::stringstream ss;
+	ss << eng;
+	ss >> other;
+	BOOST_CHECK( eng == other );
+	BOOST_CHECK_EQUAL( eng(), other() );
+}
+
+//! the lanes are the interleaved streams of the engine after 0, 1, ... jumps
+BOOST_AUTO_TEST_CASE_TEMPLATE(multi_lane, MultiLane, multi_lane_engines)
+{
+	BOOST_TEST_MESSAGE( "Testing " << boost::mpl::c_str<typename MultiLane::name>::value << " ..." );
+
+	typedef typename MultiLane::engine_type Engine;
+	const size_t L = MultiLane::lanes;
+
+	const Engine eng(2024);
+	std::vector<Engine> lanes;
+	Engine e(eng);
+	for (size_t j = 0; j < L; ++j, e.jump())
+		lanes.push_back(e);
+
+	// operator() and generate, with a partial step at the end
+	MultiLane ml(eng), bulk(eng);
+	std::vector<boost::uint64_t> values(100 * L + 3);
+	bulk.generate( values.begin(), values.end() );
+
+	bool interleaved = true;
+	for (size_t t = 0; t < values.size(); ++t)
+	{
+		const boost::uint64_t z = lanes[t % L]();
+		interleaved = interleaved && ml() == z && values[t] == z;
+	}
+	BOOST_CHECK(interleaved);
+	BOOST_CHECK( ml == bulk );
+
+	// the lanes continue after the numbers of the last step
+	BOOST_CHECK( ml.lane(0) == lanes[0] );
+	BOOST_CHECK( ml.lane(L - 1) != lanes[L - 1] );
+
+	MultiLane jumped(eng);
+	jumped.long_jump();
+	Engine lj(eng);
+	lj.long_jump();
+	BOOST_CHECK_EQUAL( jumped(), lj() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//! @}